@@ -18,9 +18,16 @@
 #pragma once
 
 #include <dynamo/2particleEventData.hpp>
+#include <magnet/containers/small_vector.hpp>
 #include <list>
 
 namespace dynamo {
+  /*! \brief The changes to the particles caused by an event.
+
+    Nearly all events change one particle or one pair of particles,
+    so the changes are stored inline and the NEventData does not
+    allocate unless an event changes more particles.
+   */
   class NEventData
   {
   public:
@@ -31,7 +38,7 @@ namespace dynamo {
     NEventData&  operator+=(const ParticleEventData& p) { L1partChanges.push_back(p); return *this; }
     NEventData&  operator+=(const PairEventData& p) { L2partChanges.push_back(p); return *this; }
 
-    std::vector<ParticleEventData> L1partChanges;
-    std::vector<PairEventData> L2partChanges;
+    magnet::containers::SmallVector<ParticleEventData, 2> L1partChanges;
+    magnet::containers::SmallVector<PairEventData, 1> L2partChanges;
   };
 }
@@ -102,6 +102,8 @@ namespace dynamo {
   {
     namespace po = boost::program_options;
 
+    _arguments.assign(argv, argv + argc);
+
     boost::program_options::options_description allopts(""),
       basicOpts, detailedEngineOpts, systemopts("System Options"),
       engineopts("Engine Options")
@@ -131,14 +133,18 @@ namespace dynamo {
        " Values:\n"
        "  1: \tStandard Engine\n"
        "  2: \tNVT Replica Exchange Engine\n"
-       "  3: \tCompression Engine")
+       "  3: \tCompression Engine\n"
+       "  4: \tDistributed NVT Replica Exchange Engine\n"
+       "  5: \tBatch Engine (many independent runs)")
       ;
 
     basicOpts.add(systemopts).add(engineopts);
 
     Engine::getCommonOptions(detailedEngineOpts);
     EReplicaExchangeSimulation::getOptions(detailedEngineOpts);
+    EDistributedReplicaExchangeSimulation::getOptions(detailedEngineOpts);
     ECompressingSimulation::getOptions(detailedEngineOpts);
+    EBatchSimulation::getOptions(detailedEngineOpts);
   
     allopts.add(basicOpts).add(detailedEngineOpts);
 
@@ -185,6 +191,12 @@ namespace dynamo {
       case (3):
 	_engine = shared_ptr<ECompressingSimulation>(new ECompressingSimulation(vm, _threads));
 	break;
+      case (4):
+	_engine = shared_ptr<EDistributedReplicaExchangeSimulation>(new EDistributedReplicaExchangeSimulation(vm, _threads));
+	break;
+      case (5):
+	_engine = shared_ptr<EBatchSimulation>(new EBatchSimulation(vm, _threads));
+	break;
       default:
 	M_throw() << vm["engine"].as<size_t>()
 		  <<", Unknown Engine Number Selected"; 
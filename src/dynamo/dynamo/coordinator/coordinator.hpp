@@ -23,7 +23,7 @@
 #pragma once
 
 #include <dynamo/coordinator/engine/engine.hpp>
-#include <magnet/thread/threadpool.hpp>
+#include <magnet/thread/workstealingpool.hpp>
 #include <boost/program_options.hpp>
 #include <vector>
 #ifdef _WIN32
@@ -36,7 +36,7 @@ namespace dynamo {
    
     This class is responsible for sorting out the correct simulation Engine to 
     run and initialising computational node specific objects like the 
-    ThreadPool.
+    WorkStealingPool.
    */
   class Coordinator
   {
@@ -76,6 +76,14 @@ namespace dynamo {
      */
     boost::program_options::variables_map& parseOptions(int argc, char* argv[]);
 
+    /*! \brief The command line arguments passed to parseOptions
+      (including the program name).
+
+      This is used by engines which must launch further copies of
+      dynarun (e.g., the EDistributedReplicaExchangeSimulation).
+     */
+    const std::vector<std::string>& getArguments() const { return _arguments; }
+
     /*! \brief Creates the specified Engine according to the command
       line options and initialises it.
      */
@@ -135,6 +143,10 @@ namespace dynamo {
      */
     boost::program_options::variables_map vm;
 
+    /*! \brief The unparsed command line arguments.
+     */
+    std::vector<std::string> _arguments;
+
     /*! \brief A smart pointer to the Engine being run.
      */
     shared_ptr<Engine> _engine;
@@ -142,10 +154,10 @@ namespace dynamo {
     /*! \brief A thread pool to utilise multiple cores on the
       computational node.
       
-      This ThreadPool is used/referenced by all code in a single
+      This WorkStealingPool is used/referenced by all code in a single
       dynarun process.
     */
-    magnet::thread::ThreadPool _threads;
+    magnet::thread::WorkStealingPool _threads;
     
     bool _enableVisualisation;
   };
@@ -0,0 +1,306 @@
+/*  dynamo:- Event driven molecular dynamics simulator 
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <dynamo/coordinator/engine/batch.hpp>
+#include <dynamo/coordinator/coordinator.hpp>
+#include <magnet/thread/workstealingpool.hpp>
+#include <magnet/string/searchreplace.hpp>
+#include <magnet/xmlreader.hpp>
+#include <magnet/xmlwriter.hpp>
+#include <boost/lexical_cast.hpp>
+#include <cstdlib>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+
+namespace dynamo {
+  void
+  EBatchSimulation::getOptions(boost::program_options::options_description& opts)
+  {
+    boost::program_options::options_description 
+      bopts("Batch Engine Options (--engine=5)");
+
+    bopts.add_options()
+      ("batch-seeds", boost::program_options::value<size_t>()->default_value(1),
+       "The number of runs of each configuration file, each with a different"
+       " random seed. If --random-seed is set, the seed of each run is the"
+       " passed seed plus the run number.")
+      ("batch-concurrent", boost::program_options::value<size_t>()->default_value(0),
+       "The maximum number of simulations loaded at once. Zero selects the"
+       " number of threads (or one without threads).")
+      ("batch-merged-file", boost::program_options::value<std::string>(),
+       "The file to write the averaged output of all the runs to"
+       " (output.merged.xml.bz2).")
+      ;
+  
+    opts.add(bopts);
+  }
+
+  EBatchSimulation::EBatchSimulation(const boost::program_options::variables_map& nVM, 
+				     magnet::thread::WorkStealingPool& tp):
+    Engine(nVM, "config.%ID.end.xml", "output.%ID.xml", tp),
+    _seeds(1),
+    _jobs(0),
+    _nextJob(0),
+    _finished(0),
+    _stop(false)
+  {}
+
+  void
+  EBatchSimulation::initialisation()
+  {
+    preSimInit();
+
+    if (!vm.count("config-file"))
+      M_throw() << "You must provide at least one input file in batch mode";
+
+    _seeds = vm["batch-seeds"].as<size_t>();
+    if (!_seeds)
+      M_throw() << "Each configuration must be run at least once (--batch-seeds)";
+
+    _jobs = _seeds * vm["config-file"].as<std::vector<std::string> >().size();
+
+    if (configFormat.find("%ID") == configFormat.npos)
+      M_throw() << "Batch mode, but format string for config file output"
+	" doesnt contain %ID";
+  
+    if (outputFormat.find("%ID") == outputFormat.npos)
+      M_throw() << "Batch mode, but format string for output"
+	" file doesnt contain %ID";  
+  }
+
+  void
+  EBatchSimulation::runSimulation()
+  {
+    size_t concurrent = vm["batch-concurrent"].as<size_t>();
+    if (!concurrent)
+      concurrent = std::max(threads.getThreadCount(), size_t(1));
+    concurrent = std::min(concurrent, _jobs);
+
+    std::vector<std::function<void()> > tasks(concurrent, std::bind(&EBatchSimulation::runWorker, this));
+    threads.queueTasks(tasks);
+    threads.wait();
+    std::cout << std::endl;
+  }
+
+  void
+  EBatchSimulation::runWorker()
+  {
+    while (true)
+      {
+	size_t id;
+	{
+	  std::lock_guard<std::mutex> lock(_mutex);
+	  if (_stop || (_nextJob == _jobs)) return;
+	  id = _nextJob++;
+	}
+	runJob(id);
+      }
+  }
+
+  void
+  EBatchSimulation::runJob(const size_t id)
+  {
+    const std::string config = vm["config-file"].as<std::vector<std::string> >()[id / _seeds];
+    const std::string outputFile = magnet::string::search_replace(outputFormat, "%ID", boost::lexical_cast<std::string>(id));
+    try {
+      Simulation sim;
+      sim.simID = id;
+      setupSim(sim, config);
+      if (vm.count("random-seed"))
+	sim.ranGenerator.seed(vm["random-seed"].as<unsigned int>() + id);
+
+      sim.initialise();
+      postSimInit(sim);
+
+      if (vm.count("ticker-period"))
+	sim.setTickerPeriod(vm["ticker-period"].as<double>());
+
+      while (sim.runSimulationStep(true))
+	if (_SIGINT || _SIGTERM)
+	  {
+	    {
+	      std::lock_guard<std::mutex> lock(_mutex);
+	      if (!_stop)
+		std::cout << "\nShutting down the running simulations, no further runs will be started" << std::endl;
+	      _stop = true;
+	    }
+	    sim.simShutdown();
+	  }
+
+      sim.outputData(outputFile);
+      sim.writeXMLfile(magnet::string::search_replace(configFormat, "%ID", boost::lexical_cast<std::string>(id)), !vm.count("unwrapped"));
+    } catch (std::exception& cep) {
+      M_throw() << "Exception caught in run " << id << " of the batch (" << config << ")\n" << cep.what();
+    }
+
+    //Only the output file is held in memory while it is merged
+    magnet::xml::Document doc(outputFile);
+    std::lock_guard<std::mutex> lock(_mutex);
+    _merged.add(doc.getNode("OutputData"), !_finished);
+    ++_finished;
+    std::cout << "\rBatch runs finished " << _finished << "/" << _jobs << "   ";
+    std::cout.flush();
+  }
+
+  void
+  EBatchSimulation::outputData()
+  {
+    if (!_finished)
+      {
+	std::cout << "No runs finished, so no merged output is written" << std::endl;
+	return;
+      }
+
+    std::string filename;
+    if (vm.count("batch-merged-file"))
+      filename = vm["batch-merged-file"].as<std::string>();
+    else
+#ifdef DYNAMO_bzip2_support
+      filename = "output.merged.xml.bz2";
+#else
+      filename = "output.merged.xml";
+#endif
+
+    magnet::xml::XmlStream XML;
+    XML.setFormatXML(true);
+    XML << std::setprecision(std::numeric_limits<double>::digits10 + 2)
+	<< magnet::xml::prolog();
+    _merged.output(XML);
+    XML.write_file(filename);
+
+    std::cout << "Merged output of " << _finished << " runs written to " << filename << std::endl;
+  }
+
+  void
+  EBatchSimulation::MergedNode::Value::add(const std::string& value)
+  {
+    if (!count)
+      first = value;
+    ++count;
+
+    if (!numeric) return;
+
+    char* end;
+    const double val = std::strtod(value.c_str(), &end);
+    if (value.empty() || (*end != '\0') || !std::isfinite(val))
+      {
+	numeric = false;
+	return;
+      }
+
+    sum += val;
+    sum2 += val * val;
+  }
+
+  void
+  EBatchSimulation::MergedNode::add(const magnet::xml::Node& node, bool first)
+  {
+    if (first)
+      name = node.getName();
+
+    //Attributes
+    size_t i = 0;
+    for (magnet::xml::Attribute attr = node.getFirstAttribute(); attr.valid(); attr = attr.getNextAttribute(), ++i)
+      {
+	if (first)
+	  attributes.push_back(std::make_pair(attr.getName(), Value()));
+
+	//Only merge matching attributes
+	if ((i < attributes.size()) && (attributes[i].first == attr.getName()))
+	  attributes[i].second.add(attr.getValue());
+      }
+
+    //Character data, split into whitespace separated values
+    {
+      const std::string text = node.getValue();
+      std::vector<std::pair<std::string, char> > values;
+      size_t pos = text.find_first_not_of(" \t\n\r");
+      while (pos != std::string::npos)
+	{
+	  const size_t end = text.find_first_of(" \t\n\r", pos);
+	  const size_t next = (end == std::string::npos) ? end : text.find_first_not_of(" \t\n\r", end);
+	  //A line break is kept if it is anywhere in the separating whitespace
+	  char separator = ' ';
+	  if ((end != std::string::npos) && (text.substr(end, (next == std::string::npos ? text.size() : next) - end).find('\n') != std::string::npos))
+	    separator = '\n';
+	  values.push_back(std::make_pair(text.substr(pos, end - pos), separator));
+	  pos = next;
+	}
+
+      if (first)
+	{
+	  data.resize(values.size());
+	  for (size_t j(0); j < values.size(); ++j)
+	    data[j].separator = values[j].second;
+	}
+
+      if (values.size() == data.size())
+	for (size_t j(0); j < values.size(); ++j)
+	  data[j].add(values[j].first);
+    }
+
+    //Child nodes
+    i = 0;
+    for (magnet::xml::Node child = node.getFirstChild(); child.valid(); child = child.getNextSibling(), ++i)
+      {
+	if (first)
+	  children.push_back(MergedNode());
+	
+	if ((i < children.size()) && (first || (children[i].name == child.getName())))
+	  children[i].add(child, first);
+      }
+  }
+
+  void
+  EBatchSimulation::MergedNode::output(magnet::xml::XmlStream& XML) const
+  {
+    XML << magnet::xml::tag(name);
+
+    for (const auto& attr : attributes)
+      {
+	const Value& val = attr.second;
+	if (val.numeric)
+	  {
+	    const double mean = val.sum / val.count;
+	    const double variance = std::max(0.0, val.sum2 / val.count - mean * mean);
+	    XML << magnet::xml::attr(attr.first) << mean
+		<< magnet::xml::attr(attr.first + "StdErr") << ((val.count > 1) ? std::sqrt(variance / (val.count - 1)) : 0.0);
+	  }
+	else
+	  XML << magnet::xml::attr(attr.first) << val.first;
+      }
+
+    if (!data.empty())
+      {
+	XML << magnet::xml::chardata();
+	for (const Value& val : data)
+	  {
+	    if (val.numeric)
+	      XML << val.sum / val.count;
+	    else
+	      XML << val.first;
+	    XML << val.separator;
+	  }
+      }
+
+    for (const MergedNode& child : children)
+      child.output(XML);
+
+    XML << magnet::xml::endtag(name);
+  }
+}
@@ -0,0 +1,142 @@
+/*  dynamo:- Event driven molecular dynamics simulator 
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*! \file batch.hpp
+ * \brief Contains the simulation Engine EBatchSimulation
+ */
+
+#pragma once
+#include <dynamo/coordinator/engine/engine.hpp>
+#include <mutex>
+
+namespace magnet { namespace xml { class XmlStream; class Node; } }
+
+namespace dynamo {
+  /*! \brief An Engine for running many independent Simulation's in
+    a single dynarun process.
+
+    Each configuration file is run --batch-seeds times with different
+    random seeds. The runs are queued on the thread pool, but only a
+    fixed number of runs (--batch-concurrent) are loaded at any one
+    time. Each run writes its own output and configuration files
+    (with %ID replaced by the run number) and is destroyed as soon as
+    it finishes, so the memory use does not grow with the number of
+    runs.
+
+    The output files of the runs are averaged into a single merged
+    report, see \ref MergedNode.
+   */
+  class EBatchSimulation: public Engine
+  {
+  public:
+    /*! \brief Only constructor.
+     
+      \param vm A reference to the Coordinator's parsed command line variables.
+      \param tp A reference to the thread pool of the dynarun instance.
+     */ 
+    EBatchSimulation(const boost::program_options::variables_map& vm, 
+		     magnet::thread::WorkStealingPool& tp);
+
+    /*! \brief Trivial virtual destructor */
+    virtual ~EBatchSimulation() {}
+    
+    /*! \brief Run every Simulation of the batch.
+     */
+    virtual void runSimulation();
+
+    /*! \brief Write the merged output of the runs.
+     */
+    virtual void outputData();
+  
+    /*! \brief The configurations are written as each run finishes,
+      so nothing is done here.
+     */
+    virtual void outputConfigs() {}
+
+    /*! \brief No Engine finalisation required.
+     */
+    virtual void finaliseRun() {}
+
+    /*! \brief Check the configuration files and options.
+     */
+    virtual void initialisation();
+
+    /*! \brief Return the options for the EBatchSimulation Engine.
+     */
+    static void getOptions(boost::program_options::options_description&);
+
+  protected:
+    /*! \brief The averaged contents of a Node of the output files.
+
+      The output files of the runs are matched up by the position
+      and name of each element. Every numeric attribute is replaced
+      by its mean over the runs and an attribute with the standard
+      error of the mean is added (the name of the attribute with
+      "StdErr" appended). Numeric character data (e.g., the columns
+      of a histogram) is averaged value by value. Anything else is
+      copied from the first run.
+     */
+    struct MergedNode
+    {
+      struct Value
+      {
+	Value(): sum(0), sum2(0), count(0), numeric(true) {}
+
+	void add(const std::string&);
+
+	std::string first;
+	double sum;
+	double sum2;
+	size_t count;
+	bool numeric;
+	//! \brief The whitespace following this value in character data.
+	char separator;
+      };
+
+      void add(const magnet::xml::Node&, bool first);
+
+      void output(magnet::xml::XmlStream&) const;
+
+      std::string name;
+      std::vector<std::pair<std::string, Value> > attributes;
+      std::vector<Value> data;
+      std::vector<MergedNode> children;
+    };
+
+    /*! \brief The loop of each thread, taking runs until the batch
+      is finished.
+     */
+    void runWorker();
+
+    /*! \brief Load, run, output and merge a single run of the batch.
+     */
+    void runJob(const size_t id);
+
+    //! \brief The number of runs of each configuration file.
+    size_t _seeds;
+    //! \brief The total number of runs.
+    size_t _jobs;
+    //! \brief The number of the next run to start.
+    size_t _nextJob;
+    //! \brief The number of runs merged so far.
+    size_t _finished;
+    //! \brief Set to stop any further runs starting.
+    bool _stop;
+
+    MergedNode _merged;
+    std::mutex _mutex;
+  };
+}
@@ -16,6 +16,18 @@
 */
 
 #include <dynamo/coordinator/engine/compressor.hpp>
+#include <dynamo/dynamics/compression.hpp>
+#include <dynamo/species/species.hpp>
+#include <magnet/thread/workstealingpool.hpp>
+#include <magnet/string/searchreplace.hpp>
+#include <magnet/xmlwriter.hpp>
+#include <magnet/timer.hpp>
+#include <boost/lexical_cast.hpp>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <iomanip>
+#include <random>
 
 namespace dynamo {
   void 
@@ -30,19 +42,259 @@ namespace dynamo {
        "Target packing fraction that compression has to attain to exit")
       ("target-density",boost::program_options::value<double>(),
        "Target number density that compression has to attain to exit")
+      ("compression-trials",boost::program_options::value<size_t>(),
+       "Run this many independent compressions of the configuration (at"
+       " each growth rate), each with a different random seed. If"
+       " --random-seed is set, the seed of each trial is the passed seed"
+       " plus the trial number. Setting any of the trial options runs the"
+       " trials in parallel on the --n-threads.")
+      ("trial-keep-velocities",
+       "Start every compression trial with the velocities of the"
+       " configuration, instead of redrawing them using the seed of the"
+       " trial")
+      ("trial-growth-rates",boost::program_options::value<std::vector<double> >()->multitoken(),
+       "The growth rates of the compression trials (defaults to --growth-rate)")
+      ("jam-tolerance",boost::program_options::value<double>(),
+       "Stop a trial as jammed once its packing fraction increases by less"
+       " than this fraction over --jam-events events")
+      ("jam-events",boost::program_options::value<size_t>()->default_value(0),
+       "The number of events between the jamming checks (zero selects ten"
+       " times the number of particles)")
+      ("keep-trials",boost::program_options::value<std::string>()->default_value("densest"),
+       "Which trials to write out, either \"densest\" or \"all\" (the"
+       " output file names must then contain %ID)")
+      ("trials-file",boost::program_options::value<std::string>(),
+       "The file to write the summary of the trials to"
+       " (compression.trials.xml.bz2)")
       ;
     opts.add(ropts);
   }
 
   ECompressingSimulation::ECompressingSimulation(const boost::program_options::variables_map& nVM, 
-						 magnet::thread::ThreadPool& tp):
-    ESingleSimulation(nVM, tp)
+						 magnet::thread::WorkStealingPool& tp):
+    ESingleSimulation(nVM, tp),
+    _trialMode(vm.count("compression-trials") || vm.count("trial-growth-rates") || vm.count("jam-tolerance") || !vm["keep-trials"].defaulted()),
+    _keepAll(false),
+    _seeds(1),
+    _nextTrial(0),
+    _stop(false),
+    _densestTrial(0)
   {
     if (vm.count("target-pack-frac") && vm.count("target-density"))
       M_throw() << "Shouldn't specify both the packing fraction and density.";
     
   }
 
+  void
+  ECompressingSimulation::initialisation()
+  {
+    if (!_trialMode)
+      return ESingleSimulation::initialisation();
+
+    Engine::preSimInit();
+
+    if (vm.count("snapshot") || vm.count("snapshot-events"))
+      M_throw() << "Snapshots do not currently work in compressing systems.";
+
+    if (!(vm.count("config-file")) || 
+	(vm["config-file"].as<std::vector<std::string> >().size() != 1))
+      M_throw() << "You must only provide one input file for the compression trials";
+
+    if (vm.count("compression-trials"))
+      _seeds = vm["compression-trials"].as<size_t>();
+    if (!_seeds)
+      M_throw() << "At least one compression trial must be run (--compression-trials)";
+
+    if (vm.count("trial-growth-rates"))
+      _growthRates = vm["trial-growth-rates"].as<std::vector<double> >();
+    else
+      _growthRates.push_back(vm["growth-rate"].as<double>());
+
+    for (const double rate : _growthRates)
+      if (!(rate > 0))
+	M_throw() << "The compression growth rates must be positive";
+
+    const std::string keep = vm["keep-trials"].as<std::string>();
+    if (keep == "all")
+      _keepAll = true;
+    else if (keep != "densest")
+      M_throw() << "Unknown value for --keep-trials, \"" << keep << "\"";
+
+    if (_keepAll)
+      {
+	//Each trial needs its own files
+	const std::string suffix = (configFormat.size() > 4 && configFormat.substr(configFormat.size() - 4) == ".bz2") ? ".bz2" : "";
+	if (!vm.count("out-config-file"))
+	  configFormat = "config.%ID.out.xml" + suffix;
+	if (!vm.count("out-data-file"))
+	  outputFormat = "output.%ID.xml" + suffix;
+
+	if (configFormat.find("%ID") == configFormat.npos)
+	  M_throw() << "All trials are kept, but the format string for the config file output doesnt contain %ID";
+	if (outputFormat.find("%ID") == outputFormat.npos)
+	  M_throw() << "All trials are kept, but the format string for the output file doesnt contain %ID";
+      }
+
+    _trials.reserve(_seeds * _growthRates.size());
+  }
+
+  void
+  ECompressingSimulation::runSimulation()
+  {
+    if (!_trialMode)
+      return ESingleSimulation::runSimulation();
+
+    const size_t jobs = _seeds * _growthRates.size();
+    const size_t concurrent = std::min(std::max(threads.getThreadCount(), size_t(1)), jobs);
+    std::vector<std::function<void()> > tasks(concurrent, std::bind(&ECompressingSimulation::runWorker, this));
+    threads.queueTasks(tasks);
+    threads.wait();
+    std::cout << std::endl;
+
+    std::sort(_trials.begin(), _trials.end(), [](const Trial& a, const Trial& b) { return a.id < b.id; });
+    _densestTrial = 0;
+    for (size_t i(0); i < _trials.size(); ++i)
+      if (_densest ? (_trials[i].id == _densest->simID) : (_trials[i].packingFraction > _trials[_densestTrial].packingFraction))
+	_densestTrial = i;
+
+    std::cout << "Trial  GrowthRate  PackingFraction  Events      WallTime(s)  Jammed\n";
+    for (const Trial& trial : _trials)
+      std::cout << std::setw(5) << trial.id << "  "
+		<< std::setw(10) << trial.growthRate << "  "
+		<< std::setw(15) << std::setprecision(8) << trial.packingFraction << "  "
+		<< std::setw(10) << trial.events << "  "
+		<< std::setw(11) << std::setprecision(4) << trial.wallTime << "  "
+		<< (trial.jammed ? "yes" : "no") << "\n";
+    if (!_trials.empty())
+      std::cout << "Densest packing fraction " << std::setprecision(8) << _trials[_densestTrial].packingFraction
+		<< " (trial " << _trials[_densestTrial].id << ")" << std::endl;
+  }
+
+  void
+  ECompressingSimulation::runWorker()
+  {
+    const size_t jobs = _seeds * _growthRates.size();
+    while (true)
+      {
+	size_t id;
+	{
+	  std::lock_guard<std::mutex> lock(_mutex);
+	  if (_stop || (_nextTrial == jobs)) return;
+	  id = _nextTrial++;
+	}
+	runTrial(id);
+      }
+  }
+
+  void
+  ECompressingSimulation::runTrial(const size_t id)
+  {
+    const std::string config = vm["config-file"].as<std::vector<std::string> >()[0];
+
+    Trial trial;
+    trial.id = id;
+    trial.growthRate = _growthRates[id / _seeds];
+    trial.seed = vm.count("random-seed") ? vm["random-seed"].as<unsigned int>() + id : std::random_device()();
+    trial.jammed = false;
+
+    std::unique_ptr<Simulation> sim(new Simulation);
+    try {
+      magnet::Timer timer;
+      sim->simID = id;
+      Engine::setupSim(*sim, config);
+      sim->ranGenerator.seed(trial.seed);
+
+      if (!vm.count("trial-keep-velocities"))
+	{
+	  //Redraw the velocities at the temperature of the
+	  //configuration, otherwise the trials are identical
+	  const double kT = sim->dynamics->getkT();
+	  std::normal_distribution<double> normal;
+	  for (Particle& part : sim->particles)
+	    {
+	      const double mass = sim->species(part)->getMass(part);
+	      if (std::isinf(mass)) continue;
+	      for (size_t i(0); i < NDIM; ++i)
+		part.getVelocity()[i] = normal(sim->ranGenerator) / std::sqrt(mass);
+	    }
+	  sim->setCOMVelocity();
+	  sim->dynamics->rescaleSystemKineticEnergy(kT / sim->dynamics->getkT());
+	}
+
+      IPCompression plug(sim.get(), trial.growthRate);
+      plug.MakeGrowth();
+      if (vm.count("target-pack-frac"))
+	plug.limitPackingFraction(vm["target-pack-frac"].as<double>());
+      else if (vm.count("target-density"))
+	plug.limitDensity(vm["target-density"].as<double>());
+      plug.CellSchedulerHack();
+
+      sim->initialise();
+      postSimInit(*sim);
+
+      if (vm.count("ticker-period"))
+	sim->setTickerPeriod(vm["ticker-period"].as<double>());
+
+      //The packing fraction grows as (1 + gamma t)^3 under the
+      //compression dynamics, so it can be tracked without summing
+      //the particle volumes.
+      const double initialPackFrac = sim->getPackingFraction();
+      const double gamma = static_cast<const DynCompression&>(*sim->dynamics).getGrowthRate();
+      const size_t jamEvents = vm["jam-events"].as<size_t>() ? vm["jam-events"].as<size_t>() : 10 * sim->N();
+      size_t nextJamCheck = sim->eventCount + jamEvents;
+      double lastPackFrac = initialPackFrac;
+
+      while (sim->runSimulationStep(true))
+	{
+	  if (_SIGINT || _SIGTERM)
+	    {
+	      {
+		std::lock_guard<std::mutex> lock(_mutex);
+		if (!_stop)
+		  std::cout << "\nShutting down the running trials, no further trials will be started" << std::endl;
+		_stop = true;
+	      }
+	      sim->simShutdown();
+	    }
+
+	  if (vm.count("jam-tolerance") && (sim->eventCount >= nextJamCheck))
+	    {
+	      const double packFrac = initialPackFrac * std::pow(1 + gamma * sim->systemTime, 3);
+	      if (packFrac - lastPackFrac < vm["jam-tolerance"].as<double>() * packFrac)
+		{
+		  trial.jammed = true;
+		  sim->simShutdown();
+		}
+	      lastPackFrac = packFrac;
+	      nextJamCheck = sim->eventCount + jamEvents;
+	    }
+	}
+
+      plug.RestoreSystem();
+      trial.packingFraction = sim->getPackingFraction();
+      trial.events = sim->eventCount;
+      trial.wallTime = timer.duration<std::ratio<1> >();
+
+      if (_keepAll)
+	{
+	  sim->outputData(magnet::string::search_replace(outputFormat, "%ID", boost::lexical_cast<std::string>(id)));
+	  sim->writeXMLfile(magnet::string::search_replace(configFormat, "%ID", boost::lexical_cast<std::string>(id)), !vm.count("unwrapped"));
+	}
+    } catch (std::exception& cep) {
+      M_throw() << "Exception caught in compression trial " << id << "\n" << cep.what();
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (!_keepAll && (!_densest || (trial.packingFraction > _trials[_densestTrial].packingFraction)))
+      {
+	_densest = std::move(sim);
+	_densestTrial = _trials.size();
+      }
+    _trials.push_back(trial);
+    std::cout << "\rCompression trials finished " << _trials.size() << "/" << _seeds * _growthRates.size() << "   ";
+    std::cout.flush();
+  }
+
   void 
   ECompressingSimulation::preSimInit()
   {
@@ -76,7 +328,69 @@ namespace dynamo {
 
   void ECompressingSimulation::finaliseRun()
   {
-    compressPlug->RestoreSystem();
+    //The trials are restored as they finish
+    if (!_trialMode)
+      compressPlug->RestoreSystem();
+  }
+
+  void
+  ECompressingSimulation::outputData()
+  {
+    if (!_trialMode)
+      return ESingleSimulation::outputData();
+
+    if (_trials.empty())
+      {
+	std::cout << "No compression trials finished, so no output is written" << std::endl;
+	return;
+      }
+
+    if (_densest)
+      _densest->outputData(outputFormat);
+
+    std::string filename;
+    if (vm.count("trials-file"))
+      filename = vm["trials-file"].as<std::string>();
+    else
+#ifdef DYNAMO_bzip2_support
+      filename = "compression.trials.xml.bz2";
+#else
+      filename = "compression.trials.xml";
+#endif
+
+    magnet::xml::XmlStream XML;
+    XML.setFormatXML(true);
+    XML << std::setprecision(std::numeric_limits<double>::digits10 + 2)
+	<< magnet::xml::prolog()
+	<< magnet::xml::tag("CompressionTrials")
+	<< magnet::xml::attr("Count") << _trials.size()
+	<< magnet::xml::attr("Densest") << _trials[_densestTrial].id;
+
+    for (const Trial& trial : _trials)
+      XML << magnet::xml::tag("Trial")
+	  << magnet::xml::attr("ID") << trial.id
+	  << magnet::xml::attr("GrowthRate") << trial.growthRate
+	  << magnet::xml::attr("Seed") << trial.seed
+	  << magnet::xml::attr("PackingFraction") << trial.packingFraction
+	  << magnet::xml::attr("Events") << trial.events
+	  << magnet::xml::attr("WallTime") << trial.wallTime
+	  << magnet::xml::attr("Jammed") << trial.jammed
+	  << magnet::xml::endtag("Trial");
+
+    XML << magnet::xml::endtag("CompressionTrials");
+    XML.write_file(filename);
+
+    std::cout << "Summary of " << _trials.size() << " compression trials written to " << filename << std::endl;
+  }
+
+  void
+  ECompressingSimulation::outputConfigs()
+  {
+    if (!_trialMode)
+      return ESingleSimulation::outputConfigs();
+
+    if (_densest)
+      _densest->writeXMLfile(configFormat, !vm.count("unwrapped"));
   }
 }
 
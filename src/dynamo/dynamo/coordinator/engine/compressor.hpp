@@ -21,6 +21,8 @@
 
 #include <dynamo/coordinator/engine/single.hpp>
 #include <dynamo/inputplugins/compression.hpp>
+#include <memory>
+#include <mutex>
 
 namespace dynamo {
   /*! \brief This Engine compresses a configuration using the
@@ -29,6 +31,15 @@ namespace dynamo {
    * This is essentially a ESingleSimulation but with some extra steps to load
    * the compression Dynamics at the start and then to restore the
    * old Dynamics at the end.
+   *
+   * If any of the trial options are given (e.g.,
+   * --compression-trials), the engine instead runs many independent
+   * compressions of the configuration on the thread pool, one for
+   * each seed and growth rate. Each trial stops at the target
+   * packing fraction/density, the event limit, or once it is jammed
+   * (see --jam-tolerance). Either the densest trial or every trial
+   * is written out, and the packing fraction and timing of each
+   * trial is written to a summary file.
    */
   class ECompressingSimulation: public ESingleSimulation
   {
@@ -39,7 +50,7 @@ namespace dynamo {
      * \param tp The shared thread pool.
      */
     ECompressingSimulation(const boost::program_options::variables_map& vm,
-			   magnet::thread::ThreadPool& tp);
+			   magnet::thread::WorkStealingPool& tp);
 
     /*! \brief A trivial virtual destructor
      */
@@ -53,6 +64,25 @@ namespace dynamo {
      */
     virtual void finaliseRun();
 
+    /*! \brief Loads the single Simulation, or checks the trial
+     * options in trial mode.
+     */
+    virtual void initialisation();
+
+    /*! \brief Runs the single Simulation, or every trial.
+     */
+    virtual void runSimulation();
+
+    /*! \brief Write the output of the Simulation (or the densest
+     * trial) and the summary of the trials.
+     */
+    virtual void outputData();
+
+    /*! \brief Write the configuration of the Simulation (or the
+     * densest trial).
+     */
+    virtual void outputConfigs();
+
     /*! \brief The options specific to the ECompressingSimulation class.
      *
      * This is used by the Coordinator::parseOptions function.
@@ -77,5 +107,48 @@ namespace dynamo {
     /*! \brief A single IPCompression plugin to manipulate the Simulation.
      */
     shared_ptr<IPCompression> compressPlug;
+
+    /*! \brief The outcome of a single compression trial.
+     */
+    struct Trial
+    {
+      size_t id;
+      double growthRate;
+      unsigned int seed;
+      double packingFraction;
+      size_t events;
+      //! \brief The wall clock time of the trial in seconds.
+      double wallTime;
+      bool jammed;
+    };
+
+    /*! \brief The loop of each thread, taking trials until all are
+     * finished.
+     */
+    void runWorker();
+
+    /*! \brief Load, compress and record a single trial.
+     */
+    void runTrial(const size_t id);
+
+    //! \brief Set if the engine is running independent trials.
+    bool _trialMode;
+    //! \brief Set if every trial is written out, not only the densest.
+    bool _keepAll;
+    //! \brief The growth rates to run trials at.
+    std::vector<double> _growthRates;
+    //! \brief The number of trials (seeds) at each growth rate.
+    size_t _seeds;
+    //! \brief The number of the next trial to start.
+    size_t _nextTrial;
+    //! \brief Set to stop any further trials starting.
+    bool _stop;
+    //! \brief The results of the finished trials.
+    std::vector<Trial> _trials;
+    //! \brief The densest trial so far, if only it is kept.
+    std::unique_ptr<Simulation> _densest;
+    //! \brief The index in _trials of the densest trial.
+    size_t _densestTrial;
+    std::mutex _mutex;
   };
 }
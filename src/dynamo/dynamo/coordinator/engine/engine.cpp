@@ -38,6 +38,7 @@ namespace dynamo {
        "Random seed for generator (To make the simulation reproduceable - Only for debugging!)")
       ("ticker-period,t",boost::program_options::value<double>(), 
        "Time between data collections. Defaults to the system MFT or 1 if no MFT available")
+      ("parallel-tickers", "Run the ticker plugins (e.g., RadialDistribution) concurrently on the --n-threads pool.")
       ("equilibrate,E", "Turns off most output for a fast silent run")
       ("load-plugin,L", boost::program_options::value<std::vector<std::string> >(), 
        "Additional individual plugins to load")
@@ -57,7 +58,7 @@ namespace dynamo {
 
   Engine::Engine(const boost::program_options::variables_map& nvm, 
 		 std::string configFile, std::string outputFile,
-		 magnet::thread::ThreadPool& tp):
+		 magnet::thread::WorkStealingPool& tp):
     vm(nvm),
     _SIGINT(false),
     _SIGTERM(false),
@@ -98,6 +99,11 @@ namespace dynamo {
     Sim.loadXMLfile(filename.c_str());
     
     Sim.endEventCount = vm["events"].as<size_t>();
+
+    Sim.threadPool = &threads;
+
+    if (vm.count("parallel-tickers"))
+      Sim.tickerPool = &threads;
   
     if (vm["events"].as<size_t>() 
 	> vm["print-events"].as<size_t>())
@@ -16,5 +16,7 @@
 */
 
 #include <dynamo/coordinator/engine/replexer.hpp>
+#include <dynamo/coordinator/engine/replexer_distributed.hpp>
 #include <dynamo/coordinator/engine/single.hpp>
 #include <dynamo/coordinator/engine/compressor.hpp>
+#include <dynamo/coordinator/engine/batch.hpp>
@@ -22,10 +22,12 @@
 #include <dynamo/dynamics/dynamics.hpp>
 #include <dynamo/schedulers/scheduler.hpp>
 #include <dynamo/systems/snapshot.hpp>
-#include <magnet/thread/threadpool.hpp>
+#include <magnet/thread/workstealingpool.hpp>
 #include <magnet/string/searchreplace.hpp>
 #include <fstream>
 #include <limits>
+#include <algorithm>
+#include <functional>
 
 namespace dynamo {
   void
@@ -48,21 +50,39 @@ namespace dynamo {
        "  1: \tAlternating sets of pairs (~Nsims/2 attempts per swap event)\n"
        "  2: \tRandom pair per swap\n"
        "  3: \t5 * Nsim random pairs per swap\n"
-       "  4: \tRandom selection of the above methods")
+       "  4: \tRandom selection of the above methods\n"
+       "  5: \tAlternating sets of pairs, where each pair swaps as soon as both are ready (no global barrier)")
+      ("replex-chunk-events", boost::program_options::value<size_t>()->default_value(0),
+       "When there are more systems than threads, the systems are run in"
+       " chunks of this many events and idle threads take over the systems"
+       " with the most work left. Zero selects 10 events per particle.")
+      ("replex-optimise-ladder", boost::program_options::value<size_t>()->default_value(0),
+       "Optimise the intermediate temperatures using the measured flow of"
+       " replicas between the coldest and hottest temperatures (feedback"
+       " optimisation). The value is the number of replica exchange cycles"
+       " before the first optimisation, each later optimisation waits twice"
+       " as many cycles as the last. The replicas are rescaled onto the new"
+       " temperatures, so this is intended for equilibration runs. Zero"
+       " disables the optimisation.")
       ;
   
     opts.add(ropts);
   }
 
   EReplicaExchangeSimulation::EReplicaExchangeSimulation(const boost::program_options::variables_map& nVm,
-							 magnet::thread::ThreadPool& tp):
+							 magnet::thread::WorkStealingPool& tp):
     Engine(nVm, "config.%ID.end.xml", "output.%ID.xml", tp),
     replicaEndTime(0),
     ReplexMode(RandomSelection),
     replexSwapCalls(0),
     round_trips(0),
     SeqSelect(false),
-    nSims(0)
+    nSims(0),
+    _busyTime(0),
+    _lastRound(0),
+    _ladderInterval(0),
+    _nextLadderUpdate(0),
+    _chunkEvents(0)
   {
     if (vm["events"].as<size_t>() != std::numeric_limits<size_t>::max())
       M_throw() << "You cannot use collisions to control a replica exchange simulation\n"
@@ -75,20 +95,11 @@ namespace dynamo {
   {
     preSimInit();
     for (unsigned int i = 0; i < nSims; i++)
-      {
-	setupSim(Simulations[i], 
-		 vm["config-file"].as<std::vector<std::string> >()[i]);
-
-	if (vm.count("snapshot"))
-	  Simulations[i].systems.push_back(shared_ptr<System>(new SysSnapshot(&(Simulations[i]), vm["snapshot"].as<double>(), "SnapshotTimer", "ID%ID.%COUNT", !vm.count("unwrapped"))));
+      initialiseSim(i);
 
-	if (vm.count("snapshot-events"))
-	  Simulations[i].systems.push_back(shared_ptr<System>(new SysSnapshot(&(Simulations[i]), vm["snapshot-events"].as<size_t>(), "SnapshotEventTimer", "%COUNTe", !vm.count("unwrapped"))));
-
-	Simulations[i].initialise();
-
-	postSimInit(Simulations[i]);
-      }
+    _chunkEvents = vm["replex-chunk-events"].as<size_t>();
+    if (!_chunkEvents)
+      _chunkEvents = 10 * Simulations[0].N();
 
     //Ensure we are in the right ensemble for all simulations
     for (size_t i = nSims; i != 0;)
@@ -164,12 +175,34 @@ namespace dynamo {
 	}
   }
 
+  void
+  EReplicaExchangeSimulation::initialiseSim(const size_t i)
+  {
+    setupSim(Simulations[i], 
+	     vm["config-file"].as<std::vector<std::string> >()[i]);
+
+    if (vm.count("snapshot"))
+      Simulations[i].systems.push_back(shared_ptr<System>(new SysSnapshot(&(Simulations[i]), vm["snapshot"].as<double>(), "SnapshotTimer", "ID%ID.%COUNT", !vm.count("unwrapped"))));
+
+    if (vm.count("snapshot-events"))
+      Simulations[i].systems.push_back(shared_ptr<System>(new SysSnapshot(&(Simulations[i]), vm["snapshot-events"].as<size_t>(), "SnapshotEventTimer", "%COUNTe", !vm.count("unwrapped"))));
+
+    Simulations[i].initialise();
+
+    postSimInit(Simulations[i]);
+  }
+
   void
   EReplicaExchangeSimulation::preSimInit()
   {
     Engine::preSimInit();
 
     ReplexMode = static_cast<Replex_Mode_Type>(vm["replex-swap-mode"].as<unsigned int>());
+
+    _ladderInterval = vm["replex-optimise-ladder"].as<size_t>();
+    _nextLadderUpdate = _ladderInterval;
+    if (_ladderInterval && (ReplexMode == AsynchronousPairs))
+      M_throw() << "The temperature ladder cannot be optimised in the asynchronous replica exchange mode";
   
     nSims = vm["config-file"].as<std::vector<std::string> >().size();
   
@@ -251,6 +284,8 @@ namespace dynamo {
 
 	}
 	break;
+      case AsynchronousPairs:
+	M_throw() << "The asynchronous replica exchange swaps are carried out while the simulations run";
       case RandomSelection:
 	{
 	  std::uniform_int_distribution<size_t> tmpDist(0, 1);
@@ -335,7 +370,7 @@ namespace dynamo {
   }
 
   void
-  EReplicaExchangeSimulation::outputData()
+  EReplicaExchangeSimulation::outputReplexStats()
   {
     {
       std::fstream replexof("replex.dat",std::ios::out | std::ios::trunc);
@@ -355,14 +390,47 @@ namespace dynamo {
     {      
       std::fstream replexof("replex.stats", std::ios::out | std::ios::trunc);
     
-      
+      const double duration = std::chrono::duration<double>(_end_time - _start_time).count();
+
+      //Each accepted swap is counted at both temperatures
+      size_t swaps = 0;
+      for (const replexPair& myPair : temperatureList)
+	swaps += myPair.second.swaps;
+      swaps /= 2;
+
+      //With no threads the tasks are run by the main thread
+      const size_t threadCount = std::max(threads.getThreadCount(), size_t(1));
+
       replexof << "Number_of_replex_cycles " << replexSwapCalls
-	       << "\nTime_spent_replexing " <<  std::chrono::duration<double>(_end_time - _start_time).count() << "s"
-	       << "\nReplex Rate " << static_cast<double>(replexSwapCalls) / std::chrono::duration<double>(_end_time - _start_time).count()
-	       << "\n";	
+	       << "\nTime_spent_replexing " << duration << "s"
+	       << "\nReplex Rate " << static_cast<double>(replexSwapCalls) / duration
+	       << "\nSwaps_per_hour " << swaps * 3600.0 / duration
+	       << "\nCore_utilisation " << _busyTime / (duration * threadCount)
+	       << "\nRound_trips " << round_trips
+	       << "\nRound_trips_per_hour " << round_trips * 3600.0 / duration
+	       << "\n";
+
+      //The round trip rate of each temperature ladder used
+      if (!_ladderEpochs.empty())
+	{
+	  std::vector<LadderEpoch> epochs(_ladderEpochs);
+	  epochs.push_back(currentLadderEpoch());
+	  for (size_t i(0); i < epochs.size(); ++i)
+	    replexof << "Ladder_" << i
+		     << " Replex_cycles " << epochs[i].cycles
+		     << " Round_trips " << epochs[i].roundTrips
+		     << " Round_trips_per_hour " << epochs[i].roundTrips * 3600.0 / epochs[i].seconds
+		     << "\n";
+	}
     
       replexof.close();
     }    
+  }
+
+  void
+  EReplicaExchangeSimulation::outputData()
+  {
+    outputReplexStats();
   
     int i = 0;
   
@@ -374,6 +442,14 @@ namespace dynamo {
   void EReplicaExchangeSimulation::runSimulation()
   {
     _start_time = std::chrono::system_clock::now();
+    _ladderStart = LadderEpoch{replexSwapCalls, round_trips, 0};
+
+    if (ReplexMode == AsynchronousPairs)
+      {
+	runAsynchronous();
+	_end_time = std::chrono::system_clock::now();
+	return;
+      }
     
     while (((Simulations[temperatureList.front().second.simID].systemTime / Simulations[temperatureList.front().second.simID].units.unitTime()) < replicaEndTime)
 	   && (Simulations[0].eventCount < vm["events"].as<size_t>()))
@@ -429,31 +505,7 @@ namespace dynamo {
 
 		    }
 		  
-		  {
-		    std::fstream replexof("replex.dat",std::ios::out | std::ios::trunc);
-		    
-		    for (const replexPair& myPair : temperatureList)
-		      replexof << myPair.second.realTemperature << " " 
-			       << myPair.second.swaps << " " 
-			       << (static_cast<double>(myPair.second.swaps) 
-				   / static_cast<double>(myPair.second.attempts))  << " "
-			       << myPair.second.upSims << " "
-			       << myPair.second.downSims
-			       << "\n";
-		    
-		    replexof.close();      
-		  }
-		  
-		  {      
-		    std::fstream replexof("replex.stats", std::ios::out | std::ios::trunc);
-		    
-		    replexof << "Number_of_replex_cycles " << replexSwapCalls
-			     << "\nTime_spent_replexing " <<  std::chrono::duration<double>(_end_time - _start_time).count() << "s"
-			     << "\nReplex Rate " << static_cast<double>(replexSwapCalls) / std::chrono::duration<double>(_end_time - _start_time).count()
-			     << "\n";	
-		    
-		    replexof.close();
-		  }		  
+		  outputReplexStats();
 		  break;
 		}
 	      case 'd':
@@ -493,49 +545,33 @@ namespace dynamo {
 	  {
 	    //Reset the stop events
 	    for (size_t i = nSims; i != 0;)
-	      {
-		//Reset the stop event
-		shared_ptr<SystHalt> tmpRef = std::dynamic_pointer_cast<SystHalt>(Simulations[--i].systems["ReplexHalt"]);
-		
-#ifdef DYNAMO_DEBUG
-		if (!tmpRef)
-		  M_throw() << "Could not find the time halt event error";
-#endif			
-		//Each simulations exchange time is inversly proportional to its temperature
-		double tFactor 
-		  = std::sqrt(temperatureList.begin()->second.realTemperature
-			      / Simulations[i].ensemble->getReducedEnsembleVals()[2]); 
-
-		tmpRef->increasedt(vm["replex-interval"].as<double>() * tFactor);
+	      setupReplexInterval(Simulations[--i]);
 
-		Simulations[i].ptrScheduler->rebuildSystemEvents();
-
-		//Reset the max collisions
-		Simulations[i].endEventCount = vm["events"].as<size_t>();
+	    if (threads.getThreadCount() && (nSims > threads.getThreadCount()))
+	      runChunked();
+	    else
+	      {
+		//Run the simulations. We also generate all tasks at once
+		//and submit them all at once to minimise lock contention.
+		std::vector<std::function<void()> > tasks;
+		tasks.reserve(nSims);
+
+		for (size_t i(0); i < nSims; ++i)
+		  tasks.push_back([this, i]() {
+		      const auto start = std::chrono::system_clock::now();
+		      Simulations[i].runSimulation(true);
+		      std::lock_guard<std::mutex> lock(_replexMutex);
+		      _busyTime += std::chrono::duration<double>(std::chrono::system_clock::now() - start).count();
+		    });
+
+		threads.queueTasks(tasks);
 	      }
 
-	    //Run the simulations. We also generate all tasks at once
-	    //and submit them all at once to minimise lock contention.
-	    std::vector<std::function<void()> > tasks;
-	    tasks.reserve(nSims);
-
-	    for (size_t i(0); i < nSims; ++i)
-	      tasks.push_back(std::bind(&Simulation::runSimulation, &static_cast<Simulation&>(Simulations[i]), true));
-
-	    threads.queueTasks(tasks);
             try {
               threads.wait();//This syncs the systems for the replica exchange
             } catch (std::exception& e) {
-              int i = 0;
               std::cerr << e.what() << std::endl;
-              std::cerr << "Attempting to write out configurations at the error." << std::endl;
-              for (replexPair p1 : temperatureList)
-                {
-                  Simulations[p1.second.simID].endEventCount = vm["events"].as<size_t>();
-                  Simulations[p1.second.simID].writeXMLfile(magnet::string::search_replace("config.%ID.error.xml", "%ID", 
-                                                                                           boost::lexical_cast<std::string>(i++)), 
-                                                            !vm.count("unwrapped"));
-                }
+              outputErrorConfigs();
               M_throw() << "Exception caught while performing simulations";
             }
 		  
@@ -543,32 +579,370 @@ namespace dynamo {
 	    ReplexSwap(ReplexMode);
 		  
 	    ReplexSwapTicker();
+
+	    if (_ladderInterval && (replexSwapCalls >= _nextLadderUpdate))
+	      optimiseLadder();
 		  
-	    double duration = std::chrono::duration<double>(std::chrono::system_clock::now() - _start_time).count();
+	    outputETA();
+	  }
+      }
+  _end_time = std::chrono::system_clock::now();
+  }
+
+  EReplicaExchangeSimulation::LadderEpoch
+  EReplicaExchangeSimulation::currentLadderEpoch() const
+  {
+    const double now = std::chrono::duration<double>(std::chrono::system_clock::now() - _start_time).count();
+    return LadderEpoch{replexSwapCalls - _ladderStart.cycles, round_trips - _ladderStart.roundTrips, now - _ladderStart.seconds};
+  }
+
+  void
+  EReplicaExchangeSimulation::optimiseLadder()
+  {
+    const size_t N = temperatureList.size();
+    _ladderInterval *= 2;
+    _nextLadderUpdate = replexSwapCalls + _ladderInterval;
+
+    if (N < 3) return;
+
+    //The fraction of the replicas at each temperature which are
+    //travelling up from the coldest temperature. By definition this
+    //is one at the coldest and zero at the hottest temperature.
+    std::vector<double> f(N);
+    for (size_t i(0); i < N; ++i)
+      {
+	const size_t visits = temperatureList[i].second.upSims + temperatureList[i].second.downSims;
+	if (!visits)
+	  {
+	    std::cout << "\nNo replica flow measured at T=" << temperatureList[i].second.realTemperature
+		      << ", delaying the temperature ladder optimisation" << std::endl;
+	    return;
+	  }
+	f[i] = double(temperatureList[i].second.upSims) / visits;
+      }
+    f.front() = 1;
+    f.back() = 0;
+
+    //The optimal density of temperatures is taken as piecewise
+    //constant in each interval, i.e., eta_i ~ sqrt(df_i) / dT_i. The
+    //measured f is noisy and may not be monotonic, so each interval
+    //is given a small minimum weight to keep every temperature
+    //distinct.
+    const double minDf = 1e-3 / N;
+    std::vector<double> weight(N - 1);
+    double totalWeight = 0;
+    for (size_t i(0); i < N - 1; ++i)
+      {
+	weight[i] = std::sqrt(std::max(f[i] - f[i + 1], minDf));
+	totalWeight += weight[i];
+      }
+
+    //Place the new temperatures so that each interval holds an
+    //equal integral of the density.
+    std::vector<double> newT(N);
+    newT.front() = temperatureList.front().first;
+    newT.back() = temperatureList.back().first;
+    {
+      size_t interval = 0;
+      double integral = 0;
+      for (size_t k(1); k < N - 1; ++k)
+	{
+	  const double target = totalWeight * k / (N - 1);
+	  while (integral + weight[interval] < target)
+	    integral += weight[interval++];
+	  const double T1 = temperatureList[interval].first, T2 = temperatureList[interval + 1].first;
+	  newT[k] = T1 + (T2 - T1) * (target - integral) / weight[interval];
+	}
+    }
+
+    //Record the performance of the old ladder
+    _ladderEpochs.push_back(currentLadderEpoch());
+    _ladderStart = LadderEpoch{replexSwapCalls, round_trips, _ladderStart.seconds + _ladderEpochs.back().seconds};
+    const LadderEpoch& epoch = _ladderEpochs.back();
+
+    std::cout << "\nOptimised temperature ladder " << _ladderEpochs.size()
+	      << " (" << epoch.roundTrips * 3600.0 / epoch.seconds << " round trips per hour on the previous ladder)"
+	      << "\n        T       f(T)     new T\n";
+
+    for (size_t i(0); i < N; ++i)
+      {
+	replexPair& dat = temperatureList[i];
+	Simulation& sim = Simulations[dat.second.simID];
+	const double oldReduced = dat.second.realTemperature;
+	dat.second.realTemperature *= newT[i] / dat.first;
+	dat.first = newT[i];
+
+	std::cout << std::setw(9) << oldReduced << " " << std::setw(9) << f[i]
+		  << " " << std::setw(9) << dat.second.realTemperature << "\n";
+
+	if (sim.ensemble->getEnsembleVals()[2] != newT[i])
+	  sim.setReplicaTemperature(newT[i]);
+
+	//Reset the statistics for the new ladder, the replicas keep
+	//their direction of travel.
+	dat.second.swaps = dat.second.attempts = dat.second.upSims = dat.second.downSims = 0;
+      }
+    std::cout.flush();
+
+    //Rescale the ticker periods to the new temperatures, as in
+    //initialisation()
+    for (size_t i = 0; i < nSims; ++i)
+      {
+	const double tFactor = std::sqrt(temperatureList.front().second.realTemperature / Simulations[i].ensemble->getReducedEnsembleVals()[2]);
+
+	if (vm.count("ticker-period"))
+	  Simulations[i].setTickerPeriod(vm["ticker-period"].as<double>() * tFactor);
+
+	if (vm.count("snapshot"))
+	  dynamic_cast<SysSnapshot &>(*Simulations[i].systems["SnapshotTimer"]).setTickerPeriod(vm["snapshot"].as<double>() * tFactor);
+      }
+  }
+
+  void
+  EReplicaExchangeSimulation::runChunked()
+  {
+    //The halt events and a shared list of the simulations which are
+    //waiting for a thread.
+    std::shared_ptr<std::vector<const SystHalt*> > halts(new std::vector<const SystHalt*>(nSims));
+    std::shared_ptr<std::vector<size_t> > waiting(new std::vector<size_t>(nSims));
+    for (size_t i(0); i < nSims; ++i)
+      {
+	(*halts)[i] = static_cast<const SystHalt*>(Simulations[i].systems["ReplexHalt"].get());
+	(*waiting)[i] = i;
+      }
+
+    //The events left until the halt, estimated from the event rate of
+    //the simulation so far.
+    auto remainingEvents = [this, halts](const size_t id) {
+      const Simulation& sim = Simulations[id];
+      const double rate = (sim.systemTime > 0) ? sim.eventCount / sim.systemTime : 1.0;
+      return (*halts)[id]->getdt() * rate;
+    };
+
+    auto worker = [this, halts, waiting, remainingEvents]() {
+      std::unique_lock<std::mutex> lock(_replexMutex);
+      while (!waiting->empty())
+	{
+	  //Longest remaining first
+	  auto it = std::max_element(waiting->begin(), waiting->end(),
+				     [&](const size_t a, const size_t b) { return remainingEvents(a) < remainingEvents(b); });
+	  const size_t id = *it;
+	  waiting->erase(it);
+	  lock.unlock();
+
+	  const auto start = std::chrono::system_clock::now();
+	  Simulation& sim = Simulations[id];
+	  //The halt event sets the endEventCount when it is reached
+	  sim.endEventCount = sim.eventCount + _chunkEvents;
+	  sim.runSimulation(true);
+	  const bool halted = (*halts)[id]->fired();
+	  const double runTime = std::chrono::duration<double>(std::chrono::system_clock::now() - start).count();
+
+	  lock.lock();
+	  _busyTime += runTime;
+	  if (!halted)
+	    waiting->push_back(id);
+	}
+    };
+
+    std::vector<std::function<void()> > tasks(threads.getThreadCount(), worker);
+    threads.queueTasks(tasks);
+  }
+
+  void
+  EReplicaExchangeSimulation::setupReplexInterval(Simulation& sim)
+  {
+    //Reset the stop event
+    shared_ptr<SystHalt> tmpRef = std::dynamic_pointer_cast<SystHalt>(sim.systems["ReplexHalt"]);
+		
+#ifdef DYNAMO_DEBUG
+    if (!tmpRef)
+      M_throw() << "Could not find the time halt event error";
+#endif			
+    //Each simulations exchange time is inversly proportional to its temperature
+    double tFactor 
+      = std::sqrt(temperatureList.begin()->second.realTemperature
+		  / sim.ensemble->getReducedEnsembleVals()[2]); 
+
+    tmpRef->increasedt(vm["replex-interval"].as<double>() * tFactor);
+
+    sim.ptrScheduler->rebuildSystemEvents();
+
+    //Reset the max collisions
+    sim.endEventCount = vm["events"].as<size_t>();
+  }
+
+  void
+  EReplicaExchangeSimulation::outputETA()
+  {
+    double duration = std::chrono::duration<double>(std::chrono::system_clock::now() - _start_time).count();
 	    
-	    double fractionComplete = (Simulations[temperatureList.front().second.simID].systemTime / Simulations[temperatureList.front().second.simID].units.unitTime()) / replicaEndTime;
-	    double seconds_remaining_double = duration * (1 / fractionComplete - 1);
-	    size_t seconds_remaining = seconds_remaining_double;
+    double fractionComplete = (Simulations[temperatureList.front().second.simID].systemTime / Simulations[temperatureList.front().second.simID].units.unitTime()) / replicaEndTime;
+    double seconds_remaining_double = duration * (1 / fractionComplete - 1);
+    size_t seconds_remaining = seconds_remaining_double;
 
-	    if (seconds_remaining_double < std::numeric_limits<size_t>::max())
-	      {
-		size_t ETA_hours = seconds_remaining / 3600;
-		size_t ETA_mins = (seconds_remaining / 60) % 60;
-		size_t ETA_secs = seconds_remaining % 60;
+    if (seconds_remaining_double < std::numeric_limits<size_t>::max())
+      {
+	size_t ETA_hours = seconds_remaining / 3600;
+	size_t ETA_mins = (seconds_remaining / 60) % 60;
+	size_t ETA_secs = seconds_remaining % 60;
 		
-		std::cout << "\rReplica Exchange No." << replexSwapCalls << ", ETA ";
-		if (ETA_hours)
-		  std::cout << ETA_hours << "hr ";
+	std::cout << "\rReplica Exchange No." << replexSwapCalls << ", ETA ";
+	if (ETA_hours)
+	  std::cout << ETA_hours << "hr ";
 		
-		if (ETA_mins)
-		  std::cout << ETA_mins << "min ";
+	if (ETA_mins)
+	  std::cout << ETA_mins << "min ";
 		
-		std::cout << ETA_secs << "s        ";
-		std::cout.flush();
-	      }
+	std::cout << ETA_secs << "s        ";
+	std::cout.flush();
+      }
+  }
+
+  void
+  EReplicaExchangeSimulation::outputErrorConfigs()
+  {
+    int i = 0;
+    std::cerr << "Attempting to write out configurations at the error." << std::endl;
+    for (replexPair p1 : temperatureList)
+      {
+	Simulations[p1.second.simID].endEventCount = vm["events"].as<size_t>();
+	Simulations[p1.second.simID].writeXMLfile(magnet::string::search_replace("config.%ID.error.xml", "%ID", 
+										 boost::lexical_cast<std::string>(i++)), 
+						  !vm.count("unwrapped"));
+      }
+  }
+
+  void
+  EReplicaExchangeSimulation::runAsynchronous()
+  {
+    {
+      const Simulation& coldest = Simulations[temperatureList.front().second.simID];
+      if ((coldest.systemTime / coldest.units.unitTime()) >= replicaEndTime)
+	return;
+    }
+
+    _roundsStarted.assign(nSims, 0);
+    _roundsFinished.assign(nSims, 0);
+    _lastRound = std::numeric_limits<size_t>::max();
+
+    std::vector<std::function<void()> > tasks;
+    tasks.reserve(nSims);
+    for (size_t slot(0); slot < nSims; ++slot)
+      tasks.push_back(std::bind(&EReplicaExchangeSimulation::runAsynchronousRound, this, slot));
+
+    threads.queueTasks(tasks);
+    try {
+      threads.wait();
+    } catch (std::exception& e) {
+      std::cerr << e.what() << std::endl;
+      outputErrorConfigs();
+      M_throw() << "Exception caught while performing simulations";
+    }
+  }
+
+  void
+  EReplicaExchangeSimulation::runAsynchronousRound(const size_t slot)
+  {
+    Simulation* sim;
+    {
+      std::lock_guard<std::mutex> lock(_replexMutex);
+      if (_roundsStarted[slot] >= _lastRound) return;
+      ++_roundsStarted[slot];
+      sim = &Simulations[temperatureList[slot].second.simID];
+    }
+
+    //Only this task may touch the simulation until it is requeued
+    const auto start = std::chrono::system_clock::now();
+    setupReplexInterval(*sim);
+    sim->runSimulation(true);
+    const double runTime = std::chrono::duration<double>(std::chrono::system_clock::now() - start).count();
+
+    std::lock_guard<std::mutex> lock(_replexMutex);
+    _busyTime += runTime;
+    const size_t round = ++_roundsFinished[slot];
+
+    //Determine the neighbour to swap with in this round, the pairs
+    //alternate as in the AlternatingSequence mode.
+    size_t partner = slot;
+    if ((slot % 2) == (round % 2))
+      {
+	if (slot + 1 < nSims)
+	  partner = slot + 1;
+      }
+    else if (slot > 0)
+      partner = slot - 1;
+
+    if (partner != slot)
+      {
+	//If the neighbour is still running, it will attempt the swap
+	//and requeue this temperature when it has finished.
+	if (_roundsFinished[partner] < round) return;
+	
+	AttemptSwap(std::min(slot, partner), std::max(slot, partner));
+	AsyncSwapTicker(partner);
+	threads.queueTask(std::bind(&EReplicaExchangeSimulation::runAsynchronousRound, this, partner));
+      }
+
+    AsyncSwapTicker(slot);
+    threads.queueTask(std::bind(&EReplicaExchangeSimulation::runAsynchronousRound, this, slot));
+  }
+
+  void 
+  EReplicaExchangeSimulation::AsyncSwapTicker(const size_t slot)
+  {
+    replexPair& dat = temperatureList[slot];
+    ++(Simulations[dat.second.simID].replexExchangeNumber);
+
+    if (SimDirection[dat.second.simID] > 0)
+      ++dat.second.upSims;
+    else if (SimDirection[dat.second.simID] < 0)
+      ++dat.second.downSims;
+
+    if (slot == nSims - 1)
+      {
+	if (SimDirection[dat.second.simID] == 1)
+	  {
+	    if (roundtrip[dat.second.simID])
+	      ++round_trips;
+	    
+	    roundtrip[dat.second.simID] = true;
 	  }
+	SimDirection[dat.second.simID] = -1; //Going down
+      }
+
+    if (slot == 0)
+      {
+	++replexSwapCalls;
+
+	if (SimDirection[dat.second.simID] == -1)
+	  {
+	    if (roundtrip[dat.second.simID])
+	      ++round_trips;
+	    
+	    roundtrip[dat.second.simID] = true;
+	  }
+	SimDirection[dat.second.simID] = 1; //Going up
+
+	if (_SIGINT || _SIGTERM)
+	  {
+	    std::cout << "\nShutting down the replica exchange once every temperature reaches the same round" << std::endl;
+	    replicaEndTime = 0.0;
+	    if (_SIGINT)
+	      Coordinator::setup_signal_handler();
+	    _SIGINT = _SIGTERM = false;
+	  }
+
+	//Once the coldest temperature is finished, every temperature
+	//is run until it reaches the round of the furthest ahead
+	//temperature. This ensures no temperature is left waiting on a
+	//neighbour which has stopped.
+	const Simulation& coldest = Simulations[dat.second.simID];
+	if ((coldest.systemTime / coldest.units.unitTime()) >= replicaEndTime)
+	  _lastRound = std::min(_lastRound, *std::max_element(_roundsStarted.begin(), _roundsStarted.end()));
+	else
+	  outputETA();
       }
-  _end_time = std::chrono::system_clock::now();
   }
 
   void 
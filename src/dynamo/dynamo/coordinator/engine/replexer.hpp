@@ -22,6 +22,7 @@
 
 #include <dynamo/coordinator/engine/engine.hpp>
 #include <chrono>
+#include <mutex>
 #include <memory>
 
 namespace dynamo {
@@ -33,7 +34,7 @@ namespace dynamo {
     positions are swapped along with a rescaling of the particles
     velocities.
    
-    This class uses the ThreadPool to parallelise the running of the
+    This class uses the WorkStealingPool to parallelise the running of the
     simulations.
    */
   class EReplicaExchangeSimulation: public Engine
@@ -42,10 +43,10 @@ namespace dynamo {
     /*! \brief The only constructor.
      
       \param vm The parsed command line options held by the Coordinator.
-      \param tp The ThreadPool for this instance of dynarun.
+      \param tp The WorkStealingPool for this instance of dynarun.
      */
     EReplicaExchangeSimulation(const boost::program_options::variables_map& vm, 
-			       magnet::thread::ThreadPool& tp);
+			       magnet::thread::WorkStealingPool& tp);
   
     /*! \brief A trivial virtual destructor. 
      */
@@ -89,8 +90,12 @@ namespace dynamo {
 			neighbour*/
       RandomPairs = 3, /*!< For 5*No. of Simulations, pick two random
 			 Simulations and attempt to swap them*/
-      RandomSelection = 4 /*!< Pick randomly between RandomPairs and
+      RandomSelection = 4, /*!< Pick randomly between RandomPairs and
 			    AlternatingSequence.*/
+      AsynchronousPairs = 5 /*!< Alternating sets of neighbouring
+			      pairs, where each pair attempts its swap as
+			      soon as both of its simulations are ready
+			      (no global barrier).*/
     } Replex_Mode_Type;
 
     /*! \brief A structure to hold replica exchange data on a single
@@ -190,6 +195,65 @@ namespace dynamo {
      */
     unsigned int nSims;
 
+    /*! \brief Protects the replica exchange data while the
+      simulations are running in the AsynchronousPairs mode (and the
+      statistics in all modes).
+     */
+    std::mutex _replexMutex;
+
+    /*! \brief The total wall time (in seconds) spent running the
+      simulations, summed over all threads.
+     */
+    double _busyTime;
+
+    /*! \brief The number of run/exchange rounds each temperature
+      has started in the AsynchronousPairs mode.
+     */
+    std::vector<size_t> _roundsStarted;
+
+    /*! \brief The number of run/exchange rounds each temperature
+      has finished running in the AsynchronousPairs mode.
+     */
+    std::vector<size_t> _roundsFinished;
+
+    /*! \brief The number of rounds every temperature must complete
+      before the AsynchronousPairs mode terminates.
+     */
+    size_t _lastRound;
+
+    /*! \brief The number of replica exchange cycles until the next
+      feedback optimisation of the temperature ladder (zero if the
+      ladder is fixed).
+     */
+    size_t _ladderInterval;
+
+    /*! \brief The replica exchange cycle at which the temperature
+      ladder is next optimised.
+     */
+    size_t _nextLadderUpdate;
+
+    /*! \brief The performance of a single temperature ladder.
+     */
+    struct LadderEpoch
+    {
+      /*! \brief The number of replica exchange cycles run on the ladder.*/
+      size_t cycles;
+      /*! \brief The number of round trips made on the ladder.*/
+      size_t roundTrips;
+      /*! \brief The wall time (in seconds) spent on the ladder.*/
+      double seconds;
+    };
+
+    /*! \brief The performance of each temperature ladder used so
+      far, the current ladder is not included.
+     */
+    std::vector<LadderEpoch> _ladderEpochs;
+
+    /*! \brief The replica exchange cycles, round trips and wall
+      time at the start of the current temperature ladder.
+     */
+    LadderEpoch _ladderStart;
+
     /*! \brief Initialises this class ready for the replica exchange.
      */
     virtual void preSimInit();
@@ -201,6 +265,13 @@ namespace dynamo {
      */
     virtual void setupSim(Simulation&, const std::string);
 
+    /*! \brief Load, set up and initialise a single Simulation.
+
+      \param i The index of the Simulation and its configuration
+      file.
+     */
+    void initialiseSim(const size_t i);
+
     //Replica Exchange attempt code
 
     /*! \brief Carry out a certain type of replica exchange phase.
@@ -226,11 +297,102 @@ namespace dynamo {
      */
     void ReplexSwapTicker();
 
+    /*! \brief Update the replica exchange data collected for a
+      single temperature, once it has completed a round in the
+      AsynchronousPairs mode.
+
+      \param slot The index of the temperature in temperatureList.
+     */
+    void AsyncSwapTicker(const size_t slot);
+
+    /*! \brief Set the next replica exchange halt time of a
+      Simulation and prepare it to run again.
+     */
+    void setupReplexInterval(Simulation&);
+
+    /*! \brief Run every Simulation up to its next replica exchange
+      halt, splitting the runs into chunks of events.
+
+      This is used when there are more Simulation's than threads. The
+      replica exchange intervals differ between the temperatures, so
+      running each Simulation as a single task leaves threads idle
+      while the longest runs finish. Instead each thread repeatedly
+      takes the waiting Simulation with the most (estimated) events
+      left until its halt and runs a chunk of it. Simulations move
+      between the threads at chunk boundaries, so every thread is
+      busy until fewer Simulations than threads remain.
+     */
+    void runChunked();
+
+    /*! \brief The number of events in each chunk of the
+      runChunked() scheduler.
+     */
+    size_t _chunkEvents;
+
+    /*! \brief Run the Simulation's without a global barrier.
+
+      In this mode each simulation is queued individually on the
+      WorkStealingPool. Once a simulation has run its interval, it attempts
+      a swap with its neighbour in the current round of the
+      alternating sequence (\ref AlternatingSequence). If the
+      neighbour has not finished its interval, the simulation
+      returns without blocking a thread, and the neighbour performs
+      the swap and requeues both simulations once it finishes.
+
+      Each pair exchange only depends on the two simulations
+      involved, so the sequence of exchange attempts (and detailed
+      balance) is identical to the synchronous AlternatingSequence
+      mode; only the order in which the simulations are run changes.
+     */
+    void runAsynchronous();
+
+    /*! \brief Run a single round of the temperature at the passed
+      index in temperatureList (see \ref runAsynchronous).
+     */
+    void runAsynchronousRound(const size_t slot);
+
+    /*! \brief Write the replica exchange statistics (the
+      replex.dat and replex.stats files).
+     */
+    void outputReplexStats();
+
+    /*! \brief Move the intermediate temperatures of the ladder to
+      maximise the round trip rate.
+
+      This is the feedback-optimised scheme of Katzgraber, Trebst,
+      Huse and Troyer (J. Stat. Mech. P03018, 2006). The fraction of
+      replicas at each temperature which last visited the coldest
+      temperature, \f$f(T)\f$, is measured from the upSims and
+      downSims counters. The density of temperatures is then set to
+      \f$\eta(T)\propto\sqrt{(-{\rm d}f/{\rm d}T)/\Delta T}\f$,
+      which places more temperatures at the bottlenecks of the
+      replica flow. The coldest and hottest temperatures are not
+      changed.
+
+      The replicas are rescaled onto the new temperatures, and the
+      exchange statistics are reset for the next ladder.
+     */
+    void optimiseLadder();
+
+    /*! \brief The performance of the current temperature ladder.
+     */
+    LadderEpoch currentLadderEpoch() const;
+
+    /*! \brief Print the progress and estimated time remaining of
+      the simulations to the screen.
+     */
+    void outputETA();
+
+    /*! \brief Write out the configurations after an exception has
+      been thrown while running the simulations.
+     */
+    void outputErrorConfigs();
+
     /*! \brief Attempt a replica exchange move between two configurations.
      
       \param id1 First Simulation to attempt to exchange.
       \param id2 Second Simulation to attempt to exchange.
      */
-    void AttemptSwap(const unsigned int id1, const unsigned int id2);
+    virtual void AttemptSwap(const unsigned int id1, const unsigned int id2);
   };
 }
@@ -0,0 +1,504 @@
+/*  dynamo:- Event driven molecular dynamics simulator 
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <dynamo/coordinator/coordinator.hpp>
+#include <dynamo/coordinator/engine/replexer_distributed.hpp>
+#include <dynamo/systems/tHalt.hpp>
+#include <dynamo/systems/andersenThermostat.hpp>
+#include <dynamo/systems/snapshot.hpp>
+#include <dynamo/dynamics/multicanonical.hpp>
+#include <dynamo/outputplugins/misc.hpp>
+#include <magnet/thread/workstealingpool.hpp>
+#include <magnet/string/searchreplace.hpp>
+#include <fstream>
+#include <limits>
+#include <thread>
+#include <chrono>
+#ifndef _WIN32
+# include <sys/types.h>
+# include <sys/wait.h>
+# include <unistd.h>
+#endif
+
+namespace dynamo {
+  void
+  EDistributedReplicaExchangeSimulation::getOptions(boost::program_options::options_description& opts)
+  {
+    boost::program_options::options_description 
+      ropts("Distributed REplica EXchange Engine Options (--engine=4)\n"
+	    "The REplica EXchange Engine options are also used");
+
+    ropts.add_options()
+      ("replex-processes", boost::program_options::value<size_t>()->default_value(1), 
+       "The total number of dynarun processes the replicas are divided between.")
+      ("replex-rank", boost::program_options::value<size_t>()->default_value(0), 
+       "The rank of this process. Rank 0 performs the replica exchange moves and the other ranks connect to it.")
+      ("replex-host", boost::program_options::value<std::string>()->default_value("127.0.0.1"), 
+       "The host name or address of the rank 0 process.")
+      ("replex-port", boost::program_options::value<unsigned short>()->default_value(47320), 
+       "The TCP port the rank 0 process listens on.")
+      ("replex-spawn", 
+       "Make rank 0 launch the other ranks as processes on this machine.")
+      ;
+  
+    opts.add(ropts);
+  }
+
+  EDistributedReplicaExchangeSimulation::EDistributedReplicaExchangeSimulation(const boost::program_options::variables_map& nVm,
+									       magnet::thread::WorkStealingPool& tp):
+    EReplicaExchangeSimulation(nVm, tp),
+    _rank(0),
+    _ranks(1)
+  {}
+
+  EDistributedReplicaExchangeSimulation::~EDistributedReplicaExchangeSimulation()
+  {
+    _peers.clear();
+#ifndef _WIN32
+    for (const int pid : _children)
+      waitpid(pid, NULL, 0);
+#endif
+  }
+
+  void
+  EDistributedReplicaExchangeSimulation::initialisation()
+  {
+    preSimInit();
+
+    _ranks = vm["replex-processes"].as<size_t>();
+    _rank = vm["replex-rank"].as<size_t>();
+
+    if (_ranks == 0)
+      M_throw() << "There must be at least one process";
+
+    if (_rank >= _ranks)
+      M_throw() << "The rank of this process (" << _rank << ") must be less than the number of processes (" << _ranks << ")";
+
+    if (nSims < _ranks)
+      M_throw() << "There are fewer replicas (" << nSims << ") than processes (" << _ranks << ")";
+
+    if (ReplexMode == AsynchronousPairs)
+      M_throw() << "The asynchronous replica exchange mode is not available in the distributed engine";
+
+    if (_ladderInterval)
+      M_throw() << "The temperature ladder cannot be optimised in the distributed engine";
+
+    if (vm.count("replex-spawn"))
+      {
+	if (_rank != 0)
+	  M_throw() << "Only rank 0 can spawn the other processes";
+	spawnProcesses();
+      }
+
+    for (size_t id(_rank); id < nSims; id += _ranks)
+      {
+	_localIDs.push_back(id);
+	initialiseSim(id);
+
+	if (dynamic_cast<const dynamo::EnsembleNVT*>(Simulations[id].ensemble.get()) == NULL)
+	  M_throw() << vm["config-file"].as<std::vector<std::string> >()[id]
+		    << " does not have an NVT ensemble";
+
+	if (std::dynamic_pointer_cast<DynNewtonianMC>(Simulations[id].dynamics))
+	  M_throw() << vm["config-file"].as<std::vector<std::string> >()[id]
+		    << " uses multicanonical Dynamics, which the distributed engine cannot exchange";
+
+	//Test a thermostat is available
+	try {
+	  Simulations[id].systems["Thermostat"];
+	} catch (...) {
+	  M_throw() << "Could not find the Thermostat for system " << id
+		    << "\nFilename " << vm["config-file"].as<std::vector<std::string> >()[id];
+	}
+
+	if (dynamic_cast<SysAndersen*>(Simulations[id].systems["Thermostat"].get()) == NULL)
+	  M_throw() << "Found a System event called \"Thermostat\" but could not convert it to an Andersen Thermostat";
+
+	Simulations[id].stateID = id;
+      }
+
+    connect();
+    buildLadder();
+
+    _energies.resize(nSims, 0);
+    _times.resize(nSims, 0);
+    _lastTimes.resize(nSims, 0);
+    _coldestTime = 0;
+  
+    SimDirection.resize(temperatureList.size(), 0);
+    roundtrip.resize(temperatureList.size(), false);
+  
+    SimDirection[temperatureList.front().second.simID] = 1; //Going up
+    SimDirection[temperatureList.back().second.simID] = -1; //Going down
+
+    //Scale the tickers as in the EReplicaExchangeSimulation
+    for (const size_t id : _localIDs)
+      {
+	const double tFactor = std::sqrt(temperatureList.begin()->second.realTemperature / Simulations[id].ensemble->getReducedEnsembleVals()[2]);
+
+	if (vm.count("ticker-period"))
+	  Simulations[id].setTickerPeriod(vm["ticker-period"].as<double>() * tFactor);
+
+	if (vm.count("snapshot"))
+	  dynamic_cast<SysSnapshot &>(*Simulations[id].systems["SnapshotTimer"]).setTickerPeriod(vm["snapshot"].as<double>() * tFactor);
+      }
+  }
+
+  void
+  EDistributedReplicaExchangeSimulation::spawnProcesses()
+  {
+#ifdef _WIN32
+    M_throw() << "Spawning local processes is not supported on Windows";
+#else
+    const std::vector<std::string>& args = Coordinator::get().getArguments();
+    
+    for (size_t rank(1); rank < _ranks; ++rank)
+      {
+	//The arguments are prepared before the fork, as only exec may
+	//be safely called in the child of a threaded process.
+	std::vector<std::string> childArgs;
+	for (const std::string& arg : args)
+	  if ((arg != "--replex-spawn") && (arg.find("--replex-rank") != 0))
+	    childArgs.push_back(arg);
+	childArgs.push_back("--replex-rank=" + boost::lexical_cast<std::string>(rank));
+
+	std::vector<char*> argv;
+	for (std::string& arg : childArgs)
+	  argv.push_back(&arg[0]);
+	argv.push_back(NULL);
+
+	const pid_t pid = fork();
+	if (pid < 0)
+	  M_throw() << "Failed to launch the process for rank " << rank;
+
+	if (pid == 0)
+	  {
+	    execvp(argv[0], argv.data());
+	    _exit(EXIT_FAILURE);
+	  }
+
+	_children.push_back(pid);
+      }
+#endif
+  }
+
+  void
+  EDistributedReplicaExchangeSimulation::connect()
+  {
+    if (_ranks == 1) return;
+
+    const unsigned short port = vm["replex-port"].as<unsigned short>();
+
+    if (_rank == 0)
+      {
+	boost::asio::ip::tcp::acceptor acceptor(_io, boost::asio::ip::tcp::endpoint(boost::asio::ip::tcp::v4(), port));
+	_peers.resize(_ranks - 1);
+	for (size_t i(1); i < _ranks; ++i)
+	  {
+	    std::unique_ptr<Stream> stream(new Stream);
+	    acceptor.accept(stream->socket());
+
+	    size_t rank;
+	    *stream >> rank;
+	    checkStream(*stream);
+	    if ((rank == 0) || (rank >= _ranks) || _peers[rank - 1])
+	      M_throw() << "Invalid or duplicate rank " << rank << " connected to the replica exchange";
+
+	    stream->precision(std::numeric_limits<double>::max_digits10);
+	    _peers[rank - 1] = std::move(stream);
+	  }
+	std::cout << "All " << _ranks << " replica exchange processes connected" << std::endl;
+      }
+    else
+      {
+	//Rank 0 may not be listening yet, so keep trying for a while
+	std::unique_ptr<Stream> stream(new Stream);
+	for (size_t attempt(0); ; ++attempt)
+	  {
+	    stream->connect(vm["replex-host"].as<std::string>(), boost::lexical_cast<std::string>(port));
+	    if (*stream) break;
+
+	    if (attempt == 600)
+	      M_throw() << "Could not connect to the rank 0 process at " << vm["replex-host"].as<std::string>() << ":" << port;
+
+	    stream->clear();
+	    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	  }
+	
+	stream->precision(std::numeric_limits<double>::max_digits10);
+	*stream << _rank << std::endl;
+	_peers.push_back(std::move(stream));
+      }
+  }
+
+  void
+  EDistributedReplicaExchangeSimulation::checkStream(const Stream& stream) const
+  {
+    if (!stream)
+      M_throw() << "Lost the connection between the replica exchange processes (rank " << _rank << ")";
+  }
+
+  void
+  EDistributedReplicaExchangeSimulation::buildLadder()
+  {
+    temperatureList.clear();
+
+    if (_rank == 0)
+      {
+	std::vector<size_t> N(nSims, Simulations[0].N());
+	for (const size_t id : _localIDs)
+	  temperatureList.push_back(replexPair(Simulations[id].ensemble->getEnsembleVals()[2], simData(id, Simulations[id].ensemble->getReducedEnsembleVals()[2])));
+
+	for (const auto& peer : _peers)
+	  {
+	    size_t count;
+	    *peer >> count;
+	    for (size_t i(0); i < count; ++i)
+	      {
+		size_t id;
+		double T, reducedT;
+		*peer >> id >> T >> reducedT >> N[id];
+		temperatureList.push_back(replexPair(T, simData(id, reducedT)));
+	      }
+	    checkStream(*peer);
+	  }
+
+	if (temperatureList.size() != nSims)
+	  M_throw() << "Only " << temperatureList.size() << " of the " << nSims << " replicas were found";
+
+	for (size_t id(1); id < nSims; ++id)
+	  if (N[0] != N[id])
+	    M_throw() << "Every replica configuration file must have the same number of particles!";
+
+	std::sort(temperatureList.begin(), temperatureList.end());
+
+	for (const auto& peer : _peers)
+	  {
+	    for (const replexPair& dat : temperatureList)
+	      *peer << dat.first << " " << dat.second.realTemperature << " " << dat.second.simID << "\n";
+	    *peer << std::flush;
+	  }
+      }
+    else
+      {
+	Stream& server = *_peers[0];
+	server << _localIDs.size() << "\n";
+	for (const size_t id : _localIDs)
+	  server << id << " " << Simulations[id].ensemble->getEnsembleVals()[2]
+		 << " " << Simulations[id].ensemble->getReducedEnsembleVals()[2] 
+		 << " " << Simulations[id].N() << "\n";
+	server << std::flush;
+
+	for (size_t i(0); i < nSims; ++i)
+	  {
+	    double T, reducedT;
+	    size_t id;
+	    server >> T >> reducedT >> id;
+	    temperatureList.push_back(replexPair(T, simData(id, reducedT)));
+	  }
+	checkStream(server);
+      }
+  }
+
+  void 
+  EDistributedReplicaExchangeSimulation::AttemptSwap(const unsigned int sim1ID, const unsigned int sim2ID)
+  {
+    replexPair& dat1 = temperatureList[sim1ID];
+    replexPair& dat2 = temperatureList[sim2ID];
+
+    ++dat1.second.attempts;
+    ++dat2.second.attempts;
+
+    //This is the EnsembleNVT::exchangeProbability
+    const double factor = (_energies[dat1.second.simID] - _energies[dat2.second.simID]) * (1 / dat1.first - 1 / dat2.first);
+
+    std::uniform_real_distribution<> uniform_dist;
+    if (std::exp(factor) > uniform_dist(Simulations[0].ranGenerator))
+      {
+	std::swap(dat1.second.simID, dat2.second.simID);
+	++dat1.second.swaps;
+	++dat2.second.swaps;
+      }
+  }
+
+  void
+  EDistributedReplicaExchangeSimulation::runLocalSimulations()
+  {
+    std::vector<std::function<void()> > tasks;
+    tasks.reserve(_localIDs.size());
+
+    for (const size_t id : _localIDs)
+      {
+	setupReplexInterval(Simulations[id]);
+	tasks.push_back([this, id]() {
+	    const auto start = std::chrono::system_clock::now();
+	    Simulations[id].runSimulation(true);
+	    std::lock_guard<std::mutex> lock(_replexMutex);
+	    _busyTime += std::chrono::duration<double>(std::chrono::system_clock::now() - start).count();
+	  });
+      }
+
+    threads.queueTasks(tasks);
+    try {
+      threads.wait();
+    } catch (std::exception& e) {
+      std::cerr << e.what() << std::endl;
+      for (const size_t id : _localIDs)
+	{
+	  Simulations[id].endEventCount = vm["events"].as<size_t>();
+	  Simulations[id].writeXMLfile(magnet::string::search_replace("config.%ID.error.xml", "%ID", boost::lexical_cast<std::string>(id)), !vm.count("unwrapped"));
+	}
+      M_throw() << "Exception caught while performing simulations";
+    }
+  }
+
+  bool
+  EDistributedReplicaExchangeSimulation::exchange(bool swap)
+  {
+    //Any process may request a shutdown
+    bool stop = _SIGTERM || _SIGINT;
+    if (_SIGINT)
+      Coordinator::setup_signal_handler();
+    _SIGTERM = _SIGINT = false;
+
+    if (_rank == 0)
+      {
+	for (const size_t id : _localIDs)
+	  {
+	    _energies[id] = Simulations[id].getOutputPlugin<OPMisc>()->getConfigurationalU();
+	    _times[id] = Simulations[id].systemTime / Simulations[id].units.unitTime();
+	  }
+
+	for (const auto& peer : _peers)
+	  {
+	    bool peerStop;
+	    size_t count;
+	    *peer >> peerStop >> count;
+	    for (size_t i(0); i < count; ++i)
+	      {
+		size_t id;
+		*peer >> id;
+		*peer >> _energies[id] >> _times[id];
+	      }
+	    checkStream(*peer);
+	    stop |= peerStop;
+	  }
+
+	//Accumulate the time at the lowest temperature before the
+	//replicas are swapped
+	const size_t coldest = temperatureList.front().second.simID;
+	if (swap)
+	  _coldestTime += _times[coldest] - _lastTimes[coldest];
+	else
+	  _coldestTime = _times[coldest];
+	_lastTimes = _times;
+
+	if (swap)
+	  {
+	    ReplexSwap(ReplexMode);
+	    ReplexSwapTicker();
+	  }
+
+	stop |= !(_coldestTime < replicaEndTime);
+
+	for (const auto& peer : _peers)
+	  {
+	    *peer << stop;
+	    for (const replexPair& dat : temperatureList)
+	      *peer << " " << dat.second.simID;
+	    *peer << std::endl;
+	  }
+
+	std::cout << "\rReplica Exchange No." << replexSwapCalls << ", "
+		  << int(100 * _coldestTime / replicaEndTime) << "%        ";
+	std::cout.flush();
+      }
+    else
+      {
+	Stream& server = *_peers[0];
+	server << stop << " " << _localIDs.size() << "\n";
+	for (const size_t id : _localIDs)
+	  server << id << " " << Simulations[id].getOutputPlugin<OPMisc>()->getConfigurationalU() 
+		 << " " << Simulations[id].systemTime / Simulations[id].units.unitTime() << "\n";
+	server << std::flush;
+
+	server >> stop;
+	for (replexPair& dat : temperatureList)
+	  server >> dat.second.simID;
+	checkStream(server);
+
+	if (swap)
+	  {
+	    ++replexSwapCalls;
+	    for (const size_t id : _localIDs)
+	      ++(Simulations[id].replexExchangeNumber);
+	  }
+      }
+
+    //Move the local replicas to their new temperatures
+    for (const replexPair& dat : temperatureList)
+      if (((dat.second.simID % _ranks) == _rank)
+	  && (Simulations[dat.second.simID].ensemble->getEnsembleVals()[2] != dat.first))
+	Simulations[dat.second.simID].setReplicaTemperature(dat.first);
+
+    return stop;
+  }
+
+  void
+  EDistributedReplicaExchangeSimulation::runSimulation()
+  {
+    _start_time = std::chrono::system_clock::now();
+
+    //The first exchange only gathers the state of the replicas, to
+    //check if any simulation is needed.
+    for (bool swap = false; !exchange(swap); swap = true)
+      runLocalSimulations();
+
+    _end_time = std::chrono::system_clock::now();
+  }
+
+  void
+  EDistributedReplicaExchangeSimulation::outputData()
+  {
+    if (_rank == 0)
+      outputReplexStats();
+
+    for (size_t i(0); i < temperatureList.size(); ++i)
+      if ((temperatureList[i].second.simID % _ranks) == _rank)
+	Simulations[temperatureList[i].second.simID].outputData
+	  ((magnet::string::search_replace(outputFormat, "%ID", boost::lexical_cast<std::string>(i))).c_str());
+  }
+
+  void 
+  EDistributedReplicaExchangeSimulation::outputConfigs()
+  {
+    if (_rank == 0)
+      {
+	std::fstream TtoID("TtoID.dat",std::ios::out | std::ios::trunc);
+	for (size_t i(0); i < temperatureList.size(); ++i)
+	  TtoID << temperatureList[i].second.realTemperature << " " << i << "\n";
+      }
+
+    for (size_t i(0); i < temperatureList.size(); ++i)
+      if ((temperatureList[i].second.simID % _ranks) == _rank)
+	{
+	  Simulation& sim = Simulations[temperatureList[i].second.simID];
+	  sim.endEventCount = vm["events"].as<size_t>();
+	  sim.writeXMLfile(magnet::string::search_replace(configFormat, "%ID", boost::lexical_cast<std::string>(i)), !vm.count("unwrapped"));
+	}
+  }
+}
@@ -0,0 +1,164 @@
+/*  dynamo:- Event driven molecular dynamics simulator 
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*! \file replexer_distributed.hpp
+ * Holds the definition of the EDistributedReplicaExchangeSimulation class.
+ */
+
+#pragma once
+
+#include <dynamo/coordinator/engine/replexer.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <memory>
+#include <vector>
+
+namespace dynamo {
+  /*! \brief A Replica Exchange/Parallel Tempering Engine which
+    spreads the replicas over several dynarun processes.
+   
+    Each process (or rank) owns the replicas whose index in the list
+    of configuration files is equal to its rank, modulo the number of
+    processes. Every process is given the full list of configuration
+    files. The processes run their replicas using their own
+    WorkStealingPool, then send the configurational energy and time of each
+    replica to rank 0 over a TCP connection.
+   
+    Rank 0 holds the temperature ladder and carries out the replica
+    exchange moves exactly as the EReplicaExchangeSimulation does, but
+    only the temperatures are exchanged. The configurations stay in
+    their process and are moved to their new temperature using
+    Simulation::setReplicaTemperature. As a result, the output plugin
+    data is collected per configuration rather than per temperature.
+   
+    Rank 0 writes the replex.dat, replex.stats and TtoID.dat
+    files. Every process writes the configuration and output files of
+    its own replicas, numbered by their final temperature as in the
+    EReplicaExchangeSimulation engine.
+
+    For testing on a single machine, --replex-spawn makes rank 0
+    launch the other ranks as local processes.
+   */
+  class EDistributedReplicaExchangeSimulation: public EReplicaExchangeSimulation
+  {
+  public:
+    /*! \brief The only constructor.
+     
+      \param vm The parsed command line options held by the Coordinator.
+      \param tp The WorkStealingPool for this instance of dynarun.
+     */
+    EDistributedReplicaExchangeSimulation(const boost::program_options::variables_map& vm, 
+					  magnet::thread::WorkStealingPool& tp);
+  
+    /*! \brief Closes the connections and waits for any spawned
+      processes to finish.
+     */
+    virtual ~EDistributedReplicaExchangeSimulation();
+
+    /*! \brief Run the local Simulation's and periodically
+      exchange the temperatures with the other processes.
+     */
+    virtual void runSimulation();
+
+    /*! \brief Initialise the local Simulation's, connect to the
+      other processes and build the temperature ladder.
+     */
+    virtual void initialisation();
+
+    /*! \brief Return the options for the distributed replica
+      exchange Engine.
+     */
+    static void getOptions(boost::program_options::options_description&);
+
+    /*! \brief Output the data of the local Simulation's, and the
+      replica exchange statistics on rank 0.
+     */
+    virtual void outputData();
+  
+    /*! \brief Output the configurations of the local Simulation's.
+     */
+    virtual void outputConfigs();
+
+  protected:
+    typedef boost::asio::ip::tcp::iostream Stream;
+
+    /*! \brief Attempt an exchange of the temperatures at the two
+      passed positions in the temperatureList.
+
+      This uses the energies reported by the processes, and is only
+      called on rank 0.
+     */
+    virtual void AttemptSwap(const unsigned int id1, const unsigned int id2);
+
+    /*! \brief Launch the other ranks as local processes. */
+    void spawnProcesses();
+
+    /*! \brief Open the connections between rank 0 and the other
+      ranks. */
+    void connect();
+
+    /*! \brief Build the temperature ladder from the replicas of all
+      processes. */
+    void buildLadder();
+
+    /*! \brief Run every local Simulation for one replica exchange
+      interval. */
+    void runLocalSimulations();
+
+    /*! \brief Gather the replica states, (optionally) perform the
+      replica exchange moves and distribute the new temperatures.
+
+      \param swap If the replica exchange moves should be attempted.
+      \return If the simulations should stop.
+     */
+    bool exchange(bool swap);
+
+    /*! \brief Check the stream to a peer is still valid. */
+    void checkStream(const Stream&) const;
+
+    //! The rank of this process.
+    size_t _rank;
+    //! The total number of processes.
+    size_t _ranks;
+    //! The indices of the Simulation's owned by this process.
+    std::vector<size_t> _localIDs;
+    //! The last configurational energy of every replica (rank 0 only).
+    std::vector<double> _energies;
+    //! The last system time of every replica (rank 0 only).
+    std::vector<double> _times;
+    //! The system time of every replica at the previous exchange (rank 0 only).
+    std::vector<double> _lastTimes;
+    /*! \brief The simulation time spent at the lowest temperature (rank 0 only).
+
+      The replicas keep their system time when they change
+      temperature, so unlike the EReplicaExchangeSimulation the end
+      of the run cannot be taken from the coldest replica's time.
+     */
+    double _coldestTime;
+
+    boost::asio::io_context _io;
+
+    /*! \brief The connections to the other processes.
+
+      On rank 0 this holds the connection to every other rank (at
+      index rank - 1), on the other ranks this holds the connection
+      to rank 0.
+     */
+    std::vector<std::unique_ptr<Stream> > _peers;
+
+    //! The process IDs of any spawned processes.
+    std::vector<int> _children;
+  };
+}
@@ -23,7 +23,7 @@
 
 namespace dynamo {
   ESingleSimulation::ESingleSimulation(const boost::program_options::variables_map& nVM, 
-				       magnet::thread::ThreadPool& tp):
+				       magnet::thread::WorkStealingPool& tp):
     Engine(nVM, "config.out.xml", "output.xml", tp)
   {}
 
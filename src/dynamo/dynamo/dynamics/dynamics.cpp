@@ -432,6 +432,14 @@ namespace dynamo {
     updateParticle(p2);
   }
 
+  void
+  Dynamics::getSquareCellCollisionTimes(const std::vector<size_t>& ids, const std::vector<Vector>& origins, const Vector& width, std::vector<double>& times) const
+  {
+    times.resize(ids.size());
+    for (size_t i(0); i < ids.size(); ++i)
+      times[i] = getSquareCellCollision2(Sim->particles[ids[i]], origins[i], width);
+  }
+
   double
   Dynamics::getParticleDelay(const Particle& part) const
   {
@@ -226,6 +226,23 @@ namespace dynamo {
     virtual double getSquareCellCollision2(const Particle& part, 
 					   const Vector & origin, 
 					   const Vector & width) const = 0;
+
+    /*! \brief Batched form of \ref getSquareCellCollision2.
+
+      Determines when each of the passed particles will hit the
+      bounding box of its cell. The default implementation calls
+      getSquareCellCollision2 for each particle, but Dynamics may
+      override this with a form which vectorises across particles.
+     
+      \param ids The IDs of the particles to test.
+      \param origins The lowest corner of the bounding cell box of each particle.
+      \param width The width of the bounding cell boxes.
+      \param times The times till collision are written here (one per particle).
+     */
+    virtual void getSquareCellCollisionTimes(const std::vector<size_t>& ids,
+					     const std::vector<Vector>& origins,
+					     const Vector& width,
+					     std::vector<double>& times) const;
   
     /*! \brief Determines which dimension of the cell the particle will
       leave first.
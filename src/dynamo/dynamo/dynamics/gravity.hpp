@@ -37,6 +37,8 @@ namespace dynamo {
     virtual void streamParticle(Particle&, const double&) const;
     virtual double getSquareCellCollision2(const Particle&, const Vector &, const Vector &) const;
     virtual int getSquareCellCollision3(const Particle&, const Vector &, const Vector &) const;
+    virtual void getSquareCellCollisionTimes(const std::vector<size_t>& ids, const std::vector<Vector>& origins, const Vector& width, std::vector<double>& times) const
+    { Dynamics::getSquareCellCollisionTimes(ids, origins, width, times); }
     virtual std::pair<bool,double> getPointPlateCollision(const Particle& np1, const Vector& nrw0, const Vector& nhat, const double& Delta, const double& Omega, const double& Sigma, const double& t, bool) const;
     virtual double getPBCSentinelTime(const Particle&, const double&) const;
     virtual double getParabolaSentinelTime(const Particle&) const;
@@ -292,6 +292,64 @@ namespace dynamo {
     return retVal;
   }
 
+  void
+  DynNewtonian::getSquareCellCollisionTimes(const std::vector<size_t>& ids, const std::vector<Vector>& origins, const Vector& width, std::vector<double>& times) const
+  {
+    const size_t N = ids.size();
+    times.resize(N);
+
+    //Gather the relative positions and velocities into a
+    //structure-of-arrays layout, so the exit time calculation below
+    //is a simple loop the compiler can vectorise.
+    std::array<std::vector<double>, NDIM> rpos, vel;
+    for (size_t iDim = 0; iDim < NDIM; ++iDim)
+      {
+	rpos[iDim].resize(N);
+	vel[iDim].resize(N);
+      }
+
+    for (size_t i = 0; i < N; ++i)
+      {
+	const Particle& part = Sim->particles[ids[i]];
+	Vector r(part.getPosition() - origins[i]);
+	Vector v(part.getVelocity());
+	Sim->BCs->applyBC(r, v);
+	for (size_t iDim = 0; iDim < NDIM; ++iDim)
+	  {
+	    rpos[iDim][i] = r[iDim];
+	    vel[iDim][i] = v[iDim];
+	  }
+      }
+
+    //This must give identical results to getSquareCellCollision2,
+    //including the treatment of negative zero velocities.
+    {
+      const double* const r = rpos[0].data();
+      const double* const v = vel[0].data();
+      double* const t = times.data();
+      const double w = width[0];
+      for (size_t i = 0; i < N; ++i)
+	{
+	  const double vi = (v[i] == 0) ? 0.0 : v[i];
+	  t[i] = ((vi < 0) ? -r[i] : (w - r[i])) / vi;
+	}
+    }
+
+    for (size_t iDim = 1; iDim < NDIM; ++iDim)
+      {
+	const double* const r = rpos[iDim].data();
+	const double* const v = vel[iDim].data();
+	double* const t = times.data();
+	const double w = width[iDim];
+	for (size_t i = 0; i < N; ++i)
+	  {
+	    const double vi = (v[i] == 0) ? 0.0 : v[i];
+	    const double tmpdt = ((vi < 0) ? -r[i] : (w - r[i])) / vi;
+	    t[i] = (tmpdt < t[i]) ? tmpdt : t[i];
+	  }
+      }
+  }
+
   int
   DynNewtonian::getSquareCellCollision3(const Particle& part, const Vector & origin, const Vector & width) const
   {
@@ -43,6 +43,7 @@ namespace dynamo {
     virtual bool cubeOverlap(const Particle& p1, const Particle& p2, const double d) const;
     virtual void streamParticle(Particle&, const double&) const;
     virtual double getSquareCellCollision2(const Particle&, const Vector &, const Vector &) const;
+    virtual void getSquareCellCollisionTimes(const std::vector<size_t>&, const std::vector<Vector>&, const Vector&, std::vector<double>&) const;
     virtual int getSquareCellCollision3(const Particle&, const Vector &, const Vector &) const;
     virtual std::pair<bool,double> getPointPlateCollision(const Particle& np1, const Vector& nrw0, const Vector& nhat, const double& Delta, const double& Omega, const double& Sigma, const double& t, bool) const;
     virtual ParticleEventData runOscilatingPlate(Particle& part, const Vector& rw0, const Vector& nhat, double& delta, const double& omega0, const double& sigma, const double& mass, const double& e, double& t, bool strongPlate) const;
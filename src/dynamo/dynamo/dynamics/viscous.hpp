@@ -52,6 +52,8 @@ namespace dynamo {
     virtual double CubeCubeInRoot(const Particle& p1, const Particle& p2, double d) const { M_throw() << "Not implemented"; }
     virtual double getSquareCellCollision2(const Particle&, const Vector &, const Vector &) const { M_throw() << "Not implemented"; }
     virtual int getSquareCellCollision3(const Particle&, const Vector &, const Vector &) const { M_throw() << "Not implemented"; }
+    virtual void getSquareCellCollisionTimes(const std::vector<size_t>& ids, const std::vector<Vector>& origins, const Vector& width, std::vector<double>& times) const
+    { Dynamics::getSquareCellCollisionTimes(ids, origins, width, times); }
     virtual std::pair<bool,double> getPointPlateCollision(const Particle& np1, const Vector& nrw0, const Vector& nhat, const double& Delta, const double& Omega, const double& Sigma, const double& t, bool) const { M_throw() << "Not implemented"; }
     virtual ParticleEventData runOscilatingPlate(Particle& part, const Vector& rw0, const Vector& nhat, double& delta, const double& omega0, const double& sigma, const double& mass, const double& e, double& t, bool strongPlate) const { M_throw() << "Not implemented"; }
     virtual bool DSMCSpheresTest(Particle&, Particle&, double&, const double&, Vector) const { M_throw() << "Not implemented"; }
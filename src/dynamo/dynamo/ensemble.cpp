@@ -97,6 +97,13 @@ namespace dynamo {
 	     << "\nT=" << EnsembleVals[2] / Sim->units.unitEnergy() << std::endl;
   }
 
+  void
+  EnsembleNVT::setTemperature(double T)
+  {
+    EnsembleVals[2] = T;
+    std::static_pointer_cast<SysAndersen>(thermostat)->setTemperature(T);
+  }
+
   std::array<double,3> 
   EnsembleNVT::getReducedEnsembleVals() const
   {
@@ -123,6 +123,14 @@ namespace dynamo {
 
     virtual const std::array<double,3>& getEnsembleVals() const { return EnsembleVals; }
 
+    /*! \brief Change the temperature of the ensemble and its
+        thermostat.
+
+	This does not rescale the particle velocities, see
+	Simulation::setReplicaTemperature.
+     */
+    void setTemperature(double T);
+
   protected:
     shared_ptr<System> thermostat;
   };
@@ -26,7 +26,9 @@
 #include <dynamo/dynamics/compression.hpp>
 #include <magnet/xmlwriter.hpp>
 #include <magnet/xmlreader.hpp>
+#include <magnet/timer.hpp>
 #include <cstdio>
+#include <functional>
 #include <set>
 #include <algorithm>
 
@@ -80,6 +82,25 @@ namespace dynamo {
     return Event(part, Sim->dynamics->getSquareCellCollision2(part, calcPosition(_cellData.getCellID(part.getID()), part), _cellDimension) - Sim->dynamics->getParticleDelay(part), GLOBAL, CELL, ID);
   }
 
+  void
+  GCells::getEvents(const std::vector<size_t>& ids, std::vector<Event>& events) const
+  {
+    //The cell transition times are calculated in bulk, which allows
+    //the Dynamics to vectorise the calculation across the particles.
+    std::vector<Vector> origins;
+    origins.reserve(ids.size());
+    for (const size_t id : ids)
+      origins.push_back(calcPosition(_cellData.getCellID(id), Sim->particles[id]));
+
+    std::vector<double> times;
+    Sim->dynamics->getSquareCellCollisionTimes(ids, origins, _cellDimension, times);
+
+    events.clear();
+    events.reserve(ids.size());
+    for (size_t i(0); i < ids.size(); ++i)
+      events.push_back(Event(Sim->particles[ids[i]], times[i] - Sim->dynamics->getParticleDelay(Sim->particles[ids[i]]), GLOBAL, CELL, ID));
+  }
+
   void
   GCells::runEvent(Particle& part, const double)
   {
@@ -92,6 +113,7 @@ namespace dynamo {
     //pushed after the callbacks are complete (the callbacks may also
     //add events so this must be done first).
     Sim->ptrScheduler->popNextEvent();
+    countCellTransition();
 
     const size_t oldCellIndex = _cellData.getCellID(part.getID());
     const auto oldCellCoord = _ordering.toCoord(oldCellIndex);
@@ -206,11 +228,8 @@ namespace dynamo {
       M_throw() << "The system size is too small to support the range of interactions specified (i.e. the system is smaller than the interaction diameter of one particle).";
   }
 
-  void GCells::buildCells()
+  void GCells::logCells() const
   {
-    _cellData.clear();
-    _cellData.resize(_ordering.length(), Sim->particles.size()); //Empty Cells created!
-
     dout << "Cells " << _ordering.getDimensions()[0] << "," << _ordering.getDimensions()[1] << "," << _ordering.getDimensions()[2]
 	 << "\nCell containers = " << _ordering.length()
 	 << "\nCell Offset "
@@ -231,8 +250,13 @@ namespace dynamo {
 	 << _cellLatticeWidth[2] / Sim->units.unitLength()
 	 << "\nSupported Interaction range " << getMaxSupportedInteractionLength() / Sim->units.unitLength()
 	 << std::endl;
+  }
+
+  void GCells::buildCellsIncremental()
+  {
+    _cellData.clear();
+    _cellData.resize(_ordering.length(), Sim->particles.size()); //Empty Cells created!
   
-    ////Add all the particles 
     //Required so particles find the right owning cell
     Sim->dynamics->updateAllParticles();
     for (const size_t& pid : *range)
@@ -242,6 +266,68 @@ namespace dynamo {
       }
   }
 
+  void GCells::buildCells()
+  {
+    logCells();
+
+    magnet::Timer timer;
+    _cellData.clear();
+    _cellData.resize(_ordering.length(), Sim->particles.size()); //Empty Cells created!
+
+    //Required so particles find the right owning cell
+    Sim->dynamics->updateAllParticles();
+
+    const size_t N = range->size();
+    const size_t cellCount = _ordering.length();
+
+    //Sorting a particle into its cell costs about as much as a
+    //hundred pair evaluations
+    const size_t chunks = Sim->parallelChunks(100 * N);
+
+    //Runs func(begin, end) over [0, size) split into the chunks
+    auto parallel_for = [&](const size_t size, const std::function<void(size_t, size_t)>& func) {
+      Sim->parallelFor(chunks, [&](const size_t chunk) {
+	  func((size * chunk) / chunks, (size * (chunk + 1)) / chunks);
+	});
+    };
+
+    //Calculate the cell of every particle
+    std::vector<size_t> particleCells(N);
+    parallel_for(N, [&](size_t begin, size_t end) {
+	for (size_t i(begin); i < end; ++i)
+	  particleCells[i] = _ordering.toIndex(getCellCoords(Sim->particles[(*range)[i]].getPosition()));
+      });
+
+    //Counting sort of the particles by cell (stable, so each cell is
+    //in the same order as the range)
+    std::vector<size_t> cellStart(cellCount + 1, 0);
+    for (const size_t& cell : particleCells)
+      ++cellStart[cell + 1];
+
+    for (size_t cell(0); cell < cellCount; ++cell)
+      cellStart[cell + 1] += cellStart[cell];
+
+    std::vector<size_t> sortedIDs(N);
+    {
+      std::vector<size_t> next(cellStart.begin(), cellStart.end() - 1);
+      for (size_t i(0); i < N; ++i)
+	sortedIDs[next[particleCells[i]]++] = (*range)[i];
+    }
+
+    //Each chunk fills a disjoint set of cells, if the cell list
+    //stores each cell separately
+    if (_cellData.concurrentFill)
+      parallel_for(cellCount, [&](size_t begin, size_t end) {
+	  _cellData.fillCells(cellStart, sortedIDs, begin, end);
+	});
+    else
+      _cellData.fillCells(cellStart, sortedIDs, 0, cellCount);
+
+    _cellData.buildMap(cellStart, sortedIDs);
+
+    dout << "Cells built in " << timer.duration<std::milli>() << "ms in " << chunks << " chunk(s)" << std::endl;
+  }
+
   std::array<size_t, 3>
   GCells::getCellCoords(Vector pos) const
   {
@@ -272,12 +358,31 @@ namespace dynamo {
   
   void
   GCells::getParticleNeighbours(const Particle& part, std::vector<size_t>& retlist) const {
+    const size_t start = retlist.size();
     getParticleNeighbours(_ordering.toCoord(_cellData.getCellID(part.getID())), retlist);
+    countNeighbourQuery(retlist.size() - start);
   }
 
   void
   GCells::getParticleNeighbours(const Vector& vec, std::vector<size_t>& retlist) const {
-    return getParticleNeighbours(getCellCoords(vec), retlist);
+    const size_t start = retlist.size();
+    getParticleNeighbours(getCellCoords(vec), retlist);
+    countNeighbourQuery(retlist.size() - start);
+  }
+
+  std::vector<size_t>
+  GCells::getOccupancyHistogram() const
+  {
+    std::vector<size_t> histogram;
+    for (size_t cellIndex(0); cellIndex < _ordering.length(); ++cellIndex)
+      {
+	const auto contents = _cellData.getCellContents(cellIndex);
+	const size_t occupancy = std::distance(contents.begin(), contents.end());
+	if (occupancy >= histogram.size())
+	  histogram.resize(occupancy + 1, 0);
+	++histogram[occupancy];
+      }
+    return histogram;
   }
 
   double 
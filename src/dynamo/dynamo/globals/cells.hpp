@@ -25,10 +25,29 @@
 #include <magnet/containers/multimaps.hpp>
 #include <magnet/containers/ordering.hpp>
 #include <unordered_map>
+#include <type_traits>
 #include <vector>
 
 namespace dynamo {
   namespace detail {
+    //! Pre-allocate a particle to cell map, if the map supports it.
+    template<typename Map> inline void reserveMap(Map&, size_t) {}
+
+    template<typename Key, typename Value>
+    inline void reserveMap(std::unordered_map<Key, Value>& map, size_t N) { map.reserve(N); }
+
+    /*! \brief Whether disjoint ranges of cells of a CellList can be
+        filled concurrently.
+
+	Only a CellList with separate storage for each cell supports
+	this, other types (e.g., Set_Multimap) insert into one shared
+	container.
+     */
+    template<typename CellList> struct ConcurrentFill: std::false_type {};
+
+    template<typename InnerSet>
+    struct ConcurrentFill<magnet::containers::Vector_Multimap<InnerSet> >: std::true_type {};
+
     /*! \brief A container for storing the cell contents (and which
         particle is in which cell).
 	
@@ -59,6 +78,36 @@ namespace dynamo {
 	_particleCell.erase(particle);
       }
 
+      //! Whether \ref fillCells may be called concurrently
+      static constexpr bool concurrentFill = ConcurrentFill<CellList>::value;
+
+      /*! \brief Replace the contents of the list with a
+	  pre-sorted CSR (compressed sparse row) layout.
+
+	  \param cellStart The offsets of each cell's particles in
+	  sortedIDs. This has one more entry than there are cells.
+	  \param sortedIDs The particle IDs sorted by their cell.
+	  \param begin The first cell to fill.
+	  \param end One past the last cell to fill.
+	  
+	  If \ref concurrentFill is true, disjoint ranges of cells may
+	  be filled concurrently. The particle to cell map must be
+	  filled afterwards using \ref buildMap.
+       */
+      void fillCells(const std::vector<size_t>& cellStart, const std::vector<size_t>& sortedIDs, size_t begin, size_t end) {
+	for (size_t cell(begin); cell < end; ++cell)
+	  _cellcontents.insert(cell, sortedIDs.begin() + cellStart[cell], sortedIDs.begin() + cellStart[cell + 1]);
+      }
+
+      /*! \brief Fill the particle to cell map from a CSR layout
+	  (see \ref fillCells). */
+      void buildMap(const std::vector<size_t>& cellStart, const std::vector<size_t>& sortedIDs) {
+	reserveMap(_particleCell, sortedIDs.size());
+	for (size_t cell(0); cell + 1 < cellStart.size(); ++cell)
+	  for (size_t i(cellStart[cell]); i < cellStart[cell + 1]; ++i)
+	    _particleCell[sortedIDs[i]] = cell;
+      }
+
       void moveTo(size_t oldcell, size_t newcell, size_t particle) {
 	_cellcontents.erase(oldcell, particle);
 	_cellcontents.insert(newcell, particle);
@@ -118,6 +167,8 @@ namespace dynamo {
 
     virtual Event getEvent(const Particle &) const;
 
+    virtual void getEvents(const std::vector<size_t>&, std::vector<Event>&) const;
+
     virtual void runEvent(Particle&, const double);
 
     virtual void initialise(size_t);
@@ -126,6 +177,8 @@ namespace dynamo {
 
     void getParticleNeighbours(const Particle&, std::vector<size_t>&) const;
     void getParticleNeighbours(const Vector&, std::vector<size_t>&) const;
+
+    virtual std::vector<size_t> getOccupancyHistogram() const;
     
     virtual void operator<<(const magnet::xml::Node&);
 
@@ -163,8 +216,26 @@ namespace dynamo {
     std::array<size_t, 3> getCellCoords(Vector) const;
 
     void addCells(std::array<size_t, 3> cellCount);
+
+    /*! \brief Sort all particles into the cells.
+
+      This performs a counting sort of the particles by cell index
+      into a CSR layout, which is then used to fill the cells in
+      bulk. The particle cell coordinates are calculated and the
+      cells are filled in parallel for large systems.
+     */
     void buildCells();
 
+    /*! \brief Sort all particles into the cells by inserting them
+        one at a time.
+
+	This is the original (serial) cell build, it is kept as a
+	reference and to benchmark \ref buildCells.
+     */
+    void buildCellsIncremental();
+
+    void logCells() const;
+
     Vector calcPosition(const size_t cellIndex, const Particle& part) const { return calcPosition(_ordering.toCoord(cellIndex), part);}
     Vector calcPosition(const std::array<size_t, 3>& coords, const Particle& part) const ;
     Vector calcPosition(const size_t cellIndex) const { return calcPosition(_ordering.toCoord(cellIndex));}
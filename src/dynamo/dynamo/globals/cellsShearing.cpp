@@ -75,6 +75,7 @@ namespace dynamo {
     //Get rid of the virtual event that is next, update is delayed
     //till after all events are added
     Sim->ptrScheduler->popNextEvent();
+    countCellTransition();
 
     const size_t oldCellIndex(_cellData.getCellID(part.getID()));
     const auto oldCellCoord = _ordering.toCoord(oldCellIndex);
@@ -33,6 +33,9 @@ namespace dynamo {
   
     virtual Event getEvent(const Particle &) const;
 
+    virtual void getEvents(const std::vector<size_t>& ids, std::vector<Event>& events) const
+    { Global::getEvents(ids, events); }
+
     virtual void runEvent(Particle&, const double);
 
   protected:
@@ -18,6 +18,7 @@
 #include <dynamo/globals/include.hpp>
 #include <dynamo/globals/global.hpp>
 #include <dynamo/particle.hpp>
+#include <dynamo/simulation.hpp>
 #include <dynamo/ranges/IDRangeAll.hpp>
 #include <dynamo/BC/LEBC.hpp>
 #include <magnet/xmlwriter.hpp>
@@ -35,6 +36,15 @@ namespace dynamo {
     return range->isInRange(p1);
   }
 
+  void
+  Global::getEvents(const std::vector<size_t>& ids, std::vector<Event>& events) const
+  {
+    events.clear();
+    events.reserve(ids.size());
+    for (const size_t id : ids)
+      events.push_back(getEvent(Sim->particles[id]));
+  }
+
   magnet::xml::XmlStream& operator<<(magnet::xml::XmlStream& XML, const Global& g)
   {
     g.outputXML(XML);
@@ -19,6 +19,7 @@
 #include <dynamo/base.hpp>
 #include <dynamo/eventtypes.hpp>
 #include <dynamo/ranges/IDRange.hpp>
+#include <vector>
 
 namespace magnet { namespace xml { class Node; } }
 namespace xml { class XmlStream; }
@@ -55,6 +56,21 @@ namespace dynamo {
      */
     virtual Event getEvent(const Particle &) const = 0;
 
+    /*! \brief Calculates the next event for each of the passed
+      particles.
+
+      This is used by the Scheduler when it is recalculating the
+      events of many particles at once. The default implementation
+      calls \ref getEvent for each particle, Globals which can
+      calculate their events more efficiently in bulk (e.g., GCells)
+      override this.
+
+      \param ids The IDs of the particles, which must all be particles
+      this Global applies to and be up to date.
+      \param events The events are written here (one per particle).
+     */
+    virtual void getEvents(const std::vector<size_t>& ids, std::vector<Event>& events) const;
+
     /*! \brief Executes the event for a particle.
       
       \param p The particle which is about to undergo an interaction.
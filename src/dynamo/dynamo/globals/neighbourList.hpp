@@ -21,6 +21,9 @@
 #include <dynamo/ranges/IDRangeList.hpp>
 #include <magnet/function/delegate.hpp>
 #include <magnet/math/vector.hpp>
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <memory>
 #include <vector>
 
@@ -84,6 +87,47 @@ namespace dynamo {
     double getMaxInteractionRange() const
     { return _maxInteractionRange; }
 
+    /*! \brief Counters describing how the neighbour list is being
+        used.
+	
+	These are cheap to maintain and are collected by the
+	OPNeighbourListStats output plugin to help tune the
+	neighbour list (e.g., the cell size and overlink).
+     */
+    struct Statistics
+    {
+      Statistics(): cellTransitions(0), neighbourQueries(0), neighboursReturned(0), maxNeighbours(0) {}
+      //! The number of virtual events where a particle changed cell.
+      size_t cellTransitions;
+      //! The number of neighbourhood look-ups performed.
+      size_t neighbourQueries;
+      //! The total number of neighbours returned by the look-ups.
+      size_t neighboursReturned;
+      //! The largest neighbourhood returned by a single look-up.
+      size_t maxNeighbours;
+      //! The count of look-ups, indexed by the neighbourhood size.
+      std::vector<size_t> neighbourHistogram;
+    };
+
+    /*! \brief A snapshot of the counters.
+
+	Neighbour queries may be made from several threads at once
+	(e.g., by concurrent ticker plugins), so the counters are
+	kept in atomics and copied out here.
+     */
+    Statistics getStatistics() const { return _stats.snapshot(); }
+
+    void resetStatistics() { _stats.reset(); }
+
+    /*! \brief Returns the number of cells (or neighbourhoods) of the
+        list, indexed by the number of particles they contain.
+
+	The default implementation returns an empty histogram for
+	neighbour lists which have no concept of occupancy.
+     */
+    virtual std::vector<size_t> getOccupancyHistogram() const
+    { return std::vector<size_t>(); }
+
     mutable magnet::Signal<void(const Particle&, const size_t&)> _sigNewNeighbour;
     mutable magnet::Signal<void(const Particle&, const size_t&)> _sigCellChange;
     mutable magnet::Signal<void()> _sigReInitialise;
@@ -91,6 +135,104 @@ namespace dynamo {
   protected:
     bool _initialised;
     double _maxInteractionRange;
+    /*! \brief The thread-safe storage behind Statistics.
+
+	The counters are relaxed atomics. The histogram is held in
+	blocks of doubling size (block k holds the bins [2^k-1,
+	2^{k+1}-1)) which are allocated on first use, so it can grow
+	without a lock and without moving existing bins.
+     */
+    class AtomicStatistics
+    {
+    public:
+      AtomicStatistics()
+      {
+	for (auto& block : _blocks) block = nullptr;
+	reset();
+      }
+
+      ~AtomicStatistics()
+      { for (auto& block : _blocks) delete[] block.load(); }
+
+      void reset()
+      {
+	_cellTransitions = 0;
+	_neighbourQueries = 0;
+	_neighboursReturned = 0;
+	_maxNeighbours = 0;
+	for (size_t k(0); k < _blocks.size(); ++k)
+	  if (std::atomic<size_t>* block = _blocks[k].load())
+	    for (size_t i(0); i < (size_t(1) << k); ++i)
+	      block[i] = 0;
+      }
+
+      void countCellTransition()
+      { _cellTransitions.fetch_add(1, std::memory_order_relaxed); }
+
+      void countQuery(const size_t neighbours)
+      {
+	_neighbourQueries.fetch_add(1, std::memory_order_relaxed);
+	_neighboursReturned.fetch_add(neighbours, std::memory_order_relaxed);
+	size_t max = _maxNeighbours.load(std::memory_order_relaxed);
+	while ((neighbours > max) && !_maxNeighbours.compare_exchange_weak(max, neighbours, std::memory_order_relaxed)) {}
+	bin(neighbours).fetch_add(1, std::memory_order_relaxed);
+      }
+
+      Statistics snapshot() const
+      {
+	Statistics stats;
+	stats.cellTransitions = _cellTransitions;
+	stats.neighbourQueries = _neighbourQueries;
+	stats.neighboursReturned = _neighboursReturned;
+	stats.maxNeighbours = _maxNeighbours;
+	if (stats.neighbourQueries)
+	  for (size_t n(0); n <= stats.maxNeighbours; ++n)
+	    {
+	      const std::atomic<size_t>* block = _blocks[blockOf(n)].load();
+	      stats.neighbourHistogram.push_back(block ? block[n + 1 - (size_t(1) << blockOf(n))].load() : 0);
+	    }
+	return stats;
+      }
+
+    private:
+      static size_t blockOf(size_t n)
+      {
+	size_t k(0);
+	while ((n + 1) >> (k + 1)) ++k;
+	return k;
+      }
+
+      std::atomic<size_t>& bin(const size_t n)
+      {
+	const size_t k = blockOf(n);
+	std::atomic<size_t>* block = _blocks[k].load();
+	if (!block)
+	  {
+	    std::atomic<size_t>* fresh = new std::atomic<size_t>[size_t(1) << k];
+	    for (size_t i(0); i < (size_t(1) << k); ++i)
+	      fresh[i] = 0;
+	    if (_blocks[k].compare_exchange_strong(block, fresh))
+	      block = fresh;
+	    else
+	      delete[] fresh;
+	  }
+	return block[n + 1 - (size_t(1) << k)];
+      }
+
+      std::atomic<size_t> _cellTransitions;
+      std::atomic<size_t> _neighbourQueries;
+      std::atomic<size_t> _neighboursReturned;
+      std::atomic<size_t> _maxNeighbours;
+      std::array<std::atomic<std::atomic<size_t>*>, 64> _blocks;
+    };
+
+    mutable AtomicStatistics _stats;
+
+    void countNeighbourQuery(const size_t neighbours) const
+    { _stats.countQuery(neighbours); }
+
+    void countCellTransition() const
+    { _stats.countCellTransition(); }
 
     GNeighbourList(const GNeighbourList&);
 
@@ -27,25 +27,56 @@
 #include <magnet/xmlwriter.hpp>
 #include <magnet/xmlreader.hpp>
 #include <magnet/exception.hpp>
-#include <fstream>
+#include <magnet/timer.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <memory>
 #include <cstdio>
 #include <set>
 #include <algorithm>
 
 namespace dynamo {
-  void 
-  GVolumetricPotential::initialise(size_t id) {
-    Global::initialise(id);
-    GNeighbourList::reinitialise();      
-
+  void
+  GVolumetricPotential::reinitialise()
+  {
     for (size_t iDim = 0; iDim < NDIM; iDim++)
-      _cellLatticeWidth[iDim] = Sim->primaryCellSize[iDim] / _ordering.getDimensions()[iDim];
-    _cellDimension = _cellLatticeWidth;
-    _cellOffset = Vector{0,0,0};
+      _voxelWidth[iDim] = Sim->primaryCellSize[iDim] / _voxelOrdering.getDimensions()[iDim];
+
+    //The voxels must be known before the neighbour list signals the
+    //reinitialisation, as the events are then recalculated
+    Sim->dynamics->updateAllParticles();
+    _particleVoxel.assign(Sim->N(), 0);
+    for (const size_t& pid : *range)
+      _particleVoxel[pid] = _voxelOrdering.toIndex(getVoxelCoords(Sim->particles[pid].getPosition()));
 
-    buildCells();
+    GCells::reinitialise();
   }
 
+  Event
+  GVolumetricPotential::getEvent(const Particle& part) const
+  {
+    Event event = GCells::getEvent(part);
+    const double voxelDt = Sim->dynamics->getSquareCellCollision2(part, calcVoxelPosition(_particleVoxel[part.getID()], part), _voxelWidth) - Sim->dynamics->getParticleDelay(part);
+    event._dt = std::min(event._dt, voxelDt);
+    return event;
+  }
+
+  void
+  GVolumetricPotential::getEvents(const std::vector<size_t>& ids, std::vector<Event>& events) const
+  {
+    GCells::getEvents(ids, events);
+
+    std::vector<Vector> origins;
+    origins.reserve(ids.size());
+    for (const size_t id : ids)
+      origins.push_back(calcVoxelPosition(_particleVoxel[id], Sim->particles[id]));
+
+    std::vector<double> times;
+    Sim->dynamics->getSquareCellCollisionTimes(ids, origins, _voxelWidth, times);
+
+    for (size_t i(0); i < ids.size(); ++i)
+      events[i]._dt = std::min(events[i]._dt, times[i] - Sim->dynamics->getParticleDelay(Sim->particles[ids[i]]));
+  }
   
   void 
   GVolumetricPotential::runEvent(Particle& part, const double dt)  {
@@ -54,9 +85,21 @@ namespace dynamo {
     //expect the particle to be up to date.
     Sim->dynamics->updateParticle(part);
 
-    const size_t oldCellIndex = _cellData.getCellID(part.getID());
-    const int cellDirectionInt(Sim->dynamics->getSquareCellCollision3(part, calcPosition(oldCellIndex, part), _cellDimension));
-    const size_t cellDirection = abs(cellDirectionInt) - 1;
+    const size_t oldVoxelIndex = _particleVoxel[part.getID()];
+    const Vector voxelOrigin = calcVoxelPosition(oldVoxelIndex, part);
+
+    //Neighbour list cell transitions are handled by GCells
+    if (Sim->dynamics->getSquareCellCollision2(part, calcPosition(_cellData.getCellID(part.getID()), part), _cellDimension)
+	< Sim->dynamics->getSquareCellCollision2(part, voxelOrigin, _voxelWidth))
+      {
+	GCells::runEvent(part, dt);
+	return;
+      }
+
+    countCellTransition();
+
+    const int voxelDirectionInt(Sim->dynamics->getSquareCellCollision3(part, voxelOrigin, _voxelWidth));
+    const size_t voxelDirection = abs(voxelDirectionInt) - 1;
 
     Event iEvent = getEvent(part);
 
@@ -70,16 +113,14 @@ namespace dynamo {
     Sim->ptrScheduler->stream(iEvent._dt);
     Sim->stream(iEvent._dt);
 
-    //Calculate which cell the particle might end up in
-    const auto oldCellCoord = _ordering.toCoord(oldCellIndex);
-    auto newCellCoord = oldCellCoord;
-    newCellCoord[cellDirection] += _ordering.getDimensions()[cellDirection] + ((cellDirectionInt > 0) ? 1 : -1);
-    newCellCoord[cellDirection] %= _ordering.getDimensions()[cellDirection];
-    const size_t newCellIndex = _ordering.toIndex(newCellCoord);
-
+    //Calculate which voxel the particle might end up in
+    const auto oldVoxelCoord = _voxelOrdering.toCoord(oldVoxelIndex);
+    auto newVoxelCoord = oldVoxelCoord;
+    newVoxelCoord[voxelDirection] += _voxelOrdering.getDimensions()[voxelDirection] + ((voxelDirectionInt > 0) ? 1 : -1);
+    newVoxelCoord[voxelDirection] %= _voxelOrdering.getDimensions()[voxelDirection];
 
     Vector vNorm{0,0,0};
-    vNorm[cellDirection] = (cellDirectionInt > 0) ? -1 : 1;
+    vNorm[voxelDirection] = (voxelDirectionInt > 0) ? -1 : 1;
 
     NEventData EDat;
 
@@ -87,13 +128,13 @@ namespace dynamo {
     Sim->dynamics->updateParticle(part);    
     Vector pos(part.getPosition()), vel(part.getVelocity());
     Sim->BCs->applyBC(pos, vel);
-    double potEnergyChange = 0.5 * (double(_volumeData[newCellIndex]) - double(_volumeData[oldCellIndex]));
-    double arg =  vel[cellDirection] * vel[cellDirection] - 2 * potEnergyChange / Sim->species(part)->getMass(part);
+    double potEnergyChange = 0.5 * (double(_volumeData(newVoxelCoord)) - double(_volumeData(oldVoxelCoord)));
+    double arg =  vel[voxelDirection] * vel[voxelDirection] - 2 * potEnergyChange / Sim->species(part)->getMass(part);
     if (arg > 0)
       {
 	EDat = ParticleEventData(part, *Sim->species(part), WALL);
-	part.getVelocity()[cellDirection] *= std::sqrt(arg) / std::abs(part.getVelocity()[cellDirection]);
-	_cellData.moveTo(oldCellIndex, newCellIndex, part.getID());
+	part.getVelocity()[voxelDirection] *= std::sqrt(arg) / std::abs(part.getVelocity()[voxelDirection]);
+	_particleVoxel[part.getID()] = _voxelOrdering.toIndex(newVoxelCoord);
       }
     else
       EDat = Sim->dynamics->runPlaneEvent(part, vNorm, 1.0, 0.0);
@@ -105,6 +146,37 @@ namespace dynamo {
       Ptr->eventUpdate(iEvent, EDat);
   }
 
+  std::array<size_t, 3>
+  GVolumetricPotential::getVoxelCoords(Vector pos) const
+  {
+    Sim->BCs->applyBC(pos);
+
+    std::array<size_t, 3> retval;
+    for (size_t iDim = 0; iDim < NDIM; iDim++)
+      {
+	long coord = std::floor(pos[iDim] / _voxelWidth[iDim] + 0.5 * _voxelOrdering.getDimensions()[iDim]);
+	coord %= long(_voxelOrdering.getDimensions()[iDim]);
+	if (coord < 0) coord += _voxelOrdering.getDimensions()[iDim];
+	retval[iDim] = coord;
+      }
+
+    return retval;
+  }
+
+  Vector
+  GVolumetricPotential::calcVoxelPosition(const size_t voxelIndex, const Particle& part) const
+  {
+    const auto coords = _voxelOrdering.toCoord(voxelIndex);
+    Vector origin;
+    for (size_t i(0); i < NDIM; ++i)
+      {
+	origin[i] = coords[i] * _voxelWidth[i] - 0.5 * Sim->primaryCellSize[i];
+	origin[i] -= Sim->primaryCellSize[i] * lrint((origin[i] - part.getPosition()[i]) / Sim->primaryCellSize[i]);
+      }
+
+    return origin;
+  }
+
   void 
   GVolumetricPotential::outputXML(magnet::xml::XmlStream& XML) const {
     XML << magnet::xml::tag("Global")
@@ -125,11 +197,11 @@ namespace dynamo {
 	  << magnet::xml::attr("z") << _offset[2]
 	  << magnet::xml::endtag("Offset");      
 
-    if (_ordering.getDimensions() != _imageDimensions)
+    if (_voxelOrdering.getDimensions() != _imageDimensions)
       XML << magnet::xml::tag("SampleDimensions")
-	  << magnet::xml::attr("x") << _ordering.getDimensions()[0]
-	  << magnet::xml::attr("y") << _ordering.getDimensions()[1]
-	  << magnet::xml::attr("z") << _ordering.getDimensions()[2]
+	  << magnet::xml::attr("x") << _voxelOrdering.getDimensions()[0]
+	  << magnet::xml::attr("y") << _voxelOrdering.getDimensions()[1]
+	  << magnet::xml::attr("z") << _voxelOrdering.getDimensions()[2]
 	  << magnet::xml::endtag("SampleDimensions");
     
     XML << magnet::xml::endtag("Global");
@@ -161,38 +233,40 @@ namespace dynamo {
 	sampleDimensions = std::array<size_t, 3>{{XMLdim.getAttribute("x").as<size_t>(), XMLdim.getAttribute("y").as<size_t>(), XMLdim.getAttribute("z").as<size_t>()}};
       }
 
+    if (_sampleBytes != 1)
+      M_throw() << "Do not have an optimised loader for resampling data yet";
+
+    for (size_t iDim(0); iDim < NDIM; ++iDim)
+      if (_offset[iDim] + sampleDimensions[iDim] > _imageDimensions[iDim])
+	M_throw() << "The sampled region of " << _fileName << " lies outside the image dimensions";
+
     Ordering fileOrdering(_imageDimensions);
-    std::vector<unsigned char> fileData(fileOrdering.size() * _sampleBytes);
-    dout << "Opening " << _fileName << std::endl;
-    std::ifstream file(_fileName.c_str(), std::ifstream::binary);
-
-    if (!file.good())
-      M_throw() << "Failed open the file " << _fileName;
-    dout << "Reading " << fileOrdering.size() * _sampleBytes << " bytes of data into memory" <<  std::endl;
-    file.read(reinterpret_cast<char*>(fileData.data()), fileOrdering.size() * _sampleBytes);
-    
-    if (!file)
-      M_throw() << "Failed reading volumetric data (read " << file.gcount() << " bytes of an expected " << fileOrdering.size() * _sampleBytes << "  from " << _fileName << ")";
-    file.close();
+    const size_t fileBytes = fileOrdering.size() * _sampleBytes;
+    dout << "Mapping " << _fileName << std::endl;
+    std::unique_ptr<boost::interprocess::file_mapping> mapping;
+    std::unique_ptr<boost::interprocess::mapped_region> region;
+    try {
+      mapping.reset(new boost::interprocess::file_mapping(_fileName.c_str(), boost::interprocess::read_only));
+      region.reset(new boost::interprocess::mapped_region(*mapping, boost::interprocess::read_only));
+    } catch (boost::interprocess::interprocess_exception& e) {
+      M_throw() << "Failed to map the file " << _fileName << " (" << e.what() << ")";
+    }
 
-    _ordering = Ordering(sampleDimensions);
-    _volumeData.resize(_ordering.size());
+    if (region->get_size() < fileBytes)
+      M_throw() << "Failed reading volumetric data (found " << region->get_size() << " bytes of an expected " << fileBytes << "  in " << _fileName << ")";
 
-    dout << "Resampling " << _ordering.size() << " bytes of data from the file into the simulation" <<  std::endl;
-    if (_sampleBytes == 1)
-      {
-	if (sampleDimensions == _imageDimensions)
-	  std::swap(_volumeData, fileData);
-	else
-	  for (size_t z = 0; z < sampleDimensions[2]; ++z)
-	    for (size_t y = 0; y < sampleDimensions[1]; ++y)
-	      {
-		size_t startindex = fileOrdering.toIndex(std::array<size_t, 3>{{_offset[0], y + _offset[1], z + _offset[2]}});
-		std::copy(fileData.begin() + startindex, fileData.begin() + startindex + sampleDimensions[0], _volumeData.begin() + _ordering.toIndex(std::array<size_t, 3>{{0, y, z}}));
-	      }
-      }
-    else
-      M_throw() << "Do not have an optimised loader for resampling data yet";
+    _voxelOrdering = Ordering(sampleDimensions);
+
+    dout << "Compressing " << _voxelOrdering.size() << " bytes of data from the file into the simulation" <<  std::endl;
+    const unsigned char* fileData = static_cast<const unsigned char*>(region->get_address());
+    magnet::Timer timer;
+    _volumeData.build(sampleDimensions, [&](const std::array<size_t, 3>& coord) {
+	return fileData[fileOrdering.toIndex(std::array<size_t, 3>{{coord[0] + _offset[0], coord[1] + _offset[1], coord[2] + _offset[2]}})];
+      });
+    
+    dout << "Compressed " << _voxelOrdering.size() << " bytes into " << _volumeData.memoryUsage() << " bytes ("
+	 << _volumeData.uniformBricks() << " of " << _volumeData.bricks() << " bricks uniform) in "
+	 << timer.duration<std::milli>() << "ms" << std::endl;
     dout << "Loading complete" <<  std::endl;
   }
 
@@ -214,7 +288,7 @@ namespace dynamo {
     if (!_renderObj)
       M_throw() << "Initialising before the render object has been created";
 
-    context->queueTask(std::bind(&coil::RVolume::loadData, _renderObj.get(), _volumeData, _ordering.getDimensions(), Vector{Sim->primaryCellSize / Sim->units.unitLength()}));
+    context->queueTask(std::bind(&coil::RVolume::loadData, _renderObj.get(), _volumeData.dense(), _voxelOrdering.getDimensions(), Vector{Sim->primaryCellSize / Sim->units.unitLength()}));
   }
 
   void
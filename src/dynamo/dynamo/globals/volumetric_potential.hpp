@@ -20,6 +20,7 @@
 #include <dynamo/particle.hpp>
 #include <dynamo/coilRenderObj.hpp>
 #include <magnet/containers/ordering.hpp>
+#include <magnet/containers/bricked_volume.hpp>
 #ifdef DYNAMO_visualizer
 # include <coil/RenderObj/Volume.hpp>
 #endif 
@@ -29,6 +30,17 @@
 
 namespace dynamo {
   /*! \brief An implementation of volumetric potentials.
+
+    The raw volume file is memory mapped and compressed into a
+    magnet::containers::BrickedVolume as it is loaded, so large
+    segmented images which are mostly solid or empty can be used. The
+    potential lookup for each voxel transition remains O(1).
+
+    The cells of the neighbour list are sized by the interactions as
+    in GCells, and not by the voxels, so the memory used does not
+    scale with the size of the image. Instead, the voxel of each
+    particle is tracked separately and the next event of a particle
+    is the earliest of its cell and voxel transitions.
    */
   class GVolumetricPotential: public GCells, public CoilRenderObj
   {
@@ -38,9 +50,13 @@ namespace dynamo {
       GCells(ptrSim, "VolumetricPotential")
     { operator<<(XML); }
     
+    virtual Event getEvent(const Particle&) const;
+
+    virtual void getEvents(const std::vector<size_t>&, std::vector<Event>&) const;
+
     virtual void runEvent(Particle& p, const double dt);
 
-    virtual void initialise(size_t id);
+    virtual void reinitialise();
 
     virtual void operator<<(const magnet::xml::Node&);
 
@@ -53,13 +69,22 @@ namespace dynamo {
   protected:
     virtual void outputXML(magnet::xml::XmlStream&) const;
 
+    std::array<size_t, 3> getVoxelCoords(Vector) const;
+
+    //! The origin of the periodic image of the voxel nearest the particle.
+    Vector calcVoxelPosition(const size_t voxelIndex, const Particle& part) const;
+
 #ifdef DYNAMO_visualizer
     mutable shared_ptr<coil::RVolume> _renderObj;
 #endif
 
     std::string _fileName;
     size_t _sampleBytes;
-    std::vector<unsigned char> _volumeData;
+    magnet::containers::BrickedVolume<unsigned char> _volumeData;
+    Ordering _voxelOrdering;
+    Vector _voxelWidth;
+    //! The voxel index of each particle, by particle ID.
+    std::vector<size_t> _particleVoxel;
     std::array<size_t, 3> _imageDimensions;
     std::array<size_t, 3> _offset;
   };
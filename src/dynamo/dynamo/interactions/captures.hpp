@@ -27,6 +27,8 @@
 #endif
 #include <map>
 #include <unordered_set>
+#include <algorithm>
+#include <vector>
 
 namespace dynamo { 
   namespace detail { 
@@ -69,23 +71,33 @@ namespace std
 
 namespace dynamo {
   namespace detail {
-    namespace {
-      ::std::size_t
-      hash_combine(const ::std::size_t hash1, const ::std::size_t hash2)
-      {
-	return hash1 ^ (hash2 + 0x9e3779b9 + (hash1 << 6) + (hash1 >> 2));
-      }
+    /*! \brief The Zobrist key of a captured pair in a given state.
+
+      The hash of a CaptureMap is the XOR of the keys of all of its
+      entries, so it can be updated in O(1) as entries change. The
+      keys are generated by a splitmix64 mix of the pair and state
+      rather than drawn from a table, so they are identical in every
+      process and need no storage. The key of the uncaptured state (0)
+      is zero, so missing entries do not contribute to the hash.
+    */
+    inline uint64_t zobristKey(const PairKey& key, const size_t state)
+    {
+      if (!state) return 0;
+      uint64_t z = uint64_t(key) + 0x9e3779b97f4a7c15ULL * (state + 1);
+      z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+      z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+      return z ^ (z >> 31);
     }
-    
+
     /*!\brief This is a container that stores a single size_t
       identified by a pair of particles.
        
       To efficiently store the state of all possible particle
       pairings, a map is used and entries are only stored if the
-      state is non-zero. Although an unordered_map may be slightly
-      faster, a map is used to allow comparison of CaptureMaps and a
-      rapid hashing if CaptureMaps are to be used as an index of the
-      simulation state.
+      state is non-zero. An incrementally updated Zobrist hash of the
+      contents is maintained (see \ref zobristKey), allowing
+      CaptureMaps to be used as a rapid index of the simulation
+      state.
        
       To facilitate the storage only if non-zero behaviour, the array
       access operator is overloaded to automatically return a size_t
@@ -102,29 +114,36 @@ namespace dynamo {
     {
       typedef CaptureMapContainer Container;
     public:
+      CaptureMap(): _hash(0) {}
+
       /*!\brief This proxy is used to double check if an assignment of
 	zero is done, and delete the entry if it is. */
       struct EntryProxy {
       public:
-	EntryProxy(Container& container, const PairKey& key):
-	  _container(container), _key(key) {}
+	EntryProxy(CaptureMap& map, const PairKey& key):
+	  _map(map), _key(key) {}
 
 	operator const size_t() const {
-	  const auto it (_container.find(_key));
-	  return (it == _container.end()) ? 0 : (it->second);
+	  const auto it (_map.Container::find(_key));
+	  return (it == _map.Container::end()) ? 0 : (it->second);
 	}
 	
 	EntryProxy& operator=(size_t newval) {
+	  const size_t oldval = *this;
+	  if (oldval == newval) return *this;
+
+	  _map._hash ^= zobristKey(_key, oldval) ^ zobristKey(_key, newval);
+
 	  if (newval == 0)
-	    _container.erase(_key);
+	    _map.Container::erase(_key);
 	  else
-	    _container[_key] = newval;
+	    _map.Container::operator[](_key) = newval;
 
 	  return *this;
 	}
 	
       private:
-	Container& _container;
+	CaptureMap& _map;
 	const PairKey _key;
       };
       
@@ -140,20 +159,42 @@ namespace dynamo {
 	Container::const_iterator it = Container::find(key);
 	return (it == Container::end()) ? 0 : (it->second);
       }
+
+      void clear() { Container::clear(); _hash = 0; }
+
+      //! \brief The Zobrist hash of the current contents of the map.
+      std::size_t hash() const { return _hash; }
+
+    private:
+      std::size_t _hash;
     };
 
-    struct CaptureMapKey: public std::vector<CaptureMap::value_type>
+    /*! \brief A compact, sorted copy of a CaptureMap.
+
+      This stores the entries of a CaptureMap in ascending order of
+      the pairs, so equal maps always give equal keys regardless of
+      the iteration order of the source container. The Zobrist hash
+      of the source map is cached.
+     */
+    struct CaptureMapKey: public std::vector<std::pair<PairKey, size_t> >
     {
-      typedef std::vector<CaptureMap::value_type> Container;
+      typedef std::vector<std::pair<PairKey, size_t> > Container;
       CaptureMapKey(const CaptureMap& map):
-      Container(map.begin(), map.end()) {}
+	Container(map.begin(), map.end()), _hash(map.hash())
+      {
+	std::sort(Container::begin(), Container::end(),
+		  [](const Container::value_type& a, const Container::value_type& b)
+		  { return uint64_t(a.first) < uint64_t(b.first); });
+      }
 
-      std::size_t hash() const {
-	std::size_t hash(0);
-	for (const Container::value_type& val : *this)
-	  hash = hash_combine(hash, hash_combine(size_t(val.first), size_t(val.second)));
-	return hash;
+      std::size_t hash() const { return _hash; }
+
+      bool operator==(const CaptureMapKey& o) const {
+	return (_hash == o._hash) && (static_cast<const Container&>(*this) == o);
       }
+
+    private:
+      std::size_t _hash;
     };
 
     /*! \brief A functor to allow the storage of CaptureMapKey types
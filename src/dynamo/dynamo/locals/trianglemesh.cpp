@@ -16,21 +16,183 @@
 */
 
 #include <dynamo/locals/trianglemesh.hpp>
-#include <dynamo/BC/BC.hpp>
-#include <dynamo/dynamics/dynamics.hpp>
+#include <dynamo/BC/None.hpp>
+#include <dynamo/dynamics/gravity.hpp>
+#include <dynamo/dynamics/viscous.hpp>
 #include <dynamo/NparticleEventData.hpp>
 #include <dynamo/units/units.hpp>
 #include <dynamo/schedulers/scheduler.hpp>
 #include <dynamo/outputplugins/outputplugin.hpp>
+#include <magnet/intersection/ray_AABB.hpp>
+#include <magnet/containers/stack_vector.hpp>
+#include <algorithm>
 
 
 namespace dynamo {
   LTriangleMesh::LTriangleMesh(const magnet::xml::Node& XML, dynamo::Simulation* tmp):
-    Local(tmp, "LocalWall")
+    Local(tmp, "LocalWall"),
+    _useBVH(false)
   { operator<<(XML); }
 
+  void
+  LTriangleMesh::initialise(size_t nID)
+  {
+    Local::initialise(nID);
+
+    //The hierarchy is traversed along straight line trajectories, so
+    //it can only be used if the particles follow rays and the mesh
+    //is not periodically imaged.
+    _useBVH = std::dynamic_pointer_cast<DynNewtonian>(Sim->dynamics)
+      && !std::dynamic_pointer_cast<DynGravity>(Sim->dynamics)
+      && !std::dynamic_pointer_cast<DynViscous>(Sim->dynamics)
+      && std::dynamic_pointer_cast<BCNone>(Sim->BCs);
+
+    buildBVH();
+  }
+
+  void
+  LTriangleMesh::buildBVH()
+  {
+    _bvh.clear();
+    _bvhTriangles.resize(_elements.size());
+    for (size_t id(0); id < _elements.size(); ++id)
+      _bvhTriangles[id] = id;
+
+    if (_elements.empty()) return;
+
+    std::vector<Vector> centroids;
+    centroids.reserve(_elements.size());
+    for (const TriangleElements& elem : _elements)
+      centroids.push_back((_vertices[std::get<0>(elem)] + _vertices[std::get<1>(elem)] + _vertices[std::get<2>(elem)]) / 3);
+
+    _bvh.reserve(2 * _elements.size());
+    buildBVHNode(0, _elements.size(), centroids);
+
+    //The node bounds are expanded by this margin when traversed, to
+    //make sure round-off never culls a triangle the brute force
+    //search would have found.
+    _bvhMargin = 1e-8 * std::max(1.0, (_bvh[0]._max - _bvh[0]._min).nrm());
+  }
+
+  size_t
+  LTriangleMesh::buildBVHNode(size_t start, size_t end, const std::vector<Vector>& centroids)
+  {
+    const size_t nodeID = _bvh.size();
+    _bvh.push_back(BVHNode());
+
+    Vector min = Vector{+HUGE_VAL, +HUGE_VAL, +HUGE_VAL};
+    Vector max = Vector{-HUGE_VAL, -HUGE_VAL, -HUGE_VAL};
+    Vector cmin = min, cmax = max;
+    for (size_t i(start); i < end; ++i)
+      {
+	const TriangleElements& elem = _elements[_bvhTriangles[i]];
+	for (const size_t vertex : {std::get<0>(elem), std::get<1>(elem), std::get<2>(elem)})
+	  for (size_t iDim(0); iDim < NDIM; ++iDim)
+	    {
+	      min[iDim] = std::min(min[iDim], _vertices[vertex][iDim]);
+	      max[iDim] = std::max(max[iDim], _vertices[vertex][iDim]);
+	    }
+
+	const Vector& centroid = centroids[_bvhTriangles[i]];
+	for (size_t iDim(0); iDim < NDIM; ++iDim)
+	  {
+	    cmin[iDim] = std::min(cmin[iDim], centroid[iDim]);
+	    cmax[iDim] = std::max(cmax[iDim], centroid[iDim]);
+	  }
+      }
+
+    _bvh[nodeID]._min = min;
+    _bvh[nodeID]._max = max;
+
+    //Split the triangles at the median centroid along the longest
+    //axis of the centroid bounds.
+    const size_t maxLeafSize = 4;
+    const Vector extent = cmax - cmin;
+    size_t axis = 0;
+    for (size_t iDim(1); iDim < NDIM; ++iDim)
+      if (extent[iDim] > extent[axis]) axis = iDim;
+
+    if ((end - start <= maxLeafSize) || (extent[axis] == 0))
+      {
+	_bvh[nodeID]._start = start;
+	_bvh[nodeID]._count = end - start;
+	return nodeID;
+      }
+
+    const size_t mid = start + (end - start) / 2;
+    std::nth_element(_bvhTriangles.begin() + start, _bvhTriangles.begin() + mid, _bvhTriangles.begin() + end,
+		     [&](const size_t a, const size_t b) { return centroids[a][axis] < centroids[b][axis]; });
+
+    buildBVHNode(start, mid, centroids);
+    const size_t right = buildBVHNode(mid, end, centroids);
+    _bvh[nodeID]._start = right;
+    _bvh[nodeID]._count = 0;
+    return nodeID;
+  }
+
   Event 
   LTriangleMesh::getEvent(const Particle& part) const
+  {
+    if (!_useBVH || _bvh.empty())
+      return getEventBruteForce(part);
+
+#ifdef ISSS_DEBUG
+    if (!Sim->dynamics->isUpToDate(part))
+      M_throw() << "Particle is not up to date";
+#endif
+
+    size_t triangleid = 0; //The id of the triangle for which the event is for
+    double diam = 0.5 * _diameter->getProperty(part);
+    const Vector expansion = Vector{1, 1, 1} * (diam + _bvhMargin);
+    const Vector& pos = part.getPosition();
+    const Vector& vel = part.getVelocity();
+
+    std::pair<double, size_t> tmin(std::numeric_limits<float>::infinity(), 0); //Default to no collision
+
+    //Depth-first traversal, visiting the nearest child first and
+    //culling any node the trajectory enters after the current
+    //earliest event. Ties are resolved exactly as in the brute force
+    //search (earliest time, then triangle part, then triangle id).
+    magnet::containers::StackVector<size_t, 64> stack;
+    stack.push_back(0);
+    while (!stack.empty())
+      {
+	const BVHNode& node = _bvh[stack.pop_back()];
+	const double t_node = magnet::intersection::ray_AABB(pos, vel, node._min - expansion, node._max + expansion);
+	if ((t_node == HUGE_VAL) || (t_node > tmin.first))
+	  continue;
+
+	if (node._count)
+	  {
+	    for (size_t i(node._start); i < node._start + node._count; ++i)
+	      {
+		const size_t id = _bvhTriangles[i];
+		std::pair<double, size_t> t 
+		  = Sim->dynamics->getSphereTriangleEvent(part,
+							  _vertices[std::get<0>(_elements[id])],
+							  _vertices[std::get<1>(_elements[id])],
+							  _vertices[std::get<2>(_elements[id])],
+							  diam);
+		if ((t < tmin) || ((t == tmin) && (id < triangleid))) { tmin = t; triangleid = id; }
+	      }
+	    continue;
+	  }
+
+	const size_t left = &node - &_bvh[0] + 1;
+	const size_t right = node._start;
+	const double t_left = magnet::intersection::ray_AABB(pos, vel, _bvh[left]._min - expansion, _bvh[left]._max + expansion);
+	const double t_right = magnet::intersection::ray_AABB(pos, vel, _bvh[right]._min - expansion, _bvh[right]._max + expansion);
+	if (t_left <= t_right)
+	  { stack.push_back(right); stack.push_back(left); }
+	else
+	  { stack.push_back(left); stack.push_back(right); }
+      }
+
+    return Event(part, tmin.first, LOCAL, WALL, ID, 8 * triangleid + tmin.second);
+  }
+
+  Event 
+  LTriangleMesh::getEventBruteForce(const Particle& part) const
   {
 #ifdef ISSS_DEBUG
     if (!Sim->dynamics->isUpToDate(part))
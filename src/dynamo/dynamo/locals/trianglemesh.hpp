@@ -30,19 +30,42 @@ namespace dynamo {
   class LTriangleMesh: public Local, public CoilRenderObj
   {
   public:
+    typedef std::tuple<size_t, size_t, size_t> TriangleElements;
+
     LTriangleMesh(const magnet::xml::Node&, dynamo::Simulation*);
 
     template<class T1, class T2>
-    LTriangleMesh(dynamo::Simulation* nSim, T1 e, T2 d, std::string name, IDRange* nRange):
+    LTriangleMesh(dynamo::Simulation* nSim, T1 e, T2 d, std::string name, IDRange* nRange, 
+		  const std::vector<Vector>& vertices = std::vector<Vector>(), 
+		  const std::vector<TriangleElements>& elements = std::vector<TriangleElements>()):
       Local(nRange, nSim, "LocalWall"),
+      _vertices(vertices),
+      _elements(elements),
       _e(Sim->_properties.getProperty(e, Property::Units::Dimensionless())),
-      _diameter(Sim->_properties.getProperty(d, Property::Units::Length()))
+      _diameter(Sim->_properties.getProperty(d, Property::Units::Length())),
+      _useBVH(false)
     { localName = name; }
 
     virtual ~LTriangleMesh() {}
 
+    virtual void initialise(size_t nID);
+
     virtual Event getEvent(const Particle&) const;
 
+    /*! \brief Determine the next event by testing every triangle of
+      the mesh.
+
+      This is the reference search which \ref getEvent falls back to
+      if the bounding volume hierarchy cannot be used for the current
+      dynamics or boundary conditions.
+    */
+    Event getEventBruteForce(const Particle&) const;
+
+    /*! \brief Returns true if \ref getEvent uses the bounding volume
+      hierarchy to search the mesh.
+    */
+    bool usingBVH() const { return _useBVH; }
+
     virtual ParticleEventData runEvent(Particle&, const Event&) const;
   
     virtual void operator<<(const magnet::xml::Node&);
@@ -62,11 +85,33 @@ namespace dynamo {
     virtual void outputXML(magnet::xml::XmlStream&) const;
 
     std::vector<Vector> _vertices;
-
-    typedef std::tuple<size_t, size_t, size_t> TriangleElements;
     std::vector<TriangleElements> _elements;
 
     shared_ptr<Property> _e;
     shared_ptr<Property> _diameter;
+
+    /*! \brief A node of the bounding volume hierarchy over the
+      triangles of the mesh.
+
+      Leaf nodes (_count != 0) hold the triangles
+      _bvhTriangles[_start, _start + _count). Internal nodes store
+      their first child directly after themselves in \ref _bvh, and
+      their second child at the index _start.
+     */
+    struct BVHNode
+    {
+      Vector _min;
+      Vector _max;
+      size_t _start;
+      size_t _count;
+    };
+
+    void buildBVH();
+    size_t buildBVHNode(size_t start, size_t end, const std::vector<Vector>& centroids);
+
+    std::vector<BVHNode> _bvh;
+    std::vector<size_t> _bvhTriangles;
+    double _bvhMargin;
+    bool _useBVH;
   };
 }
@@ -20,6 +20,7 @@
 #include <dynamo/include.hpp>
 #include <dynamo/interactions/include.hpp>
 #include <magnet/xmlwriter.hpp>
+#include <algorithm>
 
 namespace dynamo {
   OPCollMatrix::OPCollMatrix(const dynamo::Simulation* tmp, const magnet::xml::Node&):
@@ -31,7 +32,7 @@ namespace dynamo {
   void 
   OPCollMatrix::initialise()
   {
-    lastEvent.resize(Sim->N(), lastEventData(Sim->systemTime, eventKey(classKey(0, NOSOURCE), NONE)));
+    lastEvent.resize(Sim->N(), lastEventData(Sim->systemTime, EventKeyIndex::npos));
   }
 
   OPCollMatrix::~OPCollMatrix()
@@ -53,19 +54,30 @@ namespace dynamo {
   void 
   OPCollMatrix::newEvent(const size_t& part, const EEventType& etype, const classKey& ck)
   {
-    if (lastEvent[part].second.first.second != NOSOURCE)
+    const size_t eventID = eventIndex(ck, etype);
+    if (eventID == counters.size())
       {
-	counterData& refCount = counters[counterKey(eventKey(ck,etype), lastEvent[part].second)];
-      
-	refCount.totalTime += Sim->systemTime - lastEvent[part].first;
+	counters.resize(eventID + 1);
+	initialCounter.resize(eventID + 1, 0);
+      }
+
+    lastEventData& last = lastEvent[part];
+    if (last.second != EventKeyIndex::npos)
+      {
+	std::vector<counterData>& row = counters[eventID];
+	if (last.second >= row.size())
+	  row.resize(eventIndex.size());
+
+	counterData& refCount = row[last.second];
+	refCount.totalTime += Sim->systemTime - last.first;
 	++(refCount.count);
 	++(totalCount);
       }
     else
-      ++initialCounter[eventKey(ck,etype)];
+      ++initialCounter[eventID];
 
-    lastEvent[part].first = Sim->systemTime;
-    lastEvent[part].second = eventKey(ck, etype);
+    last.first = Sim->systemTime;
+    last.second = eventID;
   }
 
   void
@@ -75,56 +87,68 @@ namespace dynamo {
     XML << magnet::xml::tag("CollCounters") 
 	<< magnet::xml::tag("TransitionMatrix");
   
-    std::map<eventKey, std::pair<size_t, double> > totmap;
-  
-    typedef std::pair<const counterKey, counterData> locPair;
-  
-  
     size_t initialsum(0);
+    for (const size_t& n : initialCounter)
+      initialsum += n;
+
+    //Collect the transitions that occurred, sorted by their event keys
+    typedef std::pair<size_t, size_t> transition;
+    std::vector<transition> transitions;
+    for (size_t id(0); id < counters.size(); ++id)
+      for (size_t lastID(0); lastID < counters[id].size(); ++lastID)
+	if (counters[id][lastID].count)
+	  transitions.push_back(transition(id, lastID));
+
+    std::sort(transitions.begin(), transitions.end(), 
+	      [&](const transition& a, const transition& b) 
+	      { 
+		return std::make_pair(eventIndex.key(a.first), eventIndex.key(a.second))
+		  < std::make_pair(eventIndex.key(b.first), eventIndex.key(b.second));
+	      });
   
-    typedef std::pair<eventKey,size_t> npair;
-    for (const npair& n : initialCounter)
-      initialsum += n.second;
-  
-    for (const locPair& ele : counters)
+    std::vector<size_t> totals(counters.size(), 0);
+    std::vector<size_t> totalsOrder;
+    for (const transition& ele : transitions)
       {
+	const eventKey& event = eventIndex.key(ele.first);
+	const eventKey& prior = eventIndex.key(ele.second);
+	const counterData& data = counters[ele.first][ele.second];
 	XML << magnet::xml::tag("Count")
-	    << magnet::xml::attr("Event") << ele.first.first.second
-	    << magnet::xml::attr("Name") << getName(ele.first.first.first, Sim)
-	    << magnet::xml::attr("lastEvent") << ele.first.second.second
-	    << magnet::xml::attr("lastName") << getName(ele.first.second.first, Sim)
-	    << magnet::xml::attr("Percent") << 100.0 * ((double) ele.second.count) 
+	    << magnet::xml::attr("Event") << event.second
+	    << magnet::xml::attr("Name") << getName(event.first, Sim)
+	    << magnet::xml::attr("lastEvent") << prior.second
+	    << magnet::xml::attr("lastName") << getName(prior.first, Sim)
+	    << magnet::xml::attr("Percent") << 100.0 * ((double) data.count) 
 	  / ((double) totalCount)
-	    << magnet::xml::attr("mft") << ele.second.totalTime
-	  / (Sim->units.unitTime() * ((double) ele.second.count))
+	    << magnet::xml::attr("mft") << data.totalTime
+	  / (Sim->units.unitTime() * ((double) data.count))
 	    << magnet::xml::endtag("Count");
       
 	//Add the total count
-	totmap[ele.first.first].first += ele.second.count;
-      
-	//Add the rate
-	totmap[ele.first.first].second += ((double) ele.second.count) 
-	  / ele.second.totalTime;
+	if (!totals[ele.first])
+	  totalsOrder.push_back(ele.first);
+	totals[ele.first] += data.count;
       }
   
     XML << magnet::xml::endtag("TransitionMatrix")
 	<< magnet::xml::tag("Totals");
   
-    typedef std::pair<eventKey, std::pair<size_t, double> > mappair;
-  
-    for (const mappair& mp1 : totmap)
-      XML << magnet::xml::tag("TotCount")
-	  << magnet::xml::attr("Name") << getName(mp1.first.first, Sim)
-	  << magnet::xml::attr("Event") << mp1.first.second
-	  << magnet::xml::attr("Percent") 
-	  << 100.0 * (((double) mp1.second.first)
-		      +((double) initialCounter[mp1.first]))
-      / (((double) totalCount) + ((double) initialsum))
-	  << magnet::xml::attr("Count") << mp1.second.first + initialCounter[mp1.first]
-	  << magnet::xml::attr("EventMeanFreeTime")
-	  << Sim->systemTime / ((mp1.second.first + initialCounter[mp1.first])
-			      * Sim->units.unitTime())
-	  << magnet::xml::endtag("TotCount");
+    for (const size_t id : totalsOrder)
+      {
+	const eventKey& event = eventIndex.key(id);
+	const size_t count = totals[id] + initialCounter[id];
+	XML << magnet::xml::tag("TotCount")
+	    << magnet::xml::attr("Name") << getName(event.first, Sim)
+	    << magnet::xml::attr("Event") << event.second
+	    << magnet::xml::attr("Percent") 
+	    << 100.0 * (((double) totals[id])
+			+((double) initialCounter[id]))
+	  / (((double) totalCount) + ((double) initialsum))
+	    << magnet::xml::attr("Count") << count
+	    << magnet::xml::attr("EventMeanFreeTime")
+	    << Sim->systemTime / (count * Sim->units.unitTime())
+	    << magnet::xml::endtag("TotCount");
+      }
   
     XML << magnet::xml::endtag("Totals")
 	<< magnet::xml::endtag("CollCounters");
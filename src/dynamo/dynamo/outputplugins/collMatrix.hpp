@@ -19,7 +19,6 @@
 #include <dynamo/outputplugins/outputplugin.hpp>
 #include <dynamo/eventtypes.hpp>
 #include <dynamo/outputplugins/eventtypetracking.hpp>
-#include <map>
 #include <vector>
 
 namespace dynamo {
@@ -32,6 +31,9 @@ namespace dynamo {
   private:
   
   public:
+    typedef EventKey eventKey;
+
+
     OPCollMatrix(const dynamo::Simulation*, const magnet::xml::Node&);
     ~OPCollMatrix();
 
@@ -40,6 +42,26 @@ namespace dynamo {
     virtual void eventUpdate(const Event&, const NEventData&);
 
     void output(magnet::xml::XmlStream &);
+
+    //! The number of transitions counted between all event keys.
+    unsigned long getTotalCount() const { return totalCount; }
+
+    //! The number of particles whose first event had this key.
+    size_t getInitialCount(const eventKey& event) const
+    {
+      const size_t id = eventIndex.find(event.first, event.second);
+      return (id == EventKeyIndex::npos) ? 0 : initialCounter[id];
+    }
+
+    //! The number of transitions to event from a previous event last.
+    unsigned long getTransitionCount(const eventKey& event, const eventKey& last) const
+    {
+      const size_t id = eventIndex.find(event.first, event.second);
+      const size_t lastID = eventIndex.find(last.first, last.second);
+      if ((id == EventKeyIndex::npos) || (lastID == EventKeyIndex::npos) || (lastID >= counters[id].size()))
+	return 0;
+      return counters[id][lastID].count;
+    }
   
   protected:
     void newEvent(const size_t&, const EEventType&, const classKey&);
@@ -54,15 +76,15 @@ namespace dynamo {
   
     unsigned long totalCount;
 
-    typedef std::pair<classKey, EEventType> eventKey;
+    //! Numbers the event keys seen so far.
+    EventKeyIndex eventIndex;
 
-    typedef std::pair<eventKey, eventKey> counterKey;
-  
-    std::map<counterKey, counterData> counters;
+    //! The transition counters, indexed as [event][last event].
+    std::vector<std::vector<counterData> > counters;
   
-    std::map<eventKey, size_t> initialCounter;
+    std::vector<size_t> initialCounter;
 
-    typedef std::pair<double, eventKey> lastEventData;
+    typedef std::pair<double, size_t> lastEventData;
 
     std::vector<lastEventData> lastEvent; 
   };
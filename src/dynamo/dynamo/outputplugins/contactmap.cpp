@@ -46,9 +46,9 @@ namespace dynamo {
   void 
   OPContactMap::initialise() 
   {
-    _collected_maps.clear();
+    _maps.clear();
+    _map_ids.clear();
     _map_links.clear();
-    _next_map_id = 0;
     _weight = 0;
     _total_weight = 0;
   
@@ -57,7 +57,10 @@ namespace dynamo {
     if (!_interaction)
       M_throw() << "Could not cast \"" << _interaction_name << "\" to an ICapture type to build the contact map";
     
-    _current_map = _collected_maps.insert(CollectedMapType::value_type(*_interaction, MapData(Sim->systemTime, Sim->calcInternalEnergy(), _next_map_id++))).first;
+    _current_map = 0;
+    _maps.push_back(MapData(NO_PARENT, Sim->systemTime, Sim->calcInternalEnergy()));
+    _maps.back()._delta.assign(_interaction->begin(), _interaction->end());
+    _map_ids[_interaction->hash()] = _current_map;
   }
 
   void OPContactMap::stream(double dt) { _weight += dt; }
@@ -66,7 +69,7 @@ namespace dynamo {
   OPContactMap::flush()
   {
     //Cannot create new maps here, as flush may happen when the output plugins are invalid
-    MapData& data = _current_map->second;
+    MapData& data = _maps[_current_map];
     data._weight += _weight;
     _total_weight += _weight;
     _weight = 0;
@@ -88,23 +91,41 @@ namespace dynamo {
 
     if (event._sourceID == _interaction->getID())
       if ((event._type == STEP_IN) || (event._type == STEP_OUT))
-	mapChanged(true);
+	mapChanged(&event);
   }
 
   void 
-  OPContactMap::mapChanged(bool addLink) {
+  OPContactMap::mapChanged(const Event* event) {
     flush();
-    size_t oldMapID(_current_map->second._id);
+    const size_t oldMapID = _current_map;
     
     //Try and find the current map in the collected maps
-    _current_map = _collected_maps.find(*_interaction);
-    if (_current_map == _collected_maps.end())
-      //Insert the new map
-      _current_map = _collected_maps.insert(CollectedMapType::value_type(*_interaction, MapData(Sim->systemTime, Sim->getOutputPlugin<OPMisc>()->getConfigurationalU(), _next_map_id++))).first;
+    const std::size_t hash = _interaction->hash();
+    const auto it = _map_ids.find(hash);
+    if (it != _map_ids.end())
+      _current_map = it->second;
+    else
+      {
+	//Insert the new map
+	_current_map = _maps.size();
+	_map_ids[hash] = _current_map;
+	if (event)
+	  {
+	    //Only the pair of the event has changed since the last map
+	    const detail::PairKey pair(event->_particle1ID, event->_particle2ID);
+	    _maps.push_back(MapData(oldMapID, Sim->systemTime, Sim->getOutputPlugin<OPMisc>()->getConfigurationalU()));
+	    _maps.back()._delta.push_back(std::make_pair(pair, _interaction->isCaptured(event->_particle1ID, event->_particle2ID)));
+	  }
+	else
+	  {
+	    _maps.push_back(MapData(NO_PARENT, Sim->systemTime, Sim->getOutputPlugin<OPMisc>()->getConfigurationalU()));
+	    _maps.back()._delta.assign(_interaction->begin(), _interaction->end());
+	  }
+      }
     
     //Add the link	    
-    if (addLink)
-      ++(_map_links[std::make_pair(oldMapID, _current_map->second._id)]);
+    if (event)
+      ++(_map_links[std::make_pair(oldMapID, _current_map)]);
   }
 
   void 
@@ -114,50 +135,94 @@ namespace dynamo {
     
     std::swap(_weight, op._weight);
     std::swap(_total_weight, op._total_weight);
-    std::swap(_next_map_id, op._next_map_id);
-    std::swap(_collected_maps, op._collected_maps);
+    std::swap(_maps, op._maps);
+    std::swap(_map_ids, op._map_ids);
     std::swap(_current_map, op._current_map);
     std::swap(_map_links, op._map_links);
 
     //Now let each plugin know the map has changed
-    mapChanged(false);
-    op.mapChanged(false);
+    mapChanged(NULL);
+    op.mapChanged(NULL);
   }
 
   void
   OPContactMap::periodicOutput()
   { 
-    I_Pcout() << ", Maps " << _collected_maps.size() << ", links " << _map_links.size();
+    I_Pcout() << ", Maps " << _maps.size() << ", links " << _map_links.size();
   }
 
   void 
   OPContactMap::output(magnet::xml::XmlStream& XML)
   {
-    dout << "Writing out " << _collected_maps.size() << " Contact maps with "
+    dout << "Writing out " << _maps.size() << " Contact maps with "
 	 << _map_links.size() << " links" << std::endl;
 
     namespace xml = magnet::xml;
     XML << xml::tag("ContactMap")
 	<< xml::tag("Maps")
-      	<< xml::attr("Count") << _collected_maps.size();
+      	<< xml::attr("Count") << _maps.size();
     ;
     
-    for (const CollectedMapType::value_type& entry : _collected_maps)
+    //Each map is a delta from its parent, so the maps are rebuilt
+    //by a depth first walk of the discovery tree from each of the
+    //fully stored maps. The children are listed using a counting
+    //sort by parent.
+    std::vector<size_t> childStart(_maps.size() + 1, 0);
+    for (const MapData& map : _maps)
+      if (map._parent != NO_PARENT)
+	++childStart[map._parent + 1];
+
+    for (size_t id(0); id < _maps.size(); ++id)
+      childStart[id + 1] += childStart[id];
+
+    std::vector<size_t> children(childStart.back());
+    {
+      std::vector<size_t> cursor(childStart.begin(), childStart.end() - 1);
+      for (size_t id(0); id < _maps.size(); ++id)
+	if (_maps[id]._parent != NO_PARENT)
+	  children[cursor[_maps[id]._parent]++] = id;
+    }
+
+    struct Frame {
+      size_t _id;
+      size_t _next_child;
+      //! The contacts overwritten when entering this map
+      std::vector<std::pair<detail::PairKey, size_t> > _undo;
+    };
+
+    detail::CaptureMap contacts;
+    std::vector<Frame> stack;
+    for (size_t root(0); root < _maps.size(); ++root)
       {
-	XML << xml::tag("Map")
-	    << xml::attr("ID") << entry.second._id
-            << xml::attr("DiscoveryTime") << entry.second._discovery_time / Sim->units.unitTime()
-	    << xml::attr("Energy") << entry.second._energy / Sim->units.unitEnergy()
-	    << xml::attr("Weight") << entry.second._weight / _total_weight;
-	
-	for (const ICapture::value_type& ids : entry.first)
-	  XML << xml::tag("Contact")
-	      << xml::attr("ID1") << ids.first.first
-	      << xml::attr("ID2") << ids.first.second
-	      << xml::attr("State") << ids.second
-	      << xml::endtag("Contact");
-	
-	XML << xml::endtag("Map");
+	if (_maps[root]._parent != NO_PARENT) continue;
+
+	contacts.clear();
+	for (const auto& entry : _maps[root]._delta)
+	  contacts[entry.first] = entry.second;
+	writeMap(XML, root, contacts);
+	stack.push_back(Frame{root, childStart[root], {}});
+
+	while (!stack.empty())
+	  {
+	    Frame& frame = stack.back();
+	    if (frame._next_child == childStart[frame._id + 1])
+	      {
+		for (auto it = frame._undo.rbegin(); it != frame._undo.rend(); ++it)
+		  contacts[it->first] = it->second;
+		stack.pop_back();
+		continue;
+	      }
+
+	    const size_t child = children[frame._next_child++];
+	    Frame childFrame{child, childStart[child], {}};
+	    for (const auto& entry : _maps[child]._delta)
+	      {
+		childFrame._undo.push_back(std::make_pair(entry.first, size_t(contacts[entry.first])));
+		contacts[entry.first] = entry.second;
+	      }
+	    writeMap(XML, child, contacts);
+	    stack.push_back(std::move(childFrame));
+	  }
       }
 
     XML << xml::endtag("Maps")
@@ -174,4 +239,25 @@ namespace dynamo {
     XML << xml::endtag("Links")
 	<< xml::endtag("ContactMap");
   }
+
+  void
+  OPContactMap::writeMap(magnet::xml::XmlStream& XML, const size_t id, const detail::CaptureMap& contacts) const
+  {
+    namespace xml = magnet::xml;
+    const MapData& map = _maps[id];
+    XML << xml::tag("Map")
+	<< xml::attr("ID") << id
+	<< xml::attr("DiscoveryTime") << map._discovery_time / Sim->units.unitTime()
+	<< xml::attr("Energy") << map._energy / Sim->units.unitEnergy()
+	<< xml::attr("Weight") << map._weight / _total_weight;
+	
+    for (const detail::CaptureMapKey::value_type& ids : detail::CaptureMapKey(contacts))
+      XML << xml::tag("Contact")
+	  << xml::attr("ID1") << ids.first.first
+	  << xml::attr("ID2") << ids.first.second
+	  << xml::attr("State") << ids.second
+	  << xml::endtag("Contact");
+	
+    XML << xml::endtag("Map");
+  }
 }
@@ -18,6 +18,7 @@
 #pragma once
 #include <dynamo/outputplugins/outputplugin.hpp>
 #include <dynamo/interactions/captures.hpp>
+#include <limits>
 #include <map>
 #include <vector>
 #include <unordered_map>
@@ -52,35 +53,57 @@ namespace dynamo {
     void stream(double);
     void flush();
     
-    void mapChanged(bool addLink);
+    /*! \brief Called when the contact map may have changed.
+
+      \param event The STEP_IN/STEP_OUT event which changed the map,
+      or NULL if the whole system was replaced (e.g., by a replica
+      exchange). A link is only recorded if an event is given.
+     */
+    void mapChanged(const Event* event);
+
+    void writeMap(magnet::xml::XmlStream&, const size_t id, const detail::CaptureMap& contacts) const;
 
     double _weight;
     double _total_weight;
-    /*! \brief A sorted listing of all the captured pairs in the
-     system
-    */
-    size_t _next_map_id;
 
     struct MapData
     {
-      MapData(double discovery_time = 0, double energy=0, size_t id = 0): 
-        _weight(0), _energy(energy), _discovery_time(discovery_time), _id(id) {}
+      MapData(size_t parent, double discovery_time, double energy): 
+        _weight(0), _energy(energy), _discovery_time(discovery_time), _parent(parent) {}
       double _weight;
       double _energy;
       double _discovery_time;
-      size_t _id;
+      /*! \brief The ID of the map this map was discovered from, or
+        NO_PARENT if this map was stored in full.
+      */
+      size_t _parent;
+      /*! \brief The contacts which differ from the parent map, or
+        all of the contacts if there is no parent.
+      */
+      std::vector<std::pair<detail::PairKey, size_t> > _delta;
     };
 
-    typedef std::unordered_map<detail::CaptureMapKey, MapData,  detail::CaptureMapKeyHash> CollectedMapType;
+    static const size_t NO_PARENT = std::numeric_limits<size_t>::max();
+
     typedef std::unordered_map<std::pair<size_t, size_t>, size_t, detail::OPContactMapPairHash> LinksMapType;
-    /*! \brief A hash table storing the histogram of the contact maps.
+    /*! \brief The histogram of the contact maps, indexed by the map
+      ID.
       
-      The key of this map is a sorted list of the captured pairs in
-      the system. This sorting is implicitly carried out by the
-      _current_map.
+      New maps are almost always reached by a single capture or
+      release from the current map, so they are stored as a delta
+      from it. The full maps are only rebuilt when they are written
+      out.
+     */
+    std::vector<MapData> _maps;
+    /*! \brief A hash table of the IDs of the collected maps, keyed
+      by the Zobrist hash of their contacts.
+
+      The ICapture interaction keeps its hash up to date as pairs
+      are captured and released, so looking up the current map is
+      O(1) regardless of the number of contacts.
      */
-    CollectedMapType _collected_maps;
-    CollectedMapType::iterator _current_map;
+    std::unordered_map<std::size_t, size_t> _map_ids;
+    size_t _current_map;
     LinksMapType _map_links;
     std::string _interaction_name;
     std::shared_ptr<ICapture> _interaction;
@@ -59,5 +59,7 @@ namespace dynamo {
     {
       return classKey(i._sourceID, i._source);
     }
+
+    const size_t EventKeyIndex::npos;
   }
 }
@@ -17,8 +17,11 @@
 
 #pragma once
 #include <dynamo/eventtypes.hpp>
+#include <array>
+#include <limits>
 #include <utility>
 #include <string>
+#include <vector>
 
 namespace dynamo
 {
@@ -35,5 +38,60 @@ namespace dynamo
     std::string getClass(const classKey&);
 
     classKey getClassKey(const Event&);
+
+    typedef std::pair<classKey, EEventType> EventKey;
+
+    /*! \brief Numbers the event keys (class, ID and type) densely in
+      order of first appearance.
+
+      This lets the output plugins keep their per-event counters in
+      flat arrays. A lookup is two array accesses, compared to a
+      tree search for a std::map<EventKey, ...>.
+     */
+    class EventKeyIndex
+    {
+    public:
+      static const size_t npos = std::numeric_limits<size_t>::max();
+
+      //! Returns the index of an event key, numbering it if it is new.
+      size_t operator()(const classKey& ck, const EEventType type)
+      {
+	std::vector<size_t>& slots = _slots[ck.second];
+	const size_t slot = ck.first * FINAL_ENUM_TO_CATCH_THE_COMMA + type;
+	if (slot >= slots.size())
+	  slots.resize(slot + 1, npos);
+
+	size_t& index = slots[slot];
+	if (index == npos)
+	  {
+	    index = _keys.size();
+	    _keys.push_back(EventKey(ck, type));
+	  }
+	return index;
+      }
+
+      //! Returns the index of an event key, or npos if it is not numbered.
+      size_t find(const classKey& ck, const EEventType type) const
+      {
+	const std::vector<size_t>& slots = _slots[ck.second];
+	const size_t slot = ck.first * FINAL_ENUM_TO_CATCH_THE_COMMA + type;
+	return (slot < slots.size()) ? slots[slot] : npos;
+      }
+
+      const EventKey& key(const size_t index) const { return _keys[index]; }
+
+      //! The number of event keys seen so far.
+      size_t size() const { return _keys.size(); }
+
+      void swap(EventKeyIndex& other)
+      {
+	std::swap(_slots, other._slots);
+	std::swap(_keys, other._keys);
+      }
+
+    private:
+      std::array<std::vector<size_t>, NOSOURCE + 1> _slots;
+      std::vector<EventKey> _keys;
+    };
   }
 }
@@ -25,3 +25,4 @@
 #include <dynamo/outputplugins/eventEffects.hpp>
 #include <dynamo/outputplugins/intEnergyHist.hpp>
 #include <dynamo/outputplugins/msd.hpp>
+#include <dynamo/outputplugins/nblistStats.hpp>
@@ -23,6 +23,7 @@
 #include <magnet/memUsage.hpp>
 #include <magnet/xmlwriter.hpp>
 #include <dynamo/systems/tHalt.hpp>
+#include <algorithm>
 #include <ctime>
 
 namespace dynamo {
@@ -45,6 +46,7 @@ namespace dynamo {
     OPMisc& op = static_cast<OPMisc&>(misc2);
     
     std::swap(_counters, op._counters);
+    _counterIndex.swap(op._counterIndex);
     std::swap(_starttime, op._starttime);
     std::swap(_dualEvents, op._dualEvents);
     std::swap(_singleEvents, op._singleEvents);
@@ -68,6 +70,12 @@ namespace dynamo {
     for (auto& correlator : _mutualDiffusion)
       correlator.clear();
 
+    _shearViscosityL.clear();
+    _bulkViscosityL.clear();
+    _thermalConductivityL.clear();
+    for (auto& estimator : _mutualDiffusionL)
+      estimator.clear();
+
     //These remain unchanged
     //_internalEnergy;
     //_speciesMasses;
@@ -191,6 +199,21 @@ namespace dynamo {
     XML << endtag("Component");    
   }
 
+  void outputEstimate(magnet::xml::XmlStream& XML, const OPMisc::TransportEstimate& estimate) {
+    using namespace magnet::xml;
+    XML << attr("Value") << estimate.value
+	<< attr("Error") << estimate.error
+	<< attr("Time") << estimate.time
+	<< attr("Windows") << estimate.windows
+	<< attr("Plateau") << estimate.plateau;
+  }
+
+  void outputEstimate(magnet::xml::XmlStream& XML, const std::string& name, const OPMisc::TransportEstimate& estimate) {
+    XML << magnet::xml::tag(name);
+    outputEstimate(XML, estimate);
+    XML << magnet::xml::endtag(name);
+  }
+
   template<class T>
   void outputCorrelator(magnet::xml::XmlStream& XML, const double inv_units, const double time_units, magnet::math::LogarithmicTimeCorrelator<T>& corr) {
     outputCorrelator(XML, false, false, inv_units, time_units, corr);
@@ -288,8 +311,25 @@ namespace dynamo {
     }
     _crossVisc.setFreeStreamValue(crossViscFS1, crossViscFS2);
 
+    //The transport coefficient estimators sample the same integrated
+    //fluxes as the correlators above
+    _shearViscosityL.resize(correlator_dt, [](const Matrix& a, const Matrix& b) {
+	double sum(0);
+	for (size_t i(0); i < NDIM; ++i)
+	  for (size_t j(0); j < NDIM; ++j)
+	    if (i != j)
+	      sum += a(i, j) * b(i, j);
+	return sum / (NDIM * (NDIM - 1));
+      }, true);
+    _shearViscosityL.setFreeStreamValue(kineticP);
+    _bulkViscosityL.resize(correlator_dt, [](const double& a, const double& b) { return a * b; }, true);
+    _bulkViscosityL.setFreeStreamValue(isoViscFS / 3);
+    _thermalConductivityL.resize(correlator_dt, [](const Vector& a, const Vector& b) { return (a | b) / NDIM; }, false);
+    _thermalConductivityL.setFreeStreamValue(thermalConductivityFS);
+
     _thermalDiffusion.resize(Sim->species.size());
     _mutualDiffusion.resize(Sim->species.size() * Sim->species.size());
+    _mutualDiffusionL.resize(Sim->species.size() * Sim->species.size());
     for (size_t spid1(0); spid1 < Sim->species.size(); ++spid1)
       {
 	_thermalDiffusion[spid1].resize(correlator_dt, 10, 2, false);
@@ -301,6 +341,10 @@ namespace dynamo {
 	    _mutualDiffusion[spid1 * Sim->species.size() + spid2].setFreeStreamValue
 	      (_speciesMomenta[spid1] - (_speciesMasses[spid1] / _systemMass) * _sysMomentum.current(),
 	       _speciesMomenta[spid2] - (_speciesMasses[spid2] / _systemMass) * _sysMomentum.current());
+	    _mutualDiffusionL[spid1 * Sim->species.size() + spid2].resize(correlator_dt, [](const Vector& a, const Vector& b) { return (a | b) / NDIM; }, false);
+	    _mutualDiffusionL[spid1 * Sim->species.size() + spid2].setFreeStreamValue
+	      (_mutualDiffusion[spid1 * Sim->species.size() + spid2].getFreeStreamValues().first,
+	       _mutualDiffusion[spid1 * Sim->species.size() + spid2].getFreeStreamValues().second);
 	  }
       }
 
@@ -332,7 +376,10 @@ namespace dynamo {
     if ((NDat.L1partChanges.size() == 0) && (NDat.L2partChanges.size() == 1))
       type = NDat.L2partChanges[0].getType();
     
-    CounterData& counterdata = _counters[CounterKey(getClassKey(eevent), type)];
+    const size_t counterID = _counterIndex(getClassKey(eevent), type);
+    if (counterID == _counters.size())
+      _counters.resize(counterID + 1);
+    CounterData& counterdata = _counters[counterID];
     counterdata.count += NDat.L1partChanges.size() + NDat.L2partChanges.size();
 
     Vector thermalDel({0,0,0});
@@ -410,12 +457,14 @@ namespace dynamo {
 
 	const auto visc_imp = magnet::math::Dyadic(PDat.rij, delP);
 	_viscosity.addImpulse(visc_imp);
+	_shearViscosityL.addImpulse(visc_imp);
 
 
 	double isoVisc_imp(0);
 	for (size_t iDim(0); iDim < NDIM; ++iDim)
 	  isoVisc_imp += visc_imp(iDim, iDim);
 	_bulkVisc.addImpulse(isoVisc_imp / 3);
+	_bulkViscosityL.addImpulse(isoVisc_imp / 3);
     
 	Vector crossVisc_imp1({0, 0, 0});
 	Vector crossVisc_imp2({0, 0, 0});
@@ -432,6 +481,7 @@ namespace dynamo {
 	const Vector thermalImpulse = PDat.rij * p1deltaE;
 
 	_thermalConductivity.addImpulse(thermalImpulse);
+	_thermalConductivityL.addImpulse(thermalImpulse);
 
 	for (size_t spid1(0); spid1 < Sim->species.size(); ++spid1)
 	  _thermalDiffusion[spid1].addImpulse(thermalImpulse, Vector{0,0,0});
@@ -442,15 +492,18 @@ namespace dynamo {
 
     _thermalConductivity.setFreeStreamValue
       (_thermalConductivity.getFreeStreamValue() + thermalDel);
+    _thermalConductivityL.setFreeStreamValue(_thermalConductivity.getFreeStreamValue());
 
     const auto kineticP = _kineticP.current();
     
     _viscosity.setFreeStreamValue(kineticP);
+    _shearViscosityL.setFreeStreamValue(kineticP);
 
     double isoViscFS(0);
     for (size_t iDim(0); iDim < NDIM; ++iDim)
       isoViscFS += kineticP(iDim, iDim);
     _bulkVisc.setFreeStreamValue(isoViscFS / 3);
+    _bulkViscosityL.setFreeStreamValue(isoViscFS / 3);
     
     Vector crossViscFS1({0, 0, 0});
     Vector crossViscFS2({0, 0, 0});
@@ -468,9 +521,12 @@ namespace dynamo {
 			      _speciesMomenta[spid1] - _sysMomentum.current() * (_speciesMasses[spid1] / _systemMass));
 
 	for (size_t spid2(spid1); spid2 < Sim->species.size(); ++spid2)
-	  _mutualDiffusion[spid1 * Sim->species.size() + spid2].setFreeStreamValue
-	    (_speciesMomenta[spid1] - (_speciesMasses[spid1] / _systemMass) * _sysMomentum.current(),
-	     _speciesMomenta[spid2] - (_speciesMasses[spid2] / _systemMass) * _sysMomentum.current());
+	  {
+	    const Vector J1 = _speciesMomenta[spid1] - (_speciesMasses[spid1] / _systemMass) * _sysMomentum.current();
+	    const Vector J2 = _speciesMomenta[spid2] - (_speciesMasses[spid2] / _systemMass) * _sysMomentum.current();
+	    _mutualDiffusion[spid1 * Sim->species.size() + spid2].setFreeStreamValue(J1, J2);
+	    _mutualDiffusionL[spid1 * Sim->species.size() + spid2].setFreeStreamValue(J1, J2);
+	  }
       }
   }
 
@@ -486,11 +542,17 @@ namespace dynamo {
     _viscosity.freeStream(dt);
     _bulkVisc.freeStream(dt);
     _crossVisc.freeStream(dt);
+    _shearViscosityL.freeStream(dt);
+    _bulkViscosityL.freeStream(dt);
+    _thermalConductivityL.freeStream(dt);
     for (size_t spid1(0); spid1 < Sim->species.size(); ++spid1)
       {
 	_thermalDiffusion[spid1].freeStream(dt);
 	for (size_t spid2(spid1); spid2 < Sim->species.size(); ++spid2)
-	  _mutualDiffusion[spid1 * Sim->species.size() + spid2].freeStream(dt);
+	  {
+	    _mutualDiffusion[spid1 * Sim->species.size() + spid2].freeStream(dt);
+	    _mutualDiffusionL[spid1 * Sim->species.size() + spid2].freeStream(dt);
+	  }
       }
   }
 
@@ -520,6 +582,42 @@ namespace dynamo {
   OPMisc::getPressureTensor() const
   { return ((collisionalP / Sim->systemTime) + _kineticP.mean()) / Sim->getSimVolume(); }
 
+  namespace {
+    OPMisc::TransportEstimate scaleEstimate(OPMisc::TransportEstimate estimate, const double scale, const double time_units)
+    {
+      estimate.value *= scale;
+      estimate.error *= scale;
+      estimate.time /= time_units;
+      return estimate;
+    }
+  }
+
+  OPMisc::TransportEstimate
+  OPMisc::getShearViscosity() const
+  { 
+    return scaleEstimate(_shearViscosityL.getEstimate(), 1.0 / (Sim->units.unitViscosity() * getMeankT() * Sim->getSimVolume()), Sim->units.unitTime());
+  }
+
+  OPMisc::TransportEstimate
+  OPMisc::getBulkViscosity() const
+  {
+    return scaleEstimate(_bulkViscosityL.getEstimate(), 1.0 / (Sim->units.unitViscosity() * getMeankT() * Sim->getSimVolume()), Sim->units.unitTime());
+  }
+
+  OPMisc::TransportEstimate
+  OPMisc::getThermalConductivity() const
+  {
+    const double kT = getMeankT();
+    return scaleEstimate(_thermalConductivityL.getEstimate(), Sim->units.unitk() / (Sim->units.unitThermalCond() * kT * kT * Sim->getSimVolume()), Sim->units.unitTime());
+  }
+
+  OPMisc::TransportEstimate
+  OPMisc::getMutualDiffusion(size_t species1, size_t species2) const
+  {
+    if (species1 > species2) std::swap(species1, species2);
+    return scaleEstimate(_mutualDiffusionL[species1 * Sim->species.size() + species2].getEstimate(), 1.0 / (Sim->units.unitMutualDiffusion() * getMeankT() * Sim->getSimVolume()), Sim->units.unitTime());
+  }
+
   void
   OPMisc::output(magnet::xml::XmlStream &XML)
   {
@@ -634,23 +732,33 @@ namespace dynamo {
 
 	<< tag("EventCounters");
   
-    typedef std::pair<CounterKey, CounterData> mappair;
-    for (const mappair& mp1 : _counters)
-      XML << tag("Entry")
-	  << attr("Type") << getClass(mp1.first.first)
-	  << attr("Name") << getName(mp1.first.first, Sim)
-	  << attr("Event") << mp1.first.second
-	  << attr("Count") << mp1.second.count
-	  << tag("NetImpulse") 
-	  << mp1.second.netimpulse / Sim->units.unitMomentum()
-	  << endtag("NetImpulse")
-	  << tag("NetKEChange")
-	  << attr("Value") << mp1.second.netKEchange / Sim->units.unitEnergy()
-	  << endtag("NetKEChange")
-	  << tag("NetUChange")
-	  << attr("Value") << mp1.second.netUchange / Sim->units.unitEnergy()
-	  << endtag("NetUChange")
-	  << endtag("Entry");
+    //The counters are numbered in order of appearance, sort them by
+    //their key for output
+    std::vector<size_t> order(_counters.size());
+    for (size_t id(0); id < order.size(); ++id)
+      order[id] = id;
+    std::sort(order.begin(), order.end(), [&](const size_t a, const size_t b) { return _counterIndex.key(a) < _counterIndex.key(b); });
+
+    for (const size_t id : order)
+      {
+	const EventKey& key = _counterIndex.key(id);
+	const CounterData& data = _counters[id];
+	XML << tag("Entry")
+	    << attr("Type") << getClass(key.first)
+	    << attr("Name") << getName(key.first, Sim)
+	    << attr("Event") << key.second
+	    << attr("Count") << data.count
+	    << tag("NetImpulse") 
+	    << data.netimpulse / Sim->units.unitMomentum()
+	    << endtag("NetImpulse")
+	    << tag("NetKEChange")
+	    << attr("Value") << data.netKEchange / Sim->units.unitEnergy()
+	    << endtag("NetKEChange")
+	    << tag("NetUChange")
+	    << attr("Value") << data.netUchange / Sim->units.unitEnergy()
+	    << endtag("NetUChange")
+	    << endtag("Entry");
+      }
     
     XML << endtag("EventCounters")
 
@@ -739,7 +847,24 @@ namespace dynamo {
 	    XML << endtag("Correlator");
 	  }
 
-      XML << endtag("MutualDiffusion");
+      XML << endtag("MutualDiffusion")
+	  << tag("TransportCoefficients");
+
+      outputEstimate(XML, "ShearViscosity", getShearViscosity());
+      outputEstimate(XML, "BulkViscosity", getBulkViscosity());
+      outputEstimate(XML, "ThermalConductivity", getThermalConductivity());
+
+      for (size_t i(0); i < Sim->species.size(); ++i)
+	for (size_t j(i); j < Sim->species.size(); ++j)
+	  {
+	    XML << tag("MutualDiffusion")
+		<< attr("Species1") << Sim->species[i]->getName()
+		<< attr("Species2") << Sim->species[j]->getName();
+	    outputEstimate(XML, getMutualDiffusion(i, j));
+	    XML << endtag("MutualDiffusion");
+	  }
+
+      XML << endtag("TransportCoefficients");
     }
     XML << endtag("Misc");
   }
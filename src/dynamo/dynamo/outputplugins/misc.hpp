@@ -22,7 +22,7 @@
 #include <magnet/math/timeaveragedproperty.hpp>
 #include <magnet/math/correlators.hpp>
 #include <chrono>
-#include <map>
+#include <vector>
 
 namespace dynamo {
   using namespace EventTypeTracking;
@@ -66,11 +66,30 @@ namespace dynamo {
 
     Matrix getPressureTensor() const;
 
+    typedef magnet::math::TransportEstimate TransportEstimate;
+
+    /*! \brief Estimates of the transport coefficients (in output
+        units), with their blocked standard errors.
+
+	These are the plateau values of the Einstein forms of the
+	Green-Kubo relations (see
+	magnet::math::EinsteinTransportEstimator).
+     */
+    TransportEstimate getShearViscosity() const;
+    TransportEstimate getBulkViscosity() const;
+    TransportEstimate getThermalConductivity() const;
+    TransportEstimate getMutualDiffusion(size_t species1, size_t species2) const;
+
+    //! The number of particle changes counted for an event key.
+    size_t getEventCount(const EventKey& key) const
+    {
+      const size_t id = _counterIndex.find(key.first, key.second);
+      return (id == EventKeyIndex::npos) ? 0 : _counters[id].count;
+    }
+
   protected:
     void stream(double dt);
 
-    typedef std::pair<classKey, EEventType> CounterKey;
-
     struct CounterData
     {
       CounterData(): count(0), netimpulse({0,0,0}), netKEchange(0), netUchange(0) {}
@@ -80,7 +99,8 @@ namespace dynamo {
       double netUchange;
     };
 
-    std::map<CounterKey, CounterData> _counters;
+    EventKeyIndex _counterIndex;
+    std::vector<CounterData> _counters;
     std::chrono::system_clock::time_point _starttime;
     unsigned long _dualEvents;
     unsigned long _singleEvents;
@@ -96,6 +116,10 @@ namespace dynamo {
     magnet::math::LogarithmicTimeCorrelator<Vector> _crossVisc;
     std::vector<magnet::math::LogarithmicTimeCorrelator<Vector> > _thermalDiffusion;
     std::vector<magnet::math::LogarithmicTimeCorrelator<Vector> > _mutualDiffusion;
+    magnet::math::EinsteinTransportEstimator<Matrix> _shearViscosityL;
+    magnet::math::EinsteinTransportEstimator<double> _bulkViscosityL;
+    magnet::math::EinsteinTransportEstimator<Vector> _thermalConductivityL;
+    std::vector<magnet::math::EinsteinTransportEstimator<Vector> > _mutualDiffusionL;
     std::vector<double> _internalEnergy;
     std::vector<double> _speciesMasses;
     std::vector<Vector> _speciesMomenta;
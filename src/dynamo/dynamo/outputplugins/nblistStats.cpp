@@ -0,0 +1,155 @@
+/*  dynamo:- Event driven molecular dynamics simulator 
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <dynamo/outputplugins/nblistStats.hpp>
+#include <dynamo/simulation.hpp>
+#include <dynamo/globals/neighbourList.hpp>
+#include <dynamo/schedulers/scheduler.hpp>
+#include <magnet/xmlwriter.hpp>
+
+namespace dynamo {
+  namespace {
+    void outputCountHistogram(magnet::xml::XmlStream& XML, const std::vector<size_t>& histogram)
+    {
+      size_t samples = 0;
+      double sum = 0;
+      for (size_t i(0); i < histogram.size(); ++i)
+	{
+	  samples += histogram[i];
+	  sum += double(i) * histogram[i];
+	}
+
+      XML << magnet::xml::tag("Histogram")
+	  << magnet::xml::attr("SampleCount") << samples
+	  << magnet::xml::attr("AverageVal") << (samples ? sum / samples : 0)
+	  << magnet::xml::chardata();
+
+      for (size_t i(0); i < histogram.size(); ++i)
+	if (histogram[i])
+	  XML << i << " " << double(histogram[i]) / samples << "\n";
+
+      XML << magnet::xml::endtag("Histogram");
+    }
+  }
+
+  OPNeighbourListStats::OPNeighbourListStats(const dynamo::Simulation* tmp, const magnet::xml::Node&):
+    OutputPlugin(tmp, "NeighbourListStats"),
+    _startEventCount(0),
+    _occupancySamples(0),
+    _maxOccupancy(0)
+  {}
+
+  void
+  OPNeighbourListStats::initialise()
+  {
+    _nblist.reset();
+    for (const shared_ptr<Global>& glob : Sim->globals)
+      if (glob->getName() == "SchedulerNBList")
+	_nblist = std::dynamic_pointer_cast<GNeighbourList>(glob);
+
+    if (!_nblist)
+      for (const shared_ptr<Global>& glob : Sim->globals)
+	if (!_nblist)
+	  _nblist = std::dynamic_pointer_cast<GNeighbourList>(glob);
+
+    if (!_nblist)
+      M_throw() << "The NeighbourListStats plugin requires a neighbour list";
+
+    //Discard the counts from building the initial event list
+    _nblist->resetStatistics();
+    _startEventCount = Sim->eventCount;
+    _occupancy.clear();
+    _occupancySamples = 0;
+    _maxOccupancy = 0;
+    _globalEvents.assign(Sim->globals.size(), 0);
+    sampleOccupancy();
+  }
+
+  void
+  OPNeighbourListStats::eventUpdate(const Event& event, const NEventData&)
+  {
+    if (event._source == GLOBAL)
+      ++_globalEvents[event._sourceID];
+  }
+
+  void
+  OPNeighbourListStats::periodicOutput()
+  { sampleOccupancy(); }
+
+  void
+  OPNeighbourListStats::sampleOccupancy()
+  {
+    const std::vector<size_t> histogram = _nblist->getOccupancyHistogram();
+    if (histogram.empty()) return;
+
+    if (histogram.size() > _occupancy.size())
+      _occupancy.resize(histogram.size(), 0);
+
+    for (size_t i(0); i < histogram.size(); ++i)
+      _occupancy[i] += histogram[i];
+
+    _maxOccupancy = std::max(_maxOccupancy, histogram.size() - 1);
+    ++_occupancySamples;
+  }
+
+  void
+  OPNeighbourListStats::output(magnet::xml::XmlStream& XML)
+  {
+    sampleOccupancy();
+
+    const GNeighbourList::Statistics stats = _nblist->getStatistics();
+    //Cell transitions are virtual events, so they are not counted in
+    //the simulation event count
+    const size_t events = Sim->eventCount - _startEventCount;
+    const size_t totalEvents = events + stats.cellTransitions;
+
+    XML << magnet::xml::tag("NeighbourListStats")
+	<< magnet::xml::attr("Name") << _nblist->getName()
+	<< magnet::xml::attr("CellEvents") << stats.cellTransitions
+	<< magnet::xml::attr("CellEventFraction") << (totalEvents ? double(stats.cellTransitions) / totalEvents : 0)
+	<< magnet::xml::attr("MaxSupportedInteractionLength") << _nblist->getMaxSupportedInteractionLength() / Sim->units.unitLength();
+
+    XML << magnet::xml::tag("Occupancy")
+	<< magnet::xml::attr("Samples") << _occupancySamples
+	<< magnet::xml::attr("Max") << _maxOccupancy;
+    outputCountHistogram(XML, _occupancy);
+    XML << magnet::xml::endtag("Occupancy");
+
+    XML << magnet::xml::tag("NeighboursPerQuery")
+	<< magnet::xml::attr("Queries") << stats.neighbourQueries
+	<< magnet::xml::attr("Mean") << (stats.neighbourQueries ? double(stats.neighboursReturned) / stats.neighbourQueries : 0)
+	<< magnet::xml::attr("Max") << stats.maxNeighbours;
+    outputCountHistogram(XML, stats.neighbourHistogram);
+    XML << magnet::xml::endtag("NeighboursPerQuery");
+
+    XML << magnet::xml::tag("NeighboursPerEvent")
+	<< magnet::xml::attr("Mean") << (totalEvents ? double(stats.neighboursReturned) / totalEvents : 0)
+	<< magnet::xml::attr("QueriesPerEvent") << (totalEvents ? double(stats.neighbourQueries) / totalEvents : 0)
+	<< magnet::xml::endtag("NeighboursPerEvent");
+
+    XML << magnet::xml::tag("Globals");
+    for (size_t ID(0); ID < _globalEvents.size(); ++ID)
+      XML << magnet::xml::tag("Global")
+	  << magnet::xml::attr("Name") << Sim->globals[ID]->getName()
+	  << magnet::xml::attr("Count") << _globalEvents[ID]
+	  << magnet::xml::attr("Fraction") << (totalEvents ? double(_globalEvents[ID]) / totalEvents : 0)
+	  << magnet::xml::endtag("Global");
+    XML << magnet::xml::endtag("Globals");
+
+    XML << magnet::xml::endtag("NeighbourListStats");
+  }
+}
@@ -0,0 +1,61 @@
+/*  dynamo:- Event driven molecular dynamics simulator 
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+#include <dynamo/outputplugins/outputplugin.hpp>
+#include <vector>
+
+namespace dynamo {
+  class GNeighbourList;
+
+  /*! \brief Collects statistics on the performance of the
+      scheduler's neighbour list.
+
+      This plugin reports the occupancy of the cells, the number of
+      neighbours returned per look-up and per event, the fraction of
+      all events which are cell transitions, and how often each
+      Global (e.g., GWaker, GFrancesco or GPBCSentinel) fires. These
+      are the numbers required to tune the cell size and overlink of
+      the neighbour list for a particular system.
+
+      The occupancy is sampled every time the periodic output is
+      triggered and once more when the output is written.
+   */
+  class OPNeighbourListStats: public OutputPlugin
+  {
+  public:
+    OPNeighbourListStats(const dynamo::Simulation*, const magnet::xml::Node&);
+
+    virtual void initialise();
+
+    virtual void eventUpdate(const Event&, const NEventData&);
+
+    virtual void periodicOutput();
+
+    virtual void output(magnet::xml::XmlStream&);
+
+  protected:
+    void sampleOccupancy();
+
+    shared_ptr<GNeighbourList> _nblist;
+    size_t _startEventCount;
+    std::vector<size_t> _occupancy;
+    size_t _occupancySamples;
+    size_t _maxOccupancy;
+    std::vector<size_t> _globalEvents;
+  };
+}
@@ -143,6 +143,8 @@ namespace dynamo {
       return testGeneratePlugin<OPVelProfile>(Sim, XML);
     else if (!Name.compare("RadialDistribution"))
       return testGeneratePlugin<OPRadialDistribution>(Sim, XML);
+    else if (!Name.compare("StructureFactor"))
+      return testGeneratePlugin<OPStructureFactor>(Sim, XML);
     else if (!Name.compare("MSDCorrelator"))
       return testGeneratePlugin<OPMSDCorrelator>(Sim, XML);
     else if (!Name.compare("VACF"))
@@ -169,6 +171,8 @@ namespace dynamo {
       return testGeneratePlugin<OPVTK>(Sim, XML);
     else if (!Name.compare("Craig"))
       return testGeneratePlugin<OPCraig>(Sim, XML);
+    else if (!Name.compare("NeighbourListStats"))
+      return testGeneratePlugin<OPNeighbourListStats>(Sim, XML);
     else
       M_throw() << Name << ", Unknown type of OutputPlugin encountered";
   }
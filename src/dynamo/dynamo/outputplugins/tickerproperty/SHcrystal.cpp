@@ -15,17 +15,14 @@
     along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
-#include <boost/math/special_functions/spherical_harmonic.hpp>
 #include <dynamo/outputplugins/tickerproperty/SHcrystal.hpp>
-#include <dynamo/schedulers/scheduler.hpp>
 #include <dynamo/globals/neighbourList.hpp>
 #include <dynamo/units/units.hpp>
 #include <dynamo/BC/BC.hpp>
-#include <boost/math/special_functions/spherical_harmonic.hpp>
 #include <magnet/math/wigner3J.hpp>
 #include <magnet/xmlwriter.hpp>
 #include <magnet/xmlreader.hpp>
-#include <fstream>
+#include <algorithm>
 #include <cmath>
 #include <limits>
 
@@ -33,9 +30,22 @@ namespace dynamo {
   OPSHCrystal::OPSHCrystal(const dynamo::Simulation* tmp, const magnet::xml::Node& XML):
     OPTicker(tmp,"SHCrystal"), rg(1.2), maxl(7),
     nblistID(std::numeric_limits<size_t>::max()),
-    count(0)
+    count(0),
+    _Ylm(0),
+    _solidThreshold(0.7),
+    _solidBonds(7),
+    _largestCluster(0)
   {
     operator<<(XML);
+
+    //The local order needs the l=4 and l=6 harmonics, whatever MaxL is
+    _Ylm = magnet::math::SphericalHarmonics(std::max(maxl, size_t(7)) - 1);
+
+    _w6coeff.resize(13 * 13, 0);
+    for (int m1(-6); m1 <= 6; ++m1)
+      for (int m2(-6); m2 <= 6; ++m2)
+	if (std::abs(m1 + m2) <= 6)
+	  _w6coeff[(m1 + 6) * 13 + m2 + 6] = magnet::math::wignerThreej(6, 6, 6, m1, m2, -(m1 + m2));
   }
 
   void 
@@ -47,6 +57,12 @@ namespace dynamo {
     if (XML.hasAttribute("MaxL"))
       maxl = XML.getAttribute("MaxL").as<size_t>();
 
+    if (XML.hasAttribute("SolidThreshold"))
+      _solidThreshold = XML.getAttribute("SolidThreshold").as<double>();
+
+    if (XML.hasAttribute("SolidBonds"))
+      _solidBonds = XML.getAttribute("SolidBonds").as<size_t>();
+
     rg *= Sim->units.unitLength();
 
 
@@ -54,54 +70,210 @@ namespace dynamo {
 	 << rg / Sim->units.unitLength() << std::endl;
   }
 
+  const GNeighbourList&
+  OPSHCrystal::neighbourList()
+  {
+    if (nblistID == std::numeric_limits<size_t>::max())
+      {
+	double smallestlength = std::numeric_limits<float>::infinity();
+	for (const shared_ptr<Global>& pGlob : Sim->globals)
+	  if (std::dynamic_pointer_cast<GNeighbourList>(pGlob))
+	    {
+	      const double l(static_cast<const GNeighbourList*>(pGlob.get())
+			     ->getMaxSupportedInteractionLength());
+	      if ((l >= rg) && (l < smallestlength))
+		{
+		  //this neighbourlist is better suited
+		  smallestlength = l;
+		  nblistID = pGlob->getID();
+		}
+	    }
+
+	if (nblistID == std::numeric_limits<size_t>::max())
+	  M_throw() << "There is not a suitable neighbourlist for the cut-off radius selected."
+	    "\nR_g = " << rg / Sim->units.unitLength();
+      }
+
+    return static_cast<const GNeighbourList&>(*Sim->globals[nblistID]);
+  }
 
   void 
   OPSHCrystal::initialise() 
   { 
-    double smallestlength = std::numeric_limits<float>::infinity();
-    for (const shared_ptr<Global>& pGlob : Sim->globals)
-      if (std::dynamic_pointer_cast<GNeighbourList>(pGlob))
-	{
-	  const double l(static_cast<const GNeighbourList*>(pGlob.get())
-			 ->getMaxSupportedInteractionLength());
-	  if ((l >= rg) && (l < smallestlength))
-	    {
-	      //this neighbourlist is better suited
-	      smallestlength = l;
-	      nblistID = pGlob->getID();
-	    }
-	}
-
-    if (nblistID == std::numeric_limits<size_t>::max())
-      M_throw() << "There is not a suitable neighbourlist for the cut-off radius selected."
-	"\nR_g = " << rg / Sim->units.unitLength();
+    neighbourList();
 
     globalcoeff.resize(maxl);
     for (size_t l=0; l < maxl; ++l)
-      globalcoeff[l].resize(2*l+1,std::complex<double>(0,0));
+      globalcoeff[l].assign(2*l+1,std::complex<double>(0,0));
+    count = 0;
+
+    _samples = 0;
+    _q4sum = _q6sum = _w6sum = _solidsum = _clustersum = 0;
+    _clusterHistogram.clear();
 
     ticker();
   }
 
+  size_t
+  OPSHCrystal::calculateLocalOrder()
+  {
+    const GNeighbourList& nblist = neighbourList();
+    const size_t N = Sim->N();
+    _local.resize(N);
+    _q6m.resize(N);
+    _neighbours.resize(N);
+
+    //Each chunk sums the harmonics of its own particles' bonds, the
+    //global sums are merged afterwards
+    const size_t chunks = Sim->parallelChunks(N * 100 * _Ylm.size());
+    std::vector<std::vector<std::complex<double> > > chunkcoeff(chunks, std::vector<std::complex<double> >(_Ylm.size()));
+    std::vector<size_t> chunkcount(chunks, 0);
+
+    Sim->parallelFor(chunks, [&](const size_t chunk) {
+	std::vector<std::complex<double> > Y(_Ylm.size()), sum(_Ylm.size());
+	std::vector<size_t> candidates;
+	for (size_t id1(N * chunk / chunks); id1 < N * (chunk + 1) / chunks; ++id1)
+	  {
+	    const Particle& part = Sim->particles[id1];
+	    candidates.clear();
+	    nblist.getParticleNeighbours(part, candidates);
+
+	    std::vector<size_t>& neighbours = _neighbours[id1];
+	    neighbours.clear();
+	    std::fill(sum.begin(), sum.end(), std::complex<double>(0, 0));
+	    for (const size_t id2 : candidates)
+	      {
+		if (id2 == id1) continue;
+		Vector rij = part.getPosition() - Sim->particles[id2].getPosition();
+		Sim->BCs->applyBC(rij);
+		const double norm = rij.nrm();
+		if ((norm > rg) || (norm == 0)) continue;
+
+		neighbours.push_back(id2);
+		_Ylm.evaluate(rij[0], rij[1], rij[2], Y.data());
+		for (size_t i(0); i < Y.size(); ++i)
+		  sum[i] += Y[i];
+	      }
+
+	    for (size_t i(0); i < sum.size(); ++i)
+	      chunkcoeff[chunk][i] += sum[i];
+	    chunkcount[chunk] += neighbours.size();
+
+	    LocalOrder& local = _local[id1];
+	    local.neighbours = neighbours.size();
+	    local.q4 = local.q6 = local.w6 = 0;
+	    std::array<std::complex<double>, 13>& q6m = _q6m[id1];
+	    q6m.fill(std::complex<double>(0, 0));
+	    if (neighbours.empty()) continue;
+
+	    double q4sum(0), q6sum(0);
+	    for (int m(-4); m <= 4; ++m)
+	      q4sum += std::norm(sum[magnet::math::SphericalHarmonics::index(4, m)]);
+	    for (int m(-6); m <= 6; ++m)
+	      q6sum += std::norm(sum[magnet::math::SphericalHarmonics::index(6, m)]);
+
+	    const double nb = neighbours.size();
+	    local.q4 = std::sqrt(q4sum * 4.0 * M_PI / 9.0) / nb;
+	    local.q6 = std::sqrt(q6sum * 4.0 * M_PI / 13.0) / nb;
+	    if (q6sum == 0) continue;
+
+	    //The normalised q6m vector, used for w6 and the connections
+	    const double q6norm = std::sqrt(q6sum);
+	    for (int m(-6); m <= 6; ++m)
+	      q6m[m + 6] = sum[magnet::math::SphericalHarmonics::index(6, m)] / q6norm;
+
+	    std::complex<double> w6(0, 0);
+	    for (int m1(-6); m1 <= 6; ++m1)
+	      for (int m2(std::max(-6, -6 - m1)); m2 <= std::min(6, 6 - m1); ++m2)
+		w6 += _w6coeff[(m1 + 6) * 13 + m2 + 6] * q6m[m1 + 6] * q6m[m2 + 6] * q6m[6 - m1 - m2];
+	    local.w6 = w6.real();
+	  }
+      });
+
+    //A pair of neighbours are connected if their q6m vectors are
+    //aligned
+    Sim->parallelFor(chunks, [&](const size_t chunk) {
+	for (size_t id1(N * chunk / chunks); id1 < N * (chunk + 1) / chunks; ++id1)
+	  {
+	    LocalOrder& local = _local[id1];
+	    local.connections = 0;
+	    for (const size_t id2 : _neighbours[id1])
+	      {
+		std::complex<double> d6(0, 0);
+		for (size_t m(0); m < 13; ++m)
+		  d6 += _q6m[id1][m] * std::conj(_q6m[id2][m]);
+		local.connections += (d6.real() > _solidThreshold);
+	      }
+	    local.solid = (local.connections >= _solidBonds);
+	  }
+      });
+
+    //Neighbouring solid particles are joined into clusters
+    std::vector<size_t> parent(N);
+    for (size_t id(0); id < N; ++id)
+      parent[id] = id;
+    auto root = [&](size_t id) {
+      while (parent[id] != id)
+	id = parent[id] = parent[parent[id]];
+      return id;
+    };
+
+    for (size_t id1(0); id1 < N; ++id1)
+      if (_local[id1].solid)
+	for (const size_t id2 : _neighbours[id1])
+	  if (_local[id2].solid)
+	    parent[root(id1)] = root(id2);
+
+    std::vector<size_t> clusterSize(N, 0);
+    _largestCluster = 0;
+    for (size_t id(0); id < N; ++id)
+      if (_local[id].solid)
+	_largestCluster = std::max(_largestCluster, ++clusterSize[root(id)]);
+
+    _configcoeff.assign(_Ylm.size(), std::complex<double>(0, 0));
+    _configcount = 0;
+    for (size_t chunk(0); chunk < chunks; ++chunk)
+      {
+	for (size_t i(0); i < _Ylm.size(); ++i)
+	  _configcoeff[i] += chunkcoeff[chunk][i];
+	_configcount += chunkcount[chunk];
+      }
+
+    return _largestCluster;
+  }
+
   void 
   OPSHCrystal::ticker()
   {
-    sphericalsum ssum(Sim, rg, maxl);
-  
-    for (const Particle& part : Sim->particles)
+    calculateLocalOrder();
+
+    for (size_t l(0); l < maxl; ++l)
+      for (int m(-l); m <= static_cast<int>(l); ++m)
+	globalcoeff[l][m+l] += _configcoeff[magnet::math::SphericalHarmonics::index(l, m)];
+    count += _configcount;
+
+    double q4(0), q6(0), w6(0);
+    size_t bonded(0), solid(0);
+    for (const LocalOrder& local : _local)
       {
-	std::unique_ptr<IDRange> ids(Sim->ptrScheduler->getParticleNeighbours(part));
-	for (const size_t& id1 : *ids)
-	  ssum(part, id1);
-      
-	for (size_t l(0); l < maxl; ++l)
-	  for (int m(-l); m <= static_cast<int>(l); ++m)
-	    globalcoeff[l][m+l] += ssum.coeffsum[l][m+l];
-      
-	count += ssum.count;
+	solid += local.solid;
+	if (!local.neighbours) continue;
+	++bonded;
+	q4 += local.q4;
+	q6 += local.q6;
+	w6 += local.w6;
+      }
 
-	ssum.clear();
+    ++_samples;
+    if (bonded)
+      {
+	_q4sum += q4 / bonded;
+	_q6sum += q6 / bonded;
+	_w6sum += w6 / bonded;
       }
+    _solidsum += double(solid) / Sim->N();
+    _clustersum += _largestCluster;
+    ++_clusterHistogram[_largestCluster];
   }
 
   void 
@@ -144,57 +316,24 @@ namespace dynamo {
 	    << magnet::xml::endtag("W");
       }
 
-    XML << magnet::xml::endtag("SHCrystal");
-  }
+    XML << magnet::xml::tag("LocalOrder")
+	<< magnet::xml::attr("Samples") << _samples
+	<< magnet::xml::attr("SolidThreshold") << _solidThreshold
+	<< magnet::xml::attr("SolidBonds") << _solidBonds
+	<< magnet::xml::attr("q4") << _q4sum / _samples
+	<< magnet::xml::attr("q6") << _q6sum / _samples
+	<< magnet::xml::attr("w6") << _w6sum / _samples
+	<< magnet::xml::attr("SolidFraction") << _solidsum / _samples
+	<< magnet::xml::attr("LargestCluster") << _clustersum / _samples;
 
-  OPSHCrystal::sphericalsum::sphericalsum
-  (const dynamo::Simulation * const nSim, const double& nrg, const size_t& nl):
-    Sim(nSim), rg(nrg), maxl(nl), count(0)
-  {
-    coeffsum.resize(maxl);
-    for (size_t l=0; l < maxl; ++l)
-      coeffsum[l].resize(2*l+1,std::complex<double>(0,0));
-  }
+    for (const auto& entry : _clusterHistogram)
+      XML << magnet::xml::tag("LargestClusterHistogram")
+	  << magnet::xml::attr("Size") << entry.first
+	  << magnet::xml::attr("Count") << entry.second
+	  << magnet::xml::endtag("LargestClusterHistogram");
 
-  void 
-  OPSHCrystal::sphericalsum::operator()
-    (const Particle& part, const size_t& ID) const
-  {
-    if (part.getID() == ID) return;
-    Vector rij = part.getPosition() - Sim->particles[ID].getPosition();
-    Sim->BCs->applyBC(rij);
-  
-    double norm = rij.nrm();
-    if (norm <= rg)
-      {
-	++count;
-	rij /= norm;
-	double theta = std::acos(rij[0]);
-	double sintheta = std::sin(theta);
-	double phi = rij[1] / sintheta;
-      
-	if (fabs(phi) > 1.0)
-	  phi = (phi > 0) ? 0.5 * M_PI : 1.5 * M_PI;
-	else
-	  phi = std::asin(phi);
-
-	if (std::sin(theta) == 0) phi = 0;
-      
-	if (phi < 0) phi += 2.0 * M_PI;
+    XML << magnet::xml::endtag("LocalOrder");
 
-	for (size_t l(0); l < maxl; ++l)
-	  for (int m(-l); m <= static_cast<int>(l); ++m)
-	    coeffsum[l][m+l] += boost::math::spherical_harmonic(l,m,theta,phi);
-      }
-  }
-
-  void
-  OPSHCrystal::sphericalsum::clear()
-  {
-    count = 0;
-
-    for (size_t l(0); l < maxl; ++l)
-      for (int m(-l); m <= static_cast<int>(l); ++m)
-	coeffsum[l][m+l] = std::complex<double>(0,0);
+    XML << magnet::xml::endtag("SHCrystal");
   }
 }
@@ -17,11 +17,37 @@
 
 #pragma once
 #include <dynamo/outputplugins/tickerproperty/ticker.hpp>
+#include <magnet/math/spherical_harmonics.hpp>
 #include <vector>
 #include <complex>
+#include <array>
+#include <map>
 
 namespace dynamo {
   class Particle;
+  class GNeighbourList;
+
+  /*! \brief Steinhardt bond-order analysis of the crystallinity of
+      the system.
+
+      The global \f$Q_l\f$ and \f$W_l\f$ are averaged over all
+      bonds shorter than the cut-off radius (CutOffR) for \f$l <\f$
+      MaxL.
+
+      The local bond order \f$q_4\f$, \f$q_6\f$ and
+      \f$\hat{w}_6\f$ of each particle is also calculated from its
+      own bonds. Following ten Wolde, Ruiz-Montero and Frenkel
+      [J. Chem. Phys. 104, 9932 (1996)], two neighbours are
+      connected if the normalised product of their \f$q_{6m}\f$ is
+      above SolidThreshold, and a particle with at least SolidBonds
+      connections is solid-like. Neighbouring solid particles form a
+      cluster, and the size of the largest cluster is both averaged
+      (with its histogram) and available as a reaction coordinate for
+      SysUmbrella.
+
+      All of these are calculated in parallel on the simulation's
+      thread pool (see Simulation::parallelFor()).
+   */
   class OPSHCrystal: public OPTicker
   {
   public:
@@ -37,9 +63,37 @@ namespace dynamo {
 
     virtual void operator<<(const magnet::xml::Node&);
 
-  protected:
+    /*! \brief The local bond order of a particle. */
+    struct LocalOrder
+    {
+      double q4;
+      double q6;
+      double w6;
+      size_t neighbours;
+      size_t connections;
+      bool solid;
+    };
+
+    /*! \brief Calculate the local bond order of every particle and
+        the solid clusters of the current configuration.
+
+	The particles must have been brought up to date (e.g., with
+	Dynamics::updateAllParticles()) first.
 
-    std::complex<double> localq(const Particle& part, int l, int m);
+	\return The size of the largest solid cluster.
+     */
+    size_t calculateLocalOrder();
+
+    /*! \brief The local bond order of each particle, from the last
+        call to calculateLocalOrder(). */
+    const std::vector<LocalOrder>& getLocalOrder() const { return _local; }
+
+    /*! \brief The size of the largest solid cluster, from the last
+        call to calculateLocalOrder(). */
+    size_t getLargestCluster() const { return _largestCluster; }
+
+  protected:
+    const GNeighbourList& neighbourList();
 
     //! Cut-off radius 
     double rg;
@@ -49,20 +103,26 @@ namespace dynamo {
   
     std::vector<std::vector<std::complex<double> > > globalcoeff;
 
-    struct sphericalsum
-    {
-      sphericalsum(const dynamo::Simulation * const, 
-		   const double&, const size_t&);
-    
-      void operator()(const Particle&, const size_t&) const;
-    
-      void clear();
-
-      const dynamo::Simulation* const Sim;
-      const double rg;
-      const size_t maxl;
-      mutable size_t count;
-      mutable std::vector<std::vector<std::complex<double> > > coeffsum;
-    };
+    magnet::math::SphericalHarmonics _Ylm;
+    //! The Wigner 3j symbols of the \f$\hat{w}_6\f$ sum, indexed by m1 and m2
+    std::vector<double> _w6coeff;
+    double _solidThreshold;
+    size_t _solidBonds;
+
+    std::vector<LocalOrder> _local;
+    std::vector<std::array<std::complex<double>, 13> > _q6m;
+    std::vector<std::vector<size_t> > _neighbours;
+    size_t _largestCluster;
+    //! The harmonic sums over the bonds of the last configuration
+    std::vector<std::complex<double> > _configcoeff;
+    size_t _configcount;
+
+    size_t _samples;
+    double _q4sum;
+    double _q6sum;
+    double _w6sum;
+    double _solidsum;
+    double _clustersum;
+    std::map<size_t, size_t> _clusterHistogram;
   };
 }
@@ -33,6 +33,8 @@ namespace dynamo {
 
     virtual void ticker();
 
+    virtual bool concurrentTicker() const { return true; }
+
     virtual void output(magnet::xml::XmlStream&);
   
   protected:
@@ -24,6 +24,7 @@
 #include <dynamo/outputplugins/tickerproperty/chainBondLength.hpp>
 #include <dynamo/outputplugins/tickerproperty/vel_dist.hpp>
 #include <dynamo/outputplugins/tickerproperty/radialdist.hpp>
+#include <dynamo/outputplugins/tickerproperty/structurefactor.hpp>
 #include <dynamo/outputplugins/tickerproperty/velprof.hpp>
 #include <dynamo/outputplugins/tickerproperty/msdcorrelator.hpp>
 #include <dynamo/outputplugins/tickerproperty/kenergyticker.hpp>
@@ -29,9 +29,7 @@ namespace dynamo {
 							     const magnet::xml::Node& XML):
     OPTicker(tmp,"MSDOrientationalCorrelator"),
     length(50),
-    currCorrLength(0),
-    ticksTaken(0),
-    notReady(true)
+    scaling(2)
   {
     operator<<(XML);
   }
@@ -41,80 +39,55 @@ namespace dynamo {
   {
     if (XML.hasAttribute("Length"))
       length = XML.getAttribute("Length").as<size_t>();
+
+    if (XML.hasAttribute("Scaling"))
+      scaling = XML.getAttribute("Scaling").as<size_t>();
   }
 
   void
   OPMSDOrientationalCorrelator::initialise()
   {
-    dout << "The length of the MSD orientational correlator is " << length << std::endl;
-
-    historicalData.resize(Sim->N(), boost::circular_buffer<RUpair>(length));
-
-    stepped_data_parallel.resize(length, double(0.0));
-    stepped_data_perpendicular.resize(length, double(0.0));
-    stepped_data_rotational_legendre1.resize(length, double(0.0));
-    stepped_data_rotational_legendre2.resize(length, double(0.0));
+    if (!Sim->dynamics->hasOrientationData())
+      M_throw() << "The MSDOrientationalCorrelator plugin requires particles with orientations";
 
-    // The Legendre polynomials are equal to 1 at t = 0
-    stepped_data_rotational_legendre1[0] = 1.0;
-    stepped_data_rotational_legendre2[0] = 1.0;
+    dout << "The MSD orientational correlator has " << length << " lags per level, with a scaling of " << scaling << std::endl;
 
-    currCorrLength = 1.0;
+    correlator.resize(Sim->N(), length, scaling);
+    stepped_data_parallel.clear();
+    stepped_data_perpendicular.clear();
+    stepped_data_rotational_legendre1.clear();
+    stepped_data_rotational_legendre2.clear();
 
-    const std::vector<Dynamics::rotData>& initial_rdat(Sim->dynamics->getCompleteRotData());
-
-    for (const Particle& part : Sim->particles)
-      {
-	historicalData[part.getID()].push_front(RUpair(part.getPosition(), initial_rdat[part.getID()].orientation * Quaternion::initialDirector()));
-      }
+    ticker();
   }
 
   void
   OPMSDOrientationalCorrelator::ticker()
   {
     const std::vector<Dynamics::rotData>& current_rdat(Sim->dynamics->getCompleteRotData());
-    for (const Particle& part : Sim->particles)
-      {
-	historicalData[part.getID()].push_front(RUpair(part.getPosition(), current_rdat[part.getID()].orientation * Quaternion::initialDirector()));
-      }
+    correlator.push([&](size_t ID) { return RUpair(Sim->particles[ID].getPosition(), current_rdat[ID].orientation * Quaternion::initialDirector()); });
 
-    if (notReady)
-      {
-	if (++currCorrLength != length)
-	  {
-	    return;
-	  }
+    stepped_data_parallel.resize(correlator.getLagCount(), 0.0);
+    stepped_data_perpendicular.resize(correlator.getLagCount(), 0.0);
+    stepped_data_rotational_legendre1.resize(correlator.getLagCount(), 0.0);
+    stepped_data_rotational_legendre2.resize(correlator.getLagCount(), 0.0);
 
-	notReady = false;
-      }
-
-    accPass();
-  }
+    auto accumulate = [&](size_t lag, size_t, const RUpair& origin, const RUpair& current)
+      {
+	//The displacement is projected onto the orientation at the time origin
+	const Vector displacement_term = current.first - origin.first;
+	const double longitudinal_projection = (displacement_term | origin.second);
+	const double cos_theta = (current.second | origin.second);
 
-  void
-  OPMSDOrientationalCorrelator::accPass()
-  {
-    ++ticksTaken;
+	stepped_data_parallel[lag] += std::pow(longitudinal_projection, 2);
+	stepped_data_perpendicular[lag] += (displacement_term - (longitudinal_projection * origin.second)).nrm2();
 
-    double longitudinal_projection(0.0), cos_theta(0.0);
-    Vector displacement_term{0,0,0};
+	double clamp_cos_theta = std::max(std::min(1.0, cos_theta), -1.0);
+	stepped_data_rotational_legendre1[lag] += boost::math::legendre_p(1, clamp_cos_theta);
+	stepped_data_rotational_legendre2[lag] += boost::math::legendre_p(2, clamp_cos_theta);
+      };
 
-    for (const Particle& part : Sim->particles)
-      {
-	for (size_t step(0); step < length; ++step)
-	  {
-	    displacement_term = historicalData[part.getID()][step].first - historicalData[part.getID()][0].first;
-	    longitudinal_projection = (displacement_term | historicalData[part.getID()][0].second);
-	    cos_theta = (historicalData[part.getID()][step].second | historicalData[part.getID()][0].second);
-
-	    stepped_data_parallel[step] += std::pow(longitudinal_projection, 2);
-	    stepped_data_perpendicular[step] += (displacement_term - (longitudinal_projection * historicalData[part.getID()][0].second)).nrm2();
-
-	    double clamp_cos_theta = std::max(std::min(1.0, cos_theta), -1.0);
-	    stepped_data_rotational_legendre1[step] += boost::math::legendre_p(1, clamp_cos_theta);
-	    stepped_data_rotational_legendre2[step] += boost::math::legendre_p(2, clamp_cos_theta);
-	  }
-      }
+    correlator.correlate(accumulate);
   }
 
   void
@@ -129,10 +102,10 @@ namespace dynamo {
 	<< magnet::xml::attr("Type") << "Parallel"
 	<< magnet::xml::chardata();
 
-    for (size_t step(0); step < length; ++step)
+    for (size_t i(0); i < correlator.getLagCount(); ++i)
       {
-	XML << dt * step << "\t"
-	    << stepped_data_parallel[step] / (static_cast<double>(ticksTaken) * static_cast<double>(Sim->N()) * Sim->units.unitArea())
+	XML << dt * correlator.getLag(i) << "\t"
+	    << stepped_data_parallel[i] / (static_cast<double>(correlator.getSampleCount(i)) * static_cast<double>(Sim->N()) * Sim->units.unitArea())
 	    << "\n";
       }
 
@@ -142,10 +115,10 @@ namespace dynamo {
 	<< magnet::xml::attr("Type") << "Perpendicular"
 	<< magnet::xml::chardata();
 
-    for (size_t step(0); step < length; ++step)
+    for (size_t i(0); i < correlator.getLagCount(); ++i)
       {
-	XML << dt * step << "\t"
-	    << stepped_data_perpendicular[step] / (static_cast<double>(ticksTaken) * static_cast<double>(Sim->N()) * Sim->units.unitArea())
+	XML << dt * correlator.getLag(i) << "\t"
+	    << stepped_data_perpendicular[i] / (static_cast<double>(correlator.getSampleCount(i)) * static_cast<double>(Sim->N()) * Sim->units.unitArea())
 	    << "\n";
       }
 
@@ -158,10 +131,10 @@ namespace dynamo {
 	<< magnet::xml::attr("Name") << "LegendrePolynomial1"
 	<< magnet::xml::chardata();
 
-    for (size_t step(0); step < length; ++step)
+    for (size_t i(0); i < correlator.getLagCount(); ++i)
       {
-	XML << dt * step << "\t"
-	    << stepped_data_rotational_legendre1[step] / (static_cast<double>(ticksTaken) * static_cast<double>(Sim->N()))
+	XML << dt * correlator.getLag(i) << "\t"
+	    << stepped_data_rotational_legendre1[i] / (static_cast<double>(correlator.getSampleCount(i)) * static_cast<double>(Sim->N()))
 	    << "\n";
       }
 
@@ -171,10 +144,10 @@ namespace dynamo {
 	<< magnet::xml::attr("Name") << "LegendrePolynomial2"
 	<< magnet::xml::chardata();
 
-    for (size_t step(0); step < length; ++step)
+    for (size_t i(0); i < correlator.getLagCount(); ++i)
       {
-	XML << dt * step << "\t"
-	    << stepped_data_rotational_legendre2[step] / (static_cast<double>(ticksTaken) * static_cast<double>(Sim->N()))
+	XML << dt * correlator.getLag(i) << "\t"
+	    << stepped_data_rotational_legendre2[i] / (static_cast<double>(correlator.getSampleCount(i)) * static_cast<double>(Sim->N()))
 	    << "\n";
       }
 
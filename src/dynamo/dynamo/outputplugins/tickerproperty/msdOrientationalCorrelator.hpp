@@ -17,7 +17,7 @@
 
 #pragma once
 #include <dynamo/outputplugins/tickerproperty/ticker.hpp>
-#include <boost/circular_buffer.hpp>
+#include <magnet/math/correlators.hpp>
 #include <magnet/math/vector.hpp>
 #include <vector>
 
@@ -40,16 +40,12 @@ namespace dynamo {
     virtual void stream(double) {}
     virtual void ticker();
 
-    void accPass();
-
-    std::vector<boost::circular_buffer<RUpair> > historicalData;
+    magnet::math::MultipleTauCorrelator<RUpair> correlator;
     std::vector<double> stepped_data_parallel, stepped_data_perpendicular,
 			   stepped_data_rotational_legendre1,
 			   stepped_data_rotational_legendre2;
 
     size_t length;
-    size_t currCorrLength;
-    size_t ticksTaken;
-    bool notReady;
+    size_t scaling;
   };
 }
@@ -28,9 +28,7 @@ namespace dynamo {
 				   const magnet::xml::Node& XML):
     OPTicker(tmp,"MSDCorrelator"),
     length(20),
-    currCorrLength(0),
-    ticksTaken(0),
-    notReady(true)
+    scaling(2)
   {
     operator<<(XML);
   }
@@ -40,77 +38,70 @@ namespace dynamo {
   {
     if (XML.hasAttribute("Length"))
       length = XML.getAttribute("Length").as<size_t>();
+
+    if (XML.hasAttribute("Scaling"))
+      scaling = XML.getAttribute("Scaling").as<size_t>();
   }
 
   void 
   OPMSDCorrelator::initialise()
   {
-    dout << "The length of the MSD correlator is " << length << std::endl;
-    posHistory.resize(Sim->N(), boost::circular_buffer<Vector>(length));
-    currCorrLength=1;
+    dout << "The MSD correlator has " << length << " lags per level, with a scaling of " << scaling << std::endl;
 
+    speciesIDs.resize(Sim->N());
     for (const Particle& part : Sim->particles)
-      posHistory[part.getID()].push_front(part.getPosition());
+      speciesIDs[part.getID()] = Sim->species(part)->getID();
+
+    molecules.clear();
+    for (const shared_ptr<Topology>& topo : Sim->topology)
+      for (const shared_ptr<IDRange>& range : topo->getMolecules())
+	molecules.push_back(std::make_pair(range, topo->getID()));
 
-    speciesData.resize(Sim->species.size(), std::vector<double>(length, 0.0));
-    structData.resize(Sim->topology.size(), std::vector<double>(length, 0.0));
+    correlator.resize(Sim->N() + molecules.size(), length, scaling);
+    speciesData.assign(Sim->species.size(), std::vector<double>());
+    structData.assign(Sim->topology.size(), std::vector<double>());
+
+    ticker();
   }
 
-  void 
-  OPMSDCorrelator::ticker()
+  Vector
+  OPMSDCorrelator::getPosition(size_t channel) const
   {
-    for (const Particle& part : Sim->particles)
-      posHistory[part.getID()].push_front(part.getPosition());
-  
-    if (notReady)
+    if (channel < Sim->N())
+      return Sim->particles[channel].getPosition();
+
+    Vector molCOM({0,0,0});
+    double molMass(0);
+    for (const size_t& ID : *molecules[channel - Sim->N()].first)
       {
-	if (++currCorrLength != length)
-	  return;
-      
-	notReady = false;
+	double mass = Sim->species(Sim->particles[ID])->getMass(ID);
+	molCOM += Sim->particles[ID].getPosition() * mass;
+	molMass += mass;
       }
-  
-    accPass();
+
+    return molCOM / molMass;
   }
 
-  void
-  OPMSDCorrelator::accPass()
+  void 
+  OPMSDCorrelator::ticker()
   {
-    ++ticksTaken;
-  
-    for (const shared_ptr<Species>& sp : Sim->species)
-      for (const size_t& ID : *sp->getRange())
-      for (size_t step(1); step < length; ++step)
-	speciesData[sp->getID()][step] += (posHistory[ID][step] - posHistory[ID][0]).nrm2();
-  
-    for (const shared_ptr<Topology>& topo : Sim->topology)
-      for (const shared_ptr<IDRange>& range : topo->getMolecules())
+    correlator.push([&](size_t channel) { return getPosition(channel); });
+
+    for (std::vector<double>& data : speciesData)
+      data.resize(correlator.getLagCount(), 0.0);
+    for (std::vector<double>& data : structData)
+      data.resize(correlator.getLagCount(), 0.0);
+
+    const size_t N = Sim->N();
+    auto accumulate = [&](size_t lag, size_t channel, const Vector& origin, const Vector& current)
       {
-	Vector  molCOM({0,0,0});
-	double molMass(0);
-
-	for (const size_t& ID : *range)
-	  {
-	    double mass = Sim->species[Sim->particles[ID]]->getMass(ID);
-	    molCOM += posHistory[ID][0] * mass;
-	    molMass += mass;
-	  }
-
-	molCOM /= molMass;
-
-	for (size_t step(1); step < length; ++step)
-	  {
-	    Vector  molCOM2({0,0,0});
-	  
-	    for (const size_t& ID : *range)
-	      molCOM2 += posHistory[ID][step] 
-	      * Sim->species[Sim->particles[ID]]->getMass(ID);
-	  
-	    molCOM2 /= molMass;
-	  
-	    structData[topo->getID()][step] += (molCOM2 - molCOM).nrm2();
-	  }
-      }
+	if (channel < N)
+	  speciesData[speciesIDs[channel]][lag] += (current - origin).nrm2();
+	else
+	  structData[molecules[channel - N].second][lag] += (current - origin).nrm2();
+      };
+
+    correlator.correlate(accumulate);
   }
 
   void
@@ -130,10 +121,10 @@ namespace dynamo {
 	    << sp->getName()
 	    << magnet::xml::chardata();
       
-	for (size_t step(0); step < length; ++step)
-	  XML << dt * step << " "
-	      << speciesData[sp->getID()][step] 
-	    / (static_cast<double>(ticksTaken) 
+	for (size_t i(0); i < correlator.getLagCount(); ++i)
+	  XML << dt * correlator.getLag(i) << " "
+	      << speciesData[sp->getID()][i] 
+	    / (static_cast<double>(correlator.getSampleCount(i)) 
 	       * static_cast<double>(sp->getCount())
 	       * Sim->units.unitArea())
 	      << "\n";
@@ -151,10 +142,10 @@ namespace dynamo {
 	    << topo->getName()
 	    << magnet::xml::chardata();
       
-	for (size_t step(0); step < length; ++step)
-	  XML << dt * step << " "
-	      << structData[topo->getID()][step]
-	    / (static_cast<double>(ticksTaken) 
+	for (size_t i(0); i < correlator.getLagCount(); ++i)
+	  XML << dt * correlator.getLag(i) << " "
+	      << structData[topo->getID()][i]
+	    / (static_cast<double>(correlator.getSampleCount(i)) 
 	       * static_cast<double>(topo->getMolecules().size())
 	       * Sim->units.unitArea())
 	      << "\n";
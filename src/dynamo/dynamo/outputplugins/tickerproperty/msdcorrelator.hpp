@@ -17,11 +17,20 @@
 
 #pragma once
 #include <dynamo/outputplugins/tickerproperty/ticker.hpp>
-#include <boost/circular_buffer.hpp>
+#include <magnet/math/correlators.hpp>
 #include <magnet/math/vector.hpp>
 #include <vector>
 
 namespace dynamo {
+  /*! \brief Collects the mean square displacement of the species
+      and the molecules (centre of mass) of the topologies.
+
+      The MSD is collected using a multiple-tau correlator (see
+      magnet::math::MultipleTauCorrelator), giving logarithmically
+      spaced lag times. The Length attribute sets the number of lags
+      per level and the Scaling attribute the ratio of the lag
+      spacing of successive levels.
+   */
   class OPMSDCorrelator: public OPTicker
   {
   public:
@@ -37,14 +46,18 @@ namespace dynamo {
     virtual void stream(double) {}
     virtual void ticker();
 
-    void accPass();
+    virtual bool concurrentTicker() const { return true; }
 
-    std::vector<boost::circular_buffer<Vector> > posHistory;
+    Vector getPosition(size_t channel) const;
+
+    magnet::math::MultipleTauCorrelator<Vector> correlator;
+    //! The species ID of each particle channel
+    std::vector<size_t> speciesIDs;
+    //! The molecules (and their topology ID) sampled after the particles
+    std::vector<std::pair<shared_ptr<IDRange>, size_t> > molecules;
     std::vector<std::vector<double> > speciesData;
     std::vector<std::vector<double> > structData;
     size_t length;
-    size_t currCorrLength;
-    size_t ticksTaken;
-    bool notReady;
+    size_t scaling;
   };
 }
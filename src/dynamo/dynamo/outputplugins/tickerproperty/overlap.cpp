@@ -19,35 +19,170 @@
 #include <dynamo/include.hpp>
 #include <dynamo/simulation.hpp>
 #include <dynamo/dynamics/dynamics.hpp>
+#include <dynamo/schedulers/scheduler.hpp>
+#include <magnet/xmlwriter.hpp>
+#include <magnet/xmlreader.hpp>
+#include <algorithm>
+#include <cmath>
 
 namespace dynamo {
   OPOverlapTest::OPOverlapTest(const dynamo::Simulation* tmp, 
-			       const magnet::xml::Node&):
-    OPTicker(tmp,"OverlapTester")
-  {}
+			       const magnet::xml::Node& XML):
+    OPTicker(tmp,"OverlapTester"),
+    _max_reports(20),
+    _ticks(0),
+    _invalid_ticks(0),
+    _brute_force(false)
+  { operator<<(XML); }
 
+  void 
+  OPOverlapTest::operator<<(const magnet::xml::Node& XML)
+  {
+    if (XML.hasAttribute("MaxReports"))
+      _max_reports = XML.getAttribute("MaxReports").as<size_t>();
+
+    if (XML.hasAttribute("BruteForce"))
+      _brute_force = true;
+  }
 
   void 
   OPOverlapTest::initialise()
   {
     dout << "Testing for overlaps in starting configuration" << std::endl;
-    ticker();
+    _ticks = 0;
+    _invalid_ticks = 0;
+    _initial = check();
   }
 
   void
-  OPOverlapTest::output(magnet::xml::XmlStream&)
+  OPOverlapTest::output(magnet::xml::XmlStream& XML)
   {
     dout << "Testing for overlaps in output configuration" << std::endl;
-    ticker();
+    Sim->dynamics->updateAllParticles();
+    const Report final = check();
+
+    XML << magnet::xml::tag("OverlapTester")
+	<< magnet::xml::attr("Ticks") << _ticks
+	<< magnet::xml::attr("InvalidTicks") << _invalid_ticks;
+    writeReport(XML, "Initial", _initial);
+    writeReport(XML, "Final", final);
+    XML << magnet::xml::endtag("OverlapTester");
   }
 
   void 
   OPOverlapTest::ticker()
   {
-    for (std::vector<Particle>::const_iterator iPtr = Sim->particles.begin();
-	 iPtr != Sim->particles.end(); ++iPtr)
-      for (std::vector<Particle>::const_iterator jPtr = iPtr + 1;
-	   jPtr != Sim->particles.end(); ++jPtr)
-	Sim->getInteraction(*iPtr, *jPtr)->validateState(*iPtr, *jPtr);
+    ++_ticks;
+    if (check()._count)
+      ++_invalid_ticks;
+  }
+
+  OPOverlapTest::Report
+  OPOverlapTest::check() const
+  {
+    const size_t N = Sim->particles.size();
+    //The closest reports are kept, but at least one is needed to
+    //find the worst pair
+    const size_t kept = std::max(_max_reports, size_t(1));
+    auto closer = [](const Overlap& a, const Overlap& b) { return a._distance < b._distance; };
+
+    //Each chunk checks a contiguous range of the first particle of
+    //the pairs, keeping a max-heap of its closest invalid pairs
+    auto checkRange = [&](const size_t begin, const size_t end, Report& report) {
+      auto checkPair = [&](const Particle& p1, const Particle& p2) {
+	++report._pairs;
+	if (!Sim->getInteraction(p1, p2)->validateState(p1, p2, false)) return;
+	++report._count;
+	report._overlaps.push_back(Overlap{p1.getID(), p2.getID(), Sim->BCs->getDistance(p1, p2)});
+	std::push_heap(report._overlaps.begin(), report._overlaps.end(), closer);
+	if (report._overlaps.size() > kept)
+	  {
+	    std::pop_heap(report._overlaps.begin(), report._overlaps.end(), closer);
+	    report._overlaps.pop_back();
+	  }
+      };
+
+      for (size_t id1(begin); id1 < end; ++id1)
+	{
+	  const Particle& p1 = Sim->particles[id1];
+	  if (_brute_force)
+	    for (size_t id2(id1 + 1); id2 < N; ++id2)
+	      checkPair(p1, Sim->particles[id2]);
+	  else
+	    {
+	      std::unique_ptr<IDRange> ids(Sim->ptrScheduler->getParticleNeighbours(p1));
+	      for (const size_t id2 : *ids)
+		if (id2 > id1)
+		  checkPair(p1, Sim->particles[id2]);
+	    }
+	}
+    };
+
+    const size_t work = _brute_force ? N * N / 2 : N * 100;
+    const size_t chunks = Sim->parallelChunks(work);
+
+    //The brute force ranges are balanced by the number of pairs
+    //rather than the number of particles
+    auto split = [&](const size_t c) -> size_t {
+      if (!_brute_force) return (N * c) / chunks;
+      return N - size_t(N * std::sqrt(double(chunks - c) / chunks));
+    };
+
+    std::vector<Report> reports(chunks);
+    Sim->parallelFor(chunks, [&](const size_t chunk) {
+	checkRange(split(chunk), split(chunk + 1), reports[chunk]);
+      });
+
+    Report retval;
+    retval._time = Sim->systemTime;
+    for (const Report& report : reports)
+      {
+	retval._pairs += report._pairs;
+	retval._count += report._count;
+	retval._overlaps.insert(retval._overlaps.end(), report._overlaps.begin(), report._overlaps.end());
+      }
+
+    std::sort(retval._overlaps.begin(), retval._overlaps.end(), closer);
+    if (retval._overlaps.size() > kept)
+      retval._overlaps.resize(kept);
+
+    if (retval._count)
+      {
+	derr << retval._count << " invalid pairs found out of the " << retval._pairs << " checked, the closest are:" << std::endl;
+	for (size_t i(0); i < std::min(retval._overlaps.size(), _max_reports); ++i)
+	  {
+	    const Overlap& overlap = retval._overlaps[i];
+	    const Particle& p1 = Sim->particles[overlap._p1];
+	    const Particle& p2 = Sim->particles[overlap._p2];
+	    Sim->getInteraction(p1, p2)->validateState(p1, p2, true);
+	  }
+      }
+
+    return retval;
+  }
+
+  void
+  OPOverlapTest::writeReport(magnet::xml::XmlStream& XML, const std::string& name, const Report& report) const
+  {
+    XML << magnet::xml::tag(name)
+	<< magnet::xml::attr("Time") << report._time / Sim->units.unitTime()
+	<< magnet::xml::attr("PairsChecked") << report._pairs
+	<< magnet::xml::attr("Count") << report._count;
+
+    if (report._count)
+      XML << magnet::xml::attr("WorstDistance") << report._overlaps.front()._distance / Sim->units.unitLength();
+
+    for (size_t i(0); i < std::min(report._overlaps.size(), _max_reports); ++i)
+      {
+	const Overlap& overlap = report._overlaps[i];
+	XML << magnet::xml::tag("Pair")
+	    << magnet::xml::attr("ID1") << overlap._p1
+	    << magnet::xml::attr("ID2") << overlap._p2
+	    << magnet::xml::attr("Interaction") << Sim->getInteraction(Sim->particles[overlap._p1], Sim->particles[overlap._p2])->getName()
+	    << magnet::xml::attr("Distance") << overlap._distance / Sim->units.unitLength()
+	    << magnet::xml::endtag("Pair");
+      }
+
+    XML << magnet::xml::endtag(name);
   }
 }
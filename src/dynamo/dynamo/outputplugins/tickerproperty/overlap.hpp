@@ -18,8 +18,21 @@
 #pragma once
 
 #include <dynamo/outputplugins/tickerproperty/ticker.hpp>
+#include <string>
+#include <vector>
 
 namespace dynamo {
+  /*! \brief Checks the state of every particle pair for invalid
+    states (e.g., overlapping hard cores) at the start and end of the
+    simulation and on every tick.
+
+    Only the pairs of particles which are neighbours in the
+    scheduler's neighbour list are checked, unless the BruteForce
+    flag is set. The checks are split across the simulation's
+    thread pool for large systems. The invalid pairs of the initial and final
+    configurations are reported in the output, closest first, up to
+    MaxReports pairs each (default 20).
+   */
   class OPOverlapTest: public OPTicker
   {
   public:
@@ -33,6 +46,37 @@ namespace dynamo {
   
     virtual void output(magnet::xml::XmlStream&);
 
+    void operator<<(const magnet::xml::Node&);
+
   protected:
+    struct Overlap
+    {
+      size_t _p1;
+      size_t _p2;
+      double _distance;
+    };
+
+    struct Report
+    {
+      Report(): _time(0), _pairs(0), _count(0) {}
+      double _time;
+      //! The number of pairs which were checked
+      size_t _pairs;
+      //! The number of invalid pairs
+      size_t _count;
+      //! The closest invalid pairs (at least one and up to MaxReports), closest first
+      std::vector<Overlap> _overlaps;
+    };
+
+    //! \brief Check the current configuration.
+    Report check() const;
+
+    void writeReport(magnet::xml::XmlStream&, const std::string& name, const Report&) const;
+
+    Report _initial;
+    size_t _max_reports;
+    size_t _ticks;
+    size_t _invalid_ticks;
+    bool _brute_force;
   };
 }
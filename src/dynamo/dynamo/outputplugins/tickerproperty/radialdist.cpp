@@ -18,8 +18,13 @@
 #include <dynamo/outputplugins/tickerproperty/radialdist.hpp>
 #include <dynamo/outputplugins/misc.hpp>
 #include <dynamo/include.hpp>
+#include <dynamo/BC/PBC.hpp>
 #include <magnet/xmlwriter.hpp>
 #include <magnet/xmlreader.hpp>
+#include <magnet/containers/ordering.hpp>
+#include <algorithm>
+#include <cmath>
+#include <typeinfo>
 
 namespace dynamo {
   OPRadialDistribution::OPRadialDistribution(const dynamo::Simulation* tmp, 
@@ -29,7 +34,8 @@ namespace dynamo {
     length(100),
     sampleCount(0),
     sample_energy(0),
-    sample_energy_bin_width(0)
+    sample_energy_bin_width(0),
+    bruteForce(false)
   { operator<<(XML); }
 
   void 
@@ -47,8 +53,10 @@ namespace dynamo {
             pairIDs.push_back(sp->getID());
           if (sp->getName() == pairstrings[1])
             pairIDs.push_back(sp->getID());
-          rdfpairs.push_back(std::make_pair(pairIDs[0],pairIDs[1]));
         }
+        if (pairIDs.size() != 2)
+          M_throw() << "Could not find the species of the rdfpairs \"" << pairval << "\"";
+        rdfpairs.push_back(std::make_pair(pairIDs[0],pairIDs[1]));
       }
       else {
         for (const shared_ptr<Species>& sp1 : Sim->species)
@@ -74,6 +82,9 @@ namespace dynamo {
         length = 2 + static_cast<size_t>(Sim->primaryCellSize[mindir] / (2 * binWidth));
       }
 
+      if (XML.hasAttribute("BruteForce"))
+        bruteForce = true;
+
       if (XML.hasAttribute("SampleEnergy")) {
         sample_energy = XML.getAttribute("SampleEnergy").as<double>() 
           * Sim->units.unitEnergy();
@@ -129,23 +140,134 @@ namespace dynamo {
       }
     
     ++sampleCount;
-  
-    for (const shared_ptr<Species>& sp1 : Sim->species)
-      for (const shared_ptr<Species>& sp2 : Sim->species)
-        for (std::pair<unsigned int, unsigned int> pairI : rdfpairs)
-        {
-          if (sp1->getID() == std::get<0>(pairI) && sp2->getID() == std::get<1>(pairI))
-          {
-            for (const size_t& p1 : *sp1->getRange())
-           	for (const size_t& p2 : *sp2->getRange())
-           	{
-           	  Vector  rij = Sim->particles[p1].getPosition() - Sim->particles[p2].getPosition();
-           	  Sim->BCs->applyBC(rij);
-           	  const size_t i = static_cast<size_t>(rij.nrm() / binWidth + 0.5);
-           	  if (i < length) ++data[sp1->getID()][sp2->getID()][i];
-           	}
-          }
-        }
+
+    //The grid must have at least three cells in each dimension, or
+    //the neighbouring cells of a cell are not distinct. The cells
+    //are wider than the sampled distance, so all sampled pairs are
+    //in neighbouring cells.
+    std::array<size_t, 3> cells;
+    bool useCells = !bruteForce && (typeid(*Sim->BCs) == typeid(BCPeriodic));
+    for (size_t iDim(0); iDim < NDIM; ++iDim)
+      {
+	cells[iDim] = static_cast<size_t>(Sim->primaryCellSize[iDim] / (length * binWidth));
+	useCells &= (cells[iDim] >= 3);
+      }
+
+    for (const std::pair<unsigned int, unsigned int>& pairI : rdfpairs)
+      {
+	const Species& sp1 = *Sim->species[pairI.first];
+	const Species& sp2 = *Sim->species[pairI.second];
+	if (useCells)
+	  sampleCells(sp1, sp2, cells, data[pairI.first][pairI.second]);
+	else
+	  sampleBruteForce(sp1, sp2, data[pairI.first][pairI.second]);
+      }
+  }
+
+  void
+  OPRadialDistribution::parallelSample(const size_t size, const size_t work, const std::function<void(size_t, size_t, std::vector<unsigned long>&)>& func, std::vector<unsigned long>& histogram) const
+  {
+    const size_t chunks = Sim->parallelChunks(work);
+    if (chunks == 1)
+      return func(0, size, histogram);
+
+    std::vector<std::vector<unsigned long> > histograms(chunks, std::vector<unsigned long>(length, 0));
+    Sim->parallelFor(chunks, [&](const size_t chunk) {
+	func((size * chunk) / chunks, (size * (chunk + 1)) / chunks, histograms[chunk]);
+      });
+
+    for (const std::vector<unsigned long>& chunkHistogram : histograms)
+      for (size_t i(0); i < length; ++i)
+	histogram[i] += chunkHistogram[i];
+  }
+
+  void
+  OPRadialDistribution::sampleBruteForce(const Species& species1, const Species& species2, std::vector<unsigned long>& histogram) const
+  {
+    const IDRange& range1 = *species1.getRange();
+    std::vector<Vector> positions2;
+    positions2.reserve(species2.getCount());
+    for (const size_t& p2 : *species2.getRange())
+      positions2.push_back(Sim->particles[p2].getPosition());
+
+    //Pairs beyond this distance are not binned, so the square root
+    //can be skipped. It is half a bin beyond the last bin edge.
+    const double maxDist2 = length * binWidth * length * binWidth;
+
+    parallelSample(range1.size(), range1.size() * positions2.size(), [&](size_t begin, size_t end, std::vector<unsigned long>& hist) {
+	for (size_t id1(begin); id1 < end; ++id1)
+	  {
+	    const Vector& pos1 = Sim->particles[range1[id1]].getPosition();
+	    for (const Vector& pos2 : positions2)
+	      {
+		Vector rij = pos1 - pos2;
+		Sim->BCs->applyBC(rij);
+		const double r2 = rij.nrm2();
+		if (r2 >= maxDist2) continue;
+		const size_t i = static_cast<size_t>(std::sqrt(r2) / binWidth + 0.5);
+		if (i < length) ++hist[i];
+	      }
+	  }
+      }, histogram);
+  }
+
+  void
+  OPRadialDistribution::sampleCells(const Species& species1, const Species& species2, const std::array<size_t, 3>& cells, std::vector<unsigned long>& histogram) const
+  {
+    const magnet::containers::RowMajorOrdering<3> ordering(cells);
+
+    auto getCellCoords = [&](Vector pos) {
+      Sim->BCs->applyBC(pos);
+      std::array<size_t, 3> coords;
+      for (size_t iDim(0); iDim < NDIM; ++iDim)
+	{
+	  const long coord = std::floor((pos[iDim] / Sim->primaryCellSize[iDim] + 0.5) * cells[iDim]);
+	  //Rounding can place a particle on the far edge of the box
+	  coords[iDim] = std::min(std::max(coord, 0l), long(cells[iDim] - 1));
+	}
+      return coords;
+    };
+
+    //Counting sort of species2 by cell, keeping the positions
+    //together for locality
+    const IDRange& range2 = *species2.getRange();
+    std::vector<size_t> particleCells(range2.size());
+    std::vector<size_t> cellStart(ordering.length() + 1, 0);
+    for (size_t i(0); i < range2.size(); ++i)
+      {
+	particleCells[i] = ordering.toIndex(getCellCoords(Sim->particles[range2[i]].getPosition()));
+	++cellStart[particleCells[i] + 1];
+      }
+    
+    for (size_t cell(0); cell < ordering.length(); ++cell)
+      cellStart[cell + 1] += cellStart[cell];
+
+    std::vector<Vector> positions2(range2.size());
+    {
+      std::vector<size_t> next(cellStart.begin(), cellStart.end() - 1);
+      for (size_t i(0); i < range2.size(); ++i)
+	positions2[next[particleCells[i]]++] = Sim->particles[range2[i]].getPosition();
+    }
+
+    const double maxDist2 = length * binWidth * length * binWidth;
+    const IDRange& range1 = *species1.getRange();
+
+    parallelSample(range1.size(), 27 * range1.size() * (range2.size() / ordering.length() + 1), [&](size_t begin, size_t end, std::vector<unsigned long>& hist) {
+	for (size_t id1(begin); id1 < end; ++id1)
+	  {
+	    const Vector& pos1 = Sim->particles[range1[id1]].getPosition();
+	    for (const size_t cell : ordering.getSurroundingIndices(getCellCoords(pos1), std::array<size_t, 3>{{1, 1, 1}}))
+	      for (size_t j(cellStart[cell]); j < cellStart[cell + 1]; ++j)
+		{
+		  Vector rij = pos1 - positions2[j];
+		  Sim->BCs->applyBC(rij);
+		  const double r2 = rij.nrm2();
+		  if (r2 >= maxDist2) continue;
+		  const size_t i = static_cast<size_t>(std::sqrt(r2) / binWidth + 0.5);
+		  if (i < length) ++hist[i];
+		}
+	  }
+      }, histogram);
   }
 
   std::vector<std::pair<double, double> > 
@@ -19,10 +19,24 @@
 
 #include <dynamo/outputplugins/tickerproperty/ticker.hpp>
 #include <magnet/math/histogram.hpp>
+#include <array>
+#include <functional>
 #include <vector>
 #include <boost/algorithm/string.hpp>
 
 namespace dynamo {
+  class Species;
+
+  /*! \brief Samples the radial distribution function, g(r), of the
+    species pairs.
+
+    For periodic systems where the sampled distance (Length *
+    BinWidth) is under a third of the box, only the nearby pairs are
+    visited using a temporary cell grid. Otherwise (or if the
+    BruteForce flag is set) every pair is visited. Both methods give
+    identical histograms, and the sampling is split across the
+    simulation's thread pool for large systems.
+   */
   class OPRadialDistribution: public OPTicker
   {
   public:
@@ -42,6 +56,28 @@ namespace dynamo {
     std::vector<std::pair<double, double> > getgrdata(size_t species1ID, size_t species2ID) const;
     double getBinWidth() const { return binWidth; }
   protected:
+    /*! \brief Adds the distances of every species1-species2 pair to
+      the histogram.
+    */
+    void sampleBruteForce(const Species& species1, const Species& species2, std::vector<unsigned long>& histogram) const;
+
+    /*! \brief Adds the distances of the species1-species2 pairs
+      which are in neighbouring cells of a grid to the histogram.
+
+      \param cells The number of cells in each dimension, which must
+      be at least 3 and give cells wider than the sampled distance.
+    */
+    void sampleCells(const Species& species1, const Species& species2, const std::array<size_t, 3>& cells, std::vector<unsigned long>& histogram) const;
+
+    /*! \brief Runs func(begin, end, histogram) over [0, size) split
+      into chunks on the Simulation::threadPool, summing the
+      per-chunk histograms into histogram.
+
+      \param work An estimate of the pairs to be visited (see
+      Simulation::parallelChunks()).
+     */
+    void parallelSample(const size_t size, const size_t work, const std::function<void(size_t, size_t, std::vector<unsigned long>&)>& func, std::vector<unsigned long>& histogram) const;
+
     double binWidth;
     size_t length;
     unsigned long sampleCount;
@@ -49,5 +85,6 @@ namespace dynamo {
     double sample_energy_bin_width;
     std::vector<std::pair<unsigned int, unsigned int>> rdfpairs;
     std::vector<std::vector<std::vector<unsigned long> > > data;
+    bool bruteForce;
   };
 }
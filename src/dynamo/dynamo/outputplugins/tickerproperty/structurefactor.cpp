@@ -0,0 +1,339 @@
+/*  dynamo:- Event driven molecular dynamics simulator 
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <dynamo/outputplugins/tickerproperty/structurefactor.hpp>
+#include <dynamo/include.hpp>
+#include <dynamo/BC/PBC.hpp>
+#include <magnet/math/fft.hpp>
+#include <magnet/xmlwriter.hpp>
+#include <magnet/xmlreader.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <typeinfo>
+
+namespace dynamo {
+  OPStructureFactor::OPStructureFactor(const dynamo::Simulation* tmp,
+				       const magnet::xml::Node& XML):
+    OPTicker(tmp,"StructureFactor"),
+    method(AUTO),
+    binWidth(0),
+    maxK(15),
+    gridSize(0),
+    maxGrid(128),
+    length(0),
+    sampleCount(0)
+  { operator<<(XML); }
+
+  void
+  OPStructureFactor::operator<<(const magnet::xml::Node& XML)
+  {
+    try {
+      if (XML.hasAttribute("Method"))
+	{
+	  const std::string name = XML.getAttribute("Method").as<std::string>();
+	  if (name == "Auto")
+	    method = AUTO;
+	  else if (name == "Direct")
+	    method = DIRECT;
+	  else if (name == "FFT")
+	    method = FFT;
+	  else
+	    M_throw() << "Unknown structure factor Method \"" << name << "\", must be Auto, Direct or FFT";
+	}
+
+      if (XML.hasAttribute("MaxK"))
+	maxK = XML.getAttribute("MaxK").as<double>();
+      maxK /= Sim->units.unitLength();
+
+      if (XML.hasAttribute("BinWidth"))
+	binWidth = XML.getAttribute("BinWidth").as<double>() / Sim->units.unitLength();
+
+      if (XML.hasAttribute("Grid"))
+	{
+	  gridSize = XML.getAttribute("Grid").as<size_t>();
+	  if (!gridSize || (gridSize & (gridSize - 1)))
+	    M_throw() << "The structure factor Grid must be a power of two";
+	}
+
+      if (XML.hasAttribute("MaxGrid"))
+	{
+	  maxGrid = XML.getAttribute("MaxGrid").as<size_t>();
+	  if ((maxGrid < 2) || (maxGrid & (maxGrid - 1)))
+	    M_throw() << "The structure factor MaxGrid must be a power of two";
+	}
+    }
+    catch (std::exception& excep) {
+      M_throw() << "Error while parsing output plugin options\n" << excep.what();
+    }
+  }
+
+  void
+  OPStructureFactor::initialise()
+  {
+    if (typeid(*Sim->BCs) != typeid(BCPeriodic))
+      M_throw() << "The structure factor can only be sampled with periodic boundary conditions";
+
+    //Default to the spacing of the wavevectors of the largest box
+    //dimension
+    if (!binWidth)
+      binWidth = 2 * M_PI / *std::max_element(Sim->primaryCellSize.begin(), Sim->primaryCellSize.end());
+
+    //The mesh is chosen so that the Nyquist wavenumber is at least
+    //twice MaxK, as the aliasing errors of the cloud-in-cell
+    //assignment grow as the Nyquist wavenumber is approached.
+    const Vector& L = Sim->primaryCellSize;
+    bool fits = true;
+    for (size_t iDim(0); iDim < NDIM; ++iDim)
+      if (gridSize)
+	meshDims[iDim] = gridSize;
+      else
+	{
+	  meshDims[iDim] = 2;
+	  while (meshDims[iDim] * M_PI / L[iDim] < 2 * maxK)
+	    meshDims[iDim] <<= 1;
+	  fits = fits && (meshDims[iDim] <= maxGrid);
+	}
+
+    if (method == AUTO)
+      {
+	//Compare the operations of the two methods. The Direct method
+	//sums every particle for half of the wavevectors in the
+	//sphere of radius maxK. The FFT is only used if its mesh fits
+	//in MaxGrid, so that MaxK is never lowered automatically.
+	const double kvectors = (4.0 / 3.0) * M_PI * maxK * maxK * maxK * Sim->getSimVolume() / std::pow(2 * M_PI, 3);
+	const double meshSize = double(meshDims[0]) * meshDims[1] * meshDims[2];
+	const double fftWork = meshSize * std::log2(meshSize) + 8.0 * Sim->N();
+	method = (fits && (fftWork < 0.5 * Sim->N() * kvectors)) ? FFT : DIRECT;
+      }
+
+    if (method == FFT)
+      {
+	if (!fits)
+	  for (size_t iDim(0); iDim < NDIM; ++iDim)
+	    meshDims[iDim] = std::min(meshDims[iDim], maxGrid);
+
+	//The largest wavenumber the mesh can sample. This is half
+	//the Nyquist wavenumber, unless the Grid was set explicitly.
+	const double fraction = gridSize ? 1 : 0.5;
+	double meshK = std::numeric_limits<double>::infinity();
+	for (size_t iDim(0); iDim < NDIM; ++iDim)
+	  meshK = std::min(meshK, fraction * meshDims[iDim] * M_PI / L[iDim]);
+
+	if (meshK < maxK)
+	  {
+	    derr << "The mesh of " << meshDims[0] << "x" << meshDims[1] << "x" << meshDims[2]
+		 << " cannot sample up to MaxK=" << maxK * Sim->units.unitLength()
+		 << ", lowering MaxK to " << meshK * Sim->units.unitLength()
+		 << " (increase MaxGrid or use the Direct method)" << std::endl;
+	    maxK = meshK;
+	  }
+
+	mesh.assign(meshDims[0] * meshDims[1] * meshDims[2], 0);
+      }
+    else
+      mesh.clear();
+
+    length = static_cast<size_t>(maxK / binWidth) + 2;
+    sum.assign(length, 0);
+    counts.assign(length, 0);
+
+    dout << "Method = " << ((method == DIRECT) ? "Direct" : "FFT")
+	 << "\nMaxK = " << maxK * Sim->units.unitLength()
+	 << "\nBinWidth = " << binWidth * Sim->units.unitLength() << std::endl;
+
+    ticker();
+  }
+
+  void
+  OPStructureFactor::ticker()
+  {
+    ++sampleCount;
+    if (method == DIRECT)
+      sampleDirect();
+    else
+      sampleFFT();
+  }
+
+  void
+  OPStructureFactor::addToShell(const double k, const double Sk)
+  {
+    const size_t i = static_cast<size_t>(k / binWidth + 0.5);
+    if (i < length)
+      {
+	sum[i] += Sk;
+	++counts[i];
+      }
+  }
+
+  void
+  OPStructureFactor::sampleDirect()
+  {
+    const Vector& L = Sim->primaryCellSize;
+    std::array<int, 3> nmax;
+    for (size_t iDim(0); iDim < NDIM; ++iDim)
+      nmax[iDim] = static_cast<int>(maxK * L[iDim] / (2 * M_PI));
+
+    //Only half of the wavevectors are needed, as S(-k) = S(k)
+    std::vector<std::array<int, 3> > kvectors;
+    std::vector<double> kmags;
+    for (int nx(0); nx <= nmax[0]; ++nx)
+      for (int ny(-nmax[1]); ny <= nmax[1]; ++ny)
+	for (int nz(-nmax[2]); nz <= nmax[2]; ++nz)
+	  {
+	    if ((nx == 0) && ((ny < 0) || ((ny == 0) && (nz <= 0))))
+	      continue;
+	    const double k = (2 * M_PI * Vector{nx / L[0], ny / L[1], nz / L[2]}).nrm();
+	    if (k > maxK) continue;
+	    kvectors.push_back(std::array<int, 3>{{nx, ny + nmax[1], nz + nmax[2]}});
+	    kmags.push_back(k);
+	  }
+
+    //Each chunk sums a range of the wavevectors over every particle,
+    //so the sums are independent of the number of chunks
+    const size_t N = Sim->particles.size();
+    const size_t chunks = Sim->parallelChunks(N * kvectors.size());
+    std::vector<std::complex<double> > rho(kvectors.size());
+
+    Sim->parallelFor(chunks, [&](const size_t chunk) {
+      //The phase factors exp(-i k_d r_d) of each component of the
+      //wavevector, from which the phase factor of each wavevector is
+      //built
+      std::array<std::vector<std::complex<double> >, 3> phases;
+      for (size_t iDim(0); iDim < NDIM; ++iDim)
+	phases[iDim].resize(2 * nmax[iDim] + 1);
+
+      const size_t kstart = (kvectors.size() * chunk) / chunks;
+      const size_t kend = (kvectors.size() * (chunk + 1)) / chunks;
+      for (size_t id(0); id < N; ++id)
+	{
+	  Vector r = Sim->particles[id].getPosition();
+	  Sim->BCs->applyBC(r);
+
+	  for (size_t iDim(0); iDim < NDIM; ++iDim)
+	    {
+	      const std::complex<double> base = std::polar(1.0, -2 * M_PI * r[iDim] / L[iDim]);
+	      std::complex<double>* phase = &phases[iDim][nmax[iDim]];
+	      phase[0] = 1;
+	      for (int n(1); n <= nmax[iDim]; ++n)
+		{
+		  phase[n] = phase[n - 1] * base;
+		  phase[-n] = std::conj(phase[n]);
+		}
+	    }
+
+	  const std::complex<double>* phaseX = &phases[0][nmax[0]];
+	  for (size_t i(kstart); i < kend; ++i)
+	    rho[i] += phaseX[kvectors[i][0]] * phases[1][kvectors[i][1]] * phases[2][kvectors[i][2]];
+	}
+      });
+
+    for (size_t i(0); i < kvectors.size(); ++i)
+      addToShell(kmags[i], std::norm(rho[i]) / N);
+  }
+
+  void
+  OPStructureFactor::sampleFFT()
+  {
+    const Vector& L = Sim->primaryCellSize;
+
+    //The mesh is kept between samples to avoid reallocating it
+    const std::array<size_t, 3>& M = meshDims;
+    std::fill(mesh.begin(), mesh.end(), std::complex<double>(0, 0));
+    for (const Particle& part : Sim->particles)
+      {
+	Vector r = part.getPosition();
+	Sim->BCs->applyBC(r);
+
+	std::array<size_t, 3> node;
+	std::array<double, 3> frac;
+	for (size_t iDim(0); iDim < NDIM; ++iDim)
+	  {
+	    const double u = (r[iDim] / L[iDim] + 0.5) * M[iDim];
+	    const double cell = std::floor(u);
+	    frac[iDim] = u - cell;
+	    node[iDim] = ((static_cast<long>(cell) % long(M[iDim])) + M[iDim]) % M[iDim];
+	  }
+
+	for (size_t corner(0); corner < 8; ++corner)
+	  {
+	    double weight = 1;
+	    std::array<size_t, 3> coords;
+	    for (size_t iDim(0); iDim < NDIM; ++iDim)
+	      {
+		const bool upper = (corner >> iDim) & 1;
+		weight *= upper ? frac[iDim] : 1 - frac[iDim];
+		coords[iDim] = upper ? (node[iDim] + 1) % M[iDim] : node[iDim];
+	      }
+	    mesh[coords[0] + M[0] * (coords[1] + M[1] * coords[2])] += weight;
+	  }
+      }
+
+    magnet::math::fft3D(mesh, M, false, Sim->threadPool, Sim->parallelChunks(mesh.size() * 3 * std::log2(M[0])));
+
+    const size_t N = Sim->particles.size();
+    std::array<long, 3> nmax;
+    for (size_t iDim(0); iDim < NDIM; ++iDim)
+      //The Nyquist wavevector is ambiguous, so it is skipped
+      nmax[iDim] = std::min(static_cast<long>(maxK * L[iDim] / (2 * M_PI)), long(M[iDim] / 2) - 1);
+
+    //The cloud-in-cell assignment convolutes the density with a
+    //window whose transform is sinc^2 in each dimension
+    auto window = [&](const long n, const size_t iDim) {
+      if (!n) return 1.0;
+      const double x = M_PI * n / M[iDim];
+      const double sinc = std::sin(x) / x;
+      return sinc * sinc;
+    };
+
+    for (long nx(-nmax[0]); nx <= nmax[0]; ++nx)
+      for (long ny(-nmax[1]); ny <= nmax[1]; ++ny)
+	for (long nz(-nmax[2]); nz <= nmax[2]; ++nz)
+	  {
+	    const double k = (2 * M_PI * Vector{nx / L[0], ny / L[1], nz / L[2]}).nrm();
+	    if ((k == 0) || (k > maxK)) continue;
+	    const double W = window(nx, 0) * window(ny, 1) * window(nz, 2);
+	    const size_t index = ((nx + M[0]) % M[0]) + M[0] * (((ny + M[1]) % M[1]) + M[1] * ((nz + M[2]) % M[2]));
+	    addToShell(k, std::norm(mesh[index]) / (N * W * W));
+	  }
+  }
+
+  std::vector<std::pair<double, double> >
+  OPStructureFactor::getSk() const
+  {
+    std::vector<std::pair<double, double> > retval;
+    //Skip the zero bin
+    for (size_t i(1); i < length; ++i)
+      if (counts[i])
+	retval.push_back(std::make_pair(i * binWidth, sum[i] / counts[i]));
+    return retval;
+  }
+
+  void
+  OPStructureFactor::output(magnet::xml::XmlStream& XML)
+  {
+    XML << magnet::xml::tag("StructureFactor")
+	<< magnet::xml::attr("SampleCount") << sampleCount
+	<< magnet::xml::attr("Method") << ((method == DIRECT) ? "Direct" : "FFT")
+	<< magnet::xml::chardata();
+
+    for (const std::pair<double, double>& shell : getSk())
+      XML << shell.first * Sim->units.unitLength() << " " << shell.second << "\n";
+
+    XML << magnet::xml::endtag("StructureFactor");
+  }
+}
@@ -0,0 +1,89 @@
+/*  dynamo:- Event driven molecular dynamics simulator 
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <dynamo/outputplugins/tickerproperty/ticker.hpp>
+#include <array>
+#include <complex>
+#include <vector>
+
+namespace dynamo {
+  /*! \brief Samples the static structure factor, S(k), of all the
+    particles.
+
+    The structure factor of a wavevector \f$\mathbf{k}\f$ is
+    \f[S(\mathbf{k})=\frac{1}{N}\left|\sum_{j=1}^{N}\exp(-i\,\mathbf{k}\cdot\mathbf{r}_j)\right|^2\f]
+    which is averaged over the wavevectors of the periodic box in
+    shells of \f$|\mathbf{k}|\f$ up to MaxK.
+
+    Two methods are available. The Direct method evaluates the sum
+    for every wavevector, costing O(N) per wavevector. The FFT method
+    assigns the particles to a mesh using cloud-in-cell weights,
+    Fourier transforms the mesh, and deconvolutes the assignment
+    window, costing O(M^3 log M) for an M^3 mesh. The mesh is
+    chosen so that its Nyquist wavenumber is twice MaxK (or set with
+    Grid), but is limited to MaxGrid (128 by default) in each
+    dimension, as its memory grows as M^3. If the limited mesh
+    cannot reach MaxK, MaxK is lowered with a warning. The default
+    (Auto) uses whichever method needs fewer operations, but only
+    uses the FFT if its mesh fits within MaxGrid.
+   */
+  class OPStructureFactor: public OPTicker
+  {
+  public:
+    OPStructureFactor(const dynamo::Simulation*, const magnet::xml::Node&);
+
+    virtual void initialise();
+
+    virtual void stream(double) {}
+
+    virtual void ticker();
+
+    virtual void output(magnet::xml::XmlStream&);
+
+    void operator<<(const magnet::xml::Node&);
+
+    /*! \brief The shell averaged structure factor, as pairs of the
+        shell wavenumber and S(k) in simulation units. Empty shells
+        are skipped.
+    */
+    std::vector<std::pair<double, double> > getSk() const;
+
+  protected:
+    enum Method { AUTO, DIRECT, FFT };
+
+    void sampleDirect();
+    void sampleFFT();
+
+    //! Adds the structure factor of a wavevector to its shell.
+    void addToShell(const double k, const double Sk);
+
+    Method method;
+    double binWidth;
+    double maxK;
+    size_t gridSize;
+    size_t maxGrid;
+    size_t length;
+    size_t sampleCount;
+    std::vector<double> sum;
+    std::vector<size_t> counts;
+    //! The FFT mesh, kept between samples
+    std::array<size_t, 3> meshDims;
+    std::vector<std::complex<double> > mesh;
+  };
+}
@@ -37,6 +37,19 @@ namespace dynamo {
     virtual void output(magnet::xml::XmlStream&) {}
 
     virtual void ticker() = 0;
+
+    /*! \brief Whether ticker() may run concurrently with the other
+      ticker plugins (see dynarun's --parallel-tickers option).
+
+      This is only safe if ticker() reads the simulation state and
+      writes to nothing but the plugin's own data, so it defaults to
+      false. Plugins which have been checked to do so override it to
+      return true. Plugins which query the neighbour list, split
+      their own work across the thread pool, change the simulation,
+      or draw from its random number generator must stay on the
+      simulation thread.
+     */
+    virtual bool concurrentTicker() const { return false; }
   
     virtual void periodicOutput() {}
 
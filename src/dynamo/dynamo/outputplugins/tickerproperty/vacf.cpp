@@ -28,9 +28,7 @@ namespace dynamo {
 				   const magnet::xml::Node& XML):
     OPTicker(tmp,"VACF"),
     length(50),
-    currCorrLength(0),
-    ticksTaken(0),
-    notReady(true)
+    scaling(2)
   {
     operator<<(XML);
   }
@@ -40,74 +38,70 @@ namespace dynamo {
   {
     if (XML.hasAttribute("Length"))
       length = XML.getAttribute("Length").as<size_t>();
+
+    if (XML.hasAttribute("Scaling"))
+      scaling = XML.getAttribute("Scaling").as<size_t>();
   }
 
   void 
   OPVACF::initialise()
   {
-    dout << "The length of the VACF correlator is " << length << std::endl;
+    dout << "The VACF correlator has " << length << " lags per level, with a scaling of " << scaling << std::endl;
+
+    speciesIDs.resize(Sim->N());
+    for (const Particle& part : Sim->particles)
+      speciesIDs[part.getID()] = Sim->species(part)->getID();
 
-    velHistory.resize(Sim->N(), boost::circular_buffer<Vector>(length));
+    molecules.clear();
+    for (const shared_ptr<Topology>& topo : Sim->topology)
+      for (const shared_ptr<IDRange>& range : topo->getMolecules())
+	molecules.push_back(std::make_pair(range, topo->getID()));
 
-    currCorrLength=1;
+    correlator.resize(Sim->N() + molecules.size(), length, scaling);
+    speciesData.assign(Sim->species.size(), std::vector<double>());
+    structData.assign(Sim->topology.size(), std::vector<double>());
 
-    for (const Particle& part : Sim->particles)
-      velHistory[part.getID()].push_front(part.getPosition());
-    
-    speciesData.resize(Sim->species.size(), std::vector<double>(length, 0.0));
-    structData.resize(Sim->topology.size(), std::vector<double>(length, 0.0));
+    ticker();
   }
 
-  void 
-  OPVACF::ticker()
+  Vector
+  OPVACF::getVelocity(size_t channel) const
   {
-    for (const Particle& part : Sim->particles)
-      velHistory[part.getID()].push_front(part.getVelocity());
-  
-    if (notReady)
+    if (channel < Sim->N())
+      return Sim->particles[channel].getVelocity();
+
+    Vector COMvelocity({0,0,0});
+    double molMass(0);
+    for (const size_t& ID : *molecules[channel - Sim->N()].first)
       {
-	if (++currCorrLength != length) return;
-	notReady = false;
+	double mass = Sim->species(Sim->particles[ID])->getMass(ID);
+	COMvelocity += Sim->particles[ID].getVelocity() * mass;
+	molMass += mass;
       }
-    
-    accPass();
+
+    return COMvelocity / molMass;
   }
 
-  void
-  OPVACF::accPass()
+  void 
+  OPVACF::ticker()
   {
-    ++ticksTaken;
-  
-    for (const shared_ptr<Species>& sp : Sim->species)
-      for (const size_t& ID : *sp->getRange())
-      for (size_t step(0); step < length; ++step)
-	speciesData[sp->getID()][step] += velHistory[ID][step] | velHistory[ID][0];
-  
-    for (const shared_ptr<Topology>& topo : Sim->topology)
-      for (const shared_ptr<IDRange>& range : topo->getMolecules())
-	{
-	  Vector COMvelocity({0,0,0});
-	  double molMass(0);
-	  
-	  for (const size_t& ID : *range)
-	    {
-	      double mass = Sim->species[Sim->particles[ID]]->getMass(ID);
-	      COMvelocity += velHistory[ID][0] * mass;
-	      molMass += mass;
-	    }
-
-	  COMvelocity /= molMass;
-	  
-	  for (size_t step(0); step < length; ++step)
-	    {
-	      Vector COMvelocity2({0,0,0});
-	      
-	      for (const size_t& ID : *range)
-		COMvelocity2 += velHistory[ID][step] * Sim->species[Sim->particles[ID]]->getMass(ID);
-	      COMvelocity2 /= molMass;
-	      structData[topo->getID()][step] += COMvelocity | COMvelocity2;
-	    }
-	}
+    correlator.push([&](size_t channel) { return getVelocity(channel); });
+
+    for (std::vector<double>& data : speciesData)
+      data.resize(correlator.getLagCount(), 0.0);
+    for (std::vector<double>& data : structData)
+      data.resize(correlator.getLagCount(), 0.0);
+
+    const size_t N = Sim->N();
+    auto accumulate = [&](size_t lag, size_t channel, const Vector& origin, const Vector& current)
+      {
+	if (channel < N)
+	  speciesData[speciesIDs[channel]][lag] += origin | current;
+	else
+	  structData[molecules[channel - N].second][lag] += origin | current;
+      };
+
+    correlator.correlate(accumulate);
   }
 
   void
@@ -125,9 +119,9 @@ namespace dynamo {
 	    << sp->getName()
 	    << magnet::xml::chardata();
       
-	for (size_t step(0); step < length; ++step)
-	  XML << dt * step << " "
-	      << speciesData[sp->getID()][step] / (static_cast<double>(ticksTaken) * static_cast<double>(sp->getCount()) * Sim->units.unitVelocity() * Sim->units.unitVelocity())
+	for (size_t i(0); i < correlator.getLagCount(); ++i)
+	  XML << dt * correlator.getLag(i) << " "
+	      << speciesData[sp->getID()][i] / (static_cast<double>(correlator.getSampleCount(i)) * static_cast<double>(sp->getCount()) * Sim->units.unitVelocity() * Sim->units.unitVelocity())
 	      << "\n";
       
 	XML << magnet::xml::endtag("Species");
@@ -143,9 +137,9 @@ namespace dynamo {
 	    << topo->getName()
 	    << magnet::xml::chardata();
       
-	for (size_t step(0); step < length; ++step)
-	  XML << dt * step << " "
-	      << structData[topo->getID()][step] / (static_cast<double>(ticksTaken) * static_cast<double>(topo->getMolecules().size()) * Sim->units.unitVelocity() * Sim->units.unitVelocity())
+	for (size_t i(0); i < correlator.getLagCount(); ++i)
+	  XML << dt * correlator.getLag(i) << " "
+	      << structData[topo->getID()][i] / (static_cast<double>(correlator.getSampleCount(i)) * static_cast<double>(topo->getMolecules().size()) * Sim->units.unitVelocity() * Sim->units.unitVelocity())
 	      << "\n";
 	
 	XML << magnet::xml::endtag("Structure");
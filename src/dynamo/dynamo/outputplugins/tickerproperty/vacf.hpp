@@ -17,11 +17,18 @@
 
 #pragma once
 #include <dynamo/outputplugins/tickerproperty/ticker.hpp>
-#include <boost/circular_buffer.hpp>
+#include <magnet/math/correlators.hpp>
 #include <magnet/math/vector.hpp>
 #include <vector>
 
 namespace dynamo {
+  /*! \brief Collects the velocity autocorrelation function of the
+      species and the molecules (centre of mass) of the topologies.
+
+      As in OPMSDCorrelator, a multiple-tau correlator gives
+      logarithmically spaced lag times, set by the Length and
+      Scaling attributes.
+   */
   class OPVACF: public OPTicker
   {
   public:
@@ -37,14 +44,18 @@ namespace dynamo {
     virtual void stream(double) {}
     virtual void ticker();
 
-    void accPass();
+    virtual bool concurrentTicker() const { return true; }
+
+    Vector getVelocity(size_t channel) const;
 
-    std::vector<boost::circular_buffer<Vector> > velHistory;
+    magnet::math::MultipleTauCorrelator<Vector> correlator;
+    //! The species ID of each particle channel
+    std::vector<size_t> speciesIDs;
+    //! The molecules (and their topology ID) sampled after the particles
+    std::vector<std::pair<shared_ptr<IDRange>, size_t> > molecules;
     std::vector<std::vector<double> > speciesData;
     std::vector<std::vector<double> > structData;
     size_t length;
-    size_t currCorrLength;
-    size_t ticksTaken;
-    bool notReady;
+    size_t scaling;
   };
 }
@@ -0,0 +1,88 @@
+/*  dynamo:- Event driven molecular dynamics simulator 
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+#include <dynamo/ranges/IDRange.hpp>
+#include <dynamo/ranges/IDRangeRange.hpp>
+#include <dynamo/particle.hpp>
+#include <magnet/memory/arena.hpp>
+#include <magnet/exception.hpp>
+#include <magnet/xmlwriter.hpp>
+#include <algorithm>
+#include <vector>
+
+namespace dynamo {
+  /*! \brief A temporary list of IDs stored in a magnet::memory::Arena.
+
+    The scheduler returns its neighbour and local lists in the
+    arena of the calling thread, so the queries made while running
+    an event do not allocate. The arena is reset after every event
+    so these ranges must not be kept between events. They are
+    created with new (arena) IDRangeArena(arena, ...).
+   */
+  class IDRangeArena: public IDRange, public magnet::memory::ArenaAllocated
+  {
+  public:
+    IDRangeArena(magnet::memory::Arena& arena, const std::vector<size_t>& IDs):
+      _arena(arena),
+      _size(IDs.size()),
+      _IDs(static_cast<size_t*>(arena.allocate(_size * sizeof(size_t), alignof(size_t))))
+    { std::copy(IDs.begin(), IDs.end(), _IDs); }
+
+    ~IDRangeArena() { _arena.deallocate(_IDs, _size * sizeof(size_t)); }
+
+    virtual bool isInRange(const Particle &part) const
+    { return std::find(_IDs, _IDs + _size, part.getID()) != _IDs + _size; }
+
+    virtual unsigned long size() const { return _size; }
+
+    virtual unsigned long operator[](unsigned long i) const { return _IDs[i]; }
+
+    virtual unsigned long at(unsigned long i) const 
+    { 
+      if (i >= _size)
+	M_throw() << "Bad array access value in range.at()";
+      return _IDs[i];
+    }
+
+  protected:
+    IDRangeArena(const IDRangeArena&);
+    IDRangeArena& operator=(const IDRangeArena&);
+
+    virtual void outputXML(magnet::xml::XmlStream& XML) const
+    {
+      XML << magnet::xml::attr("Type") << "List";
+      for (size_t i(0); i < _size; ++i)
+	XML << magnet::xml::tag("ID") << magnet::xml::attr("val") << _IDs[i] << magnet::xml::endtag("ID");
+    }
+
+    magnet::memory::Arena& _arena;
+    size_t _size;
+    size_t* _IDs;
+  };
+
+  /*! \brief A contiguous range of IDs allocated in a
+    magnet::memory::Arena.
+
+    This is an IDRangeRange, so it is O(1) to construct and
+    query. Only the object itself is placed in the arena.
+   */
+  class IDRangeArenaRange: public IDRangeRange, public magnet::memory::ArenaAllocated
+  {
+  public:
+    IDRangeArenaRange(size_t s, size_t e): IDRangeRange(s, e) {}
+  };
+}
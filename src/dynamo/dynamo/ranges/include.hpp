@@ -27,6 +27,7 @@
 #include <dynamo/ranges/IDPairRangeSingle.hpp>
 #include <dynamo/ranges/IDPairRangeSelf.hpp>
 #include <dynamo/ranges/IDRangeAll.hpp>
+#include <dynamo/ranges/IDRangeArena.hpp>
 #include <dynamo/ranges/IDRange.hpp>
 #include <dynamo/ranges/IDRangeList.hpp>
 #include <dynamo/ranges/IDRangeNone.hpp>
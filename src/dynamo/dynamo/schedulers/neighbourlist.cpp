@@ -24,7 +24,7 @@
 #include <dynamo/globals/cellsShearing.hpp>
 #include <dynamo/systems/nblistCompressionFix.hpp>
 #include <dynamo/locals/local.hpp>
-#include <dynamo/ranges/IDRangeRange.hpp>
+#include <dynamo/ranges/IDRangeArena.hpp>
 #include <dynamo/BC/include.hpp>
 #include <magnet/xmlreader.hpp>
 #include <cmath>
@@ -129,9 +129,14 @@ namespace dynamo {
 
     //Grab a reference to the neighbour list
     const GNeighbourList& nblist(*static_cast<const GNeighbourList*>(Sim->globals[NBListID].get()));
-    IDRangeList* range_ptr = new IDRangeList();
-    nblist.getParticleNeighbours(part, range_ptr->getContainer());
-    return std::unique_ptr<IDRange>(range_ptr);
+
+    //The neighbours are gathered in a reused buffer, then copied
+    //into the event arena
+    static thread_local std::vector<size_t> neighbours;
+    neighbours.clear();
+    nblist.getParticleNeighbours(part, neighbours);
+    magnet::memory::Arena& arena = magnet::memory::Arena::threadLocal();
+    return std::unique_ptr<IDRange>(new (arena) IDRangeArena(arena, neighbours));
   }
 
   std::unique_ptr<IDRange>
@@ -147,13 +152,15 @@ namespace dynamo {
 				 (Sim->globals[NBListID]
 				  .get()));
   
-    IDRangeList* range_ptr = new IDRangeList();
-    nblist.getParticleNeighbours(vec, range_ptr->getContainer());
-    return std::unique_ptr<IDRange>(range_ptr);
+    static thread_local std::vector<size_t> neighbours;
+    neighbours.clear();
+    nblist.getParticleNeighbours(vec, neighbours);
+    magnet::memory::Arena& arena = magnet::memory::Arena::threadLocal();
+    return std::unique_ptr<IDRange>(new (arena) IDRangeArena(arena, neighbours));
   }
     
   std::unique_ptr<IDRange> 
   SNeighbourList::getParticleLocals(const Particle& part) const {
-    return std::unique_ptr<IDRange>(new IDRangeRange(0, Sim->locals.size() - 1));
+    return std::unique_ptr<IDRange>(new (magnet::memory::Arena::threadLocal()) IDRangeArenaRange(0, Sim->locals.size() - 1));
   }
 }
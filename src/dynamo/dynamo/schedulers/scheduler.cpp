@@ -32,6 +32,7 @@
 #endif
 #include <magnet/xmlwriter.hpp>
 #include <magnet/xmlreader.hpp>
+#include <algorithm>
 
 namespace dynamo {
   Scheduler::Scheduler(dynamo::Simulation* const tmp, const char * aName,
@@ -92,11 +93,62 @@ namespace dynamo {
     sorter->clear();
     sorter->init(Sim->N() + 1);
 
-    for (Particle& part : Sim->particles)
-      addEvents(part);
+    std::vector<size_t> ids(Sim->N());
+    for (size_t id(0); id < ids.size(); ++id)
+      ids[id] = id;
+    addEvents(ids);
     rebuildSystemEvents();
   }
 
+  void
+  Scheduler::addEvents(const std::vector<size_t>& ids, bool invalidate)
+  {
+    //Particles are processed in batches to bound the memory used to
+    //store the bulk calculated Global events.
+    const size_t batchSize = 4096;
+    std::vector<std::vector<size_t> > globalIDs(Sim->globals.size());
+    std::vector<std::vector<Event> > globalEvents(Sim->globals.size());
+    std::vector<size_t> globalEventIndex(Sim->globals.size());
+
+    for (size_t start(0); start < ids.size(); start += batchSize)
+      {
+	const size_t end = std::min(ids.size(), start + batchSize);
+
+	for (size_t i(start); i < end; ++i)
+	  Sim->dynamics->updateParticle(Sim->particles[ids[i]]);
+
+	for (size_t g(0); g < Sim->globals.size(); ++g)
+	  {
+	    globalIDs[g].clear();
+	    for (size_t i(start); i < end; ++i)
+	      if (Sim->globals[g]->isInteraction(Sim->particles[ids[i]]))
+		globalIDs[g].push_back(ids[i]);
+	    Sim->globals[g]->getEvents(globalIDs[g], globalEvents[g]);
+	    globalEventIndex[g] = 0;
+	  }
+
+	//Add the events in the same order as addEvents(Particle&)
+	for (size_t i(start); i < end; ++i)
+	  {
+	    Particle& part = Sim->particles[ids[i]];
+	    if (invalidate)
+	      invalidateEvents(part);
+
+	    for (size_t g(0); g < Sim->globals.size(); ++g)
+	      if ((globalEventIndex[g] < globalIDs[g].size()) && (globalIDs[g][globalEventIndex[g]] == part.getID()))
+		sorter->push(globalEvents[g][globalEventIndex[g]++]);
+
+	    std::unique_ptr<IDRange> nbIDs(getParticleLocals(part));
+	    for (const size_t id2 : *nbIDs)
+	      addLocalEvent(part, id2);
+
+	    nbIDs = getParticleNeighbours(part);
+	    for (const size_t id2 : *nbIDs)
+	      addInteractionEvent(part, id2);
+	  }
+      }
+  }
+
 
   void 
   Scheduler::addEvents(Particle& part)
@@ -415,8 +467,11 @@ namespace dynamo {
 
 	  if (!data.L1partChanges.empty() || !data.L2partChanges.empty()) {
 	    Sim->_sigParticleUpdate(data);
+	    std::vector<size_t> ids;
+	    ids.reserve(data.L1partChanges.size());
 	    for (const auto& d1 : data.L1partChanges)
-	      this->fullUpdate(Sim->particles[d1.getParticleID()]);
+	      ids.push_back(d1.getParticleID());
+	    this->fullUpdate(ids);
 	    for (const auto& d2 : data.L2partChanges)
 	      this->fullUpdate(Sim->particles[d2.particle1_.getParticleID()], Sim->particles[d2.particle2_.getParticleID()]);
 	    
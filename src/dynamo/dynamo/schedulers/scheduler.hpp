@@ -70,10 +70,26 @@ namespace dynamo {
       fullUpdate(p2);
     }
 
+    /*! \brief Retest for events for many particles.
+
+      This is equivalent to calling fullUpdate for each particle in
+      turn, but the Global events (i.e., neighbour list cell
+      transitions) are calculated in bulk using Global::getEvents.
+     */
+    void fullUpdate(const std::vector<size_t>& ids) { addEvents(ids, true); }
+
     void invalidateEvents(const Particle&);
 
     void addEvents(Particle&);
 
+    /*! \brief Add the events of many particles.
+
+      \param ids The IDs of the particles.
+      \param invalidate If true, the existing events of each particle
+      are invalidated before its new events are added.
+     */
+    void addEvents(const std::vector<size_t>& ids, bool invalidate = false);
+
     void popNextEvent();
 
     void pushEvent(const Event&);
@@ -29,6 +29,8 @@
 #include <dynamo/interactions/interaction.hpp>
 #include <dynamo/outputplugins/misc.hpp>
 #include <dynamo/globals/PBCSentinel.hpp>
+#include <magnet/memory/arena.hpp>
+#include <magnet/thread/workstealingpool.hpp>
 #include <boost/filesystem.hpp>
 #include <dynamo/BC/BC.hpp>
 #include <iomanip>
@@ -47,6 +49,8 @@ namespace dynamo
     eventPrintInterval(50000),
     nextPrintEvent(0),
     _force_unwrapped(false),
+    threadPool(NULL),
+    tickerPool(NULL),
     primaryCellSize({1,1,1}),
     ranGenerator(std::random_device()()),
     lastRunMFT(0.0),
@@ -268,7 +272,33 @@ namespace dynamo
       ptr->stream(dt);
   }
 
-  double 
+  const size_t Simulation::parallelWorkCutoff;
+
+  size_t
+  Simulation::parallelChunks(const size_t work) const
+  {
+    if (!threadPool || (work < parallelWorkCutoff))
+      return 1;
+    return std::max(threadPool->getThreadCount(), size_t(1));
+  }
+
+  void
+  Simulation::parallelFor(const size_t chunks, const std::function<void(size_t)>& func) const
+  {
+    if (!threadPool || (chunks == 1))
+      {
+	for (size_t chunk(0); chunk < chunks; ++chunk)
+	  func(chunk);
+	return;
+      }
+
+    magnet::thread::WorkStealingPool::TaskGroup group(*threadPool);
+    for (size_t chunk(0); chunk < chunks; ++chunk)
+      group.run([&func, chunk]() { func(chunk); });
+    group.wait();
+  }
+
+  double
   Simulation::getLongestInteraction() const
   {
     double maxval = 0.0;
@@ -528,6 +558,29 @@ namespace dynamo
     XML.write_file(fileName);
   }
   
+  void
+  Simulation::setReplicaTemperature(double T)
+  {
+    EnsembleNVT* nvt = dynamic_cast<EnsembleNVT*>(ensemble.get());
+    if (!nvt)
+      M_throw() << "Can only change the temperature of an NVT simulation";
+
+    dynamics->updateAllParticles();
+
+    const double scale = std::sqrt(T / nvt->getEnsembleVals()[2]);
+    for (Particle& part : particles)
+      part.getVelocity() *= scale;
+    //As in replexerSwap, this assumes that scaling the velocities
+    //just changes the time unit of the simulation.
+    ptrScheduler->rescaleTimes(1.0 / scale);
+
+    for (shared_ptr<OutputPlugin>& plugin : outputPlugins)
+      plugin->temperatureRescale(scale * scale);
+
+    nvt->setTemperature(T);
+    ptrScheduler->rebuildSystemEvents();
+  }
+
   void 
   Simulation::replexerSwap(Simulation& other)
   {
@@ -800,6 +853,9 @@ namespace dynamo
     try
       {
 	ptrScheduler->runNextEvent();
+
+	//Reclaim the temporaries of the event (e.g., neighbour lists)
+	magnet::memory::Arena::threadLocal().reset();
 	
 	//Periodic work
 	if ((eventCount >= _nextPrint) && !silentMode && outputPlugins.size())
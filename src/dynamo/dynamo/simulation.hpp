@@ -23,9 +23,12 @@
 #include <dynamo/property.hpp>
 #include <dynamo/units/units.hpp>
 #include <magnet/function/delegate.hpp>
+#include <functional>
 #include <random>
 #include <vector>
 
+namespace magnet { namespace thread { class WorkStealingPool; } }
+
 namespace dynamo
 {  
   class Scheduler;
@@ -347,6 +350,43 @@ namespace dynamo
         coordinates. Needed for some interactions that break
         periodicity (like SOCells).*/
     bool _force_unwrapped;
+
+    /*! \brief The thread pool of the coordinator (see
+        --n-threads), on which parallelFor() runs. If NULL, the
+        work is done on the calling thread.*/
+    magnet::thread::WorkStealingPool* threadPool;
+
+    /*! \brief The amount of work (roughly, pair distance
+        evaluations) below which parallelChunks() does not split
+        it up.
+
+	Around 10^7 pair evaluations take a few milliseconds, which
+	comfortably repays the cost of queueing the tasks and
+	merging their results.
+     */
+    static const size_t parallelWorkCutoff = 10000000;
+
+    /*! \brief The number of chunks to split an amount of work into
+        for parallelFor().
+
+	This is one chunk per thread of the threadPool, or 1 if
+	there is no pool or the work is below parallelWorkCutoff.
+     */
+    size_t parallelChunks(const size_t work) const;
+
+    /*! \brief Runs func(chunk) for every chunk in [0, chunks) on
+        the threadPool and waits for them all to complete.
+
+	If chunks is 1 or there is no pool, func is called directly
+	on the calling thread. Exceptions thrown by func are passed
+	back to the caller.
+     */
+    void parallelFor(const size_t chunks, const std::function<void(size_t)>& func) const;
+
+    /*! \brief If set, the SysTicker runs the ticker plugins which
+        allow it (see OPTicker::concurrentTicker) concurrently on
+        this pool.*/
+    magnet::thread::WorkStealingPool* tickerPool;
     
     /*! \brief Number of Particle's in the system. */
     size_t N() const { return particles.size(); }
@@ -405,6 +445,17 @@ namespace dynamo
     Units units;    
 
     void replexerSwap(Simulation&);
+
+    /*! \brief Move the Simulation to a new temperature, as in a
+      replica exchange where only the temperatures are exchanged.
+
+      The velocities are rescaled to the new temperature, and the
+      thermostat and ensemble are updated. Unlike replexerSwap, the
+      collected output plugin data stays with this configuration.
+
+      \param T The new temperature (in simulation units).
+     */
+    void setReplicaTemperature(double T);
     
     /*! \brief Signal on particle changes.
       
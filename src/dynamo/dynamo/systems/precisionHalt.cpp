@@ -0,0 +1,265 @@
+/*  dynamo:- Event driven molecular dynamics simulator
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <dynamo/systems/precisionHalt.hpp>
+#include <dynamo/NparticleEventData.hpp>
+#include <dynamo/units/units.hpp>
+#include <dynamo/outputplugins/misc.hpp>
+#include <magnet/xmlwriter.hpp>
+#include <magnet/xmlreader.hpp>
+#include <cmath>
+#include <limits>
+
+namespace dynamo {
+  SysPrecisionHalt::SysPrecisionHalt(const magnet::xml::Node& XML, dynamo::Simulation* tmp):
+    System(tmp),
+    _sampleTime(0),
+    _lastTime(0),
+    _minSamples(64),
+    _samples(0)
+  {
+    operator<<(XML);
+    type = VIRTUAL;
+  }
+
+  SysPrecisionHalt::SysPrecisionHalt(dynamo::Simulation* nSim, double sampleTime, std::string name):
+    System(nSim),
+    _sampleTime(sampleTime * Sim->units.unitTime()),
+    _lastTime(0),
+    _minSamples(64),
+    _samples(0)
+  {
+    sysName = name;
+    type = VIRTUAL;
+  }
+
+  void
+  SysPrecisionHalt::operator<<(const magnet::xml::Node& XML)
+  {
+    sysName = XML.getAttribute("Name");
+    _sampleTime = XML.getAttribute("SampleTime").as<double>() * Sim->units.unitTime();
+    if (XML.hasAttribute("MinSamples"))
+      _minSamples = XML.getAttribute("MinSamples").as<size_t>();
+
+    _observables.clear();
+    for (magnet::xml::Node node = XML.findNode("Observable"); node.valid(); ++node)
+      {
+	const double relativeError = node.hasAttribute("RelativeError") ? node.getAttribute("RelativeError").as<double>() : 0;
+	const double absoluteError = node.hasAttribute("AbsoluteError") ? node.getAttribute("AbsoluteError").as<double>() : 0;
+	if ((relativeError <= 0) && (absoluteError <= 0))
+	  M_throw() << "The Observable \"" << node.getAttribute("Name").getValue() << "\" of the PrecisionHalt System \"" << sysName << "\" needs a RelativeError or AbsoluteError";
+	addObservable(node.getAttribute("Name"), relativeError, Integral(), 1, false, absoluteError);
+      }
+  }
+
+  void
+  SysPrecisionHalt::addObservable(const std::string& name, double relativeError, Integral integral, double unit, bool reciprocal, double absoluteError)
+  {
+    Observable obs;
+    obs.name = name;
+    obs.target = relativeError;
+    obs.absoluteTarget = absoluteError;
+    obs.integral = integral;
+    obs.unit = unit;
+    obs.reciprocal = reciprocal;
+    obs.builtin = !integral;
+    obs.last = 0;
+    _observables.push_back(obs);
+  }
+
+  void
+  SysPrecisionHalt::bindObservable(Observable& obs)
+  {
+    const OPMisc* misc = Sim->getOutputPlugin<OPMisc>().get();
+    if (!misc)
+      M_throw() << "The PrecisionHalt System \"" << sysName << "\" requires the Misc output plugin";
+
+    const Simulation* sim = Sim;
+    if (obs.name == "Pressure")
+      {
+	obs.integral = [misc, sim]() { return misc->getPressureTensor().tr() / 3.0 * sim->systemTime; };
+	obs.unit = Sim->units.unitPressure();
+      }
+    else if (obs.name == "kT")
+      {
+	obs.integral = [misc, sim]() { return misc->getMeankT() * sim->systemTime; };
+	obs.unit = Sim->units.unitEnergy();
+      }
+    else if (obs.name == "UConfigurational")
+      {
+	obs.integral = [misc, sim]() { return misc->getMeanUConfigurational() * sim->systemTime; };
+	obs.unit = Sim->units.unitEnergy();
+      }
+    else if (obs.name == "MFT")
+      {
+	//The (per particle) number of events, whose rate is averaged
+	obs.integral = [misc, sim]() { return (sim->systemTime > 0) ? sim->systemTime / (misc->getMFT() * sim->units.unitTime()) : 0; };
+	obs.unit = Sim->units.unitTime();
+	obs.reciprocal = true;
+      }
+    else
+      M_throw() << "Unknown observable \"" << obs.name << "\" for the PrecisionHalt System \"" << sysName << "\"";
+  }
+
+  void
+  SysPrecisionHalt::initialise(size_t nID)
+  {
+    ID = nID;
+
+    if (_sampleTime <= 0)
+      M_throw() << "The PrecisionHalt System \"" << sysName << "\" needs a positive SampleTime";
+
+    for (Observable& obs : _observables)
+      {
+	if (obs.builtin)
+	  bindObservable(obs);
+	obs.average.clear();
+      }
+
+    //The output plugins are not initialised yet, so the first event
+    //only records where the integrals start from
+    _samples = 0;
+    _lastTime = -1;
+    dt = _sampleTime;
+  }
+
+  NEventData
+  SysPrecisionHalt::runEvent()
+  {
+    dt += _sampleTime;
+
+    const double interval = Sim->systemTime - _lastTime;
+    for (Observable& obs : _observables)
+      {
+	const double current = obs.integral();
+	if (_lastTime >= 0)
+	  obs.average.push((current - obs.last) / interval);
+	obs.last = current;
+      }
+
+    if (_lastTime >= 0)
+      ++_samples;
+    _lastTime = Sim->systemTime;
+
+    if (_samples == _minSamples)
+      for (const Observable& obs : _observables)
+	if ((obs.absoluteTarget <= 0) && (obs.average.mean() == 0))
+	  derr << "The observable \"" << obs.name << "\" has a zero mean, so its RelativeError"
+	    " cannot be reached, set an AbsoluteError instead" << std::endl;
+
+    if (converged())
+      {
+	dout << "All observables have reached the requested precision after "
+	     << _samples << " samples, halting" << std::endl;
+	Sim->nextPrintEvent = Sim->endEventCount = Sim->eventCount;
+      }
+
+    return NEventData();
+  }
+
+  double
+  SysPrecisionHalt::Observable::value() const
+  { return reciprocal ? 1 / average.mean() : average.mean(); }
+
+  double
+  SysPrecisionHalt::Observable::error() const
+  {
+    //The error of the reciprocal, to first order
+    const double error = average.errorEstimate().error;
+    return reciprocal ? error / (average.mean() * average.mean()) : error;
+  }
+
+  double
+  SysPrecisionHalt::Observable::relativeError() const
+  {
+    const double mean = std::abs(average.mean());
+    return mean ? error() / std::abs(value()) : std::numeric_limits<double>::infinity();
+  }
+
+  bool
+  SysPrecisionHalt::Observable::converged() const
+  {
+    if (!average.errorEstimate().converged)
+      return false;
+    return ((target > 0) && (relativeError() <= target))
+      || ((absoluteTarget > 0) && (error() / unit <= absoluteTarget));
+  }
+
+  bool
+  SysPrecisionHalt::converged() const
+  {
+    if (_observables.empty() || (_samples < _minSamples))
+      return false;
+
+    for (const Observable& obs : _observables)
+      if (!obs.converged())
+	return false;
+
+    return true;
+  }
+
+  void
+  SysPrecisionHalt::outputXML(magnet::xml::XmlStream& XML) const
+  {
+    XML << magnet::xml::tag("System")
+	<< magnet::xml::attr("Type") << "PrecisionHalt"
+	<< magnet::xml::attr("Name") << sysName
+	<< magnet::xml::attr("SampleTime") << _sampleTime / Sim->units.unitTime()
+	<< magnet::xml::attr("MinSamples") << _minSamples;
+
+    for (const Observable& obs : _observables)
+      if (obs.builtin)
+	{
+	  XML << magnet::xml::tag("Observable")
+	      << magnet::xml::attr("Name") << obs.name;
+	  if (obs.target > 0)
+	    XML << magnet::xml::attr("RelativeError") << obs.target;
+	  if (obs.absoluteTarget > 0)
+	    XML << magnet::xml::attr("AbsoluteError") << obs.absoluteTarget;
+	  XML << magnet::xml::endtag("Observable");
+	}
+
+    XML << magnet::xml::endtag("System");
+  }
+
+  void
+  SysPrecisionHalt::outputData(magnet::xml::XmlStream& XML) const
+  {
+    XML << magnet::xml::tag("System")
+	<< magnet::xml::attr("Name") << sysName
+	<< magnet::xml::attr("Type") << "PrecisionHalt"
+	<< magnet::xml::attr("Samples") << _samples
+	<< magnet::xml::attr("Converged") << converged();
+
+    for (const Observable& obs : _observables)
+      {
+	const double relError = obs.relativeError();
+	XML << magnet::xml::tag("Observable")
+	    << magnet::xml::attr("Name") << obs.name
+	    << magnet::xml::attr("Value") << obs.value() / obs.unit
+	    << magnet::xml::attr("Error") << obs.error() / obs.unit
+	    << magnet::xml::attr("RelativeError") << relError
+	    << magnet::xml::attr("Target") << obs.target;
+	if (obs.absoluteTarget > 0)
+	  XML << magnet::xml::attr("AbsoluteTarget") << obs.absoluteTarget;
+	XML << magnet::xml::attr("Converged") << obs.converged()
+	    << magnet::xml::endtag("Observable");
+      }
+
+    XML << magnet::xml::endtag("System");
+  }
+}
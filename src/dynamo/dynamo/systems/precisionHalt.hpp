@@ -0,0 +1,128 @@
+/*  dynamo:- Event driven molecular dynamics simulator
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+#include <dynamo/systems/system.hpp>
+#include <dynamo/simulation.hpp>
+#include <magnet/math/blocking.hpp>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace dynamo {
+  /*! \brief Halts the simulation once a set of observables have
+      been measured to a requested precision.
+
+      Every SampleTime the average of each observable over the last
+      interval is added to a magnet::math::BlockingAverage. The
+      simulation is halted (as SystHalt does) once the blocking
+      analysis of every observable has converged and its error,
+      relative to its mean, is below the requested RelativeError.
+      An observable whose mean may be zero (e.g., UConfigurational
+      for hard spheres) cannot reach a relative error, so it can
+      instead be given an AbsoluteError (in output units), and it
+      converges once either target is reached.
+
+      \code
+      <System Type="PrecisionHalt" Name="PrecisionHalt" SampleTime="0.1" MinSamples="64">
+        <Observable Name="Pressure" RelativeError="0.001"/>
+        <Observable Name="kT" RelativeError="0.0001"/>
+        <Observable Name="MFT" RelativeError="0.001"/>
+        <Observable Name="UConfigurational" AbsoluteError="0.01"/>
+      </System>
+      \endcode
+
+      The observables are taken from the OPMisc plugin, and are
+      "Pressure", "kT", "UConfigurational" and "MFT". For the mean
+      free time, the collision rate is averaged and its reciprocal
+      reported. The achieved errors are written to the output file.
+   */
+  class SysPrecisionHalt: public System
+  {
+  public:
+    /*! \brief A function returning the time integral of an
+        observable since the start of the simulation (or, for a rate,
+        the running count being differentiated).
+     */
+    typedef std::function<double()> Integral;
+
+    SysPrecisionHalt(const magnet::xml::Node& XML, dynamo::Simulation*);
+
+    SysPrecisionHalt(dynamo::Simulation*, double sampleTime, std::string name);
+
+    virtual NEventData runEvent();
+
+    virtual void initialise(size_t);
+
+    virtual void operator<<(const magnet::xml::Node&);
+
+    virtual void outputData(magnet::xml::XmlStream&) const;
+
+    /*! \brief Monitor an observable.
+
+      \param name The name of the observable. If integral is empty,
+      this must be one of the OPMisc observables listed above.
+      \param relativeError The error of the mean, as a fraction of
+      the mean, at which the observable has converged.
+      \param integral The time integral of the observable.
+      \param unit The simulation units of the observable, used
+      when writing the output.
+      \param reciprocal Whether the reciprocal of the average is the
+      quantity of interest (e.g., a mean free time from a rate).
+      \param absoluteError The error of the mean, in output units, at
+      which the observable has also converged. Zero disables this
+      target.
+     */
+    void addObservable(const std::string& name, double relativeError, Integral integral = Integral(), double unit = 1, bool reciprocal = false, double absoluteError = 0);
+
+    /*! \brief Whether every observable has reached its requested
+        precision. */
+    bool converged() const;
+
+    /*! \brief The number of intervals sampled so far. */
+    size_t samples() const { return _samples; }
+
+  protected:
+    virtual void outputXML(magnet::xml::XmlStream&) const;
+
+    struct Observable
+    {
+      std::string name;
+      double target;
+      double absoluteTarget;
+      Integral integral;
+      double unit;
+      bool reciprocal;
+      bool builtin;
+      double last;
+      magnet::math::BlockingAverage average;
+
+      double value() const;
+      double error() const;
+      double relativeError() const;
+      bool converged() const;
+    };
+
+    void bindObservable(Observable&);
+
+    std::vector<Observable> _observables;
+    double _sampleTime;
+    double _lastTime;
+    size_t _minSamples;
+    size_t _samples;
+  };
+}
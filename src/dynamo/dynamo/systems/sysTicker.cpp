@@ -22,6 +22,7 @@
 #include <dynamo/outputplugins/tickerproperty/ticker.hpp>
 #include <dynamo/units/units.hpp>
 #include <dynamo/schedulers/scheduler.hpp>
+#include <magnet/thread/workstealingpool.hpp>
 
 namespace dynamo {
   SysTicker::SysTicker(dynamo::Simulation* nSim, double nPeriod, std::string nName):
@@ -45,11 +46,37 @@ namespace dynamo {
     dt += period;  
     //This is done here as most ticker properties require it
     Sim->dynamics->updateAllParticles();
+
+    if (!Sim->tickerPool)
+      {
+	for (shared_ptr<OutputPlugin>& Ptr : Sim->outputPlugins)
+	  {
+	    shared_ptr<OPTicker> ptr = std::dynamic_pointer_cast<OPTicker>(Ptr);
+	    if (ptr) ptr->ticker();
+	  }
+	return NEventData();
+      }
+
+    //The simulation is frozen until every plugin has been ticked, so
+    //the plugins all see the same state. The plugins which must
+    //run on the simulation thread are ticked while the others run
+    //on the pool.
+    magnet::thread::WorkStealingPool::TaskGroup group(*Sim->tickerPool);
+    std::vector<OPTicker*> serial;
     for (shared_ptr<OutputPlugin>& Ptr : Sim->outputPlugins)
       {
-	shared_ptr<OPTicker> ptr = std::dynamic_pointer_cast<OPTicker>(Ptr);
-	if (ptr) ptr->ticker();
+	OPTicker* ptr = dynamic_cast<OPTicker*>(Ptr.get());
+	if (!ptr) continue;
+	if (ptr->concurrentTicker())
+	  group.run([ptr]() { ptr->ticker(); });
+	else
+	  serial.push_back(ptr);
       }
+
+    for (OPTicker* ptr : serial)
+      ptr->ticker();
+
+    group.wait();
     return NEventData();
   }
 
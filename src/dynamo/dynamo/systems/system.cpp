@@ -24,6 +24,7 @@
 #include <dynamo/systems/umbrella.hpp>
 #include <dynamo/systems/visualizer.hpp>
 #include <dynamo/systems/sleep.hpp>
+#include <dynamo/systems/precisionHalt.hpp>
 #include <dynamo/particle.hpp>
 #include <dynamo/ranges/IDRangeAll.hpp>
 #include <magnet/xmlwriter.hpp>
@@ -62,6 +63,8 @@ namespace dynamo {
       return shared_ptr<System>(new SSleep(XML, Sim));
     else if (!XML.getAttribute("Type").getValue().compare("RotateGravity"))
       return shared_ptr<System>(new SysRotateGravity(XML, Sim));
+    else if (!XML.getAttribute("Type").getValue().compare("PrecisionHalt"))
+      return shared_ptr<System>(new SysPrecisionHalt(XML, Sim));
     else
       M_throw() << XML.getAttribute("Type").getValue()
 		<< ", Unknown type of System event encountered";
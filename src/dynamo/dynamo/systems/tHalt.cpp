@@ -24,7 +24,8 @@
 
 namespace dynamo {
   SystHalt::SystHalt(dynamo::Simulation* nSim, double ndt, std::string nName):
-    System(nSim)
+    System(nSim),
+    _fired(false)
   {
     dt = ndt * Sim->units.unitTime();
 
@@ -40,6 +41,7 @@ namespace dynamo {
   SystHalt::runEvent()
   {
     Sim->nextPrintEvent = Sim->endEventCount = Sim->eventCount;
+    _fired = true;
     return NEventData();
   }
 
@@ -51,11 +53,15 @@ namespace dynamo {
 
   void 
   SystHalt::setdt(double ndt)
-  { dt = ndt * Sim->units.unitTime(); }
+  {
+    dt = ndt * Sim->units.unitTime();
+    _fired = false;
+  }
 
   void 
   SystHalt::increasedt(double ndt)
   { 
     dt += ndt * Sim->units.unitTime(); 
+    _fired = false;
   }
 }
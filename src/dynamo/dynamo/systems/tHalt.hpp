@@ -34,12 +34,23 @@ namespace dynamo {
 
     void increasedt(double);
 
+    /*! \brief Whether the halt has fired since dt was last set.
+
+      The remaining time (getdt()) left after the halt fires is a
+      floating point residual which need not be exactly zero, so
+      this should be used to test if the simulation has halted.
+     */
+    bool fired() const { return _fired; }
+
     virtual void replicaExchange(System& os) {
-      auto s = static_cast<SystHalt&>(os);
+      auto& s = static_cast<SystHalt&>(os);
       std::swap(dt, s.dt);
+      std::swap(_fired, s._fired);
     }
 
   protected:
     virtual void outputXML(magnet::xml::XmlStream&) const {}
+
+    bool _fired;
   };
 }
@@ -18,21 +18,30 @@
 #include <dynamo/systems/umbrella.hpp>
 
 #include <dynamo/units/units.hpp>
-#include <dynamo/BC/BC.hpp>
+#include <dynamo/BC/include.hpp>
 #include <dynamo/particle.hpp>
 #include <dynamo/species/species.hpp>
 #include <dynamo/NparticleEventData.hpp>
 #include <dynamo/ranges/include.hpp>
-#include <dynamo/dynamics/dynamics.hpp>
+#include <dynamo/dynamics/newtonian.hpp>
+#include <dynamo/ensemble.hpp>
 #include <dynamo/schedulers/scheduler.hpp>
 #include <dynamo/outputplugins/outputplugin.hpp>
+#include <dynamo/outputplugins/tickerproperty/SHcrystal.hpp>
 #include <magnet/xmlwriter.hpp>
 #include <magnet/xmlreader.hpp>
+#include <random>
+#include <typeinfo>
 
 namespace dynamo {
 
   SysUmbrella::SysUmbrella(const magnet::xml::Node& XML, dynamo::Simulation* tmp): 
     System(tmp),
+    _coordinate(COM_DISTANCE),
+    _sampleTime(0),
+    _trials(0),
+    _rejections(0),
+    _retracing(false),
     _stepID(std::numeric_limits<size_t>::max())
   {
     dt = std::numeric_limits<float>::infinity();
@@ -40,9 +49,29 @@ namespace dynamo {
     type = UMBRELLA;
   }
 
+  SysUmbrella::SysUmbrella(dynamo::Simulation* nSim, std::string name, shared_ptr<Potential> potential, double energyScale, double sampleTime):
+    System(nSim),
+    _coordinate(SOLID_CLUSTER),
+    _sampleTime(sampleTime * Sim->units.unitTime()),
+    _trials(0),
+    _rejections(0),
+    _retracing(false),
+    _stepID(std::numeric_limits<size_t>::max()),
+    _potential(potential),
+    _energyScale(energyScale * Sim->units.unitEnergy()),
+    _lengthScale(1)
+  {
+    sysName = name;
+    dt = std::numeric_limits<float>::infinity();
+    type = UMBRELLA;
+  }
+
   NEventData
   SysUmbrella::runEvent()
   {
+    if (_coordinate == SOLID_CLUSTER)
+      return runClusterEvent();
+
     ++Sim->eventCount;
     for (const size_t& id : *range1)
       Sim->dynamics->updateParticle(Sim->particles[id]);
@@ -66,11 +95,118 @@ namespace dynamo {
     return SDat;
   }
 
+  NEventData
+  SysUmbrella::runClusterEvent()
+  {
+    dt += _sampleTime;
+
+    Sim->dynamics->updateAllParticles();
+    const double elapsed = Sim->systemTime - _lastSystemTime;
+    _lastSystemTime = Sim->systemTime;
+
+    //The system has just retraced the rejected interval back to the
+    //last accepted sample, so this interval is discarded.
+    if (_retracing)
+      {
+	_retracing = false;
+	return NEventData();
+      }
+
+    const size_t new_step_ID = _potential->calculateStepID(_crystal->calculateLocalOrder());
+    if (new_step_ID == _stepID)
+      {
+	_histogram[_stepID] += elapsed;
+	return NEventData();
+      }
+
+    //Metropolis acceptance of the change in the bias, at the
+    //temperature of the ensemble
+    ++_trials;
+    const double deltaU = _potential->getEnergyChange(_stepID, new_step_ID) * _energyScale;
+    std::uniform_real_distribution<> uniform;
+    if ((deltaU <= 0) || (uniform(Sim->ranGenerator) < std::exp(-deltaU / ensembleKT())))
+      {
+	_stepID = new_step_ID;
+	_histogram[_stepID] += elapsed;
+	return NEventData();
+      }
+
+    //Rejected, so the last accepted sample is counted again and the
+    //trajectory is reversed to retrace its path back to it.
+    _histogram[_stepID] += elapsed;
+    _retracing = true;
+    ++_rejections;
+    ++Sim->eventCount;
+    NEventData SDat;
+    for (Particle& part : Sim->particles)
+      {
+	SDat.L1partChanges.push_back(ParticleEventData(part, *Sim->species(part), UMBRELLA));
+	part.getVelocity() = -part.getVelocity();
+      }
+
+    return SDat;
+  }
+
+  double
+  SysUmbrella::ensembleKT() const
+  {
+    //The thermostat of an NVT ensemble cannot be retraced, so this is
+    //an NVE ensemble. If the system is hard-core, all of its energy
+    //is kinetic, which fixes the temperature.
+    if (!std::dynamic_pointer_cast<EnsembleNVE>(Sim->ensemble) || (Sim->calcInternalEnergy() != 0))
+      M_throw() << "The Umbrella System \"" << sysName << "\" on the LargestSolidCluster needs an NVE ensemble without configurational energy";
+
+    return 2.0 * Sim->ensemble->getEnsembleVals()[2] / Sim->dynamics->getParticleDOF();
+  }
+
   void
   SysUmbrella::initialise(size_t nID)
   {
     ID = nID;
 
+    if (_coordinate == SOLID_CLUSTER)
+      {
+	if (_sampleTime <= 0)
+	  M_throw() << "The Umbrella System \"" << sysName << "\" needs a positive SampleTime";
+
+	//Rejections reverse the trajectory, which must then exactly
+	//retrace its path
+	if (Sim->dynamics->hasOrientationData())
+	  M_throw() << "The Umbrella System \"" << sysName << "\" cannot reverse the trajectory of particles with orientation";
+
+	if (std::dynamic_pointer_cast<BCLeesEdwards>(Sim->BCs)
+	    || (!std::dynamic_pointer_cast<BCPeriodic>(Sim->BCs) && !std::dynamic_pointer_cast<BCNone>(Sim->BCs)))
+	  M_throw() << "The Umbrella System \"" << sysName << "\" requires periodic or no boundary conditions, as it reverses the trajectory";
+
+	if (typeid(*Sim->dynamics) != typeid(DynNewtonian))
+	  M_throw() << "The Umbrella System \"" << sysName << "\" requires Newtonian dynamics, as it reverses the trajectory";
+
+	//Stochastic and rescaling Systems would stop the trajectory
+	//retracing its path
+	for (const shared_ptr<System>& system : Sim->systems)
+	  {
+	    const EEventType systemType = system->getEvent()._type;
+	    if ((systemType != VIRTUAL) && (systemType != NON_EVENT) && !std::dynamic_pointer_cast<SysUmbrella>(system))
+	      M_throw() << "The Umbrella System \"" << sysName << "\" cannot reverse the trajectory with the System \"" << system->getName() << "\"";
+	  }
+
+	_crystal = Sim->getOutputPlugin<OPSHCrystal>();
+	if (!_crystal)
+	  M_throw() << "The Umbrella System \"" << sysName << "\" on the LargestSolidCluster requires the SHCrystal output plugin";
+
+	if (_stepID == std::numeric_limits<size_t>::max())
+	  {
+	    Sim->dynamics->updateAllParticles();
+	    _stepID = _potential->calculateStepID(_crystal->calculateLocalOrder());
+	  }
+
+	dt = _sampleTime;
+	type = UMBRELLA;
+	_retracing = false;
+	_lastSystemTime = Sim->systemTime;
+	return;
+      }
+
     if (_stepID == std::numeric_limits<size_t>::max())
       {
 	for(const size_t& id : *range1)
@@ -156,13 +292,34 @@ namespace dynamo {
   SysUmbrella::operator<<(const magnet::xml::Node& XML)
   {
     sysName = XML.getAttribute("Name");
-    magnet::xml::Node rangeNode = XML.getNode("IDRange");
-    range1 = shared_ptr<IDRange>(IDRange::getClass(rangeNode, Sim));
-    ++rangeNode;
-    range2 = shared_ptr<IDRange>(IDRange::getClass(rangeNode, Sim));
+
+    if (XML.hasAttribute("Coordinate"))
+      {
+	const std::string coordinate = XML.getAttribute("Coordinate");
+	if (coordinate == "LargestSolidCluster")
+	  _coordinate = SOLID_CLUSTER;
+	else if (coordinate == "COMDistance")
+	  _coordinate = COM_DISTANCE;
+	else
+	  M_throw() << "Unknown Coordinate \"" << coordinate << "\" for the Umbrella System \"" << sysName << "\"";
+      }
+
     _potential = Potential::getClass(XML.getNode("Potential"));
 
-    _lengthScale = XML.getAttribute("LengthScale").as<double>() * Sim->units.unitLength();
+    if (_coordinate == SOLID_CLUSTER)
+      {
+	_sampleTime = XML.getAttribute("SampleTime").as<double>() * Sim->units.unitTime();
+	_lengthScale = 1;
+      }
+    else
+      {
+	magnet::xml::Node rangeNode = XML.getNode("IDRange");
+	range1 = shared_ptr<IDRange>(IDRange::getClass(rangeNode, Sim));
+	++rangeNode;
+	range2 = shared_ptr<IDRange>(IDRange::getClass(rangeNode, Sim));
+	_lengthScale = XML.getAttribute("LengthScale").as<double>() * Sim->units.unitLength();
+      }
+
     _energyScale = XML.getAttribute("EnergyScale").as<double>() * Sim->units.unitEnergy();
 
     if (XML.hasAttribute("CurrentStep"))
@@ -174,27 +331,44 @@ namespace dynamo {
   {
     XML << magnet::xml::tag("System")
 	<< magnet::xml::attr("Type") << "Umbrella"
-	<< magnet::xml::attr("Name") << sysName
-	<< magnet::xml::attr("LengthScale") << _lengthScale / Sim->units.unitLength()
-	<< magnet::xml::attr("EnergyScale") << _energyScale / Sim->units.unitEnergy()
+	<< magnet::xml::attr("Name") << sysName;
+
+    if (_coordinate == SOLID_CLUSTER)
+      XML << magnet::xml::attr("Coordinate") << "LargestSolidCluster"
+	  << magnet::xml::attr("SampleTime") << _sampleTime / Sim->units.unitTime();
+    else
+      XML << magnet::xml::attr("LengthScale") << _lengthScale / Sim->units.unitLength();
+
+    XML << magnet::xml::attr("EnergyScale") << _energyScale / Sim->units.unitEnergy()
 	<< magnet::xml::attr("CurrentStep") << _stepID
-	<< _potential
-	<< range1
-	<< range2
-	<< magnet::xml::endtag("System");
+	<< _potential;
+
+    if (_coordinate == COM_DISTANCE)
+      XML << range1 << range2;
+
+    XML << magnet::xml::endtag("System");
   }
 
 
   void 
   SysUmbrella::outputData(magnet::xml::XmlStream& XML) const
   {
-    _histogram[_stepID] += Sim->systemTime - _lastSystemTime;
-    _lastSystemTime = Sim->systemTime;
+    //Samples of the cluster size are credited as they are taken
+    if (_coordinate == COM_DISTANCE)
+      {
+	_histogram[_stepID] += Sim->systemTime - _lastSystemTime;
+	_lastSystemTime = Sim->systemTime;
+      }
 
     using namespace magnet::xml;
     XML << tag("System")
 	<< attr("Name") << sysName
 	<< attr("Type") << "Umbrella";
+
+    if (_coordinate == SOLID_CLUSTER)
+      XML << attr("Trials") << _trials
+	  << attr("Rejections") << _rejections;
+
     for (const auto& entry: _histogram)
       {
 	const std::pair<double, double> step_bounds 
@@ -204,7 +378,7 @@ namespace dynamo {
 	    << attr("ID") << entry.first
 	    << attr("Rmin") << step_bounds.first
 	    << attr("Rmax") << step_bounds.second
-	    << attr("Energy") << (*_potential)[entry.first - 1].second
+	    << attr("Energy") << _potential->getEnergyChange(0, entry.first)
 	    << attr("Time") << entry.second / Sim->units.unitTime()
 	    << endtag("Entry");
       }
@@ -23,10 +23,45 @@
 #include <map>
 
 namespace dynamo {
+  class OPSHCrystal;
+
+  /*! \brief An umbrella (biasing) potential acting on a reaction
+      coordinate of the system.
+
+      By default the coordinate is the distance between the centres
+      of mass of two ranges of particles. The potential is then
+      applied exactly, through events when the distance crosses a
+      step of the potential.
+
+      If Coordinate="LargestSolidCluster", the coordinate is the size
+      of the largest solid cluster found by the SHCrystal output
+      plugin (see OPSHCrystal), which cannot be tracked through
+      events. Instead, it is evaluated every SampleTime and the change
+      of step is accepted with the Metropolis probability of the
+      change of the bias energy, at the temperature of the NVE
+      ensemble (which must be free of configurational energy).
+      If the change is rejected, the current step is sampled again and
+      every velocity is reversed so the system retraces its path back
+      to the last accepted sample. The time spent on the rejected and
+      retraced paths is left out of the histogram, although it is
+      still seen by the output plugins. Retracing requires Newtonian
+      dynamics of particles without orientation, periodic or no
+      boundary conditions, and no stochastic Systems.
+   */
   class SysUmbrella: public System
   {
   public:
     SysUmbrella(const magnet::xml::Node& XML, dynamo::Simulation*);
+
+    /*! \brief Construct an umbrella on the size of the largest solid
+        cluster.
+
+	\param potential The bias, whose step positions are cluster
+	sizes.
+	\param energyScale The energy units of the potential.
+	\param sampleTime How often the cluster size is checked.
+     */
+    SysUmbrella(dynamo::Simulation*, std::string name, shared_ptr<Potential> potential, double energyScale, double sampleTime);
   
     virtual NEventData runEvent();
 
@@ -36,6 +71,13 @@ namespace dynamo {
 
     virtual void outputData(magnet::xml::XmlStream&) const;
 
+    //! \brief The time spent in each step of the potential.
+    const std::map<size_t, double>& getHistogram() const { return _histogram; }
+
+    size_t getTrials() const { return _trials; }
+
+    size_t getRejections() const { return _rejections; }
+
   protected:
     virtual void outputXML(magnet::xml::XmlStream&) const;
 
@@ -43,6 +85,18 @@ namespace dynamo {
 
     void recalculateTime();
 
+    NEventData runClusterEvent();
+
+    double ensembleKT() const;
+
+    enum Coordinate { COM_DISTANCE, SOLID_CLUSTER };
+
+    Coordinate _coordinate;
+    double _sampleTime;
+    shared_ptr<OPSHCrystal> _crystal;
+    size_t _trials;
+    size_t _rejections;
+    bool _retracing;
     std::size_t _stepID;
     shared_ptr<Potential> _potential;
     shared_ptr<IDRange> range1;
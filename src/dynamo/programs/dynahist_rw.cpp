@@ -17,6 +17,8 @@
 
 #include <magnet/xmlreader.hpp>
 #include <magnet/exception.hpp>
+#include <magnet/thread/workstealingpool.hpp>
+#include <magnet/timer.hpp>
 
 #include <boost/program_options.hpp>
 #include <boost/filesystem.hpp>
@@ -32,6 +34,8 @@
 #include <iomanip>
 #include <iosfwd>
 #include <array>
+#include <limits>
+#include <algorithm>
 
 using namespace std;
 using namespace boost;
@@ -44,6 +48,12 @@ static long double minErr = 1e-16;
 static size_t NStepsPerStep = 0;
 static boost::program_options::variables_map vm;
 
+//The threads used to solve the histogram equations
+static magnet::thread::WorkStealingPool threadPool;
+
+//The number of sweeps performed by the self-consistent iteration
+static size_t iterationSweeps = 0;
+
 long double betaMax;
 long double betaMin;
 
@@ -231,6 +241,17 @@ typedef std::vector<densOStatesPair> densOStatesType;
 densOStatesType densOStates;
   
 
+//Each new_logZ only depends on the current logZ's, so the systems
+//are recalculated in parallel
+void
+recalcRange(size_t bottom, size_t top)
+{
+  for (size_t i(bottom); i <= top; ++i)
+    threadPool.queueTask([i, bottom, top]() { SimulationDataData[i].recalc_newlogZ(bottom, top); });
+  threadPool.wait();
+  ++iterationSweeps;
+}
+
 void
 solveWeightsInRange(size_t bottom = 0, size_t top = 0)
 {
@@ -243,8 +264,7 @@ solveWeightsInRange(size_t bottom = 0, size_t top = 0)
     {
       for (size_t i = NStepsPerStep; i != 0; --i)
 	{
-	  for (size_t i(bottom); i <= top; ++i)
-	    SimulationDataData[i].recalc_newlogZ(bottom, top);
+	  recalcRange(bottom, top);
 	  
 	  for (size_t i(bottom); i <= top; ++i)
 	    SimulationDataData[i].iterate_logZ();
@@ -252,13 +272,10 @@ solveWeightsInRange(size_t bottom = 0, size_t top = 0)
 
       //Now the error checking run
       err = 0.0;
+      recalcRange(bottom, top);
       for (size_t i(bottom); i <= top; ++i)
-	{
-	  SimulationDataData[i].recalc_newlogZ(bottom, top);
-	  
-	  if (SimulationDataData[i].calc_error() > err)
-	    err = SimulationDataData[i].calc_error();
-	}
+	if (SimulationDataData[i].calc_error() > err)
+	  err = SimulationDataData[i].calc_error();
 
       //May as well use this as an iteration too
       for (size_t i(bottom); i <= top; ++i)
@@ -321,6 +338,370 @@ solveWeightsPiecemeal()
 }
 
 
+//The log of the smallest normal long double (plus a margin for the
+//rounding of exp). Smaller exponentials would trip the underflow
+//exception enabled in main, so they are treated as zero.
+static const long double logMin = std::log(std::numeric_limits<long double>::min()) + 1;
+
+inline long double safeExp(long double x)
+{ return (x < logMin) ? 0 : std::exp(x); }
+
+/*! \brief A log-sum-exp accumulator.
+
+  The terms are summed relative to the largest term added so far,
+  so the sum can neither overflow nor underflow however far the
+  logZ's are from their solution.
+*/
+struct LogSum
+{
+  LogSum(): max(0), sum(0) {}
+
+  void add(long double v)
+  {
+    if (sum == 0) { max = v; sum = 1; }
+    else if (v > max) { sum = sum * safeExp(max - v) + 1; max = v; }
+    else sum += safeExp(v - max);
+  }
+
+  void add(const LogSum& o)
+  {
+    if (o.sum == 0) return;
+    if (sum == 0) { *this = o; return; }
+    if (o.max > max) { sum = sum * safeExp(max - o.max) + o.sum; max = o.max; }
+    else sum += o.sum * safeExp(o.max - max);
+  }
+
+  bool empty() const { return sum == 0; }
+  long double value() const { return max + std::log(sum); }
+
+  long double max;
+  long double sum;
+};
+
+/*! \brief Run func(begin, end, block) over [0, N) split into blocks
+  on the thread pool.
+
+  The number of blocks does not depend on the number of threads, so
+  reductions performed over the blocks in order give the same result
+  for any thread count.
+*/
+static const size_t maxBlocks = 64;
+
+template<class F>
+size_t parallelBlocks(const size_t N, F func)
+{
+  const size_t blocks = std::max<size_t>(1, std::min(N, maxBlocks));
+  for (size_t block(0); block < blocks; ++block)
+    threadPool.queueTask([=]() { func(block * N / blocks, (block + 1) * N / blocks, block); });
+  threadPool.wait();
+  return blocks;
+}
+
+/*! \brief Solves the multi-histogram equations by minimising the
+  MBAR objective function with Newton's method.
+
+  The histograms are pooled into a single histogram \f$N(X)\f$ over
+  the unique values of \f$X\f$. Writing \f$f_j=\ln Z_j\f$ and
+  \f$u_j(X)=\gamma_j\,X+W_j(X)\f$, the self-consistent equations
+  iterated by solveWeightsInRange() are the stationary point of
+  \f[
+  L(f) = \sum_X N(X)\ln\sum_j e^{u_j(X)-f_j} + \sum_j f_j
+  \f]
+  which is convex. The gradient and Hessian of \f$L\f$ are
+  \f[
+  \frac{\partial L}{\partial f_k} = 1 - c_k \qquad
+  \frac{\partial^2 L}{\partial f_k\partial f_l} = \delta_{kl}\,c_k
+  - \sum_X N(X)\,p_k(X)\,p_l(X)
+  \f]
+  where \f$p_k(X)=e^{u_k(X)-f_k}/\sum_j e^{u_j(X)-f_j}\f$ and
+  \f$c_k=\sum_X N(X)\,p_k(X)\f$. Each evaluation costs
+  \f$O(N_X N_{sims}^2)\f$, rather than the
+  \f$O(N_X N_{sims}^3)\f$ of a sweep of calc_logZ(), and is
+  threaded over the bins. All exponentials are taken using the
+  log-sum-exp trick.
+
+  The first system is the reference and its logZ is held fixed.
+*/
+struct NewtonSolver
+{
+  struct Evaluation
+  {
+    long double objective;
+    std::vector<LogSum> logC;
+    std::vector<long double> hessian;
+  };
+
+  NewtonSolver(): 
+    _nSims(SimulationDataData.size())
+  {
+    if (NGamma != 1) 
+      M_throw() << "For multiple gamma reweighting, one must be designated as E and used in the W lookup";
+
+    densOStatesMap pooled;
+    for (const SimulationData& dat : SimulationDataData)
+      for (const SimulationData::histogramEntry& simdat : dat.data)
+	pooled[simdat.X] += simdat.Probability;
+
+    for (const densOStatesMap::value_type& bin : pooled)
+      {
+	//Empty bins do not contribute
+	if (bin.second <= 0) continue;
+	_N.push_back(bin.second);
+	_logN.push_back(std::log(bin.second));
+	for (const SimulationData& dat : SimulationDataData)
+	  _u.push_back(dat.gamma[0] * bin.first[0] + dat.W(bin.first[0]));
+      }
+  }
+
+  void evaluate(const std::vector<long double>& f, Evaluation& result) const
+  {
+    const size_t nSims = _nSims;
+    std::vector<Evaluation> partials(maxBlocks);
+    
+    const size_t blocks = parallelBlocks(_N.size(), [&](size_t begin, size_t end, size_t block)
+      {
+	//Products of two q's are always normal numbers
+	static const long double halfLogMin = 0.5 * logMin + 1;
+	Evaluation& part = partials[block];
+	part.objective = 0;
+	part.logC.assign(nSims, LogSum());
+	part.hessian.assign(nSims * nSims, 0);
+	std::vector<long double> q(nSims);
+
+	for (size_t bin(begin); bin < end; ++bin)
+	  {
+	    const long double* u = &_u[bin * nSims];
+	    long double max = u[0] - f[0];
+	    for (size_t j(1); j < nSims; ++j)
+	      max = std::max(max, u[j] - f[j]);
+
+	    long double sum = 0;
+	    for (size_t j(0); j < nSims; ++j)
+	      sum += safeExp(u[j] - f[j] - max);
+	    const long double D = max + std::log(sum);
+	    part.objective += _N[bin] * D;
+
+	    for (size_t k(0); k < nSims; ++k)
+	      {
+		//This is ln[N(X) p_k(X)]
+		const long double lnp = _logN[bin] + u[k] - f[k] - D;
+		part.logC[k].add(lnp);
+		//This is ln[N(X)^{1/2} p_k(X)]
+		const long double lnq = lnp - 0.5 * _logN[bin];
+		q[k] = (lnq < halfLogMin) ? 0 : std::exp(lnq);
+	      }
+
+	    for (size_t k(0); k < nSims; ++k)
+	      if (q[k])
+		for (size_t l(k); l < nSims; ++l)
+		  part.hessian[k * nSims + l] -= q[k] * q[l];
+	  }
+      });
+
+    //Reduce the blocks in order
+    result.objective = 0;
+    result.logC.assign(nSims, LogSum());
+    result.hessian.assign(nSims * nSims, 0);
+    for (size_t block(0); block < blocks; ++block)
+      {
+	result.objective += partials[block].objective;
+	for (size_t k(0); k < nSims; ++k)
+	  {
+	    result.logC[k].add(partials[block].logC[k]);
+	    for (size_t l(k); l < nSims; ++l)
+	      result.hessian[k * nSims + l] += partials[block].hessian[k * nSims + l];
+	  }
+      }
+
+    for (size_t k(0); k < nSims; ++k)
+      {
+	result.objective += f[k];
+	result.hessian[k * nSims + k] += c(result, k);
+	for (size_t l(k + 1); l < nSims; ++l)
+	  result.hessian[l * nSims + k] = result.hessian[k * nSims + l];
+      }
+  }
+
+  static long double c(const Evaluation& eval, size_t k)
+  { return eval.logC[k].empty() ? 0 : safeExp(eval.logC[k].value()); }
+
+  /*! \brief Solves the symmetric positive definite system A x = b
+    by Cholesky decomposition, leaving x in b.
+
+    \return False if A is not positive definite.
+   */
+  static bool choleskySolve(std::vector<long double> A, std::vector<long double>& b)
+  {
+    const size_t n = b.size();
+    for (size_t j(0); j < n; ++j)
+      {
+	long double diag = A[j * n + j];
+	for (size_t k(0); k < j; ++k)
+	  diag -= A[j * n + k] * A[j * n + k];
+	
+	if (!(diag > 0)) return false;
+	A[j * n + j] = std::sqrt(diag);
+
+	for (size_t i(j + 1); i < n; ++i)
+	  {
+	    long double val = A[i * n + j];
+	    for (size_t k(0); k < j; ++k)
+	      val -= A[i * n + k] * A[j * n + k];
+	    A[i * n + j] = val / A[j * n + j];
+	  }
+      }
+
+    for (size_t i(0); i < n; ++i)
+      {
+	for (size_t k(0); k < i; ++k)
+	  b[i] -= A[i * n + k] * b[k];
+	b[i] /= A[i * n + i];
+      }
+
+    for (size_t i(n); i != 0; --i)
+      {
+	for (size_t k(i); k < n; ++k)
+	  b[i - 1] -= A[k * n + i - 1] * b[k];
+	b[i - 1] /= A[(i - 1) * n + i - 1];
+      }
+
+    return true;
+  }
+
+  /*! \brief An initial estimate of the logZ's from exponential
+    averaging between neighbouring systems.
+   */
+  static void initialEstimate(std::vector<long double>& f)
+  {
+    for (size_t k(1); k < SimulationDataData.size(); ++k)
+      {
+	const SimulationData& prev = SimulationDataData[k - 1];
+	const SimulationData& next = SimulationDataData[k];
+	LogSum ratio, norm;
+	for (const SimulationData::histogramEntry& simdat : prev.data)
+	  if (simdat.Probability > 0)
+	    {
+	      const long double lnP = std::log(simdat.Probability);
+	      norm.add(lnP);
+	      ratio.add(lnP + (next.gamma[0] - prev.gamma[0]) * simdat.X[0] 
+			+ next.W(simdat.X[0]) - prev.W(simdat.X[0]));
+	    }
+
+	f[k] = f[k - 1] + ((ratio.empty() || norm.empty()) ? 0 : ratio.value() - norm.value());
+      }
+  }
+
+  /*! \brief Solve for the logZ's.
+
+    \return The number of Newton iterations taken.
+   */
+  size_t solve()
+  {
+    std::cout << "##################################################\n";
+    std::cout << "Solving for Z's, by Newton minimisation over " << _N.size() << " bins using " 
+	      << std::max<size_t>(threadPool.getThreadCount(), 1) << " thread(s)\n";
+
+    if (_nSims < 2) return 0;
+
+    std::vector<long double> f(_nSims, 0);
+    f[0] = SimulationDataData.front().logZ;
+    initialEstimate(f);
+
+    const size_t maxIterations = 1000;
+    const size_t n = _nSims - 1;
+    Evaluation current, trial;
+    evaluate(f, current);
+
+    long double lastErr = HUGE_VALL;
+    size_t iteration = 1;
+    for (; ; ++iteration)
+      {
+	if (iteration > maxIterations)
+	  M_throw() << "The Newton solver failed to converge in " << maxIterations << " iterations";
+
+	//The reduced gradient and Hessian, without the reference system
+	std::vector<long double> gradient(n), step(n), hessian(n * n);
+	for (size_t k(0); k < n; ++k)
+	  {
+	    gradient[k] = 1 - c(current, k + 1);
+	    step[k] = -gradient[k];
+	    for (size_t l(0); l < n; ++l)
+	      hessian[k * n + l] = current.hessian[(k + 1) * _nSims + l + 1];
+	  }
+
+#if !defined(__APPLE__) && !defined(_WIN32)
+	//Products of tiny Hessian entries may harmlessly underflow
+	const int excepts = fedisableexcept(FE_UNDERFLOW);
+#endif
+	bool newton = choleskySolve(hessian, step);
+#if !defined(__APPLE__) && !defined(_WIN32)
+	feenableexcept(excepts);
+#endif
+	std::vector<long double> ftrial(f);
+	for (int attempt(0); ; ++attempt)
+	  {
+	    //Fall back to a self-consistent iteration step, which
+	    //always decreases the objective
+	    if (!newton)
+	      for (size_t k(0); k < n; ++k)
+		step[k] = current.logC[k + 1].empty() ? 0 : current.logC[k + 1].value();
+
+	    long double slope = 0;
+	    for (size_t k(0); k < n; ++k)
+	      slope += gradient[k] * step[k];
+
+	    //Backtracking line search
+	    long double t = 1;
+	    bool accepted = false;
+	    for (; t > 1e-8; t /= 2)
+	      {
+		for (size_t k(0); k < n; ++k)
+		  ftrial[k + 1] = f[k + 1] + t * step[k];
+		evaluate(ftrial, trial);
+		if (trial.objective <= current.objective + 1e-4 * t * slope
+		    + 64 * std::numeric_limits<long double>::epsilon() * std::fabs(current.objective))
+		  { accepted = true; break; }
+	      }
+
+	    if (accepted || !newton) break;
+	    newton = false;
+	  }
+
+	long double err = 0;
+	for (size_t k(1); k < _nSims; ++k)
+	  {
+	    const long double change = std::fabs(ftrial[k] - f[k]);
+	    err = std::max(err, (ftrial[k] == 0) ? change : change / std::fabs(ftrial[k]));
+	  }
+
+	f.swap(ftrial);
+	std::swap(current, trial);
+
+	printf("\r%E", double(err));
+	fflush(stdout);
+
+	//Stop when converged, or if rounding errors prevent any
+	//further improvement
+	if ((err <= minErr) || ((err < 1e-12) && (err >= lastErr)))
+	  break;
+	lastErr = err;
+      }
+
+    for (size_t k(0); k < _nSims; ++k)
+      SimulationDataData[k].logZ = f[k];
+
+    std::cout << "\nNewton minimisation complete in " << iteration << " iterations\n";
+    return iteration;
+  }
+
+  size_t _nSims;
+  std::vector<long double> _N;
+  std::vector<long double> _logN;
+  //The u_j(X) for each bin (row) and system (column)
+  std::vector<long double> _u;
+};
+
+
 void calcDensityOfStates()
 {
   densOStates.clear();
@@ -550,6 +931,9 @@ main(int argc, char *argv[])
       ("data-file", po::value<std::vector<std::string> >(), "Specify a config file to load, or just list them on the command line")
       ("alpha", po::value<long double>()->default_value(1), "A fraction of the difference between the old and new logZ's to use, use to stop divergence")
       ("NSteps,N", po::value<size_t>()->default_value(10), "Number of steps to take before testing the error and spitting out the current vals")
+      ("solver", po::value<std::string>()->default_value("newton"), "The method used to solve for the logZ's. \"newton\" minimises the MBAR objective function using Newton's method, \"iterate\" uses the rolling piecemeal self-consistent iteration")
+      ("n-threads", po::value<unsigned int>(), "Number of threads to spawn for solving for the logZ's, as for dynarun (by default the solver runs on the calling thread)")
+      ("benchmark", "Solve for the logZ's using both solvers, and report their run times and the difference between their solutions. The solution of the selected solver is used for the output")
       ("Tmin", po::value<double>(), "Set the coldest temperature to output calculated data for (Cv.out, Energy.out) etc. If unset this defaults to the temperature of the coldest simulation.")
       ("Tmax", po::value<double>(), "Set the hottest temperature to output calculated data for (Cv.out, Energy.out) etc. If unset this defaults to the temperature of the hottest simulation.")
       ;
@@ -571,6 +955,13 @@ main(int argc, char *argv[])
     alpha = vm["alpha"].as<long double>();
     NStepsPerStep = vm["NSteps"].as<size_t>();
 
+    const std::string solver = vm["solver"].as<std::string>();
+    if ((solver != "newton") && (solver != "iterate"))
+      M_throw() << "Unknown solver \"" << solver << "\", the available solvers are \"newton\" and \"iterate\"";
+
+    if (vm.count("n-threads"))
+      threadPool.setThreadCount(vm["n-threads"].as<unsigned int>());
+
     //Data load
     for (std::string fileName : vm["data-file"].as<std::vector<std::string> >())
       SimulationDataData.push_back(SimulationData(fileName));
@@ -606,7 +997,47 @@ main(int argc, char *argv[])
     for (const SimulationData& dat : SimulationDataData)
       std::cout << dat.fileName << " NData = " << dat.data.size() << " gamma[0] = " << dat.gamma[0] << "\n";
 
-    solveWeightsPiecemeal();
+    std::vector<std::string> solvers(1, solver);
+    if (vm.count("benchmark"))
+      solvers.insert(solvers.begin(), (solver == "newton") ? "iterate" : "newton");
+
+    std::vector<std::vector<long double> > solutions;
+    std::vector<double> runTimes;
+    std::vector<size_t> iterations;
+    for (const std::string& method : solvers)
+      {
+	for (SimulationData& dat : SimulationDataData)
+	  dat.logZ = dat.new_logZ = 0;
+
+	magnet::Timer timer;
+	if (method == "newton")
+	  iterations.push_back(NewtonSolver().solve());
+	else
+	  {
+	    const size_t start = iterationSweeps;
+	    solveWeightsPiecemeal();
+	    iterations.push_back(iterationSweeps - start);
+	  }
+	runTimes.push_back(timer.duration<std::ratio<1> >());
+
+	solutions.push_back(std::vector<long double>());
+	for (const SimulationData& dat : SimulationDataData)
+	  solutions.back().push_back(dat.logZ);
+      }
+
+    if (vm.count("benchmark"))
+      {
+	long double maxDiff = 0;
+	for (size_t i(0); i < SimulationDataData.size(); ++i)
+	  maxDiff = std::max(maxDiff, std::fabs(solutions[0][i] - solutions[1][i]));
+
+	std::cout << "##################################################\n";
+	std::cout << "Solver benchmark\n";
+	for (size_t i(0); i < solvers.size(); ++i)
+	  std::cout << solvers[i] << ": " << iterations[i] << ((solvers[i] == "newton") ? " iterations" : " sweeps")
+		    << " in " << runTimes[i] << "s\n";
+	std::cout << "Maximum difference in logZ = " << maxDiff << "\n";
+      }
     
     std::cout << "##################################################\n";
     for (const SimulationData& dat : SimulationDataData)
@@ -0,0 +1,87 @@
+#!/usr/bin/env python3
+#   dynamo:- Event driven molecular dynamics simulator 
+#   http://www.dynamomd.org
+#   Copyright (C) 2009  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+#
+#   This program is free software: you can redistribute it and/or
+#   modify it under the terms of the GNU General Public License
+#   version 3 as published by the Free Software Foundation.
+#
+#   This program is distributed in the hope that it will be useful,
+#   but WITHOUT ANY WARRANTY; without even the implied warranty of
+#   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#   GNU General Public License for more details.
+#
+#   You should have received a copy of the GNU General Public License
+#   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+import os
+import sys
+import getopt
+import subprocess
+import xml.etree.ElementTree as ET
+import dynamo
+
+shortargs=""
+longargs=["dynarun=", "dynamod="]
+try:
+    options, args = getopt.gnu_getopt(sys.argv[1:], shortargs, longargs)
+except getopt.GetoptError as err:
+    print(str(err))
+    sys.exit(2)
+
+dynarun_cmd="NOT SET"
+dynamod_cmd="NOT SET"
+
+for o,a in options:
+    if o == "--dynarun":
+        dynarun_cmd = a
+    if o == "--dynamod":
+        dynamod_cmd = a
+
+for name,exe in [("dynamod", dynamod_cmd), ("dynarun", dynarun_cmd)]:
+    if not(os.path.isfile(exe) and os.access(exe, os.X_OK)):
+        raise RuntimeError("Failed to find "+name+" executabe at "+exe)
+
+###### INITIALISATION
+Densities=[0.2, 0.5]
+for i,density in enumerate(Densities):
+    #The thermostat makes the runs depend on the random seed
+    cmd=[dynamod_cmd, "-m0", "-T1.0", "-d"+str(density), "-ob"+str(i)+".xml"]
+    print(" ".join(cmd))
+    subprocess.check_call(cmd)
+
+###### BATCH RUN (two configurations, three seeds each, two at a time)
+seeds=3
+cmd=[dynarun_cmd, "--engine=5", "--batch-seeds="+str(seeds), "--batch-concurrent=2", "-N2", "-c20000", "-obc%ID.xml", "--out-data-file=bo%ID.xml", "--batch-merged-file=merged.xml"]+["b"+str(i)+".xml" for i in range(len(Densities))]
+print(" ".join(cmd))
+subprocess.check_call(cmd)
+
+###### OUTPUT VALIDATION
+error_count = 0
+runs = seeds * len(Densities)
+
+pressures=[]
+for i in range(runs):
+    if not os.path.isfile("bc"+str(i)+".xml"):
+        error_count = error_count + 1
+        print("Missing the configuration of run "+str(i))
+    pressures.append(float(ET.parse("bo"+str(i)+".xml").getroot().find(".//Pressure").attrib["Avg"]))
+
+#Each seed must give a different run
+if len(set(pressures[0:seeds])) != seeds:
+    error_count = error_count + 1
+    print("Runs of the same configuration with different seeds are identical: "+str(pressures[0:seeds]))
+
+merged = ET.parse("merged.xml").getroot().find(".//Pressure")
+expected = sum(pressures) / runs
+if not dynamo.isclose(float(merged.attrib["Avg"]), expected, 1e-10):
+    error_count = error_count + 1
+    print("The merged pressure is not the mean of the runs: "+merged.attrib["Avg"]+"!="+str(expected))
+
+if float(merged.attrib["AvgStdErr"]) <= 0:
+    error_count = error_count + 1
+    print("The merged pressure has no standard error")
+
+print("Total errors:", error_count)
+sys.exit(error_count > 0)
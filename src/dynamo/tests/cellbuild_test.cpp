@@ -0,0 +1,147 @@
+#define BOOST_TEST_MODULE CellBuild_test
+#include <boost/test/included/unit_test.hpp>
+#include <dynamo/simulation.hpp>
+#include <dynamo/BC/include.hpp>
+#include <dynamo/ranges/include.hpp>
+#include <dynamo/inputplugins/cells/include.hpp>
+#include <dynamo/species/point.hpp>
+#include <dynamo/dynamics/newtonian.hpp>
+#include <dynamo/schedulers/include.hpp>
+#include <dynamo/schedulers/sorters/boundedPQFEL.hpp>
+#include <dynamo/schedulers/sorters/MinMaxPEL.hpp>
+#include <dynamo/globals/cells.hpp>
+#include <dynamo/interactions/hardsphere.hpp>
+#include <magnet/thread/workstealingpool.hpp>
+#include <magnet/timer.hpp>
+#include <random>
+
+std::mt19937 RNG;
+typedef dynamo::BoundedPQFEL<dynamo::MinMaxPEL<3> > DefaultSorter;
+
+//Exposes the cell building routines for testing
+struct TestCells: public dynamo::GCells
+{
+  TestCells(dynamo::Simulation* Sim): GCells(Sim, "SchedulerNBList") {}
+
+  using dynamo::GCells::buildCells;
+  using dynamo::GCells::buildCellsIncremental;
+
+  //The contents of every cell, and the cell of every particle
+  std::pair<std::vector<std::vector<size_t> >, std::vector<size_t> > state() const
+  {
+    std::vector<std::vector<size_t> > contents(_ordering.length());
+    for (size_t cell(0); cell < _ordering.length(); ++cell)
+      for (const size_t& id : _cellData.getCellContents(cell))
+	contents[cell].push_back(id);
+
+    std::vector<size_t> cells(Sim->N());
+    for (size_t id(0); id < Sim->N(); ++id)
+      cells[id] = _cellData.getCellID(id);
+
+    return std::make_pair(contents, cells);
+  }
+};
+
+dynamo::Vector getRandVelVec()
+{
+  //See http://mathworld.wolfram.com/SpherePointPicking.html
+  std::normal_distribution<> normal_dist(0.0, (1.0 / sqrt(double(NDIM))));
+
+  dynamo::Vector tmpVec;
+  for (size_t iDim = 0; iDim < NDIM; iDim++)
+    tmpVec[iDim] = normal_dist(RNG);
+
+  return tmpVec;
+}
+
+//4 * 40^3 = 256000 particles, enough to use the parallel build
+void init(dynamo::Simulation& Sim, const double density)
+{
+  RNG.seed(std::random_device()());
+  Sim.ranGenerator.seed(std::random_device()());
+
+  Sim.dynamics = dynamo::shared_ptr<dynamo::Dynamics>(new dynamo::DynNewtonian(&Sim));
+  Sim.BCs = dynamo::shared_ptr<dynamo::BoundaryCondition>(new dynamo::BCPeriodic(&Sim));
+  Sim.ptrScheduler = dynamo::shared_ptr<dynamo::SNeighbourList>(new dynamo::SNeighbourList(&Sim, new DefaultSorter()));
+
+  std::unique_ptr<dynamo::UCell> packptr(new dynamo::CUFCC(std::array<long, 3>{{40,40,40}}, dynamo::Vector{1,1,1}, new dynamo::UParticle()));
+  packptr->initialise();
+  std::vector<dynamo::Vector> latticeSites(packptr->placeObjects(dynamo::Vector{0,0,0}));
+  Sim.primaryCellSize = dynamo::Vector{1,1,1};
+
+  double particleDiam = std::cbrt(density / latticeSites.size());
+  Sim.interactions.push_back(dynamo::shared_ptr<dynamo::Interaction>(new dynamo::IHardSphere(&Sim, particleDiam, 1.0, new dynamo::IDPairRangeAll(), "Bulk")));
+  Sim.addSpecies(dynamo::shared_ptr<dynamo::Species>(new dynamo::SpPoint(&Sim, new dynamo::IDRangeAll(&Sim), 1.0, "Bulk", 0)));
+  Sim.units.setUnitLength(particleDiam);
+
+  unsigned long nParticles = 0;
+  Sim.particles.reserve(latticeSites.size());
+  for (const dynamo::Vector & position : latticeSites)
+    Sim.particles.push_back(dynamo::Particle(position, getRandVelVec() * Sim.units.unitVelocity(), nParticles++));
+
+  dynamo::shared_ptr<TestCells> cells(new TestCells(&Sim));
+  cells->setConfigOutput(false);
+  Sim.globals.push_back(cells);
+
+  Sim.ensemble = dynamo::Ensemble::loadEnsemble(Sim);
+}
+
+BOOST_AUTO_TEST_CASE( Bulk_Cell_Build )
+{
+  //The bulk build is split across a pool as the coordinator would
+  magnet::thread::WorkStealingPool pool;
+  pool.setThreadCount(4);
+
+  dynamo::Simulation Sim;
+  Sim.threadPool = &pool;
+  init(Sim, 0.5);
+  Sim.initialise();
+
+  //Move the system forward so the particles have left their lattice sites
+  for (size_t i(0); i < 100000; ++i)
+    Sim.runSimulationStep();
+
+  TestCells& cells = static_cast<TestCells&>(*Sim.globals[0]);
+
+  double incrementalTime, bulkTime;
+  {
+    magnet::Timer timer;
+    cells.buildCellsIncremental();
+    incrementalTime = timer.duration<std::milli>();
+  }
+  const auto incremental = cells.state();
+
+  {
+    magnet::Timer timer;
+    cells.buildCells();
+    bulkTime = timer.duration<std::milli>();
+  }
+  const auto bulk = cells.state();
+
+  BOOST_TEST_MESSAGE(Sim.N() << " particles, incremental cell build " << incrementalTime << "ms, bulk cell build " << bulkTime << "ms");
+
+  //The bulk build is stable, so even the order of the cell contents
+  //must match
+  BOOST_CHECK(incremental.first == bulk.first);
+  BOOST_CHECK(incremental.second == bulk.second);
+
+  //The simulation must continue correctly with the rebuilt cells
+  Sim.ptrScheduler->rebuildList();
+  Sim.endEventCount = Sim.eventCount + 10000;
+  while (Sim.runSimulationStep()) {}
+
+  //Simulation::checkSystem tests every pair, which is too slow for
+  //this many particles, so only the neighbouring pairs are tested.
+  Sim.dynamics->updateAllParticles();
+  size_t errors = 0;
+  std::vector<size_t> neighbours;
+  for (const dynamo::Particle& p1 : Sim.particles)
+    {
+      neighbours.clear();
+      cells.getParticleNeighbours(p1, neighbours);
+      for (const size_t id : neighbours)
+	if (id > p1.getID())
+	  errors += Sim.getInteraction(p1, Sim.particles[id])->validateState(p1, Sim.particles[id]);
+    }
+  BOOST_CHECK_MESSAGE(errors <= 1, "There are more than two invalid states in the final configuration");
+}
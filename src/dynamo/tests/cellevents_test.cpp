@@ -0,0 +1,119 @@
+#define BOOST_TEST_MODULE CellEvents_test
+#include <boost/test/included/unit_test.hpp>
+#include <dynamo/simulation.hpp>
+#include <dynamo/BC/include.hpp>
+#include <dynamo/ranges/include.hpp>
+#include <dynamo/inputplugins/cells/include.hpp>
+#include <dynamo/species/point.hpp>
+#include <dynamo/dynamics/newtonian.hpp>
+#include <dynamo/schedulers/include.hpp>
+#include <dynamo/schedulers/sorters/boundedPQFEL.hpp>
+#include <dynamo/schedulers/sorters/MinMaxPEL.hpp>
+#include <dynamo/globals/cells.hpp>
+#include <dynamo/interactions/hardsphere.hpp>
+#include <magnet/timer.hpp>
+#include <random>
+
+std::mt19937 RNG;
+typedef dynamo::BoundedPQFEL<dynamo::MinMaxPEL<3> > DefaultSorter;
+
+dynamo::Vector getRandVelVec()
+{
+  //See http://mathworld.wolfram.com/SpherePointPicking.html
+  std::normal_distribution<> normal_dist(0.0, (1.0 / sqrt(double(NDIM))));
+
+  dynamo::Vector tmpVec;
+  for (size_t iDim = 0; iDim < NDIM; iDim++)
+    tmpVec[iDim] = normal_dist(RNG);
+
+  return tmpVec;
+}
+
+void init(dynamo::Simulation& Sim, const double density)
+{
+  RNG.seed(std::random_device()());
+  Sim.ranGenerator.seed(std::random_device()());
+
+  Sim.dynamics = dynamo::shared_ptr<dynamo::Dynamics>(new dynamo::DynNewtonian(&Sim));
+  Sim.BCs = dynamo::shared_ptr<dynamo::BoundaryCondition>(new dynamo::BCPeriodic(&Sim));
+  Sim.ptrScheduler = dynamo::shared_ptr<dynamo::SNeighbourList>(new dynamo::SNeighbourList(&Sim, new DefaultSorter()));
+
+  std::unique_ptr<dynamo::UCell> packptr(new dynamo::CUFCC(std::array<long, 3>{{20,20,20}}, dynamo::Vector{1,1,1}, new dynamo::UParticle()));
+  packptr->initialise();
+  std::vector<dynamo::Vector> latticeSites(packptr->placeObjects(dynamo::Vector{0,0,0}));
+  Sim.primaryCellSize = dynamo::Vector{1,1,1};
+
+  double particleDiam = std::cbrt(density / latticeSites.size());
+  Sim.interactions.push_back(dynamo::shared_ptr<dynamo::Interaction>(new dynamo::IHardSphere(&Sim, particleDiam, 1.0, new dynamo::IDPairRangeAll(), "Bulk")));
+  Sim.addSpecies(dynamo::shared_ptr<dynamo::Species>(new dynamo::SpPoint(&Sim, new dynamo::IDRangeAll(&Sim), 1.0, "Bulk", 0)));
+  Sim.units.setUnitLength(particleDiam);
+
+  unsigned long nParticles = 0;
+  Sim.particles.reserve(latticeSites.size());
+  for (const dynamo::Vector & position : latticeSites)
+    Sim.particles.push_back(dynamo::Particle(position, getRandVelVec() * Sim.units.unitVelocity(), nParticles++));
+
+  //Some particles with zero (and negative zero) velocity components
+  Sim.particles[0].getVelocity()[0] = 0;
+  Sim.particles[1].getVelocity()[1] = -0.0;
+  Sim.particles[2].getVelocity() = dynamo::Vector{0, 0, -1};
+
+  Sim.ensemble = dynamo::Ensemble::loadEnsemble(Sim);
+}
+
+BOOST_AUTO_TEST_CASE( Bulk_Cell_Events )
+{
+  dynamo::Simulation Sim;
+  init(Sim, 0.1);
+  Sim.initialise();
+
+  //Move the system forward so the particles have delayed states
+  for (size_t i(0); i < 10000; ++i)
+    Sim.runSimulationStep();
+
+  dynamo::shared_ptr<dynamo::GCells> cells;
+  for (const auto& glob : Sim.globals)
+    if (std::dynamic_pointer_cast<dynamo::GCells>(glob))
+      cells = std::dynamic_pointer_cast<dynamo::GCells>(glob);
+  BOOST_REQUIRE(cells);
+
+  std::vector<size_t> ids(Sim.N());
+  for (size_t id(0); id < ids.size(); ++id)
+    ids[id] = id;
+
+  std::vector<dynamo::Event> events;
+  cells->getEvents(ids, events);
+  BOOST_REQUIRE_EQUAL(events.size(), ids.size());
+  for (size_t i(0); i < ids.size(); ++i)
+    {
+      const dynamo::Event scalar = cells->getEvent(Sim.particles[ids[i]]);
+      BOOST_CHECK_EQUAL(events[i]._dt, scalar._dt);
+      BOOST_CHECK_EQUAL(events[i]._particle1ID, scalar._particle1ID);
+      BOOST_CHECK_EQUAL(events[i]._type, scalar._type);
+    }
+
+  //Benchmark the bulk path against the scalar path
+  const size_t passes = 20;
+  double bulkTime, scalarTime;
+  {
+    magnet::Timer timer;
+    for (size_t i(0); i < passes; ++i)
+      cells->getEvents(ids, events);
+    bulkTime = timer.duration<std::nano>() / (passes * ids.size());
+  }
+
+  {
+    magnet::Timer timer;
+    for (size_t i(0); i < passes; ++i)
+      cells->dynamo::Global::getEvents(ids, events);
+    scalarTime = timer.duration<std::nano>() / (passes * ids.size());
+  }
+
+  BOOST_TEST_MESSAGE(ids.size() << " particles, scalar cell events " << scalarTime << " ns / particle, bulk cell events " << bulkTime << " ns / particle");
+
+  //The bulk rebuild must leave a consistent simulation
+  Sim.ptrScheduler->rebuildList();
+  Sim.endEventCount = Sim.eventCount + 10000;
+  while (Sim.runSimulationStep()) {}
+  BOOST_CHECK_MESSAGE(Sim.checkSystem() <= 1, "There are more than two invalid states in the final configuration");
+}
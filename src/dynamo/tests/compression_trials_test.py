@@ -0,0 +1,105 @@
+#!/usr/bin/env python3
+#   dynamo:- Event driven molecular dynamics simulator 
+#   http://www.dynamomd.org
+#   Copyright (C) 2009  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+#
+#   This program is free software: you can redistribute it and/or
+#   modify it under the terms of the GNU General Public License
+#   version 3 as published by the Free Software Foundation.
+#
+#   This program is distributed in the hope that it will be useful,
+#   but WITHOUT ANY WARRANTY; without even the implied warranty of
+#   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#   GNU General Public License for more details.
+#
+#   You should have received a copy of the GNU General Public License
+#   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+import os
+import sys
+import getopt
+import subprocess
+import xml.etree.ElementTree as ET
+import dynamo
+
+shortargs=""
+longargs=["dynarun=", "dynamod="]
+try:
+    options, args = getopt.gnu_getopt(sys.argv[1:], shortargs, longargs)
+except getopt.GetoptError as err:
+    print(str(err))
+    sys.exit(2)
+
+dynarun_cmd="NOT SET"
+dynamod_cmd="NOT SET"
+
+for o,a in options:
+    if o == "--dynarun":
+        dynarun_cmd = a
+    if o == "--dynamod":
+        dynamod_cmd = a
+
+for name,exe in [("dynamod", dynamod_cmd), ("dynarun", dynarun_cmd)]:
+    if not(os.path.isfile(exe) and os.access(exe, os.X_OK)):
+        raise RuntimeError("Failed to find "+name+" executabe at "+exe)
+
+###### INITIALISATION
+cmd=[dynamod_cmd, "-m0", "-C4", "-d0.5", "-oc.xml"]
+print(" ".join(cmd))
+subprocess.check_call(cmd)
+
+###### COMPRESSION TRIALS (two growth rates, two seeds each, two at a time)
+seeds=2
+rates=[0.5, 1.0]
+target=0.45
+cmd=[dynarun_cmd, "--engine=3", "--compression-trials="+str(seeds), "--trial-growth-rates"]+[str(rate) for rate in rates]+["--target-pack-frac="+str(target), "-N2", "-s1", "--keep-trials=all", "-occ%ID.xml", "--out-data-file=co%ID.xml", "--trials-file=trials.xml", "c.xml"]
+print(" ".join(cmd))
+subprocess.check_call(cmd)
+
+###### OUTPUT VALIDATION
+error_count = 0
+runs = seeds * len(rates)
+
+root = ET.parse("trials.xml").getroot()
+trials = root.findall("Trial")
+if len(trials) != runs:
+    error_count = error_count + 1
+    print("Expected "+str(runs)+" trials in the summary, found "+str(len(trials)))
+
+densest = 0
+for trial in trials:
+    ID = int(trial.attrib["ID"])
+    packfrac = float(trial.attrib["PackingFraction"])
+    densest = max(densest, packfrac)
+    
+    if float(trial.attrib["GrowthRate"]) != rates[ID // seeds]:
+        error_count = error_count + 1
+        print("Trial "+str(ID)+" ran at the wrong growth rate "+trial.attrib["GrowthRate"])
+
+    if int(trial.attrib["Seed"]) != 1 + ID:
+        error_count = error_count + 1
+        print("Trial "+str(ID)+" used the wrong seed "+trial.attrib["Seed"])
+
+    #Every trial must reach the target packing fraction
+    if not dynamo.isclose(packfrac, target, 1e-6):
+        error_count = error_count + 1
+        print("Trial "+str(ID)+" did not reach the target packing fraction: "+str(packfrac))
+
+    for fmt in ["cc%ID.xml", "co%ID.xml"]:
+        if not os.path.isfile(fmt.replace("%ID", str(ID))):
+            error_count = error_count + 1
+            print("Missing the output file "+fmt.replace("%ID", str(ID)))
+
+#Each seed must give a different trial
+events=[trial.attrib["Events"] for trial in trials[0:seeds]]
+if len(set(events)) != seeds:
+    error_count = error_count + 1
+    print("Trials at the same growth rate with different seeds are identical: "+str(events))
+
+densestID = int(root.attrib["Densest"])
+if float(trials[densestID].attrib["PackingFraction"]) != densest:
+    error_count = error_count + 1
+    print("The densest trial is not trial "+str(densestID))
+
+print("Total errors:", error_count)
+sys.exit(error_count > 0)
@@ -0,0 +1,103 @@
+#!/usr/bin/env python3
+#   dynamo:- Event driven molecular dynamics simulator 
+#   http://www.dynamomd.org
+#   Copyright (C) 2009  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+#
+#   This program is free software: you can redistribute it and/or
+#   modify it under the terms of the GNU General Public License
+#   version 3 as published by the Free Software Foundation.
+#
+#   This program is distributed in the hope that it will be useful,
+#   but WITHOUT ANY WARRANTY; without even the implied warranty of
+#   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#   GNU General Public License for more details.
+#
+#   You should have received a copy of the GNU General Public License
+#   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Checks the maps rebuilt from the stored deltas of the Contactmap
+# plugin: every map must be distinct, and every link must join two
+# maps which differ in the state of a single pair.
+import dynamo
+import os
+import sys
+import getopt
+import subprocess
+import xml.etree.ElementTree as ET
+
+error_count=0
+
+shortargs=""
+longargs=["dynarun="]
+try:
+    options, args = getopt.gnu_getopt(sys.argv[1:], shortargs, longargs)
+except getopt.GetoptError as err:
+    print(str(err))
+    sys.exit(2)
+
+dynarun_cmd="NOT SET"
+for o,a in options:
+    if o == "--dynarun":
+        dynarun_cmd = a
+
+if not(os.path.isfile(dynarun_cmd) and os.access(dynarun_cmd, os.X_OK)):
+    raise RuntimeError("Failed to find dynarun executabe at "+dynarun_cmd+"\,"+str(sys.argv))
+        
+doc = dynamo.basicDoc
+doc.find('./Simulation/SimulationSize').attrib.update({'x':'4', 'y':'4', 'z':'4'})
+
+dynamo.addParticle(doc, pos=[0,0,0], vel=[1,0.3,0])
+dynamo.addParticle(doc, pos=[0.9,0,0], vel=[-1,0,0.2])
+dynamo.addParticle(doc, pos=[-0.5,1.2,0.7], vel=[0.1,-0.7,0.4])
+
+interactions = doc.find('./Simulation/Interactions')
+interaction = ET.SubElement(interactions, 'Interaction', {'Type':'Stepped', 'LengthScale':'1', 'EnergyScale':'1', 'Name':'Bulk'})
+ET.SubElement(interaction, 'IDPairRange', {'Type':'All'})
+potential = ET.SubElement(interaction, 'Potential', {'Type':'Stepped', 'Direction':'Left'})
+ET.SubElement(potential, 'Step', {'R':'1.0', 'E':'-0.5'})
+ET.SubElement(potential, 'Step', {'R':'0.5', 'E':'-0.75'})
+
+open('contactmap.xml', 'w').write(dynamo.prettyprint(doc))
+
+cmd=[dynarun_cmd, "contactmap.xml", '-c100000', '-L', 'Contactmap:Interaction=Bulk', '--out-data-file=contactmap_output.xml']
+print(" ".join(cmd))
+subprocess.check_call(cmd)
+
+output = ET.parse('contactmap_output.xml')
+maps = {}
+weight = 0
+for maptag in output.findall('./ContactMap/Maps/Map'):
+    contacts = frozenset((int(c.attrib['ID1']), int(c.attrib['ID2']), int(c.attrib['State'])) for c in maptag.findall('Contact'))
+    maps[int(maptag.attrib['ID'])] = contacts
+    weight += float(maptag.attrib['Weight'])
+
+print("Maps", len(maps))
+if sorted(maps.keys()) != list(range(int(output.find('./ContactMap/Maps').attrib['Count']))):
+    print("Map IDs are not contiguous")
+    error_count += 1
+
+if len(set(maps.values())) != len(maps):
+    print("Duplicate maps were stored")
+    error_count += 1
+
+if len(maps) < 3:
+    print("Too few maps were visited to test the plugin")
+    error_count += 1
+
+if not dynamo.isclose(weight, 1.0, 1e-6):
+    print("Map weights sum to", weight)
+    error_count += 1
+
+def states(contacts):
+    return {(c[0], c[1]):c[2] for c in contacts}
+
+for link in output.findall('./ContactMap/Links/Link'):
+    source = states(maps[int(link.attrib['Source'])])
+    target = states(maps[int(link.attrib['Target'])])
+    changed = [pair for pair in set(source) | set(target) if source.get(pair, 0) != target.get(pair, 0)]
+    if len(changed) > 1:
+        print("Link", link.attrib, "changes", len(changed), "pairs")
+        error_count += 1
+
+print("Total errors:", error_count)
+sys.exit(error_count > 0)
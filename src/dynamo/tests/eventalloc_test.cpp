@@ -0,0 +1,82 @@
+#define BOOST_TEST_MODULE EventAlloc_test
+#define MAGNET_DEFINE_ALLOCATION_COUNTER
+#include <boost/test/included/unit_test.hpp>
+#include <magnet/memory/allocation_counter.hpp>
+#include <dynamo/simulation.hpp>
+#include <dynamo/BC/include.hpp>
+#include <dynamo/ranges/include.hpp>
+#include <dynamo/inputplugins/cells/include.hpp>
+#include <dynamo/species/point.hpp>
+#include <dynamo/dynamics/newtonian.hpp>
+#include <dynamo/schedulers/include.hpp>
+#include <dynamo/schedulers/sorters/boundedPQFEL.hpp>
+#include <dynamo/schedulers/sorters/MinMaxPEL.hpp>
+#include <dynamo/interactions/hardsphere.hpp>
+#include <magnet/timer.hpp>
+#include <random>
+
+std::mt19937 RNG;
+typedef dynamo::BoundedPQFEL<dynamo::MinMaxPEL<3> > DefaultSorter;
+
+dynamo::Vector getRandVelVec()
+{
+  //See http://mathworld.wolfram.com/SpherePointPicking.html
+  std::normal_distribution<> normal_dist(0.0, (1.0 / sqrt(double(NDIM))));
+
+  dynamo::Vector tmpVec;
+  for (size_t iDim = 0; iDim < NDIM; iDim++)
+    tmpVec[iDim] = normal_dist(RNG);
+
+  return tmpVec;
+}
+
+void init(dynamo::Simulation& Sim, const double density)
+{
+  RNG.seed(1);
+  Sim.ranGenerator.seed(1);
+
+  Sim.dynamics = dynamo::shared_ptr<dynamo::Dynamics>(new dynamo::DynNewtonian(&Sim));
+  Sim.BCs = dynamo::shared_ptr<dynamo::BoundaryCondition>(new dynamo::BCPeriodic(&Sim));
+  Sim.ptrScheduler = dynamo::shared_ptr<dynamo::SNeighbourList>(new dynamo::SNeighbourList(&Sim, new DefaultSorter()));
+
+  std::unique_ptr<dynamo::UCell> packptr(new dynamo::CUFCC(std::array<long, 3>{{10,10,10}}, dynamo::Vector{1,1,1}, new dynamo::UParticle()));
+  packptr->initialise();
+  std::vector<dynamo::Vector> latticeSites(packptr->placeObjects(dynamo::Vector{0,0,0}));
+  Sim.primaryCellSize = dynamo::Vector{1,1,1};
+
+  double particleDiam = std::cbrt(density / latticeSites.size());
+  Sim.interactions.push_back(dynamo::shared_ptr<dynamo::Interaction>(new dynamo::IHardSphere(&Sim, particleDiam, 1.0, new dynamo::IDPairRangeAll(), "Bulk")));
+  Sim.addSpecies(dynamo::shared_ptr<dynamo::Species>(new dynamo::SpPoint(&Sim, new dynamo::IDRangeAll(&Sim), 1.0, "Bulk", 0)));
+  Sim.units.setUnitLength(particleDiam);
+
+  unsigned long nParticles = 0;
+  Sim.particles.reserve(latticeSites.size());
+  for (const dynamo::Vector & position : latticeSites)
+    Sim.particles.push_back(dynamo::Particle(position, getRandVelVec() * Sim.units.unitVelocity(), nParticles++));
+
+  Sim.ensemble = dynamo::Ensemble::loadEnsemble(Sim);
+}
+
+BOOST_AUTO_TEST_CASE( Event_Allocations )
+{
+  dynamo::Simulation Sim;
+  init(Sim, 0.5);
+  Sim.initialise();
+
+  //Let the event queue and the scratch storage reach their working sizes
+  Sim.endEventCount = 20000;
+  while (Sim.runSimulationStep(true)) {}
+
+  const size_t events = 200000;
+  Sim.endEventCount = Sim.eventCount + events;
+  const size_t startCount = magnet::memory::allocationCount();
+  magnet::Timer timer;
+  while (Sim.runSimulationStep(true)) {}
+  const double seconds = timer.duration<std::ratio<1> >();
+  const double allocations = double(magnet::memory::allocationCount() - startCount) / events;
+
+  BOOST_TEST_MESSAGE(Sim.N() << " hard spheres: " << allocations << " heap allocations per event, " 
+		     << events / seconds << " events per second");
+  BOOST_CHECK(allocations < 0.01);
+  BOOST_CHECK(Sim.checkSystem() <= 1);
+}
@@ -0,0 +1,158 @@
+#define BOOST_TEST_MODULE EventCounters_test
+#include <boost/test/included/unit_test.hpp>
+#include <dynamo/simulation.hpp>
+#include <dynamo/BC/include.hpp>
+#include <dynamo/ranges/include.hpp>
+#include <dynamo/inputplugins/cells/include.hpp>
+#include <dynamo/species/point.hpp>
+#include <dynamo/dynamics/newtonian.hpp>
+#include <dynamo/schedulers/include.hpp>
+#include <dynamo/schedulers/sorters/boundedPQFEL.hpp>
+#include <dynamo/schedulers/sorters/MinMaxPEL.hpp>
+#include <dynamo/interactions/hardsphere.hpp>
+#include <dynamo/outputplugins/misc.hpp>
+#include <dynamo/outputplugins/collMatrix.hpp>
+#include <magnet/timer.hpp>
+#include <random>
+#include <limits>
+
+std::mt19937 RNG;
+typedef dynamo::BoundedPQFEL<dynamo::MinMaxPEL<3> > DefaultSorter;
+
+dynamo::Vector getRandVelVec()
+{
+  //See http://mathworld.wolfram.com/SpherePointPicking.html
+  std::normal_distribution<> normal_dist(0.0, (1.0 / sqrt(double(NDIM))));
+
+  dynamo::Vector tmpVec;
+  for (size_t iDim = 0; iDim < NDIM; iDim++)
+    tmpVec[iDim] = normal_dist(RNG);
+
+  return tmpVec;
+}
+
+void init(dynamo::Simulation& Sim, const double density)
+{
+  RNG.seed(1);
+  Sim.ranGenerator.seed(1);
+
+  Sim.dynamics = dynamo::shared_ptr<dynamo::Dynamics>(new dynamo::DynNewtonian(&Sim));
+  Sim.BCs = dynamo::shared_ptr<dynamo::BoundaryCondition>(new dynamo::BCPeriodic(&Sim));
+  Sim.ptrScheduler = dynamo::shared_ptr<dynamo::SNeighbourList>(new dynamo::SNeighbourList(&Sim, new DefaultSorter()));
+
+  std::unique_ptr<dynamo::UCell> packptr(new dynamo::CUFCC(std::array<long, 3>{{10,10,10}}, dynamo::Vector{1,1,1}, new dynamo::UParticle()));
+  packptr->initialise();
+  std::vector<dynamo::Vector> latticeSites(packptr->placeObjects(dynamo::Vector{0,0,0}));
+  Sim.primaryCellSize = dynamo::Vector{1,1,1};
+
+  double particleDiam = std::cbrt(density / latticeSites.size());
+  Sim.interactions.push_back(dynamo::shared_ptr<dynamo::Interaction>(new dynamo::IHardSphere(&Sim, particleDiam, 1.0, new dynamo::IDPairRangeAll(), "Bulk")));
+  Sim.addSpecies(dynamo::shared_ptr<dynamo::Species>(new dynamo::SpPoint(&Sim, new dynamo::IDRangeAll(&Sim), 1.0, "Bulk", 0)));
+  Sim.units.setUnitLength(particleDiam);
+
+  unsigned long nParticles = 0;
+  Sim.particles.reserve(latticeSites.size());
+  for (const dynamo::Vector & position : latticeSites)
+    Sim.particles.push_back(dynamo::Particle(position, getRandVelVec() * Sim.units.unitVelocity(), nParticles++));
+
+  Sim.ensemble = dynamo::Ensemble::loadEnsemble(Sim);
+}
+
+const dynamo::EEventType streamTypes[] = {dynamo::CORE, dynamo::STEP_IN, dynamo::STEP_OUT, dynamo::BOUNCE};
+
+//! A stream of 64 pair events of interaction 0 cycling through a few
+//! event types. Each particle takes part in one event, so the
+//! particles 2n and 2n+1 always see the event type streamTypes[n % 4].
+std::vector<std::pair<dynamo::Event, dynamo::NEventData> > eventStream(const dynamo::Simulation& Sim)
+{
+  std::vector<std::pair<dynamo::Event, dynamo::NEventData> > stream;
+  for (size_t i(0); i < 64; ++i)
+    {
+      const dynamo::Particle& p1 = Sim.particles[(2 * i) % Sim.N()];
+      const dynamo::Particle& p2 = Sim.particles[(2 * i + 1) % Sim.N()];
+      const dynamo::EEventType type = streamTypes[i % 4];
+      dynamo::PairEventData data(p1, p2, *Sim.species(p1), *Sim.species(p2), type);
+      data.impulse = dynamo::Vector{0, 0, 0};
+      data.rvdot = 0;
+      stream.push_back(std::make_pair(dynamo::Event(p1.getID(), 0, dynamo::INTERACTION, type, 0, p2.getID()), dynamo::NEventData(data)));
+    }
+  return stream;
+}
+
+//! Average wall-clock cost of one eventUpdate call on a plugin, in
+//! nanoseconds, for the eventStream.
+double eventCost(dynamo::OutputPlugin& plugin, const dynamo::Simulation& Sim, const size_t events)
+{
+  const std::vector<std::pair<dynamo::Event, dynamo::NEventData> > stream = eventStream(Sim);
+
+  double best = std::numeric_limits<double>::infinity();
+  for (size_t repeat(0); repeat < 3; ++repeat)
+    {
+      magnet::Timer timer;
+      for (size_t i(0); i < events; ++i)
+	plugin.eventUpdate(stream[i % stream.size()].first, stream[i % stream.size()].second);
+      best = std::min(best, timer.duration<std::ratio<1> >());
+    }
+  return 1e9 * best / events;
+}
+
+BOOST_AUTO_TEST_CASE( Event_Counter_Cost )
+{
+  dynamo::Simulation Sim;
+  init(Sim, 0.5);
+  Sim.addOutputPlugin("Misc");
+  Sim.addOutputPlugin("CollisionMatrix");
+  Sim.initialise();
+
+  Sim.endEventCount = 20000;
+  while (Sim.runSimulationStep(true)) {}
+
+  const size_t events = 1000000;
+  BOOST_TEST_MESSAGE("Misc: " << eventCost(*Sim.getOutputPlugin<dynamo::OPMisc>(), Sim, events) << " ns per event");
+  BOOST_TEST_MESSAGE("CollisionMatrix: " << eventCost(*Sim.getOutputPlugin<dynamo::OPCollMatrix>(), Sim, events) << " ns per event");
+
+  //The plugins must still be able to write out what they counted
+  magnet::xml::XmlStream XML;
+  BOOST_CHECK_NO_THROW(Sim.getOutputPlugin<dynamo::OPMisc>()->output(XML));
+  BOOST_CHECK_NO_THROW(Sim.getOutputPlugin<dynamo::OPCollMatrix>()->output(XML));
+}
+
+BOOST_AUTO_TEST_CASE( Event_Counts )
+{
+  dynamo::Simulation Sim;
+  init(Sim, 0.5);
+  Sim.addOutputPlugin("Misc");
+  Sim.addOutputPlugin("CollisionMatrix");
+  Sim.initialise();
+
+  const size_t passes = 10;
+  const std::vector<std::pair<dynamo::Event, dynamo::NEventData> > stream = eventStream(Sim);
+  for (size_t pass(0); pass < passes; ++pass)
+    for (const auto& event : stream)
+      {
+	Sim.getOutputPlugin<dynamo::OPMisc>()->eventUpdate(event.first, event.second);
+	Sim.getOutputPlugin<dynamo::OPCollMatrix>()->eventUpdate(event.first, event.second);
+      }
+
+  const dynamo::OPMisc& misc = *Sim.getOutputPlugin<dynamo::OPMisc>();
+  const dynamo::OPCollMatrix& collMatrix = *Sim.getOutputPlugin<dynamo::OPCollMatrix>();
+  const dynamo::EventTypeTracking::classKey interaction(0, dynamo::INTERACTION);
+
+  //Each pair event is counted once, a quarter of the stream is each type
+  for (const dynamo::EEventType type : streamTypes)
+    BOOST_CHECK_EQUAL(misc.getEventCount(dynamo::EventKey(interaction, type)), passes * stream.size() / 4);
+  BOOST_CHECK_EQUAL(misc.getEventCount(dynamo::EventKey(interaction, dynamo::WALL)), size_t(0));
+
+  //Each of the 128 particles has its first event counted as an
+  //initial event, then always transitions to the same event type
+  BOOST_CHECK_EQUAL(collMatrix.getTotalCount(), 2 * stream.size() * (passes - 1));
+  for (const dynamo::EEventType type : streamTypes)
+    {
+      const dynamo::EventKey key(interaction, type);
+      BOOST_CHECK_EQUAL(collMatrix.getInitialCount(key), 2 * stream.size() / 4);
+      BOOST_CHECK_EQUAL(collMatrix.getTransitionCount(key, key), 2 * stream.size() * (passes - 1) / 4);
+      for (const dynamo::EEventType last : streamTypes)
+	if (last != type)
+	  BOOST_CHECK_EQUAL(collMatrix.getTransitionCount(key, dynamo::EventKey(interaction, last)), 0ul);
+    }
+}
@@ -0,0 +1,117 @@
+#define BOOST_TEST_MODULE NeighbourListStats_test
+#include <boost/test/included/unit_test.hpp>
+#include <dynamo/simulation.hpp>
+#include <dynamo/BC/include.hpp>
+#include <dynamo/ranges/include.hpp>
+#include <dynamo/inputplugins/cells/include.hpp>
+#include <dynamo/species/point.hpp>
+#include <dynamo/dynamics/newtonian.hpp>
+#include <dynamo/schedulers/include.hpp>
+#include <dynamo/schedulers/sorters/boundedPQFEL.hpp>
+#include <dynamo/schedulers/sorters/MinMaxPEL.hpp>
+#include <dynamo/interactions/hardsphere.hpp>
+#include <dynamo/globals/neighbourList.hpp>
+#include <dynamo/outputplugins/nblistStats.hpp>
+#include <thread>
+#include <sstream>
+
+typedef dynamo::BoundedPQFEL<dynamo::MinMaxPEL<3> > DefaultSorter;
+
+//A 4x4x4 FCC lattice of 256 stationary hard spheres
+void init(dynamo::Simulation& Sim, const double density)
+{
+  Sim.ranGenerator.seed(1);
+
+  Sim.dynamics = dynamo::shared_ptr<dynamo::Dynamics>(new dynamo::DynNewtonian(&Sim));
+  Sim.BCs = dynamo::shared_ptr<dynamo::BoundaryCondition>(new dynamo::BCPeriodic(&Sim));
+  Sim.ptrScheduler = dynamo::shared_ptr<dynamo::SNeighbourList>(new dynamo::SNeighbourList(&Sim, new DefaultSorter()));
+
+  std::unique_ptr<dynamo::UCell> packptr(new dynamo::CUFCC(std::array<long, 3>{{4,4,4}}, dynamo::Vector{1,1,1}, new dynamo::UParticle()));
+  packptr->initialise();
+  std::vector<dynamo::Vector> latticeSites(packptr->placeObjects(dynamo::Vector{0,0,0}));
+  Sim.primaryCellSize = dynamo::Vector{1,1,1};
+
+  double particleDiam = std::cbrt(density / latticeSites.size());
+  Sim.interactions.push_back(dynamo::shared_ptr<dynamo::Interaction>(new dynamo::IHardSphere(&Sim, particleDiam, 1.0, new dynamo::IDPairRangeAll(), "Bulk")));
+  Sim.addSpecies(dynamo::shared_ptr<dynamo::Species>(new dynamo::SpPoint(&Sim, new dynamo::IDRangeAll(&Sim), 1.0, "Bulk", 0)));
+  Sim.units.setUnitLength(particleDiam);
+
+  unsigned long nParticles = 0;
+  Sim.particles.reserve(latticeSites.size());
+  for (const dynamo::Vector & position : latticeSites)
+    Sim.particles.push_back(dynamo::Particle(position, dynamo::Vector{0,0,0}, nParticles++));
+
+  Sim.ensemble = dynamo::Ensemble::loadEnsemble(Sim);
+}
+
+BOOST_AUTO_TEST_CASE( Neighbour_Query_Counts )
+{
+  dynamo::Simulation Sim;
+  init(Sim, 0.5);
+  Sim.addOutputPlugin("NeighbourListStats");
+  Sim.initialise();
+
+  dynamo::GNeighbourList* nblist = nullptr;
+  for (const dynamo::shared_ptr<dynamo::Global>& glob : Sim.globals)
+    if (!nblist)
+      nblist = dynamic_cast<dynamo::GNeighbourList*>(glob.get());
+  BOOST_REQUIRE(nblist);
+
+  //The neighbourhood sizes of the lattice, found one query at a time
+  nblist->resetStatistics();
+  std::vector<size_t> histogram;
+  size_t returned = 0;
+  for (const dynamo::Particle& p : Sim.particles)
+    {
+      std::vector<size_t> neighbours;
+      nblist->getParticleNeighbours(p, neighbours);
+      if (neighbours.size() >= histogram.size())
+	histogram.resize(neighbours.size() + 1, 0);
+      ++histogram[neighbours.size()];
+      returned += neighbours.size();
+    }
+
+  dynamo::GNeighbourList::Statistics stats = nblist->getStatistics();
+  BOOST_CHECK_EQUAL(stats.neighbourQueries, Sim.N());
+  BOOST_CHECK_EQUAL(stats.neighboursReturned, returned);
+  BOOST_CHECK_EQUAL(stats.maxNeighbours, histogram.size() - 1);
+  BOOST_CHECK(stats.neighbourHistogram == histogram);
+
+  //Repeat the queries from several threads at once, no counts may
+  //be lost
+  nblist->resetStatistics();
+  const size_t threads = 4, repeats = 50;
+  std::vector<std::thread> workers;
+  for (size_t t(0); t < threads; ++t)
+    workers.push_back(std::thread([&]() {
+	  std::vector<size_t> neighbours;
+	  for (size_t r(0); r < repeats; ++r)
+	    for (const dynamo::Particle& p : Sim.particles)
+	      {
+		neighbours.clear();
+		nblist->getParticleNeighbours(p, neighbours);
+	      }
+	}));
+  for (std::thread& worker : workers)
+    worker.join();
+
+  stats = nblist->getStatistics();
+  const size_t passes = threads * repeats;
+  BOOST_CHECK_EQUAL(stats.neighbourQueries, passes * Sim.N());
+  BOOST_CHECK_EQUAL(stats.neighboursReturned, passes * returned);
+  BOOST_CHECK_EQUAL(stats.maxNeighbours, histogram.size() - 1);
+  BOOST_REQUIRE_EQUAL(stats.neighbourHistogram.size(), histogram.size());
+  for (size_t i(0); i < histogram.size(); ++i)
+    BOOST_CHECK_EQUAL(stats.neighbourHistogram[i], passes * histogram[i]);
+
+  //The plugin reports the same counts
+  magnet::xml::XmlStream XML;
+  Sim.getOutputPlugin<dynamo::OPNeighbourListStats>()->output(XML);
+  std::ostringstream queries, samples;
+  queries << "Queries=\"" << passes * Sim.N() << "\"";
+  samples << "SampleCount=\"" << passes * Sim.N() << "\"";
+  std::ostringstream os;
+  os << XML.getUnderlyingStream().rdbuf();
+  BOOST_CHECK(os.str().find(queries.str()) != std::string::npos);
+  BOOST_CHECK(os.str().find(samples.str()) != std::string::npos);
+}
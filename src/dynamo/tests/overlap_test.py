@@ -0,0 +1,88 @@
+#!/usr/bin/env python3
+#   dynamo:- Event driven molecular dynamics simulator 
+#   http://www.dynamomd.org
+#   Copyright (C) 2009  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+#
+#   This program is free software: you can redistribute it and/or
+#   modify it under the terms of the GNU General Public License
+#   version 3 as published by the Free Software Foundation.
+#
+#   This program is distributed in the hope that it will be useful,
+#   but WITHOUT ANY WARRANTY; without even the implied warranty of
+#   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#   GNU General Public License for more details.
+#
+#   You should have received a copy of the GNU General Public License
+#   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Checks the OverlapTester finds the same overlapping pairs using the
+# neighbour list as by checking every pair.
+import dynamo
+import os
+import sys
+import getopt
+import subprocess
+import xml.etree.ElementTree as ET
+
+error_count=0
+
+shortargs=""
+longargs=["dynarun="]
+try:
+    options, args = getopt.gnu_getopt(sys.argv[1:], shortargs, longargs)
+except getopt.GetoptError as err:
+    print(str(err))
+    sys.exit(2)
+
+dynarun_cmd="NOT SET"
+for o,a in options:
+    if o == "--dynarun":
+        dynarun_cmd = a
+
+if not(os.path.isfile(dynarun_cmd) and os.access(dynarun_cmd, os.X_OK)):
+    raise RuntimeError("Failed to find dynarun executabe at "+dynarun_cmd+"\,"+str(sys.argv))
+        
+doc = dynamo.basicDoc
+
+#A lattice of spheres with two overlapping pairs, one across the
+#periodic boundary
+for x in range(5):
+    for y in range(5):
+        for z in range(5):
+            dynamo.addParticle(doc, pos=[2*x-4.5, 2*y-4.5, 2*z-4.5], vel=[0,0,0])
+dynamo.addParticle(doc, pos=[-4.2, -4.5, -4.5], vel=[0,0,0])
+dynamo.addParticle(doc, pos=[4.9, 3.5, -4.5], vel=[0,0,0])
+
+interactions = doc.find('./Simulation/Interactions')
+interaction = ET.SubElement(interactions, 'Interaction', {'Type':'HardSphere', 'Diameter':'1', 'Name':'Bulk'})
+ET.SubElement(interaction, 'IDPairRange', {'Type':'All'})
+
+open('overlap.xml', 'w').write(dynamo.prettyprint(doc))
+
+def overlaps(plugin):
+    cmd=[dynarun_cmd, "overlap.xml", '-c0', '-L', plugin, '--out-data-file=overlap_output.xml']
+    print(" ".join(cmd))
+    subprocess.check_call(cmd)
+    tag = ET.parse('overlap_output.xml').find('./OverlapTester/Initial')
+    pairs = set((int(p.attrib['ID1']), int(p.attrib['ID2'])) for p in tag.findall('Pair'))
+    return int(tag.attrib['Count']), float(tag.attrib['WorstDistance']), pairs
+
+nblist = overlaps('OverlapTester')
+bruteforce = overlaps('OverlapTester:BruteForce')
+print("Neighbour list", nblist)
+print("Brute force", bruteforce)
+
+if nblist != bruteforce:
+    print("The neighbour list and brute force checks differ")
+    error_count += 1
+
+if nblist[0] != 2 or nblist[2] != {(0, 125), (20, 126)}:
+    print("Expected overlaps between particles 0 and 125 and particles 20 and 126")
+    error_count += 1
+
+if not dynamo.isclose(nblist[1], 0.3, 1e-6):
+    print("Expected the worst overlap at a distance of 0.3")
+    error_count += 1
+
+print("Total errors:", error_count)
+sys.exit(error_count > 0)
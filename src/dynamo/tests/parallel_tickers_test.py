@@ -0,0 +1,67 @@
+#!/usr/bin/env python3
+#   dynamo:- Event driven molecular dynamics simulator 
+#   http://www.dynamomd.org
+#   Copyright (C) 2009  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+#
+#   This program is free software: you can redistribute it and/or
+#   modify it under the terms of the GNU General Public License
+#   version 3 as published by the Free Software Foundation.
+#
+#   This program is distributed in the hope that it will be useful,
+#   but WITHOUT ANY WARRANTY; without even the implied warranty of
+#   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#   GNU General Public License for more details.
+#
+#   You should have received a copy of the GNU General Public License
+#   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# The ticker plugins see the same frozen state whether they run in
+# sequence or concurrently, so both runs must collect identical data.
+import os
+import sys
+import getopt
+import subprocess
+import xml.etree.ElementTree as ET
+
+shortargs=""
+longargs=["dynarun=", "dynamod="]
+try:
+    options, args = getopt.gnu_getopt(sys.argv[1:], shortargs, longargs)
+except getopt.GetoptError as err:
+    print(str(err))
+    sys.exit(2)
+
+dynarun_cmd="NOT SET"
+dynamod_cmd="NOT SET"
+
+for o,a in options:
+    if o == "--dynarun":
+        dynarun_cmd = a
+    if o == "--dynamod":
+        dynamod_cmd = a
+
+for name,exe in [("dynamod", dynamod_cmd), ("dynarun", dynarun_cmd)]:
+    if not(os.path.isfile(exe) and os.access(exe, os.X_OK)):
+        raise RuntimeError("Failed to find "+name+" executabe at "+exe)
+
+cmd=[dynamod_cmd, "-m0", "-C5", "-d0.5", "-otickers.xml"]
+print(" ".join(cmd))
+subprocess.check_call(cmd)
+
+plugins=["-LRadialDistribution", "-LVelDist", "-LKEnergyTicker", "-LStructureFactor", "-LOverlapTester"]
+outputs={}
+for name, mode in [("serial", []), ("parallel", ["--parallel-tickers", "-N4"])]:
+    cmd=[dynarun_cmd, "tickers.xml", "-c20000", "-s1", "-t0.1"] + mode + plugins + ["--out-data-file=tickers_"+name+".xml", "--out-config-file=tickers_"+name+".config.xml"]
+    print(" ".join(cmd))
+    subprocess.check_call(cmd)
+    root = ET.parse("tickers_"+name+".xml").getroot()
+    outputs[name] = {tag:ET.tostring(root.find(tag)) for tag in ["RadialDistribution", "VelDist", "KEnergyTicker", "StructureFactor", "OverlapTester"]}
+
+error_count=0
+for tag in outputs["serial"]:
+    if outputs["serial"][tag] != outputs["parallel"][tag]:
+        print("The", tag, "output differs between the serial and parallel tickers")
+        error_count += 1
+
+print("Total errors:", error_count)
+sys.exit(error_count > 0)
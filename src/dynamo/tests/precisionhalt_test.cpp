@@ -0,0 +1,133 @@
+#define BOOST_TEST_MODULE PrecisionHalt_test
+#include <boost/test/included/unit_test.hpp>
+#include <dynamo/simulation.hpp>
+#include <dynamo/BC/include.hpp>
+#include <dynamo/ranges/include.hpp>
+#include <dynamo/inputplugins/cells/include.hpp>
+#include <dynamo/species/point.hpp>
+#include <dynamo/dynamics/newtonian.hpp>
+#include <dynamo/schedulers/include.hpp>
+#include <dynamo/schedulers/sorters/boundedPQFEL.hpp>
+#include <dynamo/schedulers/sorters/MinMaxPEL.hpp>
+#include <dynamo/inputplugins/include.hpp>
+#include <dynamo/interactions/hardsphere.hpp>
+#include <dynamo/outputplugins/misc.hpp>
+#include <dynamo/systems/precisionHalt.hpp>
+#include <random>
+
+std::mt19937 RNG;
+typedef dynamo::BoundedPQFEL<dynamo::MinMaxPEL<3> > DefaultSorter;
+
+dynamo::Vector getRandVelVec()
+{
+  std::normal_distribution<> normal_dist(0.0, (1.0 / sqrt(double(NDIM))));
+
+  dynamo::Vector tmpVec;
+  for (size_t iDim = 0; iDim < NDIM; iDim++)
+    tmpVec[iDim] = normal_dist(RNG);
+
+  return tmpVec;
+}
+
+//A 4x4x4 FCC lattice of 256 hard spheres at kT=1
+void init(dynamo::Simulation& Sim, const double density)
+{
+  RNG.seed(1);
+  Sim.ranGenerator.seed(1);
+
+  Sim.dynamics = dynamo::shared_ptr<dynamo::Dynamics>(new dynamo::DynNewtonian(&Sim));
+  Sim.BCs = dynamo::shared_ptr<dynamo::BoundaryCondition>(new dynamo::BCPeriodic(&Sim));
+  Sim.ptrScheduler = dynamo::shared_ptr<dynamo::SNeighbourList>(new dynamo::SNeighbourList(&Sim, new DefaultSorter()));
+
+  std::unique_ptr<dynamo::UCell> packptr(new dynamo::CUFCC(std::array<long, 3>{{4,4,4}}, dynamo::Vector{1,1,1}, new dynamo::UParticle()));
+  packptr->initialise();
+  std::vector<dynamo::Vector> latticeSites(packptr->placeObjects(dynamo::Vector{0,0,0}));
+  Sim.primaryCellSize = dynamo::Vector{1,1,1};
+
+  double particleDiam = std::cbrt(density / latticeSites.size());
+  Sim.interactions.push_back(dynamo::shared_ptr<dynamo::Interaction>(new dynamo::IHardSphere(&Sim, particleDiam, 1.0, new dynamo::IDPairRangeAll(), "Bulk")));
+  Sim.addSpecies(dynamo::shared_ptr<dynamo::Species>(new dynamo::SpPoint(&Sim, new dynamo::IDRangeAll(&Sim), 1.0, "Bulk", 0)));
+  Sim.units.setUnitLength(particleDiam);
+
+  unsigned long nParticles = 0;
+  Sim.particles.reserve(latticeSites.size());
+  for (const dynamo::Vector & position : latticeSites)
+    Sim.particles.push_back(dynamo::Particle(position, getRandVelVec() * Sim.units.unitVelocity(), nParticles++));
+
+  Sim.ensemble = dynamo::Ensemble::loadEnsemble(Sim);
+
+  dynamo::InputPlugin(&Sim, "Rescaler").zeroMomentum();
+  dynamo::InputPlugin(&Sim, "Rescaler").rescaleVels(1.0);
+}
+
+BOOST_AUTO_TEST_CASE( Known_Variance_Series )
+{
+  dynamo::Simulation Sim;
+  init(Sim, 0.5);
+  Sim.endEventCount = 10000000;
+  Sim.addOutputPlugin("Misc");
+
+  //An observable which takes independent values from a Gaussian of
+  //mean 10 and unit variance over each sampling interval
+  const double mean = 10, target = 0.002;
+  std::mt19937 gen(1);
+  std::normal_distribution<> dist(mean, 1.0);
+  double integral = 0, lastTime = 0;
+  auto series = [&]() {
+    integral += dist(gen) * (Sim.systemTime - lastTime);
+    lastTime = Sim.systemTime;
+    return integral;
+  };
+
+  dynamo::shared_ptr<dynamo::SysPrecisionHalt> halt(new dynamo::SysPrecisionHalt(&Sim, 0.01, "PrecisionHalt"));
+  halt->addObservable("Gaussian", target, series);
+  Sim.systems.push_back(halt);
+
+  Sim.initialise();
+  while (Sim.runSimulationStep()) {}
+
+  //The run was ended by the precision target, after roughly the
+  //(1/(target*mean))^2 samples needed for independent samples
+  BOOST_CHECK(halt->converged());
+  BOOST_CHECK(Sim.eventCount < 10000000);
+  const double expected = std::pow(1.0 / (target * mean), 2);
+  BOOST_CHECK(halt->samples() > 0.6 * expected);
+  BOOST_CHECK(halt->samples() < 1.6 * expected);
+}
+
+BOOST_AUTO_TEST_CASE( Hard_Sphere_Pressure )
+{
+  {
+    dynamo::Simulation Sim;
+    init(Sim, 0.5);
+    dynamo::shared_ptr<dynamo::SysPrecisionHalt> halt(new dynamo::SysPrecisionHalt(&Sim, 0.05, "PrecisionHalt"));
+    halt->addObservable("Pressure", 0.01);
+    halt->addObservable("MFT", 0.01);
+    //Always zero for hard spheres, so only an absolute error is reachable
+    halt->addObservable("UConfigurational", 0, dynamo::SysPrecisionHalt::Integral(), 1, false, 0.01);
+    Sim.systems.push_back(halt);
+    Sim.writeXMLfile("PrecisionHalt.xml");
+  }
+
+  //The System must be restored from the configuration file
+  dynamo::Simulation Sim;
+  Sim.loadXMLfile("PrecisionHalt.xml");
+  Sim.endEventCount = 10000000;
+  Sim.addOutputPlugin("Misc");
+  Sim.initialise();
+  while (Sim.runSimulationStep()) {}
+
+  dynamo::shared_ptr<dynamo::SysPrecisionHalt> halt = std::dynamic_pointer_cast<dynamo::SysPrecisionHalt>(Sim.systems["PrecisionHalt"]);
+  BOOST_REQUIRE(halt);
+  BOOST_CHECK(halt->converged());
+  BOOST_CHECK(Sim.eventCount < 10000000);
+
+  //The Carnahan-Starling equation of state
+  const double eta = M_PI * 0.5 / 6;
+  const double Z = (1 + eta + eta * eta - eta * eta * eta) / std::pow(1 - eta, 3);
+  const dynamo::OPMisc& opMisc = *Sim.getOutputPlugin<dynamo::OPMisc>();
+  const double P = opMisc.getPressureTensor().tr() / (3.0 * Sim.units.unitPressure());
+  BOOST_CHECK_CLOSE(P, 0.5 * Z, 5);
+  //Taken from Lue 2005 DOI:10.1063/1.1834498
+  BOOST_CHECK_CLOSE(opMisc.getMFT(), 0.13031, 5);
+}
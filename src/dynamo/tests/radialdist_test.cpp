@@ -0,0 +1,128 @@
+#define BOOST_TEST_MODULE RadialDist_test
+#include <boost/test/included/unit_test.hpp>
+#include <dynamo/simulation.hpp>
+#include <dynamo/BC/include.hpp>
+#include <dynamo/ranges/include.hpp>
+#include <dynamo/ranges/IDRangeRange.hpp>
+#include <dynamo/inputplugins/cells/include.hpp>
+#include <dynamo/species/point.hpp>
+#include <dynamo/dynamics/newtonian.hpp>
+#include <dynamo/schedulers/include.hpp>
+#include <dynamo/schedulers/sorters/boundedPQFEL.hpp>
+#include <dynamo/schedulers/sorters/MinMaxPEL.hpp>
+#include <dynamo/interactions/hardsphere.hpp>
+#include <dynamo/outputplugins/tickerproperty/radialdist.hpp>
+#include <magnet/thread/workstealingpool.hpp>
+#include <random>
+
+std::mt19937 RNG;
+typedef dynamo::BoundedPQFEL<dynamo::MinMaxPEL<3> > DefaultSorter;
+
+dynamo::Vector getRandVelVec()
+{
+  //See http://mathworld.wolfram.com/SpherePointPicking.html
+  std::normal_distribution<> normal_dist(0.0, (1.0 / sqrt(double(NDIM))));
+
+  dynamo::Vector tmpVec;
+  for (size_t iDim = 0; iDim < NDIM; iDim++)
+    tmpVec[iDim] = normal_dist(RNG);
+
+  return tmpVec;
+}
+
+void init(dynamo::Simulation& Sim, const long cells, const double density)
+{
+  RNG.seed(std::random_device()());
+  Sim.ranGenerator.seed(std::random_device()());
+
+  Sim.dynamics = dynamo::shared_ptr<dynamo::Dynamics>(new dynamo::DynNewtonian(&Sim));
+  Sim.BCs = dynamo::shared_ptr<dynamo::BoundaryCondition>(new dynamo::BCPeriodic(&Sim));
+  Sim.ptrScheduler = dynamo::shared_ptr<dynamo::SNeighbourList>(new dynamo::SNeighbourList(&Sim, new DefaultSorter()));
+
+  std::unique_ptr<dynamo::UCell> packptr(new dynamo::CUFCC(std::array<long, 3>{{cells, cells, cells}}, dynamo::Vector{1,1,1}, new dynamo::UParticle()));
+  packptr->initialise();
+  std::vector<dynamo::Vector> latticeSites(packptr->placeObjects(dynamo::Vector{0,0,0}));
+  Sim.primaryCellSize = dynamo::Vector{1,1,1};
+
+  //Two species of the same spheres, to sample the cross species g(r)
+  const size_t Na = latticeSites.size() / 2;
+  double particleDiam = std::cbrt(density / latticeSites.size());
+  Sim.interactions.push_back(dynamo::shared_ptr<dynamo::Interaction>(new dynamo::IHardSphere(&Sim, particleDiam, new dynamo::IDPairRangeAll(), "Bulk")));
+  Sim.addSpecies(dynamo::shared_ptr<dynamo::Species>(new dynamo::SpPoint(&Sim, new dynamo::IDRangeRange(0, Na - 1), 1.0, "A", 0)));
+  Sim.addSpecies(dynamo::shared_ptr<dynamo::Species>(new dynamo::SpPoint(&Sim, new dynamo::IDRangeRange(Na, latticeSites.size() - 1), 1.0, "B", 1)));
+  Sim.units.setUnitLength(particleDiam);
+
+  unsigned long nParticles = 0;
+  Sim.particles.reserve(latticeSites.size());
+  for (const dynamo::Vector & position : latticeSites)
+    Sim.particles.push_back(dynamo::Particle(position, getRandVelVec() * Sim.units.unitVelocity(), nParticles++));
+
+  Sim.ensemble = dynamo::Ensemble::loadEnsemble(Sim);
+}
+
+void checkIdentical(const dynamo::Simulation& Sim, const dynamo::OPRadialDistribution& cells, const dynamo::OPRadialDistribution& bruteForce)
+{
+  for (size_t sp1(0); sp1 < Sim.species.size(); ++sp1)
+    for (size_t sp2(0); sp2 < Sim.species.size(); ++sp2)
+      {
+	const std::vector<std::pair<double, double> > cellsgr = cells.getgrdata(sp1, sp2);
+	const std::vector<std::pair<double, double> > bruteForcegr = bruteForce.getgrdata(sp1, sp2);
+	BOOST_REQUIRE_EQUAL(cellsgr.size(), bruteForcegr.size());
+	for (size_t i(0); i < cellsgr.size(); ++i)
+	  BOOST_CHECK_EQUAL(cellsgr[i].second, bruteForcegr[i].second);
+      }
+}
+
+BOOST_AUTO_TEST_CASE( Cells_Match_BruteForce )
+{
+  dynamo::Simulation Sim;
+  init(Sim, 7, 0.5);
+  Sim.endEventCount = 20000;
+  Sim.addOutputPlugin("Misc");
+  Sim.initialise();
+
+  //A sampled distance of 3 diameters gives a 4x4x4 grid
+  std::shared_ptr<dynamo::OPRadialDistribution> cells = std::dynamic_pointer_cast<dynamo::OPRadialDistribution>(dynamo::OutputPlugin::getPlugin("RadialDistribution:BinWidth=0.05,Length=60", &Sim));
+  std::shared_ptr<dynamo::OPRadialDistribution> bruteForce = std::dynamic_pointer_cast<dynamo::OPRadialDistribution>(dynamo::OutputPlugin::getPlugin("RadialDistribution:BinWidth=0.05,Length=60,BruteForce", &Sim));
+  cells->initialise();
+  bruteForce->initialise();
+
+  while (Sim.runSimulationStep(true))
+    if (!(Sim.eventCount % 1000))
+      {
+	Sim.dynamics->updateAllParticles();
+	cells->ticker();
+	bruteForce->ticker();
+      }
+
+  checkIdentical(Sim, *cells, *bruteForce);
+
+  //Check the first peak of the fluid is sampled
+  double peak = 0;
+  for (const std::pair<double, double>& bin : cells->getgrdata(0, 1))
+    peak = std::max(peak, bin.second);
+  BOOST_CHECK(peak > 1.5);
+}
+
+BOOST_AUTO_TEST_CASE( Large_Cells_Match_BruteForce )
+{
+  //Large enough for both samplings to be split across the pool
+  //(above Simulation::parallelWorkCutoff). A sampled distance of 7
+  //diameters gives a 4x4x4 grid.
+  magnet::thread::WorkStealingPool pool;
+  pool.setThreadCount(4);
+
+  dynamo::Simulation Sim;
+  Sim.threadPool = &pool;
+  init(Sim, 15, 0.5);
+  Sim.endEventCount = 0;
+  Sim.addOutputPlugin("Misc");
+  Sim.initialise();
+
+  std::shared_ptr<dynamo::OPRadialDistribution> cells = std::dynamic_pointer_cast<dynamo::OPRadialDistribution>(dynamo::OutputPlugin::getPlugin("RadialDistribution:BinWidth=0.05,Length=140", &Sim));
+  std::shared_ptr<dynamo::OPRadialDistribution> bruteForce = std::dynamic_pointer_cast<dynamo::OPRadialDistribution>(dynamo::OutputPlugin::getPlugin("RadialDistribution:BinWidth=0.05,Length=140,BruteForce", &Sim));
+  cells->initialise();
+  bruteForce->initialise();
+
+  checkIdentical(Sim, *cells, *bruteForce);
+}
@@ -0,0 +1,99 @@
+#!/usr/bin/env python3
+#   dynamo:- Event driven molecular dynamics simulator 
+#   http://www.dynamomd.org
+#   Copyright (C) 2009  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+#
+#   This program is free software: you can redistribute it and/or
+#   modify it under the terms of the GNU General Public License
+#   version 3 as published by the Free Software Foundation.
+#
+#   This program is distributed in the hope that it will be useful,
+#   but WITHOUT ANY WARRANTY; without even the implied warranty of
+#   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#   GNU General Public License for more details.
+#
+#   You should have received a copy of the GNU General Public License
+#   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+import os
+import sys
+import getopt
+import subprocess
+import re
+
+swaps=500
+swap_time=0.5
+finish_time=float(swaps)*swap_time 
+
+shortargs=""
+longargs=["dynarun=", "dynamod="]
+try:
+    options, args = getopt.gnu_getopt(sys.argv[1:], shortargs, longargs)
+except getopt.GetoptError as err:
+    print(str(err))
+    sys.exit(2)
+
+dynarun_cmd="NOT SET"
+dynamod_cmd="NOT SET"
+
+for o,a in options:
+    if o == "--dynarun":
+        dynarun_cmd = a
+    if o == "--dynamod":
+        dynamod_cmd = a
+
+for name,exe in [("dynamod", dynamod_cmd), ("dynarun", dynarun_cmd)]:
+    if not(os.path.isfile(exe) and os.access(exe, os.X_OK)):
+        raise RuntimeError("Failed to find "+name+" executabe at "+exe)
+
+###### INITIALISATION
+Temperatures=[1.0, 2.0, 5.0, 10.0]
+for i,T in enumerate(Temperatures):
+    cmd=[dynamod_cmd, "-m2", "-T"+str(T), "-od"+str(i)+".xml"]
+    print(" ".join(cmd))
+    subprocess.check_call(cmd)
+
+###### DISTRIBUTED RUN (two local processes, two replicas each)
+cmd=[dynarun_cmd, "--engine=4", "--replex-processes=2", "--replex-spawn", "-od%ID.end.xml", "--out-data-file=do%ID.xml", "-N2", "-i"+str(swap_time), "-f"+str(finish_time)]+["d"+str(i)+".xml" for i in range(len(Temperatures))]
+print(" ".join(cmd))
+subprocess.check_call(cmd)
+
+###### OUTPUT VALIDATION
+error_count = 0
+
+replex_calls=None
+with open("replex.stats") as f:
+    for line in f:
+        match = re.search("Number_of_replex_cycles ([0-9]+)", line)
+        if match:
+            replex_calls = int(match.group(1))
+            break
+
+if replex_calls is None:
+    raise RuntimeError("Could not parse the number of replex calls performed")
+
+if abs(replex_calls - swaps) > 1:
+    error_count = error_count + 1
+    print("The number of actual swaps ("+str(replex_calls)+") is different to the number of requested swaps +("+str(swaps)+")")
+
+replexdata=[line.split() for line in open("replex.dat")]
+if len(replexdata) != len(Temperatures):
+    raise RuntimeError("replex.dat does not contain every temperature")
+
+for T, data in zip(Temperatures, replexdata):
+    if abs(float(data[0]) - T) > 1e-8:
+        error_count = error_count + 1
+        print("Temperature ladder is incorrect:"+data[0]+"!="+str(T))
+    if not (int(data[1]) > 0):
+        error_count = error_count + 1
+        print("No swaps were accepted at T="+data[0])
+
+#Every replica must be written, by the process which owns it
+for i in range(len(Temperatures)):
+    for name in ["d"+str(i)+".end.xml", "do"+str(i)+".xml"]:
+        if not (os.path.isfile(name) or os.path.isfile(name+".bz2")):
+            error_count = error_count + 1
+            print("Missing output file "+name)
+
+print("Total errors:", error_count)
+sys.exit(error_count > 0)
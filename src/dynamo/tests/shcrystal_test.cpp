@@ -0,0 +1,151 @@
+#define BOOST_TEST_MODULE SHCrystal_test
+#include <boost/test/included/unit_test.hpp>
+#include <dynamo/simulation.hpp>
+#include <dynamo/BC/include.hpp>
+#include <dynamo/ranges/include.hpp>
+#include <dynamo/inputplugins/cells/include.hpp>
+#include <dynamo/species/point.hpp>
+#include <dynamo/dynamics/newtonian.hpp>
+#include <dynamo/schedulers/include.hpp>
+#include <dynamo/schedulers/sorters/boundedPQFEL.hpp>
+#include <dynamo/schedulers/sorters/MinMaxPEL.hpp>
+#include <dynamo/inputplugins/include.hpp>
+#include <dynamo/interactions/hardsphere.hpp>
+#include <dynamo/globals/cells.hpp>
+#include <dynamo/outputplugins/tickerproperty/SHcrystal.hpp>
+#include <dynamo/systems/umbrella.hpp>
+#include <random>
+
+std::mt19937 RNG;
+typedef dynamo::BoundedPQFEL<dynamo::MinMaxPEL<3> > DefaultSorter;
+
+dynamo::Vector getRandVelVec()
+{
+  std::normal_distribution<> normal_dist(0.0, (1.0 / sqrt(double(NDIM))));
+
+  dynamo::Vector tmpVec;
+  for (size_t iDim = 0; iDim < NDIM; iDim++)
+    tmpVec[iDim] = normal_dist(RNG);
+
+  return tmpVec;
+}
+
+//A 4x4x4 FCC lattice of 256 hard spheres at kT=1, with a neighbour
+//list long enough for the first shell of the crystal
+void init(dynamo::Simulation& Sim, const double density)
+{
+  RNG.seed(1);
+  Sim.ranGenerator.seed(1);
+
+  Sim.dynamics = dynamo::shared_ptr<dynamo::Dynamics>(new dynamo::DynNewtonian(&Sim));
+  Sim.BCs = dynamo::shared_ptr<dynamo::BoundaryCondition>(new dynamo::BCPeriodic(&Sim));
+  Sim.ptrScheduler = dynamo::shared_ptr<dynamo::SNeighbourList>(new dynamo::SNeighbourList(&Sim, new DefaultSorter()));
+
+  std::unique_ptr<dynamo::UCell> packptr(new dynamo::CUFCC(std::array<long, 3>{{4,4,4}}, dynamo::Vector{1,1,1}, new dynamo::UParticle()));
+  packptr->initialise();
+  std::vector<dynamo::Vector> latticeSites(packptr->placeObjects(dynamo::Vector{0,0,0}));
+  Sim.primaryCellSize = dynamo::Vector{1,1,1};
+
+  double particleDiam = std::cbrt(density / latticeSites.size());
+  Sim.interactions.push_back(dynamo::shared_ptr<dynamo::Interaction>(new dynamo::IHardSphere(&Sim, particleDiam, 1.0, new dynamo::IDPairRangeAll(), "Bulk")));
+  Sim.addSpecies(dynamo::shared_ptr<dynamo::Species>(new dynamo::SpPoint(&Sim, new dynamo::IDRangeAll(&Sim), 1.0, "Bulk", 0)));
+  Sim.units.setUnitLength(particleDiam);
+
+  dynamo::shared_ptr<dynamo::GCells> cells(new dynamo::GCells(&Sim, "SHCrystalNBList"));
+  cells->setMaxInteractionRange(1.5 * particleDiam);
+  Sim.globals.push_back(cells);
+
+  unsigned long nParticles = 0;
+  Sim.particles.reserve(latticeSites.size());
+  for (const dynamo::Vector & position : latticeSites)
+    Sim.particles.push_back(dynamo::Particle(position, getRandVelVec() * Sim.units.unitVelocity(), nParticles++));
+
+  Sim.ensemble = dynamo::Ensemble::loadEnsemble(Sim);
+
+  dynamo::InputPlugin(&Sim, "Rescaler").zeroMomentum();
+  dynamo::InputPlugin(&Sim, "Rescaler").rescaleVels(1.0);
+}
+
+BOOST_AUTO_TEST_CASE( FCC_Local_Order )
+{
+  dynamo::Simulation Sim;
+  init(Sim, 1.0);
+  Sim.addOutputPlugin("SHCrystal:CutOffR=1.35");
+  Sim.initialise();
+
+  dynamo::OPSHCrystal& crystal = *Sim.getOutputPlugin<dynamo::OPSHCrystal>();
+  BOOST_CHECK_EQUAL(crystal.calculateLocalOrder(), 256);
+
+  //The bond order of the perfect FCC crystal, from Steinhardt et
+  //al. PRB 28, 784 (1983)
+  for (const dynamo::OPSHCrystal::LocalOrder& local : crystal.getLocalOrder())
+    {
+      BOOST_CHECK_EQUAL(local.neighbours, 12);
+      BOOST_CHECK_EQUAL(local.connections, 12);
+      BOOST_CHECK(local.solid);
+      BOOST_CHECK_CLOSE(local.q4, 0.19094, 0.01);
+      BOOST_CHECK_CLOSE(local.q6, 0.57452, 0.01);
+      BOOST_CHECK_CLOSE(local.w6, -0.013161, 0.01);
+    }
+}
+
+BOOST_AUTO_TEST_CASE( Liquid_Local_Order )
+{
+  dynamo::Simulation Sim;
+  init(Sim, 0.5);
+  Sim.addOutputPlugin("SHCrystal:CutOffR=1.35");
+  Sim.endEventCount = 50000;
+  Sim.initialise();
+  while (Sim.runSimulationStep()) {}
+
+  Sim.dynamics->updateAllParticles();
+  dynamo::OPSHCrystal& crystal = *Sim.getOutputPlugin<dynamo::OPSHCrystal>();
+  BOOST_CHECK(crystal.calculateLocalOrder() < 20);
+}
+
+struct UmbrellaResult
+{
+  size_t largestCluster;
+  std::map<size_t, double> histogram;
+  size_t trials;
+  size_t rejections;
+};
+
+UmbrellaResult runUmbrella(const bool biased)
+{
+  dynamo::Simulation Sim;
+  init(Sim, 0.8);
+  Sim.addOutputPlugin("SHCrystal:CutOffR=1.35");
+  //A large penalty on any configuration with a largest solid cluster
+  //smaller than 200
+  const double penalty = biased ? 1000 : 0;
+  dynamo::shared_ptr<dynamo::SysUmbrella> umbrella(new dynamo::SysUmbrella(&Sim, "Umbrella", dynamo::shared_ptr<dynamo::Potential>(new dynamo::PotentialStepped({{200.5, penalty}}, false)), 1.0, 0.05));
+  Sim.systems.push_back(umbrella);
+  Sim.endEventCount = 200000;
+  Sim.initialise();
+  while (Sim.runSimulationStep()) {}
+
+  Sim.dynamics->updateAllParticles();
+  return UmbrellaResult{Sim.getOutputPlugin<dynamo::OPSHCrystal>()->calculateLocalOrder(), umbrella->getHistogram(), umbrella->getTrials(), umbrella->getRejections()};
+}
+
+BOOST_AUTO_TEST_CASE( Umbrella_Largest_Cluster )
+{
+  //Unbiased, the crystal melts and most of the time is spent in the
+  //liquid step (1), with every change of step accepted
+  const UmbrellaResult unbiased = runUmbrella(false);
+  BOOST_CHECK(unbiased.largestCluster < 100);
+  BOOST_CHECK(unbiased.trials > 0);
+  BOOST_CHECK_EQUAL(unbiased.rejections, 0);
+  BOOST_CHECK(unbiased.histogram.at(1) > unbiased.histogram.at(0));
+
+  //The umbrella holds it in the crystal. The penalty is so large
+  //that no time may be spent in the liquid step, and every attempt
+  //to enter it is rejected.
+  const UmbrellaResult biased = runUmbrella(true);
+  BOOST_CHECK(biased.largestCluster > 150);
+  BOOST_CHECK(biased.trials > 0);
+  BOOST_CHECK_EQUAL(biased.rejections, biased.trials);
+  BOOST_CHECK(biased.histogram.at(0) > 0);
+  BOOST_CHECK(!biased.histogram.count(1) || (biased.histogram.at(1) == 0));
+}
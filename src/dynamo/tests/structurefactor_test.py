@@ -0,0 +1,107 @@
+#!/usr/bin/env python3
+#   dynamo:- Event driven molecular dynamics simulator 
+#   http://www.dynamomd.org
+#   Copyright (C) 2009  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+#
+#   This program is free software: you can redistribute it and/or
+#   modify it under the terms of the GNU General Public License
+#   version 3 as published by the Free Software Foundation.
+#
+#   This program is distributed in the hope that it will be useful,
+#   but WITHOUT ANY WARRANTY; without even the implied warranty of
+#   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#   GNU General Public License for more details.
+#
+#   You should have received a copy of the GNU General Public License
+#   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+import os
+import sys
+import getopt
+import subprocess
+import xml.etree.ElementTree as ET
+import math
+
+shortargs=""
+longargs=["dynarun=", "dynamod="]
+try:
+    options, args = getopt.gnu_getopt(sys.argv[1:], shortargs, longargs)
+except getopt.GetoptError as err:
+    print(str(err))
+    sys.exit(2)
+
+dynarun_cmd="NOT SET"
+dynamod_cmd="NOT SET"
+
+for o,a in options:
+    if o == "--dynarun":
+        dynarun_cmd = a
+    if o == "--dynamod":
+        dynamod_cmd = a
+
+for name,exe in [("dynamod", dynamod_cmd), ("dynarun", dynarun_cmd)]:
+    if not(os.path.isfile(exe) and os.access(exe, os.X_OK)):
+        raise RuntimeError("Failed to find "+name+" executabe at "+exe)
+
+###### INITIALISATION
+#An FCC lattice of 7x7x7 unit cells with a lattice constant of 2
+cmd=[dynamod_cmd, "-m0", "-C7", "-d0.5", "-ofcc.xml"]
+print(" ".join(cmd))
+subprocess.check_call(cmd)
+
+###### SAMPLE THE LATTICE WITH BOTH METHODS
+Sk={}
+for method in ["Direct", "FFT"]:
+    cmd=[dynarun_cmd, "-c0", "-LStructureFactor:Method="+method+",MaxK=12", "--out-data-file=sk"+method+".xml", "fcc.xml"]
+    print(" ".join(cmd))
+    subprocess.check_call(cmd)
+    tag = ET.parse("sk"+method+".xml").getroot().find(".//StructureFactor")
+    if tag.attrib["Method"] != method:
+        raise RuntimeError("The "+method+" method was not used")
+    Sk[method] = [list(map(float, line.split())) for line in tag.text.strip().split("\n")]
+
+###### OUTPUT VALIDATION
+error_count = 0
+
+if [shell[0] for shell in Sk["Direct"]] != [shell[0] for shell in Sk["FFT"]]:
+    error_count = error_count + 1
+    print("The methods sampled different shells of wavevectors")
+
+for (k, direct), (k2, fft) in zip(Sk["Direct"], Sk["FFT"]):
+    #The Bragg peaks must agree to within the error of the mesh
+    #assignment, and the other shells must be near zero
+    if direct > 1:
+        if abs(fft - direct) > 0.01 * direct:
+            error_count = error_count + 1
+            print("The methods disagree on the Bragg peak at k="+str(k)+": "+str(direct)+" != "+str(fft))
+    elif (direct > 1e-10) or (fft > 0.05):
+        error_count = error_count + 1
+        print("The lattice should not scatter at k="+str(k)+": Direct="+str(direct)+", FFT="+str(fft))
+
+#The first Bragg peak is the (111) reflection, at k=2*pi*sqrt(3)/2
+first_peak = [k for k, direct in Sk["Direct"] if direct > 1][0]
+binwidth = Sk["Direct"][0][0]
+if abs(first_peak - math.pi * math.sqrt(3)) > binwidth / 2:
+    error_count = error_count + 1
+    print("The first Bragg peak is at the wrong wavenumber "+str(first_peak))
+
+###### A LIMITED MESH
+#The 128^3 mesh needed for MaxK=12 is limited to 64^3, so MaxK must be
+#lowered to a quarter of the sampling frequency of the mesh
+cmd=[dynarun_cmd, "-c0", "-LStructureFactor:Method=FFT,MaxK=12,MaxGrid=64", "--out-data-file=skLimited.xml", "fcc.xml"]
+print(" ".join(cmd))
+subprocess.check_call(cmd)
+tag = ET.parse("skLimited.xml").getroot().find(".//StructureFactor")
+limited = [list(map(float, line.split())) for line in tag.text.strip().split("\n")]
+L = 2 * 7
+if limited[-1][0] > 64 * math.pi / (2 * L) + binwidth / 2:
+    error_count = error_count + 1
+    print("The limited mesh sampled beyond its wavenumber limit, k="+str(limited[-1][0]))
+
+for (k, direct), (k2, fft) in zip(Sk["Direct"], limited):
+    if (k != k2) or ((direct > 1) and (abs(fft - direct) > 0.01 * direct)):
+        error_count = error_count + 1
+        print("The limited mesh disagrees with the Direct method at k="+str(k)+": "+str(direct)+" != "+str(fft))
+
+print("Total errors:", error_count)
+sys.exit(error_count > 0)
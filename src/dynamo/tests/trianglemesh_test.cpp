@@ -0,0 +1,139 @@
+#define BOOST_TEST_MODULE TriangleMesh_test
+#include <boost/test/included/unit_test.hpp>
+#include <dynamo/simulation.hpp>
+#include <dynamo/BC/include.hpp>
+#include <dynamo/ranges/include.hpp>
+#include <dynamo/species/point.hpp>
+#include <dynamo/dynamics/newtonian.hpp>
+#include <dynamo/schedulers/include.hpp>
+#include <dynamo/schedulers/sorters/heapPEL.hpp>
+#include <dynamo/schedulers/sorters/CBTFEL.hpp>
+#include <dynamo/locals/trianglemesh.hpp>
+#include <dynamo/interactions/hardsphere.hpp>
+#include <magnet/timer.hpp>
+#include <random>
+#include <cmath>
+
+std::mt19937 RNG;
+
+dynamo::Vector getRandVelVec()
+{
+  //See http://mathworld.wolfram.com/SpherePointPicking.html
+  std::normal_distribution<> normal_dist(0.0, (1.0 / sqrt(double(NDIM))));
+
+  dynamo::Vector tmpVec;
+  for (size_t iDim = 0; iDim < NDIM; iDim++)
+    tmpVec[iDim] = normal_dist(RNG);
+
+  return tmpVec;
+}
+
+//A wavy "hopper floor" height field made of 2 * 160 * 160 = 51200
+//triangles, with a cloud of particles above it.
+void init(dynamo::Simulation& Sim)
+{
+  RNG.seed(1);
+  Sim.ranGenerator.seed(1);
+  Sim.dynamics = dynamo::shared_ptr<dynamo::Dynamics>(new dynamo::DynNewtonian(&Sim));
+  Sim.BCs = dynamo::shared_ptr<dynamo::BoundaryCondition>(new dynamo::BCNone(&Sim));
+  Sim.ptrScheduler = dynamo::shared_ptr<dynamo::SNeighbourList>(new dynamo::SNeighbourList(&Sim, new dynamo::CBTFEL<dynamo::HeapPEL>()));
+  Sim.primaryCellSize = dynamo::Vector{50,50,50};
+
+  const size_t N = 160;
+  const double L = 40;
+  std::vector<dynamo::Vector> vertices;
+  for (size_t i(0); i <= N; ++i)
+    for (size_t j(0); j <= N; ++j)
+      {
+	const double x = L * (double(i) / N - 0.5);
+	const double y = L * (double(j) / N - 0.5);
+	vertices.push_back(dynamo::Vector{x, y, -10 + 2 * std::sin(0.5 * x) * std::cos(0.3 * y)});
+      }
+
+  std::vector<dynamo::LTriangleMesh::TriangleElements> elements;
+  for (size_t i(0); i < N; ++i)
+    for (size_t j(0); j < N; ++j)
+      {
+	const size_t v00 = i * (N + 1) + j, v10 = v00 + N + 1, v01 = v00 + 1, v11 = v10 + 1;
+	elements.push_back(dynamo::LTriangleMesh::TriangleElements(v00, v10, v11));
+	elements.push_back(dynamo::LTriangleMesh::TriangleElements(v00, v11, v01));
+      }
+
+  Sim.addSpecies(dynamo::shared_ptr<dynamo::Species>(new dynamo::SpPoint(&Sim, new dynamo::IDRangeAll(&Sim), 1.0, "Bulk", 0)));
+  Sim.interactions.push_back(dynamo::shared_ptr<dynamo::Interaction>(new dynamo::IHardSphere(&Sim, 1.0, 1.0, new dynamo::IDPairRangeAll(), "Bulk")));
+  Sim.locals.push_back(dynamo::shared_ptr<dynamo::Local>(new dynamo::LTriangleMesh(&Sim, 1.0, 1.0, "Floor", new dynamo::IDRangeAll(&Sim), vertices, elements)));
+
+  //Particles on a loose lattice above the floor
+  for (size_t i(0); i < 10; ++i)
+    for (size_t j(0); j < 10; ++j)
+      for (size_t k(0); k < 10; ++k)
+	Sim.particles.push_back(dynamo::Particle(dynamo::Vector{3.5 * i - 16, 3.5 * j - 16, 3.5 * k - 6}, getRandVelVec(), Sim.particles.size()));
+
+  //Some particles moving exactly along the axes
+  Sim.particles[0].getVelocity() = dynamo::Vector{0, 0, -1};
+  Sim.particles[1].getVelocity() = dynamo::Vector{1, 0, 0};
+  Sim.particles[2].getVelocity() = dynamo::Vector{0, 0, 1};
+
+  Sim.ensemble = dynamo::Ensemble::loadEnsemble(Sim);
+}
+
+BOOST_AUTO_TEST_CASE( BVH_Matches_BruteForce )
+{
+  dynamo::Simulation Sim;
+  init(Sim);
+  Sim.initialise();
+
+  const dynamo::LTriangleMesh& mesh = static_cast<const dynamo::LTriangleMesh&>(*Sim.locals[0]);
+  BOOST_CHECK(mesh.usingBVH());
+
+  size_t collisions = 0;
+  for (const dynamo::Particle& part : Sim.particles)
+    {
+      const dynamo::Event bvh = mesh.getEvent(part);
+      const dynamo::Event brute = mesh.getEventBruteForce(part);
+      BOOST_CHECK_EQUAL(bvh._dt, brute._dt);
+      BOOST_CHECK_EQUAL(bvh._additionalData1, brute._additionalData1);
+      collisions += (brute._dt != HUGE_VAL);
+    }
+
+  //Only the particles heading down within the footprint of the mesh
+  //hit it, which is roughly a sixth of them
+  BOOST_CHECK(collisions > Sim.particles.size() / 10);
+
+  //Benchmark the two searches. The timings are only reported, as
+  //they depend on the load of the machine.
+  const size_t passes = 5;
+  double bvhTime, bruteTime;
+  {
+    magnet::Timer timer;
+    for (size_t i(0); i < passes; ++i)
+      for (const dynamo::Particle& part : Sim.particles)
+	mesh.getEvent(part);
+    bvhTime = timer.duration<std::micro>() / (passes * Sim.particles.size());
+  }
+
+  {
+    //The brute force search is slow, so only a sample of the
+    //particles are timed
+    const size_t samples = 100;
+    magnet::Timer timer;
+    for (size_t i(0); i < samples; ++i)
+      mesh.getEventBruteForce(Sim.particles[i]);
+    bruteTime = timer.duration<std::micro>() / samples;
+  }
+
+  BOOST_TEST_MESSAGE("51200 triangle mesh, brute force " << bruteTime << " micro-s / event, BVH " << bvhTime << " micro-s / event");
+}
+
+BOOST_AUTO_TEST_CASE( Simulation_Runs )
+{
+  dynamo::Simulation Sim;
+  init(Sim);
+  //The system is not periodic and the cell lists cannot follow
+  //particles far outside the primary image, so the run is stopped
+  //before the gas has expanded out of it.
+  Sim.endEventCount = 400;
+  Sim.initialise();
+  while (Sim.runSimulationStep()) {}
+  BOOST_CHECK_MESSAGE(Sim.checkSystem() <= 1, "There are more than two invalid states in the final configuration");
+}
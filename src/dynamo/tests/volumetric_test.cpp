@@ -0,0 +1,134 @@
+#define BOOST_TEST_MODULE Volumetric_test
+#include <boost/test/included/unit_test.hpp>
+#include <dynamo/simulation.hpp>
+#include <dynamo/BC/include.hpp>
+#include <dynamo/ranges/include.hpp>
+#include <dynamo/inputplugins/cells/include.hpp>
+#include <dynamo/species/point.hpp>
+#include <dynamo/dynamics/newtonian.hpp>
+#include <dynamo/schedulers/include.hpp>
+#include <dynamo/schedulers/sorters/boundedPQFEL.hpp>
+#include <dynamo/schedulers/sorters/MinMaxPEL.hpp>
+#include <dynamo/inputplugins/include.hpp>
+#include <dynamo/interactions/hardsphere.hpp>
+#include <dynamo/globals/volumetric_potential.hpp>
+#include <magnet/xmlreader.hpp>
+#include <fstream>
+#include <random>
+
+std::mt19937 RNG;
+typedef dynamo::BoundedPQFEL<dynamo::MinMaxPEL<3> > DefaultSorter;
+
+const size_t voxels = 64;
+
+dynamo::Vector getRandVelVec()
+{
+  std::normal_distribution<> normal_dist(0.0, (1.0 / sqrt(double(NDIM))));
+
+  dynamo::Vector tmpVec;
+  for (size_t iDim = 0; iDim < NDIM; iDim++)
+    tmpVec[iDim] = normal_dist(RNG);
+
+  return tmpVec;
+}
+
+size_t voxelCoord(double x)
+{
+  long coord = std::floor((x - std::round(x) + 0.5) * voxels);
+  return (coord + voxels) % voxels;
+}
+
+//The voxel value at a particle, looking slightly ahead along its
+//velocity in case it is sat on a face of a voxel
+unsigned char voxelValue(const std::vector<unsigned char>& volume, const dynamo::Particle& p)
+{
+  const dynamo::Vector pos = p.getPosition() + p.getVelocity() * 1e-9;
+  return volume[voxelCoord(pos[0]) + voxels * (voxelCoord(pos[1]) + voxels * voxelCoord(pos[2]))];
+}
+
+double totalEnergy(dynamo::Simulation& Sim, const std::vector<unsigned char>& volume)
+{
+  Sim.dynamics->updateAllParticles();
+  double energy = Sim.dynamics->getSystemKineticEnergy();
+  for (const dynamo::Particle& p : Sim.particles)
+    energy += 0.5 * voxelValue(volume, p);
+  return energy;
+}
+
+BOOST_AUTO_TEST_CASE( Volumetric_Potential )
+{
+  RNG.seed(1);
+  dynamo::Simulation Sim;
+  Sim.ranGenerator.seed(1);
+
+  Sim.dynamics = dynamo::shared_ptr<dynamo::Dynamics>(new dynamo::DynNewtonian(&Sim));
+  Sim.BCs = dynamo::shared_ptr<dynamo::BoundaryCondition>(new dynamo::BCPeriodic(&Sim));
+  Sim.ptrScheduler = dynamo::shared_ptr<dynamo::SNeighbourList>(new dynamo::SNeighbourList(&Sim, new DefaultSorter()));
+
+  std::unique_ptr<dynamo::UCell> packptr(new dynamo::CUFCC(std::array<long, 3>{{4,4,4}}, dynamo::Vector{1,1,1}, new dynamo::UParticle()));
+  packptr->initialise();
+  std::vector<dynamo::Vector> latticeSites(packptr->placeObjects(dynamo::Vector{0,0,0}));
+  Sim.primaryCellSize = dynamo::Vector{1,1,1};
+
+  const double particleDiam = std::cbrt(0.1 / latticeSites.size());
+  Sim.interactions.push_back(dynamo::shared_ptr<dynamo::Interaction>(new dynamo::IHardSphere(&Sim, particleDiam, 1.0, new dynamo::IDPairRangeAll(), "Bulk")));
+  Sim.addSpecies(dynamo::shared_ptr<dynamo::Species>(new dynamo::SpPoint(&Sim, new dynamo::IDRangeAll(&Sim), 1.0, "Bulk", 0)));
+
+  unsigned long nParticles = 0;
+  for (const dynamo::Vector & position : latticeSites)
+    Sim.particles.push_back(dynamo::Particle(position, getRandVelVec(), nParticles++));
+
+  //A slab of voxels which no particle can enter, placed between two
+  //planes of the lattice, and a slab with a step the particles can
+  //climb
+  std::vector<bool> occupied(voxels, false);
+  for (const dynamo::Particle& p : Sim.particles)
+    occupied[voxelCoord(p.getPosition()[0])] = true;
+
+  size_t wall = 0;
+  while (occupied[wall] || occupied[wall + 1] || occupied[wall + 2])
+    ++wall;
+
+  std::vector<unsigned char> volume(voxels * voxels * voxels, 0);
+  for (size_t z(0); z < voxels; ++z)
+    for (size_t y(0); y < voxels; ++y)
+      for (size_t x(0); x < voxels; ++x)
+	{
+	  unsigned char& value = volume[x + voxels * (y + voxels * z)];
+	  if ((x >= wall) && (x < wall + 3))
+	    value = 255;
+	  else if (y < voxels / 4)
+	    value = 2;
+	}
+
+  {
+    std::ofstream raw("volumetric_test.raw", std::ios::binary);
+    raw.write(reinterpret_cast<const char*>(volume.data()), volume.size());
+    std::ofstream xml("volumetric_test.xml");
+    xml << "<Global Type=\"VolumetricPotential\" Name=\"Volume\" RawFile=\"volumetric_test.raw\" SampleBytes=\"1\">"
+	<< "<Dimensions x=\"" << voxels << "\" y=\"" << voxels << "\" z=\"" << voxels << "\"/></Global>";
+  }
+
+  magnet::xml::Document doc("volumetric_test.xml");
+  dynamo::shared_ptr<dynamo::GVolumetricPotential> volumetric(new dynamo::GVolumetricPotential(doc.getNode("Global"), &Sim));
+  Sim.globals.push_back(volumetric);
+
+  Sim.ensemble = dynamo::Ensemble::loadEnsemble(Sim);
+  dynamo::InputPlugin(&Sim, "Rescaler").zeroMomentum();
+  dynamo::InputPlugin(&Sim, "Rescaler").rescaleVels(1.0);
+
+  Sim.endEventCount = 100000;
+  Sim.initialise();
+
+  //The neighbour list cells are sized by the interactions, not the
+  //voxels
+  BOOST_CHECK(volumetric->getCellDimensions()[0] > 4.0 / voxels);
+
+  const double initialEnergy = totalEnergy(Sim, volume);
+  while (Sim.runSimulationStep()) {}
+
+  BOOST_CHECK_CLOSE(totalEnergy(Sim, volume), initialEnergy, 1e-6);
+  BOOST_CHECK(volumetric->getStatistics().cellTransitions > 0);
+  for (const dynamo::Particle& p : Sim.particles)
+    BOOST_CHECK(voxelValue(volume, p) != 255);
+}
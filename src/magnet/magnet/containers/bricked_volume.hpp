@@ -0,0 +1,177 @@
+/*  dynamo:- Event driven molecular dynamics simulator
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+#include <magnet/exception.hpp>
+#include <array>
+#include <vector>
+#include <algorithm>
+
+namespace magnet {
+  namespace containers {
+    /*! \brief A compressed 3D array which stores uniform regions
+      as single values.
+
+      The volume is split into cubic bricks of \f$2^{BrickBits}\f$
+      voxels a side. Bricks where every voxel has the same value are
+      stored as that single value, all other bricks are stored
+      densely. Each brick has an offset into the payload and a mask
+      which is zero for uniform bricks, so a lookup is always O(1)
+      and branch free.
+
+      This is useful for segmented images (e.g., porous media) where
+      most of the volume is either solid or empty.
+
+      The coordinates are row-major ordered (x varies fastest), as in
+      \ref RowMajorOrdering.
+
+      \tparam T The type of the stored voxels.
+      \tparam BrickBits The log2 of the brick side length.
+    */
+    template<class T, size_t BrickBits = 3>
+    class BrickedVolume
+    {
+    public:
+      typedef std::array<size_t, 3> ArrayType;
+
+      static const size_t BrickSide = size_t(1) << BrickBits;
+      static const size_t BrickVolume = BrickSide * BrickSide * BrickSide;
+
+      BrickedVolume(): _dimensions({{0, 0, 0}}), _brickDimensions({{0, 0, 0}}) {}
+
+      /*! \brief Build the compressed volume from a sampling functor.
+
+	The bricks are built one at a time, so the uncompressed volume
+	never needs to be held in memory.
+
+	\param dimensions The number of voxels in each dimension.
+	\param sample A functor returning the value of the voxel at
+	the passed ArrayType coordinate.
+       */
+      template<class Func>
+      void build(const ArrayType& dimensions, Func sample)
+      {
+	_dimensions = dimensions;
+	for (size_t i(0); i < 3; ++i)
+	  _brickDimensions[i] = (_dimensions[i] + BrickSide - 1) / BrickSide;
+
+	_bricks.clear();
+	_payload.clear();
+	_bricks.reserve(_brickDimensions[0] * _brickDimensions[1] * _brickDimensions[2]);
+
+	std::array<T, BrickVolume> buffer;
+	ArrayType brick;
+	for (brick[2] = 0; brick[2] < _brickDimensions[2]; ++brick[2])
+	  for (brick[1] = 0; brick[1] < _brickDimensions[1]; ++brick[1])
+	    for (brick[0] = 0; brick[0] < _brickDimensions[0]; ++brick[0])
+	      {
+		//Voxels outside of the volume (in partial bricks at the
+		//edges) are padded with the first voxel of the brick,
+		//so they never prevent a brick being uniform.
+		const ArrayType origin{{brick[0] * BrickSide, brick[1] * BrickSide, brick[2] * BrickSide}};
+		const T first = sample(origin);
+		bool uniform = true;
+		ArrayType local;
+		size_t idx = 0;
+		for (local[2] = 0; local[2] < BrickSide; ++local[2])
+		  for (local[1] = 0; local[1] < BrickSide; ++local[1])
+		    for (local[0] = 0; local[0] < BrickSide; ++local[0], ++idx)
+		      {
+			const ArrayType coord{{origin[0] + local[0], origin[1] + local[1], origin[2] + local[2]}};
+			if ((coord[0] < _dimensions[0]) && (coord[1] < _dimensions[1]) && (coord[2] < _dimensions[2]))
+			  buffer[idx] = sample(coord);
+			else
+			  buffer[idx] = first;
+			uniform &= (buffer[idx] == first);
+		      }
+
+		if (uniform)
+		  {
+		    _bricks.push_back(Brick{_payload.size(), 0});
+		    _payload.push_back(first);
+		  }
+		else
+		  {
+		    _bricks.push_back(Brick{_payload.size(), BrickVolume - 1});
+		    _payload.insert(_payload.end(), buffer.begin(), buffer.end());
+		  }
+	      }
+
+	_payload.shrink_to_fit();
+      }
+
+      /*! \brief Access the voxel at the passed coordinate. */
+      const T& operator()(const ArrayType& coord) const
+      {
+#ifdef MAGNET_DEBUG
+	for (size_t i(0); i < 3; ++i)
+	  if (coord[i] >= _dimensions[i])
+	    M_throw() << "Out of range access of a BrickedVolume";
+#endif
+	const size_t brickID = (coord[0] >> BrickBits)
+	  + _brickDimensions[0] * ((coord[1] >> BrickBits) + _brickDimensions[1] * (coord[2] >> BrickBits));
+	const size_t localID = (coord[0] & (BrickSide - 1))
+	  + BrickSide * ((coord[1] & (BrickSide - 1)) + BrickSide * (coord[2] & (BrickSide - 1)));
+	const Brick& brick = _bricks[brickID];
+	return _payload[brick._offset + (localID & brick._mask)];
+      }
+
+      /*! \brief Decompress the volume into a dense row-major array. */
+      std::vector<T> dense() const
+      {
+	std::vector<T> retval;
+	retval.reserve(size());
+	ArrayType coord;
+	for (coord[2] = 0; coord[2] < _dimensions[2]; ++coord[2])
+	  for (coord[1] = 0; coord[1] < _dimensions[1]; ++coord[1])
+	    for (coord[0] = 0; coord[0] < _dimensions[0]; ++coord[0])
+	      retval.push_back(operator()(coord));
+	return retval;
+      }
+
+      const ArrayType& getDimensions() const { return _dimensions; }
+
+      /*! \brief The number of voxels stored in the volume. */
+      size_t size() const { return _dimensions[0] * _dimensions[1] * _dimensions[2]; }
+
+      /*! \brief The number of bricks which are stored as a single value. */
+      size_t uniformBricks() const {
+	return std::count_if(_bricks.begin(), _bricks.end(), [](const Brick& b) { return b._mask == 0; });
+      }
+
+      /*! \brief The number of bricks in the volume. */
+      size_t bricks() const { return _bricks.size(); }
+
+      /*! \brief The number of bytes used to store the compressed
+          volume (excluding the object itself). */
+      size_t memoryUsage() const {
+	return _bricks.capacity() * sizeof(Brick) + _payload.capacity() * sizeof(T);
+      }
+
+    protected:
+      struct Brick {
+	size_t _offset;
+	size_t _mask;
+      };
+
+      ArrayType _dimensions;
+      ArrayType _brickDimensions;
+      std::vector<Brick> _bricks;
+      std::vector<T> _payload;
+    };
+  }
+}
@@ -21,6 +21,9 @@
 #pragma once
 
 #include <magnet/containers/iterator_pair.hpp>
+#include <algorithm>
+#include <iterator>
+#include <vector>
 
 namespace magnet {
   namespace containers {
@@ -44,6 +47,20 @@ namespace magnet {
 	_data[cell].insert(particle);
       }
 
+      /*! \brief Insert a range of values into a single key.
+
+	This allows bulk construction of the container (e.g., from a
+	counting sort), as the storage for the key is allocated once.
+	The storage is over-allocated so that later single insertions
+	rarely reallocate.
+       */
+      template<class Iterator>
+      void insert(size_t cell, Iterator begin, Iterator end) {
+	_data[cell].reserve(std::max<size_t>(4, 2 * (_data[cell].size() + std::distance(begin, end))));
+	for (; begin != end; ++begin)
+	  _data[cell].insert(*begin);
+      }
+
       typedef magnet::containers::IteratorPairRange<const_iterator> RangeType;
       RangeType getKeyContents(const size_t key) const {
 #ifdef MAGNET_DEBUG
@@ -89,6 +106,12 @@ namespace magnet {
 	_data.insert(toKey(cell, particle));
       }
 
+      template<class Iterator>
+      void insert(uint32_t cell, Iterator begin, Iterator end) {
+	for (; begin != end; ++begin)
+	  insert(cell, *begin);
+      }
+
       typedef magnet::containers::IteratorPairRange<const_iterator> RangeType;
       RangeType getKeyContents(const uint32_t cellID) const {
 	return RangeType(_data.lower_bound(toKey(cellID, 0)), _data.lower_bound(toKey(cellID + 1, 0)));
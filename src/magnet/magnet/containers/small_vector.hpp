@@ -0,0 +1,177 @@
+/*  dynamo:- Event driven molecular dynamics simulator 
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace magnet {
+  namespace containers {
+    /*! \brief A std::vector-like container which stores up to N
+      elements inline.
+
+      Unlike the StackVector, the SmallVector may grow past N
+      elements, at which point the elements are moved to the heap.
+      This is useful for containers which nearly always hold one or
+      two elements and which are created and destroyed frequently.
+     */
+    template<class T, size_t N>
+    class SmallVector
+    {
+    public:
+      typedef T value_type;
+      typedef T* iterator;
+      typedef const T* const_iterator;
+      typedef T& reference;
+      typedef const T& const_reference;
+      typedef size_t size_type;
+
+      SmallVector(): _data(inlineData()), _size(0), _capacity(N) {}
+
+      SmallVector(const SmallVector& other):
+	_data(inlineData()), _size(0), _capacity(N)
+      {
+	reserve(other.size());
+	for (const T& val : other)
+	  push_back(val);
+      }
+
+      SmallVector(SmallVector&& other):
+	_data(inlineData()), _size(0), _capacity(N)
+      { take(other); }
+
+      ~SmallVector() { clear(); release(); }
+
+      SmallVector& operator=(const SmallVector& other)
+      {
+	if (this == &other) return *this;
+	clear();
+	reserve(other.size());
+	for (const T& val : other)
+	  push_back(val);
+	return *this;
+      }
+
+      SmallVector& operator=(SmallVector&& other)
+      {
+	if (this == &other) return *this;
+	clear();
+	release();
+	take(other);
+	return *this;
+      }
+
+      void push_back(const T& val)
+      {
+	if (_size == _capacity)
+	  {
+	    //val may be an element of this container
+	    T copy(val);
+	    reserve(2 * _capacity);
+	    new (_data + _size) T(std::move(copy));
+	  }
+	else
+	  new (_data + _size) T(val);
+	++_size;
+      }
+
+      void pop_back() { _data[--_size].~T(); }
+
+      void clear()
+      {
+	for (size_t i(0); i < _size; ++i)
+	  _data[i].~T();
+	_size = 0;
+      }
+
+      void reserve(size_t capacity)
+      {
+	if (capacity <= _capacity) return;
+	T* data = static_cast<T*>(::operator new(capacity * sizeof(T)));
+	for (size_t i(0); i < _size; ++i)
+	  {
+	    new (data + i) T(std::move(_data[i]));
+	    _data[i].~T();
+	  }
+	release();
+	_data = data;
+	_capacity = capacity;
+      }
+
+      size_t size() const { return _size; }
+      size_t capacity() const { return _capacity; }
+      bool empty() const { return _size == 0; }
+
+      /*! \brief Test if the elements are stored inline. */
+      bool isInline() const { return _data == inlineData(); }
+
+      T& operator[](size_t i) { return _data[i]; }
+      const T& operator[](size_t i) const { return _data[i]; }
+      T& front() { return _data[0]; }
+      const T& front() const { return _data[0]; }
+      T& back() { return _data[_size - 1]; }
+      const T& back() const { return _data[_size - 1]; }
+
+      iterator begin() { return _data; }
+      iterator end() { return _data + _size; }
+      const_iterator begin() const { return _data; }
+      const_iterator end() const { return _data + _size; }
+      const_iterator cbegin() const { return _data; }
+      const_iterator cend() const { return _data + _size; }
+
+    private:
+      T* inlineData() { return reinterpret_cast<T*>(&_storage); }
+      const T* inlineData() const { return reinterpret_cast<const T*>(&_storage); }
+
+      void release()
+      {
+	if (!isInline())
+	  ::operator delete(_data);
+	_data = inlineData();
+	_capacity = N;
+      }
+
+      //Take the elements of other, this container must be empty and inline
+      void take(SmallVector& other)
+      {
+	if (other.isInline())
+	  {
+	    for (size_t i(0); i < other._size; ++i)
+	      new (_data + i) T(std::move(other._data[i]));
+	    _size = other._size;
+	    other.clear();
+	  }
+	else
+	  {
+	    _data = other._data;
+	    _size = other._size;
+	    _capacity = other._capacity;
+	    other._data = other.inlineData();
+	    other._size = 0;
+	    other._capacity = N;
+	  }
+      }
+
+      typename std::aligned_storage<sizeof(T) * N, alignof(T)>::type _storage;
+      T* _data;
+      size_t _size;
+      size_t _capacity;
+    };
+  }
+}
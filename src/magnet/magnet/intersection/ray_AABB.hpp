@@ -0,0 +1,74 @@
+/*  dynamo:- Event driven molecular dynamics simulator
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+#include <magnet/math/vector.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace magnet {
+  namespace intersection {
+    /*! \brief A ray->Axis-Aligned-Bounding-Box entry test without
+      back face culling.
+
+      Unlike \ref ray_AAcube, this test does not cull rays which
+      start inside the box. It is intended for culling tests in
+      bounding volume hierarchies, where a ray which is already
+      inside a volume must still visit its contents.
+
+      \param T The origin of the ray.
+      \param D The direction/velocity of the ray.
+      \param min The lower corner of the box.
+      \param max The upper corner of the box.
+      \return The time the ray enters the box (negative if the ray
+      starts inside the box), or HUGE_VAL if the ray never
+      intersects the box in the future.
+    */
+    inline double ray_AABB(const math::Vector& T, const math::Vector& D, const math::Vector& min, const math::Vector& max)
+    {
+      double time_in_max = -HUGE_VAL;
+      double time_out_min = HUGE_VAL;
+
+      for (size_t i(0); i < 3; ++i)
+	{
+	  if (D[i] == 0)
+	    {
+	      //No motion in this dimension, the ray must already be
+	      //within the slab
+	      if ((T[i] < min[i]) || (T[i] > max[i]))
+		return HUGE_VAL;
+	    }
+	  else
+	    {
+	      const double invD = 1.0 / D[i];
+	      double time_in  = (min[i] - T[i]) * invD;
+	      double time_out = (max[i] - T[i]) * invD;
+	      if (invD < 0) std::swap(time_in, time_out);
+
+	      time_in_max = std::max(time_in_max, time_in);
+	      time_out_min = std::min(time_out_min, time_out);
+	    }
+	}
+
+      //The slabs do not overlap, or the ray has already left the box
+      if ((time_in_max > time_out_min) || (time_out_min < 0))
+	return HUGE_VAL;
+
+      return time_in_max;
+    }
+  }
+}
@@ -0,0 +1,160 @@
+/*  dynamo:- Event driven molecular dynamics simulator
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace magnet {
+  namespace math {
+    /*! \brief Online blocking analysis of the error in the mean of a
+        correlated series.
+
+	Successive samples of a simulation are correlated, so the
+	naive standard error of their mean underestimates the true
+	error. Following Flyvbjerg and Petersen [J. Chem. Phys. 91,
+	461 (1989)], the series is repeatedly halved by averaging
+	neighbouring pairs of samples. Once the blocks are longer than
+	the correlation time, the naive error of the blocked series
+	stops growing and equals the true error of the mean.
+
+	Only the running sums of each blocking level (and one pending
+	sample) are stored, so the memory cost is \f$\mathcal{O}(\log
+	n)\f$ for \f$n\f$ samples.
+     */
+    class BlockingAverage
+    {
+    public:
+      BlockingAverage() { clear(); }
+
+      /*! \brief Remove all collected data. */
+      void clear() { _levels.clear(); }
+
+      /*! \brief Add a new sample to the series. */
+      void push(double value)
+      {
+	for (size_t l(0); ; ++l)
+	  {
+	    if (l == _levels.size())
+	      _levels.push_back(Level());
+
+	    Level& level = _levels[l];
+	    level.sum += value;
+	    level.sumSq += value * value;
+	    ++level.count;
+
+	    if (!level.pending)
+	      {
+		level.partial = value;
+		level.pending = true;
+		return;
+	      }
+
+	    //Pass the average of the pair up to the next level
+	    value = 0.5 * (value + level.partial);
+	    level.pending = false;
+	  }
+      }
+
+      /*! \brief The number of samples added. */
+      size_t count() const { return _levels.empty() ? 0 : _levels[0].count; }
+
+      /*! \brief The mean of the samples added. */
+      double mean() const
+      { return count() ? _levels[0].sum / _levels[0].count : 0; }
+
+      /*! \brief The number of blocking levels (level 0 is the
+          original series). */
+      size_t levels() const { return _levels.size(); }
+
+      /*! \brief The number of blocks of a level. */
+      size_t count(size_t level) const { return _levels[level].count; }
+
+      /*! \brief The naive standard error of the mean of the blocks of
+          a level, treating them as independent. */
+      double error(size_t level) const
+      {
+	const Level& l = _levels[level];
+	if (l.count < 2)
+	  return std::numeric_limits<double>::infinity();
+	const double variance = std::max(0.0, (l.sumSq - l.sum * l.sum / l.count) / (l.count - 1));
+	return std::sqrt(variance / l.count);
+      }
+
+      /*! \brief The uncertainty of error(level) itself. */
+      double errorOfError(size_t level) const
+      { return error(level) / std::sqrt(2.0 * (std::max(count(level), size_t(2)) - 1)); }
+
+      /*! \brief The result of the blocking analysis. */
+      struct Estimate
+      {
+	double error;
+	size_t level;
+	bool converged;
+      };
+
+      /*! \brief Estimate the error in the mean.
+
+	  The error of each level is compared with that of the next
+	  (coarser) level. The first level where the error stops
+	  growing, within the uncertainty of the coarser error, is
+	  taken as the plateau and the coarser error is
+	  returned. Levels with fewer than minBlocks blocks are too
+	  noisy to be used. If no plateau is found, the largest error
+	  of the usable levels is returned as a conservative estimate
+	  and the Estimate is marked as not converged.
+       */
+      Estimate errorEstimate(size_t minBlocks = 16) const
+      {
+	Estimate result = {std::numeric_limits<double>::infinity(), 0, false};
+
+	for (size_t l(0); (l + 1 < _levels.size()) && (count(l + 1) >= minBlocks); ++l)
+	  if (error(l + 1) - error(l) <= errorOfError(l + 1))
+	    {
+	      result.error = error(l + 1);
+	      result.level = l + 1;
+	      result.converged = true;
+	      return result;
+	    }
+
+	for (size_t l(0); (l < _levels.size()) && (count(l) >= minBlocks); ++l)
+	  if ((result.error == std::numeric_limits<double>::infinity()) || (error(l) > result.error))
+	    {
+	      result.error = error(l);
+	      result.level = l;
+	    }
+
+	return result;
+      }
+
+    protected:
+      struct Level
+      {
+	Level(): sum(0), sumSq(0), partial(0), count(0), pending(false) {}
+	double sum;
+	double sumSq;
+	double partial;
+	size_t count;
+	bool pending;
+      };
+
+      std::vector<Level> _levels;
+    };
+  }
+}
@@ -18,10 +18,13 @@
 #pragma once
 #include <magnet/math/vector.hpp>
 #include <magnet/exception.hpp>
+#include <magnet/math/blocking.hpp>
 #include <boost/circular_buffer.hpp>
 #include <vector>
 #include <utility>
 #include <tuple>
+#include <functional>
+#include <limits>
 
 namespace magnet {
   namespace math {    
@@ -471,6 +474,435 @@ namespace magnet {
       
       Container _correlators;
     };
+
+    /*! \brief A multiple-tau (order-n) correlator of many channels
+        sampled at a fixed interval.
+
+	Storing the full history of a set of values (e.g., the
+	positions of all particles) to correlate them over long lag
+	times requires memory and computation proportional to the
+	longest lag. This class instead keeps a hierarchy of levels,
+	each holding the last \f$p\f$ samples of every channel. Level
+	\f$l\f$ only receives every \f$m^l\f$th sample, so its lags are
+	\f$j\,m^l\f$ for \f$j<p\f$. Only the lags not already resolved
+	by the finer levels (\f$j\ge\lceil p/m\rceil\f$) are
+	correlated on the coarser levels, giving logarithmically
+	spaced lags over many decades at a memory cost of
+	\f$\mathcal{O}(N\,p\log_m T)\f$ for \f$N\f$ channels and \f$T\f$
+	samples.
+
+	The coarser levels hold the sample values (not block
+	averages), thus correlations of integrated quantities (e.g.,
+	the displacements in an MSD) are exact at every lag.
+
+	The correlation itself is carried out by the caller, see
+	correlate(), so that any function of the origin and current
+	values may be accumulated into any number of averages.
+
+	\tparam T The type of the sampled value.
+     */
+    template<class T>
+    class MultipleTauCorrelator
+    {
+    public:
+      MultipleTauCorrelator(): _channels(0), _length(2), _scaling(2) { clear(); }
+
+      /*! \brief Resets the correlator before data collection.
+
+	\param channels The number of values sampled each time.
+
+	\param length The number of samples stored in each level
+	(\f$p\f$).
+
+	\param scaling The ratio of the sample intervals of successive
+	levels (\f$m\f$).
+       */
+      void resize(size_t channels, size_t length, size_t scaling = 2)
+      {
+	if ((length < 2) || (scaling < 2))
+	  M_throw() << "MultipleTauCorrelator requires a length and scaling of at least 2, length=" << length
+		    << ", scaling=" << scaling;
+
+	_channels = channels;
+	_length = length;
+	_scaling = scaling;
+	clear();
+      }
+
+      /*! \brief Remove all collected data. */
+      void clear()
+      {
+	_levels.clear();
+	_origin.clear();
+	_sampleCounts.clear();
+	_samples = 0;
+	_dueLevels = 0;
+      }
+
+      /*! \brief Add a new sample of every channel.
+
+	  \param sample A functor returning the value of a channel,
+	  called as sample(channel).
+       */
+      template<class Func>
+      void push(const Func& sample)
+      {
+	_dueLevels = 0;
+	size_t interval = 1;
+	for (size_t l(0); ; ++l, interval *= _scaling)
+	  {
+	    if (l && (!_samples || (_samples % interval))) break;
+
+	    if (l == _levels.size())
+	      {
+		//A new level (first reached when _samples == interval)
+		//also holds the first sample of the run as an origin
+		_levels.push_back(Level(_channels * _length));
+		if (l)
+		  {
+		    std::copy(_origin.begin(), _origin.end(), _levels.back().data.begin());
+		    _levels.back().count = 1;
+		  }
+	      }
+
+	    Level& level = _levels[l];
+	    T* const slot = &level.data[(level.count % _length) * _channels];
+	    if (l)
+	      std::copy(_current, _current + _channels, slot);
+	    else
+	      {
+		for (size_t c(0); c < _channels; ++c)
+		  slot[c] = sample(c);
+		_current = slot;
+		if (!_samples)
+		  _origin.assign(slot, slot + _channels);
+	      }
+	    ++level.count;
+	    ++_dueLevels;
+
+	    const size_t end = std::min(level.count, _length);
+	    if ((end > firstLag(l)) && (lagIndex(l, end - 1) >= _sampleCounts.size()))
+	      _sampleCounts.resize(lagIndex(l, end - 1) + 1, 0);
+	    for (size_t j(firstLag(l)); j < end; ++j)
+	      ++_sampleCounts[lagIndex(l, j)];
+	  }
+
+	++_samples;
+      }
+
+      /*! \brief Correlate the last sample with all of the stored
+          origins.
+
+	  This must be called after each push() to collect the data.
+	  
+	  \param func A functor called as func(lag_index, channel,
+	  origin_value, current_value) for every lag now available.
+	  The lag_index is less than getLagCount().
+       */
+      template<class Func>
+      void correlate(Func& func) const
+      {
+	for (size_t l(0); l < _dueLevels; ++l)
+	  {
+	    const Level& level = _levels[l];
+	    const T* const current = &level.data[(level.count - 1) % _length * _channels];
+	    const size_t end = std::min(level.count, _length);
+	    for (size_t j(firstLag(l)); j < end; ++j)
+	      {
+		const size_t lag = lagIndex(l, j);
+		const T* const origin = &level.data[(level.count - 1 - j) % _length * _channels];
+		for (size_t c(0); c < _channels; ++c)
+		  func(lag, c, origin[c], current[c]);
+	      }
+	  }
+      }
+
+      /*! \brief The number of lags collected so far. */
+      size_t getLagCount() const { return _sampleCounts.size(); }
+
+      /*! \brief The lag (in samples) of a lag_index. */
+      size_t getLag(size_t i) const
+      {
+	if (i < _length) return i;
+	i -= _length;
+	const size_t perLevel = _length - firstLag(1);
+	size_t interval = _scaling;
+	for (size_t l(0); l < i / perLevel; ++l)
+	  interval *= _scaling;
+	return (firstLag(1) + i % perLevel) * interval;
+      }
+
+      /*! \brief The number of origins averaged over for a
+	  lag_index. */
+      size_t getSampleCount(size_t i) const { return _sampleCounts[i]; }
+
+    protected:
+      struct Level
+      {
+	Level(size_t size): data(size), count(0) {}
+	std::vector<T> data;
+	size_t count;
+      };
+
+      size_t firstLag(size_t level) const { return level ? (_length + _scaling - 1) / _scaling : 0; }
+
+      size_t lagIndex(size_t level, size_t j) const
+      { return level ? _length + (level - 1) * (_length - firstLag(1)) + j - firstLag(1) : j; }
+
+      std::vector<Level> _levels;
+      std::vector<T> _origin;
+      std::vector<size_t> _sampleCounts;
+      const T* _current;
+      size_t _channels;
+      size_t _length;
+      size_t _scaling;
+      size_t _samples;
+      size_t _dueLevels;
+    };
+
+    /*! \brief The estimate of a transport coefficient, see \ref
+        EinsteinTransportEstimator.
+     */
+    struct TransportEstimate
+    {
+      TransportEstimate(): value(0), error(std::numeric_limits<double>::infinity()), time(0), windows(0), plateau(false) {}
+      //! The value of \f$L(\tau)\f$.
+      double value;
+      //! The blocked standard error of value.
+      double error;
+      //! The window length \f$\tau\f$.
+      double time;
+      //! The number of windows averaged over.
+      size_t windows;
+      //! If the estimate was found to be on the plateau of \f$L(\tau)\f$.
+      bool plateau;
+    };
+
+    /*! \brief Estimates a transport coefficient from the Einstein
+        (Helfand) form of its Green-Kubo relation, with error bars.
+
+	The Green-Kubo integral of the microscopic flux is equal to
+	the long time limit of
+	\f[L(\tau)=\frac{\left\langle\Delta W^{(1)}(\tau)\cdot\Delta
+	W^{(2)}(\tau)\right\rangle}{2\,\tau}\f] 
+	where \f$\Delta W\f$ is the integral of the flux over an
+	interval of length \f$\tau\f$. The integrals are collected
+	exactly as in the \ref TimeCorrelator (free streaming plus
+	impulsive contributions) over non-overlapping windows of
+	length \f$\tau_l=2^l\,\delta t\f$, each level being built
+	by summing pairs of windows of the level below. Every window
+	provides one sample of \f$L(\tau_l)\f$ which is fed to a
+	\ref BlockingAverage, giving the uncertainty of each
+	\f$L(\tau_l)\f$ despite the correlations between windows.
+
+	As \f$L(\tau)\f$ rises to a plateau at the transport
+	coefficient (once \f$\tau\f$ is longer than the relaxation
+	time of the flux), getEstimate() searches for the first level
+	which is statistically indistinguishable from the next one.
+
+	The product of \f$\Delta W^{(1)}\f$ and \f$\Delta
+	W^{(2)}\f$ is supplied as a functor, allowing tensor
+	components to be selected or averaged into a single
+	coefficient.
+     */
+    template<class T>
+    class EinsteinTransportEstimator
+    {
+    public:
+      typedef std::function<double(const T&, const T&)> Product;
+
+      EinsteinTransportEstimator(): _sample_time(1), _removeAverage(false) { clear(); }
+
+      /*! \brief Resets the estimator before data collection.
+	
+	\param sample_time The length of the shortest window,
+	\f$\delta t\f$.
+
+	\param product Returns the (scalar) product of the integrated
+	fluxes of a window.
+
+	\param removeAverage If true, the average flux (e.g., the
+	mean pressure for the bulk viscosity) is subtracted from the
+	integrals. The product must then be bilinear, as the final
+	average is subtracted from the accumulated sums of the
+	integrals when the estimate is taken. The blocked errors are
+	taken from samples centred on the average at the time each
+	window was collected, which only differ from the final average
+	by a vanishing amount.
+       */
+      void resize(double sample_time, Product product, bool removeAverage = false)
+      {
+	if (sample_time <= 0)
+	  M_throw() << "EinsteinTransportEstimator requires a positive, non-zero sample time, sample_time=" << sample_time;
+
+	_sample_time = sample_time;
+	_product = product;
+	_removeAverage = removeAverage;
+	clear();
+      }
+
+      void clear()
+      {
+	_levels.clear();
+	_window = _total = _freestream_values = std::pair<T,T>();
+	_current_time = 0;
+	_windows = 0;
+      }
+
+      /*! \brief See \ref TimeCorrelator::addImpulse(). */
+      void addImpulse(const T& val) { addImpulse(val, val); }
+
+      /*! \brief See \ref TimeCorrelator::addImpulse(). */
+      void addImpulse(const T& val1, const T& val2)
+      {
+	_window.first += val1;
+	_window.second += val2;
+      }
+
+      /*! \brief See \ref TimeCorrelator::setFreeStreamValue(). */
+      void setFreeStreamValue(const T& val) { setFreeStreamValue(val, val); }
+
+      /*! \brief See \ref TimeCorrelator::setFreeStreamValue(). */
+      void setFreeStreamValue(const T& val1, const T& val2)
+      { _freestream_values = std::pair<T,T>(val1, val2); }
+
+      /*! \brief See \ref TimeCorrelator::freeStream(). */
+      void freeStream(double dt)
+      {
+	while ((_current_time + dt) >= _sample_time)
+	  {
+	    const double deltat = _sample_time - _current_time;
+	    _window.first += _freestream_values.first * deltat;
+	    _window.second += _freestream_values.second * deltat;
+	    push(_window);
+	    _window = std::pair<T,T>();
+	    _current_time = 0;
+	    dt -= deltat;
+	  }
+
+	_window.first += _freestream_values.first * dt;
+	_window.second += _freestream_values.second * dt;
+	_current_time += dt;
+      }
+
+      typedef TransportEstimate Estimate;
+
+      /*! \brief The number of window lengths collected so far. */
+      size_t levels() const { return _levels.size(); }
+
+      /*! \brief The estimate of \f$L(\tau_l)\f$ for one window
+          length. */
+      Estimate getLevelEstimate(size_t level, size_t minBlocks = 16) const
+      {
+	Estimate result;
+	const Level& data = _levels[level];
+	const BlockingAverage& samples = data.samples;
+	result.value = samples.mean();
+	result.time = _sample_time * std::pow(2.0, double(level));
+	if (_removeAverage && samples.count())
+	  {
+	    //<(a-m1 tau).(b-m2 tau)>/(2 tau) expanded in the sums of
+	    //the window integrals, for the final mean fluxes m1 and m2
+	    const double tau = result.time;
+	    const double n = samples.count();
+	    const std::pair<T,T> mean(_total.first * (1.0 / (_sample_time * _windows)), _total.second * (1.0 / (_sample_time * _windows)));
+	    result.value = data.productSum / (2 * tau * n)
+	      - (_product(data.sum.first, mean.second) + _product(mean.first, data.sum.second)) / (2 * n)
+	      + tau * _product(mean.first, mean.second) / 2;
+	  }
+	result.error = samples.errorEstimate(minBlocks).error;
+	result.windows = samples.count();
+	return result;
+      }
+
+      /*! \brief The estimate of the transport coefficient.
+
+	  Levels are considered in order of increasing window length
+	  while they have at least minBlocks windows. The first level
+	  which agrees with the next level to within twice their
+	  combined error is taken to be on the plateau, and the next
+	  (longer, less biased) level is returned. If no plateau is
+	  found, the longest usable level is returned with plateau
+	  set to false.
+       */
+      Estimate getEstimate(size_t minBlocks = 16) const
+      {
+	Estimate result;
+	for (size_t l(0); (l < _levels.size()) && (_levels[l].samples.count() >= minBlocks); ++l)
+	  {
+	    const Estimate current = getLevelEstimate(l, minBlocks);
+	    if (l && (std::abs(current.value - result.value) <= 2 * std::sqrt(current.error * current.error + result.error * result.error)))
+	      {
+		result = current;
+		result.plateau = true;
+		return result;
+	      }
+	    result = current;
+	  }
+	return result;
+      }
+
+      double getSampleTime() const { return _sample_time; }
+
+    protected:
+      void push(std::pair<T,T> delta)
+      {
+	_total.first += delta.first;
+	_total.second += delta.second;
+	++_windows;
+
+	double tau = _sample_time;
+	for (size_t l(0); ; ++l, tau *= 2)
+	  {
+	    if (l == _levels.size())
+	      _levels.push_back(Level());
+	    Level& level = _levels[l];
+
+	    if (_removeAverage)
+	      {
+		level.productSum += _product(delta.first, delta.second);
+		level.sum.first += delta.first;
+		level.sum.second += delta.second;
+		const double scale = tau / (_sample_time * _windows);
+		level.samples.push(_product(delta.first - _total.first * scale, delta.second - _total.second * scale) / (2 * tau));
+	      }
+	    else
+	      level.samples.push(_product(delta.first, delta.second) / (2 * tau));
+
+	    if (!level.pending)
+	      {
+		level.partial = delta;
+		level.pending = true;
+		return;
+	      }
+	    
+	    delta.first += level.partial.first;
+	    delta.second += level.partial.second;
+	    level.pending = false;
+	  }
+      }
+
+      struct Level
+      {
+	Level(): partial(), pending(false), sum(), productSum(0) {}
+	BlockingAverage samples;
+	std::pair<T,T> partial;
+	bool pending;
+	//! The sums of the window integrals and their products, to
+	//! remove the final average
+	std::pair<T,T> sum;
+	double productSum;
+      };
+
+      std::vector<Level> _levels;
+      std::pair<T,T> _window;
+      std::pair<T,T> _total;
+      std::pair<T,T> _freestream_values;
+      Product _product;
+      double _sample_time;
+      double _current_time;
+      size_t _windows;
+      bool _removeAverage;
+    };
   }
 }
-
@@ -0,0 +1,154 @@
+/*  dynamo:- Event driven molecular dynamics simulator 
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+#include <magnet/exception.hpp>
+#include <magnet/thread/workstealingpool.hpp>
+#include <array>
+#include <cmath>
+#include <complex>
+#include <vector>
+
+namespace magnet {
+  namespace math {
+    namespace detail {
+      /*! \brief The twiddle factors \f$\exp(\mp 2\pi\,i\,j/n)\f$ of a
+        radix-2 FFT of length n, for \f$j\in[0,n/2)\f$.
+
+	These are calculated directly (instead of by repeated
+	multiplication) to avoid accumulating round-off error in long
+	transforms.
+       */
+      template<class T>
+      std::vector<std::complex<T> > fft_twiddles(const size_t n, const bool inverse)
+      {
+	if (!n || (n & (n - 1)))
+	  M_throw() << "The FFT length must be a power of two, not " << n;
+
+	std::vector<std::complex<T> > twiddles(n / 2);
+	for (size_t j(0); j < n / 2; ++j)
+	  twiddles[j] = std::polar(T(1), T((inverse ? 2 : -2) * M_PI * j) / n);
+	return twiddles;
+      }
+
+      /*! \brief An in-place iterative radix-2 FFT of n values spaced
+        stride apart, using precalculated twiddle factors.
+       */
+      template<class T>
+      void fft(std::complex<T>* data, const size_t n, const size_t stride, const std::vector<std::complex<T> >& twiddles)
+      {
+	//Bit reversal permutation
+	for (size_t i(1), j(0); i < n; ++i)
+	  {
+	    size_t bit = n >> 1;
+	    for (; j & bit; bit >>= 1)
+	      j ^= bit;
+	    j ^= bit;
+	    if (i < j)
+	      std::swap(data[i * stride], data[j * stride]);
+	  }
+
+	//Butterflies
+	for (size_t len(2); len <= n; len <<= 1)
+	  {
+	    const size_t twiddleStep = n / len;
+	    for (size_t i(0); i < n; i += len)
+	      for (size_t j(0); j < len / 2; ++j)
+		{
+		  std::complex<T>& a = data[(i + j) * stride];
+		  std::complex<T>& b = data[(i + j + len / 2) * stride];
+		  const std::complex<T> v = b * twiddles[j * twiddleStep];
+		  b = a - v;
+		  a += v;
+		}
+	  }
+      }
+    }
+
+    /*! \brief An in-place fast Fourier transform of n complex values.
+
+      This calculates the unnormalised discrete Fourier transform
+      \f[X_k=\sum_{j=0}^{n-1} x_j \exp\left(\mp\frac{2\pi\,i\,j\,k}{n}\right)\f]
+      where the negative sign is taken for the forward transform. The
+      inverse transform must be divided by n to recover the original
+      values.
+
+      \param data The values to transform.
+      \param n The number of values, which must be a power of two.
+      \param stride The spacing between the values in data.
+      \param inverse Whether to calculate the inverse transform.
+     */
+    template<class T>
+    void fft(std::complex<T>* data, const size_t n, const size_t stride = 1, const bool inverse = false)
+    {
+      detail::fft(data, n, stride, detail::fft_twiddles<T>(n, inverse));
+    }
+
+    /*! \brief An in-place fast Fourier transform of a three
+      dimensional array.
+
+      The array is stored with the first index fastest, i.e., the
+      value at (x,y,z) is data[x + dims[0] * (y + dims[1] * z)]. The
+      transform is carried out along each dimension in turn, and the
+      one dimensional transforms of each pass may be split into
+      chunks and run on a thread pool.
+
+      \param data The values to transform.
+      \param dims The size of each dimension, which must all be powers
+      of two.
+      \param inverse Whether to calculate the inverse transform.
+      \param pool The pool to run the chunks on (if NULL, they are
+      run on the calling thread).
+      \param chunks The number of chunks to split each pass into.
+     */
+    template<class T>
+    void fft3D(std::vector<std::complex<T> >& data, const std::array<size_t, 3>& dims, const bool inverse = false, magnet::thread::WorkStealingPool* pool = NULL, const size_t chunks = 1)
+    {
+      if (data.size() != dims[0] * dims[1] * dims[2])
+	M_throw() << "The data size (" << data.size() << ") does not match the dimensions of the FFT";
+
+      for (size_t dim(0); dim < 3; ++dim)
+	{
+	  const std::vector<std::complex<T> > twiddles = detail::fft_twiddles<T>(dims[dim], inverse);
+
+	  //The lines along this dimension are indexed by the
+	  //coordinates of the other two dimensions, (a, b)
+	  const size_t stride = (dim == 0) ? 1 : ((dim == 1) ? dims[0] : dims[0] * dims[1]);
+	  const size_t dimA = (dim == 0) ? 1 : 0;
+	  const size_t dimB = (dim == 2) ? 1 : 2;
+	  const size_t strideA = (dimA == 0) ? 1 : dims[0];
+	  const size_t strideB = (dimB == 1) ? dims[0] : dims[0] * dims[1];
+	  const size_t lines = dims[dimA] * dims[dimB];
+
+	  auto transformLines = [&](const size_t begin, const size_t end) {
+	    for (size_t line(begin); line < end; ++line)
+	      detail::fft(&data[(line % dims[dimA]) * strideA + (line / dims[dimA]) * strideB], dims[dim], stride, twiddles);
+	  };
+
+	  if (!pool || (chunks <= 1))
+	    transformLines(0, lines);
+	  else
+	    {
+	      magnet::thread::WorkStealingPool::TaskGroup group(*pool);
+	      for (size_t c(0); c < chunks; ++c)
+		group.run([&, c]() { transformLines((lines * c) / chunks, (lines * (c + 1)) / chunks); });
+	      group.wait();
+	    }
+	}
+    }
+  }
+}
@@ -0,0 +1,114 @@
+/*  dynamo:- Event driven molecular dynamics simulator
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+#include <complex>
+#include <vector>
+#include <cmath>
+
+namespace magnet {
+  namespace math {
+    /*! \brief Evaluates every spherical harmonic \f$Y_l^m\f$ up to a
+        maximum degree for a direction.
+
+	The harmonics are generated together using the standard
+	recurrence relations for the normalised associated Legendre
+	functions, whose coefficients are precomputed at
+	construction. Writing \f$Y_l^m=\bar{P}_l^m(z)\,(x+i\,y)^m\f$
+	for a unit vector \f$(x,y,z)\f$ removes every trigonometric
+	call. The harmonics include the Condon-Shortley phase, matching
+	boost::math::spherical_harmonic with \f$\theta\f$ measured from
+	the z axis.
+     */
+    class SphericalHarmonics
+    {
+    public:
+      SphericalHarmonics(const size_t lmax):
+	_lmax(lmax), _a(size()), _b(size()), _diag(lmax + 1)
+      {
+	for (size_t m(1); m <= _lmax; ++m)
+	  _diag[m] = -std::sqrt((2.0 * m + 1) / (2.0 * m));
+
+	for (int m(0); m <= int(_lmax); ++m)
+	  for (int l(m + 2); l <= int(_lmax); ++l)
+	    {
+	      _a[index(l, m)] = std::sqrt((4.0 * l * l - 1) / double(l * l - m * m));
+	      _b[index(l, m)] = std::sqrt(((l - 1.0) * (l - 1) - m * m) / (4.0 * (l - 1) * (l - 1) - 1));
+	    }
+      }
+
+      /*! \brief The maximum degree of the harmonics. */
+      size_t lmax() const { return _lmax; }
+
+      /*! \brief The number of harmonics evaluated, \f$(l_{max}+1)^2\f$. */
+      size_t size() const { return (_lmax + 1) * (_lmax + 1); }
+
+      /*! \brief The position of \f$Y_l^m\f$ in the evaluated
+          array. */
+      static size_t index(const int l, const int m) { return l * l + l + m; }
+
+      /*! \brief Evaluate the harmonics of the direction of
+          \f$(x,y,z)\f$, which need not be normalised.
+
+	  \param out An array of size() harmonics, indexed by index().
+       */
+      void evaluate(double x, double y, double z, std::complex<double>* out) const
+      {
+	const double norm = std::sqrt(x * x + y * y + z * z);
+	x /= norm; y /= norm; z /= norm;
+
+	const std::complex<double> xy(x, y);
+	std::complex<double> xym(1, 0);
+	double Pmm = 0.5 / std::sqrt(M_PI);
+	for (int m(0); m <= int(_lmax); ++m)
+	  {
+	    if (m)
+	      {
+		Pmm *= _diag[m];
+		xym *= xy;
+	      }
+
+	    double P2 = Pmm, P1 = std::sqrt(2.0 * m + 3) * z * Pmm;
+	    store(out, m, m, P2, xym);
+	    if (m + 1 <= int(_lmax))
+	      store(out, m + 1, m, P1, xym);
+
+	    for (int l(m + 2); l <= int(_lmax); ++l)
+	      {
+		const double P = _a[index(l, m)] * (z * P1 - _b[index(l, m)] * P2);
+		store(out, l, m, P, xym);
+		P2 = P1;
+		P1 = P;
+	      }
+	  }
+      }
+
+    protected:
+      static void store(std::complex<double>* out, const int l, const int m, const double P, const std::complex<double>& xym)
+      {
+	out[index(l, m)] = P * xym;
+	if (m)
+	  out[index(l, -m)] = ((m % 2) ? -1.0 : 1.0) * std::conj(out[index(l, m)]);
+      }
+
+      size_t _lmax;
+      std::vector<double> _a;
+      std::vector<double> _b;
+      std::vector<double> _diag;
+    };
+  }
+}
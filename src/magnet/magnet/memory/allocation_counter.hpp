@@ -0,0 +1,61 @@
+/*  dynamo:- Event driven molecular dynamics simulator 
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace magnet {
+  namespace memory {
+    /*! \brief The number of calls made to the global operator new.
+
+      The counter is only incremented if one translation unit of
+      the program defines MAGNET_DEFINE_ALLOCATION_COUNTER before
+      including this header, which replaces the global new and
+      delete operators with counting versions. This is intended for
+      tests and benchmarks which check that a code path does not
+      allocate.
+     */
+    inline std::atomic<size_t>& allocationCount()
+    {
+      static std::atomic<size_t> count(0);
+      return count;
+    }
+  }
+}
+
+#ifdef MAGNET_DEFINE_ALLOCATION_COUNTER
+//GCC warns that the replacement delete operators free memory from
+//operator new, which is what replacing them does.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpragmas"
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+void* operator new(size_t size)
+{
+  magnet::memory::allocationCount().fetch_add(1, std::memory_order_relaxed);
+  if (void* ptr = std::malloc(size ? size : 1))
+    return ptr;
+  throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) { return operator new(size); }
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { std::free(ptr); }
+#pragma GCC diagnostic pop
+#endif
@@ -0,0 +1,187 @@
+/*  dynamo:- Event driven molecular dynamics simulator 
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#pragma once
+#include <algorithm>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+namespace magnet {
+  namespace memory {
+    /*! \brief A bump allocator for short lived temporaries.
+
+      Memory is handed out by advancing a pointer through a list of
+      large chunks, so an allocation costs a few instructions and no
+      locking. Memory is reclaimed in two ways. Freeing the most
+      recent allocation rewinds the pointer, so temporaries with
+      nested (stack-like) lifetimes reuse the same memory. Calling
+      reset() reclaims everything, but only once all allocations
+      have been freed, so it is always safe to call (e.g., after
+      every event of a simulation).
+
+      The chunks are kept once allocated, so after warming up the
+      arena does not allocate from the heap.
+
+      Arenas are not thread safe, threadLocal() provides an arena
+      for each thread.
+     */
+    class Arena
+    {
+    public:
+      explicit Arena(size_t chunkSize = 64 * 1024):
+	_chunkSize(chunkSize), _current(0), _top(nullptr), _live(0)
+      {}
+
+      ~Arena()
+      {
+	for (const Chunk& chunk : _chunks)
+	  ::operator delete(chunk.begin);
+      }
+
+      /*! \brief The arena of the calling thread. */
+      static Arena& threadLocal()
+      {
+	static thread_local Arena arena;
+	return arena;
+      }
+
+      void* allocate(size_t size, size_t align = alignof(std::max_align_t))
+      {
+	++_live;
+	while (true)
+	  {
+	    if (_current < _chunks.size())
+	      {
+		char* ptr = alignUp(_top, align);
+		if (ptr + size <= _chunks[_current].end)
+		  {
+		    _top = ptr + size;
+		    return ptr;
+		  }
+
+		//Try the next chunk
+		if (++_current < _chunks.size())
+		  {
+		    _top = _chunks[_current].begin;
+		    continue;
+		  }
+	      }
+
+	    //Add a chunk large enough for this allocation
+	    const size_t chunkSize = std::max(_chunkSize, size + align);
+	    char* begin = static_cast<char*>(::operator new(chunkSize));
+	    _chunks.push_back(Chunk{begin, begin + chunkSize});
+	    _current = _chunks.size() - 1;
+	    _top = begin;
+	  }
+      }
+
+      /*! \brief Free an allocation.
+
+	If this is the most recent allocation, its memory is
+	immediately reusable.
+       */
+      void deallocate(void* ptr, size_t size)
+      {
+	--_live;
+	if (static_cast<char*>(ptr) + size == _top)
+	  _top = static_cast<char*>(ptr);
+      }
+
+      /*! \brief Reclaim all of the arena's memory, if there are no
+	outstanding allocations.
+       */
+      void reset()
+      {
+	if (_live || _chunks.empty()) return;
+	_current = 0;
+	_top = _chunks.front().begin;
+      }
+
+      /*! \brief The number of allocations which have not been freed. */
+      size_t liveAllocations() const { return _live; }
+
+      /*! \brief The total size of the arena's chunks. */
+      size_t capacity() const
+      {
+	size_t retval = 0;
+	for (const Chunk& chunk : _chunks)
+	  retval += chunk.end - chunk.begin;
+	return retval;
+      }
+
+    private:
+      Arena(const Arena&);
+      Arena& operator=(const Arena&);
+
+      static char* alignUp(char* ptr, size_t align)
+      { return reinterpret_cast<char*>((reinterpret_cast<std::uintptr_t>(ptr) + align - 1) & ~std::uintptr_t(align - 1)); }
+
+      struct Chunk
+      {
+	char* begin;
+	char* end;
+      };
+
+      std::vector<Chunk> _chunks;
+      size_t _chunkSize;
+      size_t _current;
+      char* _top;
+      size_t _live;
+    };
+
+    /*! \brief Base class for classes which are allocated in an
+      Arena.
+
+      Objects are created with new (arena) T(...), and may be
+      deleted through a pointer to any of their bases which has a
+      virtual destructor (e.g., held in a std::unique_ptr<Base>).
+      Each allocation carries a small header which records its
+      arena and size, so the class operator delete can return the
+      memory.
+     */
+    class ArenaAllocated
+    {
+    public:
+      inline static void* operator new(size_t size, Arena& arena)
+      {
+	char* ptr = static_cast<char*>(arena.allocate(size + sizeof(Header)));
+	new (ptr) Header{&arena, size + sizeof(Header)};
+	return ptr + sizeof(Header);
+      }
+
+      inline static void operator delete(void* deletable)
+      {
+	if (!deletable) return;
+	Header* header = reinterpret_cast<Header*>(static_cast<char*>(deletable) - sizeof(Header));
+	header->arena->deallocate(header, header->size);
+      }
+
+      //Called if a constructor throws
+      inline static void operator delete(void* deletable, Arena&)
+      { operator delete(deletable); }
+
+    private:
+      struct alignas(std::max_align_t) Header
+      {
+	Arena* arena;
+	size_t size;
+      };
+    };
+  }
+}
@@ -20,8 +20,22 @@
 #define MAX_SMALL_OBJECT_SIZE 64
 #endif
 
+//If non-zero, each thread caches its own free lists of small objects
+//and only takes the pool lock to move a batch of objects to or from
+//the shared pools. Otherwise every allocation takes the pool lock.
+#ifndef MAGNET_THREAD_LOCAL_POOLS
+#define MAGNET_THREAD_LOCAL_POOLS 1
+#endif
+
+//The number of objects moved between a thread's cache and the shared
+//pools at once.
+#ifndef MAGNET_POOL_BATCH_SIZE
+#define MAGNET_POOL_BATCH_SIZE 64
+#endif
+
 #include <boost/pool/pool.hpp>
 #include <mutex>
+#include <new>
 
 namespace magnet {
   /*! \brief Namespace for memory management classes.*/
@@ -34,6 +48,10 @@ namespace magnet {
         This class manages several boost memory pools. Any classes
         deriving from the \ref PoolAllocated class will use this class
         to access memory pools to allocate their memory.
+
+	When MAGNET_THREAD_LOCAL_POOLS is set, allocations are served
+	from a \ref ThreadCache, which refills from (and spills back
+	to) the shared boost pools in batches.
        */
       class PoolManager {
       public:
@@ -52,22 +70,34 @@ namespace magnet {
 	}
 	
 	/*! \brief Request some memory from a suitable pool. */
-	inline void* allocateMemory(size_t size) 
+	inline void* allocateMemory(size_t size);
+	
+	/*! \brief Release some allocated memory from a suitable
+	  pool. 
+	 */
+	inline void releaseMemory(void* deletable, size_t size);
+
+	/*! \brief Request some memory directly from the shared pools,
+	  taking the pool lock.
+	 */
+	inline void* allocateShared(size_t size) 
 	{
-	  thread::ScopedLock lock(PoolManager::getLock());
+	  std::lock_guard<std::mutex> lock(PoolManager::getLock());
 	  
 	  if (size > MAX_SMALL_OBJECT_SIZE)
 	    return ::operator new(size);
 	  
-	  return m_pools[size - 1]->malloc();
+	  void* retval = m_pools[size - 1]->malloc();
+	  if (!retval) throw std::bad_alloc();
+	  return retval;
 	}
-	
-	/*! \brief Release some allocated memory from a suitable
-	  pool. 
+
+	/*! \brief Release some memory directly to the shared pools,
+	  taking the pool lock.
 	 */
-	inline void releaseMemory(void* deletable, size_t size) 
+	inline void releaseShared(void* deletable, size_t size) 
 	{
-	  thread::ScopedLock lock(PoolManager::getLock());
+	  std::lock_guard<std::mutex> lock(PoolManager::getLock());
 	  
 	  if (size > MAX_SMALL_OBJECT_SIZE) 
 	    ::operator delete(deletable);
@@ -76,6 +106,46 @@ namespace magnet {
 	    if (deletable)
 	      m_pools[size - 1]->free(deletable);
 	}
+
+	/*! \brief Take up to count objects of a small size from the
+	  shared pool under a single lock.
+
+	  The objects are returned as a singly linked list, where the
+	  first word of each object points to the next. On return,
+	  count holds the number of objects in the list.
+	 */
+	inline void* allocateBatch(size_t size, size_t& count)
+	{
+	  std::lock_guard<std::mutex> lock(PoolManager::getLock());
+	  void* head = nullptr;
+	  for (size_t i(0); i < count; ++i)
+	    {
+	      void* ptr = m_pools[size - 1]->malloc();
+	      if (!ptr)
+		{
+		  if (!head) throw std::bad_alloc();
+		  count = i;
+		  break;
+		}
+	      *static_cast<void**>(ptr) = head;
+	      head = ptr;
+	    }
+	  return head;
+	}
+
+	/*! \brief Return a linked list of small objects (see
+	  allocateBatch()) to the shared pool under a single lock.
+	 */
+	inline void releaseBatch(size_t size, void* head)
+	{
+	  std::lock_guard<std::mutex> lock(PoolManager::getLock());
+	  while (head)
+	    {
+	      void* next = *static_cast<void**>(head);
+	      m_pools[size - 1]->free(head);
+	      head = next;
+	    }
+	}
 	
       private:
 	
@@ -96,6 +166,110 @@ namespace magnet {
 	/// memory pool array. m_pools[n] corresponds to pool with objectSize==n+1.
 	boost::pool<>* m_pools[MAX_SMALL_OBJECT_SIZE];
       };
+
+      /*! \brief A per-thread cache of free small objects.
+
+	Each size has a free list, linked through the first word of
+	the free objects (boost pool chunks are always large enough
+	to hold a pointer). An empty list is refilled with a batch of
+	MAGNET_POOL_BATCH_SIZE objects from the shared pools, and once
+	a list holds two batches, one batch is returned. Objects may
+	be freed by a different thread to the one which allocated
+	them. The cache is returned to the shared pools when its
+	thread exits.
+       */
+      class ThreadCache {
+      public:
+	/*! \brief Access the cache of the calling thread. */
+	inline static ThreadCache& get()
+	{
+	  static thread_local ThreadCache cache;
+	  return cache;
+	}
+
+	inline void* allocate(size_t size)
+	{
+	  FreeList& list = _lists[size - 1];
+	  if (!list.head)
+	    {
+	      list.count = MAGNET_POOL_BATCH_SIZE;
+	      list.head = PoolManager::getPool().allocateBatch(size, list.count);
+	    }
+	  
+	  void* retval = list.head;
+	  list.head = *static_cast<void**>(retval);
+	  --list.count;
+	  return retval;
+	}
+
+	inline void release(void* deletable, size_t size)
+	{
+	  FreeList& list = _lists[size - 1];
+	  *static_cast<void**>(deletable) = list.head;
+	  list.head = deletable;
+
+	  if (++list.count < 2 * MAGNET_POOL_BATCH_SIZE) return;
+
+	  //Keep the most recently freed batch, and return the rest
+	  void* last = list.head;
+	  for (size_t i(1); i < MAGNET_POOL_BATCH_SIZE; ++i)
+	    last = *static_cast<void**>(last);
+	  void* spill = *static_cast<void**>(last);
+	  *static_cast<void**>(last) = nullptr;
+	  list.count = MAGNET_POOL_BATCH_SIZE;
+	  PoolManager::getPool().releaseBatch(size, spill);
+	}
+
+      private:
+	//Constructing the PoolManager first ensures it outlives the
+	//cache of the main thread
+	inline ThreadCache() { PoolManager::getPool(); }
+
+	inline ~ThreadCache()
+	{
+	  for (size_t i(0); i < MAX_SMALL_OBJECT_SIZE; ++i)
+	    if (_lists[i].head)
+	      PoolManager::getPool().releaseBatch(i + 1, _lists[i].head);
+	}
+
+	ThreadCache(const ThreadCache&);
+	const ThreadCache& operator=(const ThreadCache&);
+
+	struct FreeList 
+	{
+	  FreeList(): head(nullptr), count(0) {}
+	  void* head;
+	  size_t count;
+	};
+
+	FreeList _lists[MAX_SMALL_OBJECT_SIZE];
+      };
+
+      inline void* PoolManager::allocateMemory(size_t size) 
+      {
+#if MAGNET_THREAD_LOCAL_POOLS
+	if (size > MAX_SMALL_OBJECT_SIZE)
+	  return ::operator new(size);
+
+	return ThreadCache::get().allocate(size);
+#else
+	return allocateShared(size);
+#endif
+      }
+
+      inline void PoolManager::releaseMemory(void* deletable, size_t size) 
+      {
+#if MAGNET_THREAD_LOCAL_POOLS
+	if (size > MAX_SMALL_OBJECT_SIZE) 
+	  ::operator delete(deletable);
+	else 
+	  //Don't delete null pointers
+	  if (deletable)
+	    ThreadCache::get().release(deletable, size);
+#else
+	releaseShared(deletable, size);
+#endif
+      }
     }
     
     /*! \brief Base class for derived classes which want to be
@@ -0,0 +1,179 @@
+/*  dynamo:- Event driven molecular dynamics simulator 
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*! \file chaselevdeque.hpp
+ * \brief Contains the definition of ChaseLevDeque
+ */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <cstdint>
+
+namespace magnet {
+  namespace thread {
+    /*! \brief A lock-free work-stealing deque.
+
+      This is the dynamic circular work-stealing deque of Chase and
+      Lev (SPAA 2005), using the C++11 memory orderings of Le, Pop,
+      Cohen and Zappa Nardelli (PPoPP 2013).
+
+      A single owner thread pushes and pops items at the bottom of
+      the deque, while any number of other threads may steal items
+      from the top. The storage grows as required, and the old
+      arrays are kept until the deque is destroyed as a thief may
+      still be reading them.
+
+      \tparam T The stored type, this must be trivially copyable
+      (e.g., a pointer) as it is held in std::atomic.
+     */
+    template<class T>
+    class ChaseLevDeque
+    {
+      class Array
+      {
+      public:
+	explicit Array(int64_t size): _size(size), _buffer(new std::atomic<T>[size]) {}
+
+	int64_t size() const { return _size; }
+
+	T get(int64_t i) const { return _buffer[i & (_size - 1)].load(std::memory_order_relaxed); }
+
+	void put(int64_t i, T x) { _buffer[i & (_size - 1)].store(x, std::memory_order_relaxed); }
+
+	Array* grow(int64_t bottom, int64_t top) const
+	{
+	  Array* retval = new Array(2 * _size);
+	  for (int64_t i(top); i != bottom; ++i)
+	    retval->put(i, get(i));
+	  return retval;
+	}
+
+      private:
+	const int64_t _size;
+	std::unique_ptr<std::atomic<T>[]> _buffer;
+      };
+
+    public:
+      /*! \brief Constructor.
+
+	\param capacity The initial capacity of the deque, this must
+	be a power of two.
+       */
+      explicit ChaseLevDeque(int64_t capacity = 64):
+	_top(0), _bottom(0)
+      {
+	_arrays.emplace_back(new Array(capacity));
+	_array.store(_arrays.back().get(), std::memory_order_relaxed);
+      }
+
+      /*! \brief Add an item to the bottom of the deque.
+
+	This may only be called by the owner thread.
+       */
+      void push(T x)
+      {
+	const int64_t b = _bottom.load(std::memory_order_relaxed);
+	const int64_t t = _top.load(std::memory_order_acquire);
+	Array* a = _array.load(std::memory_order_relaxed);
+	if (b - t > a->size() - 1)
+	  {
+	    _arrays.emplace_back(a->grow(b, t));
+	    a = _arrays.back().get();
+	    _array.store(a, std::memory_order_release);
+	  }
+	a->put(b, x);
+	std::atomic_thread_fence(std::memory_order_release);
+	_bottom.store(b + 1, std::memory_order_relaxed);
+      }
+
+      /*! \brief Remove the most recently pushed item.
+
+	This may only be called by the owner thread.
+
+	\return False if the deque was empty.
+       */
+      bool pop(T& x)
+      {
+	const int64_t b = _bottom.load(std::memory_order_relaxed) - 1;
+	Array* a = _array.load(std::memory_order_relaxed);
+	_bottom.store(b, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	int64_t t = _top.load(std::memory_order_relaxed);
+
+	if (t > b)
+	  {
+	    //Empty
+	    _bottom.store(b + 1, std::memory_order_relaxed);
+	    return false;
+	  }
+
+	x = a->get(b);
+	if (t == b)
+	  {
+	    //The last item, race any thieves for it
+	    const bool won = _top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+	    _bottom.store(b + 1, std::memory_order_relaxed);
+	    return won;
+	  }
+	return true;
+      }
+
+      /*! \brief Remove the oldest item in the deque.
+
+	This may be called by any thread.
+
+	\return False if the deque was empty or another thread took
+	the item first.
+       */
+      bool steal(T& x)
+      {
+	int64_t t = _top.load(std::memory_order_acquire);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	const int64_t b = _bottom.load(std::memory_order_acquire);
+
+	if (t >= b) return false;
+
+	//The original algorithm uses a consume load here
+	Array* a = _array.load(std::memory_order_acquire);
+	x = a->get(t);
+	return _top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+      }
+
+      /*! \brief An estimate of the number of items in the deque. */
+      size_t size() const
+      {
+	const int64_t b = _bottom.load(std::memory_order_relaxed);
+	const int64_t t = _top.load(std::memory_order_relaxed);
+	return (b > t) ? b - t : 0;
+      }
+
+      bool empty() const { return !size(); }
+
+    private:
+      ChaseLevDeque(const ChaseLevDeque&);
+      ChaseLevDeque& operator=(const ChaseLevDeque&);
+
+      std::atomic<int64_t> _top;
+      std::atomic<int64_t> _bottom;
+      std::atomic<Array*> _array;
+      //! \brief Every array allocated, only accessed by the owner.
+      std::vector<std::unique_ptr<Array> > _arrays;
+    };
+  }
+}
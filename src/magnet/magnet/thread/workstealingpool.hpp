@@ -0,0 +1,450 @@
+/*  dynamo:- Event driven molecular dynamics simulator 
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*! \file workstealingpool.hpp
+ * \brief Contains the definition of WorkStealingPool
+ */
+
+#pragma once
+
+#include <magnet/thread/threadgroup.hpp>
+#include <magnet/thread/chaselevdeque.hpp>
+#include <magnet/exception.hpp>
+#include <sstream>
+#include <functional>
+#include <future>
+#include <deque>
+#include <random>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <type_traits>
+#include <thread>
+
+namespace magnet {
+  namespace thread {
+    /*! \brief A pool of worker threads which balance their load by
+      stealing tasks from each other.
+
+      This has the same interface as ThreadPool, but each worker
+      thread has its own ChaseLevDeque of tasks. Tasks queued from a
+      worker (e.g., a task which queues follow-on tasks) are pushed to
+      that worker's deque without any locking, and idle workers steal
+      the oldest tasks of the other workers. Tasks queued from any
+      other thread are placed in a shared injection queue.
+
+      Idle workers park on a condition variable and queueing a task
+      only wakes a single parked worker, rather than every thread in
+      the pool.
+
+      Tasks queued with queueTask() report their exceptions when
+      wait() is called, as in ThreadPool. The submit() function and
+      the TaskGroup class instead pass exceptions back to the caller.
+
+      This class will also run in 0 thread mode, where the controlling
+      process will execute the tasks when it enters the
+      WorkStealingPool::wait() function.
+     */
+    class WorkStealingPool
+    {
+      typedef std::function<void()> Task;
+
+    public:
+      /*! \brief A set of tasks which can be waited on together.
+
+	Exceptions thrown by the tasks are captured and the first is
+	rethrown by wait(). If wait() is called from a worker of the
+	pool, the worker runs other tasks while it waits, so task
+	groups may be nested.
+       */
+      class TaskGroup
+      {
+      public:
+	explicit TaskGroup(WorkStealingPool& pool): _pool(pool), _outstanding(0) {}
+
+	~TaskGroup() { try { wait(); } catch (...) {} }
+
+	/*! \brief Queue a task as part of this group. */
+	void run(Task func)
+	{
+	  ++_outstanding;
+	  _pool.queueTask([this, func]() {
+	      try { func(); }
+	      catch (...)
+		{
+		  std::lock_guard<std::mutex> lock(_mutex);
+		  if (!_exception) _exception = std::current_exception();
+		}
+
+	      std::lock_guard<std::mutex> lock(_mutex);
+	      if (!--_outstanding)
+		_finished.notify_all();
+	    });
+	}
+
+	/*! \brief Wait for every task of the group to finish, and
+	  rethrow the first exception thrown by the tasks.
+	 */
+	void wait()
+	{
+	  if (!_pool.getThreadCount() || _pool.isWorkerThread())
+	    while (_outstanding)
+	      if (!_pool.runPendingTask())
+		std::this_thread::yield();
+
+	  std::unique_lock<std::mutex> lock(_mutex);
+	  while (_outstanding)
+	    _finished.wait(lock);
+
+	  if (_exception)
+	    {
+	      std::exception_ptr e = _exception;
+	      _exception = std::exception_ptr();
+	      std::rethrow_exception(e);
+	    }
+	}
+
+      private:
+	TaskGroup(const TaskGroup&);
+	TaskGroup& operator=(const TaskGroup&);
+
+	WorkStealingPool& _pool;
+	std::atomic<size_t> _outstanding;
+	std::mutex _mutex;
+	std::condition_variable _finished;
+	std::exception_ptr _exception;
+      };
+
+      /*! \brief Default Constructor
+
+	This initialises the pool to 0 threads
+       */
+      WorkStealingPool():
+	_pending(0),
+	_injected(0),
+	_epoch(0),
+	_sleepers(0),
+	_stop_flag(false),
+	_exception_flag(false)
+      {}
+
+      /*! \brief Destructor
+
+	Join all threads in the pool and wait until they are
+	terminated. Tasks which have not started are discarded.
+       */
+      ~WorkStealingPool() throw()
+      {
+	stop();
+	Task* task;
+	while (popInjected(task))
+	  delete task;
+      }
+
+      /*! \brief Set the number of threads in the pool.
+
+	When changing the number of threads, the existing threads are
+	stopped (after finishing their current tasks) and any queued
+	tasks are kept for the new threads.
+       */
+      void setThreadCount(size_t x)
+      {
+	if (x == _threads.size()) return;
+
+	stop();
+
+	//Move any waiting tasks back to the injection queue
+	{
+	  std::lock_guard<std::mutex> lock(_injection_mutex);
+	  for (auto& deque : _deques)
+	    {
+	      Task* task;
+	      while (deque->steal(task))
+		{
+		  _injection.push_back(task);
+		  ++_injected;
+		}
+	    }
+	}
+
+	_deques.clear();
+	_stop_flag = false;
+	for (size_t i(0); i < x; ++i)
+	  _deques.emplace_back(new ChaseLevDeque<Task*>());
+
+	for (size_t i(0); i < x; ++i)
+	  _threads.create_thread(std::function<void()>(std::bind(&WorkStealingPool::beginThread, this, i)));
+      }
+
+      /*! \brief The current number of threads in the pool */
+      size_t getThreadCount() const { return _threads.size(); }
+
+      /*! \brief Queue a task to be run by the pool. */
+      void queueTask(Task func)
+      {
+	++_pending;
+	push(new Task(std::move(func)));
+	wakeWorkers(1);
+      }
+
+      /*! \brief Queue several tasks to be run by the pool.
+
+	As in ThreadPool::queueTasks, the passed vector is cleared.
+       */
+      void queueTasks(std::vector<Task>& funcs)
+      {
+	_pending += funcs.size();
+	if (isWorkerThread())
+	  for (auto& func : funcs)
+	    push(new Task(std::move(func)));
+	else
+	  {
+	    std::lock_guard<std::mutex> lock(_injection_mutex);
+	    for (auto& func : funcs)
+	      _injection.push_back(new Task(std::move(func)));
+	    _injected += funcs.size();
+	  }
+	wakeWorkers(funcs.size());
+	funcs.clear();
+      }
+
+      /*! \brief Queue a task and return a future for its result.
+
+	Any exception thrown by the task is passed to the future.
+	Calling std::future::get() inside a task blocks the worker
+	thread, use a TaskGroup to wait inside tasks. In 0 thread
+	mode the task is only run once wait() is called.
+       */
+      template<class F>
+      std::future<typename std::result_of<F()>::type> submit(F func)
+      {
+	typedef typename std::result_of<F()>::type R;
+	std::shared_ptr<std::packaged_task<R()> > task(new std::packaged_task<R()>(std::move(func)));
+	std::future<R> retval = task->get_future();
+	queueTask([task]() { (*task)(); });
+	return retval;
+      }
+
+      /*! \brief Wait for all tasks to complete.
+
+	If there are no threads in the pool then this function will
+	actually make the waiting/mother process perform the tasks.
+       */
+      void wait()
+      {
+	if (_threads.size())
+	  {
+	    std::unique_lock<std::mutex> lock(_done_mutex);
+	    while (_pending)
+	      _done_condition.wait(lock);
+	  }
+	else
+	  while (runPendingTask()) {}
+
+	if (_exception_flag)
+	  {
+	    std::lock_guard<std::mutex> lock(_exception_mutex);
+	    _exception_flag = false;
+	    const std::string data = _exception_data.str();
+	    _exception_data.str("");
+	    M_throw() << "Thread Exception found while waiting for tasks/threads to finish"
+		      << data;
+	  }
+      }
+
+      /*! \brief Run a single queued task on the calling thread.
+
+	\return False if no task could be found.
+       */
+      bool runPendingTask()
+      {
+	Task* task = findTask();
+	if (!task) return false;
+	execute(task);
+	return true;
+      }
+
+      /*! \brief Test if the calling thread is a worker of this pool. */
+      bool isWorkerThread() const { return currentWorker().pool == this; }
+
+    private:
+      WorkStealingPool(const WorkStealingPool&);
+      WorkStealingPool& operator=(const WorkStealingPool&);
+
+      struct WorkerInfo
+      {
+	const WorkStealingPool* pool;
+	size_t id;
+      };
+
+      static WorkerInfo& currentWorker()
+      {
+	static thread_local WorkerInfo info = {nullptr, 0};
+	return info;
+      }
+
+      void push(Task* task)
+      {
+	if (isWorkerThread())
+	  _deques[currentWorker().id]->push(task);
+	else
+	  {
+	    std::lock_guard<std::mutex> lock(_injection_mutex);
+	    _injection.push_back(task);
+	    ++_injected;
+	  }
+      }
+
+      bool popInjected(Task*& task)
+      {
+	if (!_injected) return false;
+	std::lock_guard<std::mutex> lock(_injection_mutex);
+	if (_injection.empty()) return false;
+	task = _injection.front();
+	_injection.pop_front();
+	--_injected;
+	return true;
+      }
+
+      /*! \brief Find a task: first from the worker's own deque, then
+	the injection queue and finally by stealing from a random
+	worker.
+       */
+      Task* findTask()
+      {
+	Task* task = nullptr;
+	const bool worker = isWorkerThread();
+	if (worker && _deques[currentWorker().id]->pop(task))
+	  return task;
+
+	if (popInjected(task))
+	  return task;
+
+	const size_t N = _deques.size();
+	if (!N) return nullptr;
+
+	static thread_local std::minstd_rand RNG(std::random_device{}());
+	const size_t start = RNG() % N;
+	//A steal may fail due to contention, so each deque is tried
+	//while it still holds tasks
+	for (size_t i(0); i < N; ++i)
+	  {
+	    ChaseLevDeque<Task*>& victim = *_deques[(start + i) % N];
+	    if (worker && (&victim == _deques[currentWorker().id].get()))
+	      continue;
+	    while (!victim.empty())
+	      if (victim.steal(task))
+		return task;
+	  }
+
+	return nullptr;
+      }
+
+      void execute(Task* task)
+      {
+	std::unique_ptr<Task> owner(task);
+	try { (*task)(); }
+	catch (std::exception& cep)
+	  {
+	    std::lock_guard<std::mutex> lock(_exception_mutex);
+	    _exception_data << "\nTHREAD: Task threw an exception:-" << cep.what();
+	    _exception_flag = true;
+	  }
+
+	if (!--_pending)
+	  {
+	    std::lock_guard<std::mutex> lock(_done_mutex);
+	    _done_condition.notify_all();
+	  }
+      }
+
+      /*! \brief Wake up to count parked workers. */
+      void wakeWorkers(size_t count)
+      {
+	++_epoch;
+	if (!_sleepers) return;
+
+	std::lock_guard<std::mutex> lock(_park_mutex);
+	if (count >= _sleepers)
+	  _park_condition.notify_all();
+	else
+	  for (size_t i(0); i < count; ++i)
+	    _park_condition.notify_one();
+      }
+
+      /*! \brief Thread worker loop. */
+      void beginThread(const size_t id)
+      {
+	currentWorker().pool = this;
+	currentWorker().id = id;
+
+	while (true)
+	  {
+	    //The epoch is read before looking for work, so any task
+	    //queued after the search fails will prevent parking.
+	    const size_t epoch = _epoch;
+	    if (runPendingTask())
+	      continue;
+
+	    std::unique_lock<std::mutex> lock(_park_mutex);
+	    if (_stop_flag) break;
+	    ++_sleepers;
+	    while ((epoch == _epoch) && !_stop_flag)
+	      _park_condition.wait(lock);
+	    --_sleepers;
+	  }
+
+	currentWorker().pool = nullptr;
+      }
+
+      /*! \brief Halt the pool and terminate all the threads. */
+      void stop()
+      {
+	{
+	  std::lock_guard<std::mutex> lock(_park_mutex);
+	  _stop_flag = true;
+	}
+	_park_condition.notify_all();
+	_threads.join_all();
+      }
+
+      ThreadGroup _threads;
+      std::vector<std::unique_ptr<ChaseLevDeque<Task*> > > _deques;
+
+      std::deque<Task*> _injection;
+      std::mutex _injection_mutex;
+
+      //! \brief The number of tasks queued but not yet finished.
+      std::atomic<size_t> _pending;
+      //! \brief The number of tasks in the injection queue.
+      std::atomic<size_t> _injected;
+      //! \brief Incremented every time a task is queued.
+      std::atomic<size_t> _epoch;
+      //! \brief The number of parked worker threads.
+      std::atomic<size_t> _sleepers;
+      bool _stop_flag;
+      std::mutex _park_mutex;
+      std::condition_variable _park_condition;
+
+      std::mutex _done_mutex;
+      std::condition_variable _done_condition;
+
+      std::atomic<bool> _exception_flag;
+      std::ostringstream _exception_data;
+      std::mutex _exception_mutex;
+    };
+  }
+}
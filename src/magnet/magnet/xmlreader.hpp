@@ -116,6 +116,19 @@ namespace magnet {
 
       inline std::string getName() const { return std::string(_attr->name(), _attr->name() + _attr->name_size()); }
 
+      /*! \brief Returns the next Attribute of the parent Node.
+
+        The returned Attribute is invalid if this is the last
+        Attribute.
+       */
+      inline Attribute getNextAttribute() const
+      {
+	if (!valid()) 
+	  M_throw() << (std::string("XML error: Cannot increment invalid attribute\nXML Path: ")
+			+ detail::getPath(_parent) + "/INVALID");
+	return Attribute(_attr->next_attribute(), _parent);
+      }
+
     private:
       friend class Node;
 
@@ -275,6 +288,51 @@ namespace magnet {
 
       inline std::string getName() const { return std::string(_node->name(), _node->name() + _node->name_size()); }
 
+      /*! \brief Fetches the first Attribute of the Node, whatever
+        its name.
+
+	Test if the Attribute is Attribute::valid() before using it.
+       */
+      inline Attribute getFirstAttribute() const
+      {
+	if (!valid()) 
+	  M_throw() << (std::string("XML error: Cannot fetch attribute of invalid node\nXML Path: ")
+			+ detail::getPath(_parent) + "/INVALID");
+	return Attribute(_node->first_attribute(), _node);
+      }
+
+      /*! \brief Fetches the first child element Node, whatever its
+        name.
+
+	Test if the Node is Node::valid() before using it.
+       */
+      inline Node getFirstChild() const
+      {
+	if (!valid()) 
+	  M_throw() << (std::string("XML error: Cannot fetch sub node of invalid node\nXML Path: ")
+			+ detail::getPath(_parent) + "/INVALID");
+	rapidxml::xml_node<>* child = _node->first_node();
+	while (child && (child->type() != rapidxml::node_element))
+	  child = child->next_sibling();
+	return Node(child, _node);
+      }
+
+      /*! \brief Fetches the next sibling element Node, whatever its
+        name (see \ref operator++ for siblings with the same name).
+
+	Test if the Node is Node::valid() before using it.
+       */
+      inline Node getNextSibling() const
+      {
+	if (!valid()) 
+	  M_throw() << (std::string("XML error: Cannot increment invalid node\nXML Path: ")
+			+ detail::getPath(_parent) + "/INVALID");
+	rapidxml::xml_node<>* sibling = _node->next_sibling();
+	while (sibling && (sibling->type() != rapidxml::node_element))
+	  sibling = sibling->next_sibling();
+	return Node(sibling, _parent);
+      }
+
    private:
       rapidxml::xml_node<> *_node;
       rapidxml::xml_node<> *_parent;
@@ -0,0 +1,170 @@
+/*  dynamo:- Event driven molecular dynamics simulator
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#define BOOST_TEST_MODULE Blocking_test
+#include <boost/test/included/unit_test.hpp>
+#include <magnet/math/blocking.hpp>
+#include <magnet/math/correlators.hpp>
+#include <random>
+
+using namespace magnet::math;
+
+//Generates an AR(1) series, x_i = phi x_{i-1} + e_i, with unit
+//variance noise e_i. The standard error of the mean of n samples is
+//1 / ((1 - phi) sqrt(n)) for large n.
+struct AR1
+{
+  AR1(double phi_): phi(phi_), x(0), RNG(1), normal(0, 1) {}
+
+  double operator()() { return x = phi * x + normal(RNG); }
+
+  double phi;
+  double x;
+  std::mt19937 RNG;
+  std::normal_distribution<double> normal;
+};
+
+BOOST_AUTO_TEST_CASE( Uncorrelated_Series )
+{
+  AR1 series(0);
+  BlockingAverage avg;
+  const size_t n = 1 << 16;
+  for (size_t i(0); i < n; ++i)
+    avg.push(series());
+
+  BOOST_CHECK_EQUAL(avg.count(), n);
+  BOOST_CHECK_EQUAL(avg.levels(), 17u);
+  BOOST_CHECK(std::abs(avg.mean()) < 4 / std::sqrt(double(n)));
+
+  const BlockingAverage::Estimate estimate = avg.errorEstimate();
+  BOOST_CHECK(estimate.converged);
+  BOOST_CHECK_CLOSE(estimate.error, 1 / std::sqrt(double(n)), 10);
+}
+
+BOOST_AUTO_TEST_CASE( Correlated_Series )
+{
+  const double phi = 0.9;
+  AR1 series(phi);
+  BlockingAverage avg;
+  const size_t n = 1 << 20;
+  for (size_t i(0); i < n; ++i)
+    avg.push(series());
+
+  const double exact = 1 / ((1 - phi) * std::sqrt(double(n)));
+
+  //The naive error underestimates the true error by a factor of
+  //sqrt((1 - phi) / (1 + phi))
+  BOOST_CHECK_CLOSE(avg.error(0), exact * std::sqrt((1 - phi) / (1 + phi)), 10);
+
+  const BlockingAverage::Estimate estimate = avg.errorEstimate();
+  BOOST_CHECK(estimate.converged);
+  BOOST_CHECK(estimate.level > 2);
+  BOOST_CHECK_CLOSE(estimate.error, exact, 15);
+  BOOST_CHECK(std::abs(avg.mean()) < 4 * exact);
+}
+
+BOOST_AUTO_TEST_CASE( Short_Series )
+{
+  //Too few samples to find a plateau, but the largest error of the
+  //usable levels is still returned
+  AR1 series(0.99);
+  BlockingAverage avg;
+  for (size_t i(0); i < 64; ++i)
+    avg.push(series());
+
+  const BlockingAverage::Estimate estimate = avg.errorEstimate();
+  BOOST_CHECK(!estimate.converged);
+  BOOST_CHECK(estimate.error >= avg.error(0));
+  BOOST_CHECK(estimate.error < std::numeric_limits<double>::infinity());
+}
+
+BOOST_AUTO_TEST_CASE( Einstein_Plateau )
+{
+  //A flux which is an AR(1) series held constant over unit time
+  //intervals. Its Green-Kubo integral is 1 / (2 (1 - phi)^2).
+  const double phi = 0.8;
+  const double exact = 1 / (2 * (1 - phi) * (1 - phi));
+  AR1 series(phi);
+
+  EinsteinTransportEstimator<double> streamed, impulsive;
+  const auto product = [](const double& a, const double& b) { return a * b; };
+  streamed.resize(1.0, product);
+  impulsive.resize(1.0, product);
+
+  const size_t n = 1 << 20;
+  for (size_t i(0); i < n; ++i)
+    {
+      const double J = series();
+      //The same integral, either streamed in two steps or added as
+      //an impulse
+      streamed.setFreeStreamValue(J);
+      streamed.freeStream(0.25);
+      streamed.freeStream(0.75);
+      impulsive.addImpulse(J);
+      impulsive.freeStream(1.0);
+    }
+
+  //The shortest window only sees the variance of the flux
+  const EinsteinTransportEstimator<double>::Estimate first = streamed.getLevelEstimate(0);
+  BOOST_CHECK_CLOSE(first.value, 0.5 / (1 - phi * phi), 5);
+  BOOST_CHECK_EQUAL(first.windows, n);
+
+  const EinsteinTransportEstimator<double>::Estimate estimate = streamed.getEstimate();
+  BOOST_CHECK(estimate.plateau);
+  BOOST_CHECK(estimate.time > 1 / (1 - phi));
+  BOOST_CHECK(estimate.error > 0);
+  BOOST_CHECK(estimate.error < 0.05 * exact);
+  BOOST_CHECK(std::abs(estimate.value - exact) < 3 * estimate.error + 0.05 * exact);
+
+  const EinsteinTransportEstimator<double>::Estimate other = impulsive.getEstimate();
+  BOOST_CHECK_CLOSE(other.value, estimate.value, 1e-6);
+  BOOST_CHECK_EQUAL(other.time, estimate.time);
+}
+
+BOOST_AUTO_TEST_CASE( Einstein_Remove_Average )
+{
+  //A flux with a large mean, which must be removed using the mean of
+  //the whole series, not the mean when each window was collected
+  AR1 series(0.5);
+  EinsteinTransportEstimator<double> estimator;
+  estimator.resize(1.0, [](const double& a, const double& b) { return a * b; }, true);
+
+  const size_t n = 4096;
+  std::vector<double> fluxes;
+  for (size_t i(0); i < n; ++i)
+    {
+      fluxes.push_back(5 + series());
+      estimator.setFreeStreamValue(fluxes.back());
+      estimator.freeStream(1.0);
+    }
+
+  double mean(0);
+  for (const double J : fluxes)
+    mean += J / n;
+
+  double level0(0), level1(0);
+  for (size_t i(0); i < n; ++i)
+    level0 += (fluxes[i] - mean) * (fluxes[i] - mean) / (2 * n);
+  for (size_t i(0); i < n; i += 2)
+    {
+      const double delta = fluxes[i] + fluxes[i + 1] - 2 * mean;
+      level1 += delta * delta / (4 * (n / 2));
+    }
+
+  BOOST_CHECK_CLOSE(estimator.getLevelEstimate(0).value, level0, 1e-8);
+  BOOST_CHECK_CLOSE(estimator.getLevelEstimate(1).value, level1, 1e-8);
+}
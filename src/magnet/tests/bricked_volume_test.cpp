@@ -0,0 +1,77 @@
+#define BOOST_TEST_MODULE BrickedVolume_test
+#include <boost/test/included/unit_test.hpp>
+#include <magnet/containers/bricked_volume.hpp>
+#include <magnet/containers/ordering.hpp>
+#include <magnet/timer.hpp>
+#include <random>
+#include <cmath>
+#include <algorithm>
+
+using namespace magnet::containers;
+
+//A synthetic porous medium: solid spheres in an empty box, with a
+//noisy band around each sphere surface.
+std::vector<unsigned char> makeVolume(const std::array<size_t, 3>& dims)
+{
+  std::mt19937 RNG(42);
+  std::uniform_real_distribution<double> pos(0, 1);
+  std::vector<std::array<double, 4> > spheres;
+  for (size_t i(0); i < 20; ++i)
+    spheres.push_back(std::array<double, 4>{{pos(RNG) * dims[0], pos(RNG) * dims[1], pos(RNG) * dims[2], 0.1 * dims[0] * (0.5 + pos(RNG))}});
+
+  RowMajorOrdering<3> ordering(dims);
+  std::vector<unsigned char> data(ordering.size(), 0);
+  std::array<size_t, 3> c;
+  for (c[2] = 0; c[2] < dims[2]; ++c[2])
+    for (c[1] = 0; c[1] < dims[1]; ++c[1])
+      for (c[0] = 0; c[0] < dims[0]; ++c[0])
+	for (const auto& s : spheres)
+	  {
+	    const double r = std::sqrt((c[0] - s[0]) * (c[0] - s[0]) + (c[1] - s[1]) * (c[1] - s[1]) + (c[2] - s[2]) * (c[2] - s[2]));
+	    if (r < s[3]) data[ordering.toIndex(c)] = 255;
+	    else if (r < s[3] + 2) data[ordering.toIndex(c)] = std::max<unsigned char>(data[ordering.toIndex(c)], RNG() % 255);
+	  }
+  return data;
+}
+
+BOOST_AUTO_TEST_CASE( BrickedVolume_matches_dense )
+{
+  //Deliberately not a multiple of the brick size
+  const std::array<size_t, 3> dims{{67, 45, 53}};
+  RowMajorOrdering<3> ordering(dims);
+  const std::vector<unsigned char> data = makeVolume(dims);
+
+  BrickedVolume<unsigned char> volume;
+  volume.build(dims, [&](const std::array<size_t, 3>& coord) { return data[ordering.toIndex(coord)]; });
+
+  BOOST_CHECK(volume.getDimensions() == dims);
+  BOOST_CHECK_EQUAL(volume.size(), data.size());
+  BOOST_CHECK(volume.uniformBricks() > 0);
+  BOOST_CHECK(volume.uniformBricks() < volume.bricks());
+
+  std::array<size_t, 3> c;
+  size_t mismatches = 0;
+  for (c[2] = 0; c[2] < dims[2]; ++c[2])
+    for (c[1] = 0; c[1] < dims[1]; ++c[1])
+      for (c[0] = 0; c[0] < dims[0]; ++c[0])
+	mismatches += (volume(c) != data[ordering.toIndex(c)]);
+  BOOST_CHECK_EQUAL(mismatches, 0);
+
+  BOOST_CHECK(volume.dense() == data);
+}
+
+BOOST_AUTO_TEST_CASE( BrickedVolume_memory )
+{
+  const std::array<size_t, 3> dims{{256, 256, 256}};
+  RowMajorOrdering<3> ordering(dims);
+  const std::vector<unsigned char> data = makeVolume(dims);
+
+  magnet::Timer timer;
+  BrickedVolume<unsigned char> volume;
+  volume.build(dims, [&](const std::array<size_t, 3>& coord) { return data[ordering.toIndex(coord)]; });
+  const double buildTime = timer.duration<std::milli>();
+
+  BOOST_TEST_MESSAGE("256^3 volume: dense " << data.size() << " bytes, bricked " << volume.memoryUsage() << " bytes ("
+		     << volume.uniformBricks() << " of " << volume.bricks() << " bricks uniform), built in " << buildTime << "ms");
+  BOOST_CHECK(volume.memoryUsage() < data.size());
+}
@@ -0,0 +1,73 @@
+#define BOOST_TEST_MODULE FFT_test
+#include <boost/test/included/unit_test.hpp>
+#include <magnet/math/fft.hpp>
+#include <random>
+
+typedef std::complex<double> Complex;
+
+std::vector<Complex> randomData(const size_t n)
+{
+  std::mt19937 RNG(1);
+  std::uniform_real_distribution<double> uniform(-1, 1);
+  std::vector<Complex> data(n);
+  for (Complex& val : data)
+    val = Complex(uniform(RNG), uniform(RNG));
+  return data;
+}
+
+BOOST_AUTO_TEST_CASE( FFT_1D_matches_DFT )
+{
+  for (const size_t n : {1, 2, 8, 64, 256})
+    {
+      const std::vector<Complex> input = randomData(n);
+      std::vector<Complex> data = input;
+      magnet::math::fft(data.data(), n);
+
+      for (size_t k(0); k < n; ++k)
+	{
+	  Complex dft(0);
+	  for (size_t j(0); j < n; ++j)
+	    dft += input[j] * std::polar(1.0, -2 * M_PI * double(j * k) / n);
+	  BOOST_CHECK_SMALL(std::abs(data[k] - dft), 1e-10);
+	}
+
+      //The inverse transform recovers the data
+      magnet::math::fft(data.data(), n, 1, true);
+      for (size_t j(0); j < n; ++j)
+	BOOST_CHECK_SMALL(std::abs(data[j] / double(n) - input[j]), 1e-12);
+    }
+}
+
+BOOST_AUTO_TEST_CASE( FFT_3D_matches_DFT )
+{
+  const std::array<size_t, 3> dims{{8, 4, 16}};
+  const std::vector<Complex> input = randomData(dims[0] * dims[1] * dims[2]);
+
+  magnet::thread::WorkStealingPool pool;
+  pool.setThreadCount(2);
+
+  for (const size_t chunks : {1, 3})
+    {
+      std::vector<Complex> data = input;
+      magnet::math::fft3D(data, dims, false, &pool, chunks);
+
+      for (size_t kx(0); kx < dims[0]; ++kx)
+	for (size_t ky(0); ky < dims[1]; ++ky)
+	  for (size_t kz(0); kz < dims[2]; ++kz)
+	    {
+	      Complex dft(0);
+	      for (size_t x(0); x < dims[0]; ++x)
+		for (size_t y(0); y < dims[1]; ++y)
+		  for (size_t z(0); z < dims[2]; ++z)
+		    dft += input[x + dims[0] * (y + dims[1] * z)]
+		      * std::polar(1.0, -2 * M_PI * (double(x * kx) / dims[0] + double(y * ky) / dims[1] + double(z * kz) / dims[2]));
+	      BOOST_CHECK_SMALL(std::abs(data[kx + dims[0] * (ky + dims[1] * kz)] - dft), 1e-10);
+	    }
+    }
+}
+
+BOOST_AUTO_TEST_CASE( FFT_rejects_bad_lengths )
+{
+  std::vector<Complex> data(12);
+  BOOST_CHECK_THROW(magnet::math::fft(data.data(), data.size()), std::exception);
+}
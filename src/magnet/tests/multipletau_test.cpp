@@ -0,0 +1,114 @@
+/*  dynamo:- Event driven molecular dynamics simulator 
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#define BOOST_TEST_MODULE MultipleTau_test
+#include <boost/test/included/unit_test.hpp>
+#include <magnet/math/correlators.hpp>
+#include <random>
+
+using namespace magnet::math;
+
+//Accumulates the squared displacement of each channel
+struct SquaredDisplacement
+{
+  std::vector<double> sum;
+  void operator()(size_t lag, size_t, const double& origin, const double& current)
+  {
+    sum.resize(std::max(sum.size(), lag + 1), 0);
+    sum[lag] += (current - origin) * (current - origin);
+  }
+};
+
+void checkBruteForce(const size_t channels, const size_t samples, const size_t length, const size_t scaling)
+{
+  std::mt19937 RNG(1);
+  std::normal_distribution<double> normal(0, 1);
+
+  //Random walks in each channel
+  std::vector<std::vector<double> > walks(samples, std::vector<double>(channels, 0));
+  for (size_t t(1); t < samples; ++t)
+    for (size_t c(0); c < channels; ++c)
+      walks[t][c] = walks[t-1][c] + normal(RNG);
+
+  MultipleTauCorrelator<double> correlator;
+  correlator.resize(channels, length, scaling);
+  SquaredDisplacement msd;
+  for (size_t t(0); t < samples; ++t)
+    {
+      correlator.push([&](size_t c){ return walks[t][c]; });
+      correlator.correlate(msd);
+    }
+
+  BOOST_REQUIRE(correlator.getLagCount() > 0);
+  BOOST_REQUIRE(msd.sum.size() <= correlator.getLagCount());
+  BOOST_CHECK_EQUAL(correlator.getLag(0), 0u);
+
+  const size_t firstLag = (length + scaling - 1) / scaling;
+  for (size_t i(0); i < correlator.getLagCount(); ++i)
+    {
+      const size_t lag = correlator.getLag(i);
+      if (i)
+	BOOST_CHECK(lag > correlator.getLag(i - 1));
+
+      //Each lag is only sampled from origins on its level's interval
+      size_t interval = 1;
+      if (i >= length)
+	for (size_t l(0); l < 1 + (i - length) / (length - firstLag); ++l)
+	  interval *= scaling;
+      BOOST_CHECK_EQUAL(lag % interval, 0u);
+      
+      double sum = 0;
+      size_t count = 0;
+      for (size_t t0(0); t0 + lag < samples; t0 += interval, ++count)
+	for (size_t c(0); c < channels; ++c)
+	  sum += (walks[t0 + lag][c] - walks[t0][c]) * (walks[t0 + lag][c] - walks[t0][c]);
+
+      BOOST_CHECK_EQUAL(correlator.getSampleCount(i), count);
+      if (i < msd.sum.size())
+	BOOST_CHECK_CLOSE(msd.sum[i], sum, 1e-8);
+    }
+
+  //All lags up to the length of the run are resolved
+  BOOST_CHECK(correlator.getLag(correlator.getLagCount() - 1) <= samples - 1);
+  BOOST_CHECK(correlator.getLag(correlator.getLagCount() - 1) * scaling > samples - 1);
+}
+
+BOOST_AUTO_TEST_CASE( Matches_BruteForce )
+{
+  checkBruteForce(3, 1000, 8, 2);
+  checkBruteForce(2, 777, 16, 2);
+  checkBruteForce(1, 2000, 5, 3);
+  checkBruteForce(4, 10, 16, 2);
+}
+
+BOOST_AUTO_TEST_CASE( Bounded_Memory )
+{
+  //A million samples fit in a few tens of levels
+  MultipleTauCorrelator<double> correlator;
+  correlator.resize(1, 16, 2);
+  size_t calls = 0;
+  auto count = [&](size_t, size_t, const double&, const double&) { ++calls; };
+  for (size_t t(0); t < 1000000; ++t)
+    {
+      correlator.push([&](size_t){ return double(t); });
+      correlator.correlate(count);
+    }
+  BOOST_CHECK(correlator.getLagCount() < 16 + 8 * 20);
+  BOOST_CHECK(correlator.getLag(correlator.getLagCount() - 1) <= 999999);
+  //Roughly length * scaling / (scaling - 1) correlations per sample
+  BOOST_CHECK(calls < 1000000 * 2 * 16);
+}
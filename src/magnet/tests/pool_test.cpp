@@ -0,0 +1,123 @@
+#define BOOST_TEST_MODULE Pool_test
+#include <boost/test/included/unit_test.hpp>
+#include <magnet/memory/pool.hpp>
+#include <magnet/timer.hpp>
+#include <thread>
+#include <vector>
+#include <cstring>
+
+using namespace magnet::memory;
+
+struct Small: public PoolAllocated { char data[8]; };
+struct Medium: public PoolAllocated { char data[24]; };
+struct Large: public PoolAllocated { char data[48]; };
+
+template<class T>
+bool filledWith(const T& obj, char val)
+{
+  for (const char c : obj.data)
+    if (c != val) return false;
+  return true;
+}
+
+BOOST_AUTO_TEST_CASE( Pool_threaded_allocation )
+{
+  const size_t nThreads = 4;
+  const size_t nObjects = 20000;
+  std::vector<std::vector<PoolAllocated*> > handoff(nThreads);
+  std::vector<size_t> errors(nThreads, 0);
+
+  //Each thread allocates and fills objects of several sizes, frees
+  //half of them, and hands the rest to the next thread to free.
+  std::vector<std::thread> threads;
+  for (size_t t(0); t < nThreads; ++t)
+    threads.push_back(std::thread([&, t]() {
+	  const char val = 'a' + t;
+	  std::vector<Small*> smalls;
+	  std::vector<Medium*> mediums;
+	  std::vector<Large*> larges;
+	  for (size_t i(0); i < nObjects; ++i)
+	    {
+	      smalls.push_back(new Small); std::memset(smalls.back()->data, val, sizeof(Small::data));
+	      mediums.push_back(new Medium); std::memset(mediums.back()->data, val, sizeof(Medium::data));
+	      larges.push_back(new Large); std::memset(larges.back()->data, val, sizeof(Large::data));
+	    }
+
+	  for (size_t i(0); i < nObjects; ++i)
+	    errors[t] += !filledWith(*smalls[i], val) + !filledWith(*mediums[i], val) + !filledWith(*larges[i], val);
+
+	  for (size_t i(0); i < nObjects; ++i)
+	    if (i % 2)
+	      { delete smalls[i]; delete mediums[i]; delete larges[i]; }
+	    else
+	      {
+		handoff[t].push_back(smalls[i]);
+		handoff[t].push_back(mediums[i]);
+		handoff[t].push_back(larges[i]);
+	      }
+	}));
+  
+  for (std::thread& thread : threads)
+    thread.join();
+  threads.clear();
+
+  for (size_t t(0); t < nThreads; ++t)
+    threads.push_back(std::thread([&, t]() {
+	  for (PoolAllocated* obj : handoff[(t + 1) % nThreads])
+	    delete obj;
+	}));
+
+  for (std::thread& thread : threads)
+    thread.join();
+
+  for (size_t t(0); t < nThreads; ++t)
+    BOOST_CHECK_EQUAL(errors[t], 0);
+}
+
+//Time the allocation of a burst of objects followed by their release
+template<class Alloc, class Release>
+double timeAllocations(size_t nThreads, Alloc alloc, Release release)
+{
+  const size_t bursts = 2000;
+  const size_t burstSize = 100;
+  magnet::Timer timer;
+  std::vector<std::thread> threads;
+  for (size_t t(0); t < nThreads; ++t)
+    threads.push_back(std::thread([&]() {
+	  std::vector<void*> ptrs(burstSize);
+	  for (size_t b(0); b < bursts; ++b)
+	    {
+	      for (void*& ptr : ptrs)
+		ptr = alloc();
+	      for (void* ptr : ptrs)
+		release(ptr);
+	    }
+	}));
+
+  for (std::thread& thread : threads)
+    thread.join();
+
+  return timer.duration<std::nano>() / (nThreads * bursts * burstSize);
+}
+
+BOOST_AUTO_TEST_CASE( Pool_benchmark )
+{
+  for (size_t nThreads : {1, 2, 4, 8})
+    {
+      const double pooled = timeAllocations(nThreads, 
+					    []() -> void* { return new Medium; },
+					    [](void* ptr) { delete static_cast<Medium*>(ptr); });
+
+      const double shared = timeAllocations(nThreads, 
+					    []() { return detail::PoolManager::getPool().allocateShared(sizeof(Medium)); },
+					    [](void* ptr) { detail::PoolManager::getPool().releaseShared(ptr, sizeof(Medium)); });
+
+      const double heap = timeAllocations(nThreads, 
+					  []() { return ::operator new(sizeof(Medium)); },
+					  [](void* ptr) { ::operator delete(ptr); });
+
+      BOOST_TEST_MESSAGE(nThreads << " thread(s): PoolAllocated " << pooled << " ns, locked shared pool " 
+			 << shared << " ns, operator new " << heap << " ns per allocation/release (MAGNET_THREAD_LOCAL_POOLS=" 
+			 << MAGNET_THREAD_LOCAL_POOLS << ")");
+    }
+}
@@ -0,0 +1,52 @@
+/*  dynamo:- Event driven molecular dynamics simulator
+    http://www.dynamomd.org
+    Copyright (C) 2011  Marcus N Campbell Bannerman <m.bannerman@gmail.com>
+
+    This program is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    version 3 as published by the Free Software Foundation.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#define BOOST_TEST_MODULE SphericalHarmonics_test
+#include <boost/test/included/unit_test.hpp>
+#include <boost/math/special_functions/spherical_harmonic.hpp>
+#include <magnet/math/spherical_harmonics.hpp>
+#include <random>
+
+using namespace magnet::math;
+
+BOOST_AUTO_TEST_CASE( Boost_Comparison )
+{
+  const int lmax = 12;
+  SphericalHarmonics Ylm(lmax);
+  std::vector<std::complex<double> > values(Ylm.size());
+
+  std::mt19937 RNG(1);
+  std::normal_distribution<double> normal(0, 1);
+  for (size_t sample(0); sample < 100; ++sample)
+    {
+      double x = normal(RNG), y = normal(RNG), z = normal(RNG);
+      //Include the poles, where the azimuth is undefined
+      if (sample == 0) x = y = 0;
+      if (sample == 1) { x = y = 0; z = -2; }
+      const double r = std::sqrt(x * x + y * y + z * z);
+      const double theta = std::acos(z / r);
+      const double phi = std::atan2(y, x);
+
+      Ylm.evaluate(x, y, z, values.data());
+      for (int l(0); l <= lmax; ++l)
+	for (int m(-l); m <= l; ++m)
+	  {
+	    const std::complex<double> expected = boost::math::spherical_harmonic(l, m, theta, phi);
+	    BOOST_CHECK_SMALL(std::abs(values[SphericalHarmonics::index(l, m)] - expected), 1e-12);
+	  }
+    }
+}
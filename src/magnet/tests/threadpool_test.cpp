@@ -2,6 +2,9 @@
 #include <vector>
 #include <stdexcept>
 #include <magnet/thread/threadpool.hpp>
+#include <magnet/thread/workstealingpool.hpp>
+#include <magnet/timer.hpp>
+#include <atomic>
 
 std::vector<float> sums;
 
@@ -33,6 +36,125 @@ struct A
   { std::cerr << "Inside memberfunc3, i=" << i << ", j=" << j << "\n"; }
 };
 
+//Recursively split a range into tasks, summing the range
+void recursiveSum(magnet::thread::WorkStealingPool& pool, size_t begin, size_t end, std::atomic<size_t>& sum)
+{
+  if (end - begin <= 16)
+    {
+      size_t local = 0;
+      for (size_t i(begin); i < end; ++i)
+	local += i;
+      sum += local;
+      return;
+    }
+
+  const size_t mid = (begin + end) / 2;
+  magnet::thread::WorkStealingPool::TaskGroup group(pool);
+  group.run(std::bind(recursiveSum, std::ref(pool), begin, mid, std::ref(sum)));
+  recursiveSum(pool, mid, end, sum);
+  group.wait();
+}
+
+void workStealingStress(size_t threads)
+{
+  magnet::thread::WorkStealingPool pool;
+  pool.setThreadCount(threads);
+
+  //Many tiny tasks queued from the main thread
+  for (size_t loop(0); loop < 100; ++loop)
+    {
+      std::atomic<size_t> count(0);
+      for (size_t i(0); i < 1000; ++i)
+	pool.queueTask([&count]() { ++count; });
+      pool.wait();
+      if (count != 1000)
+	throw std::runtime_error("WorkStealingPool lost a task");
+    }
+
+  //Tasks which queue tasks from the workers, nested task groups
+  for (size_t loop(0); loop < 20; ++loop)
+    {
+      const size_t N = 100000;
+      std::atomic<size_t> sum(0);
+      pool.queueTask(std::bind(recursiveSum, std::ref(pool), 0, N, std::ref(sum)));
+      pool.wait();
+      if (sum != N * (N - 1) / 2)
+	throw std::runtime_error("WorkStealingPool nested task groups gave the wrong result");
+    }
+
+  //Futures
+  {
+    std::vector<std::future<size_t> > results;
+    for (size_t i(0); i < 1000; ++i)
+      results.push_back(pool.submit([i]() { return i * i; }));
+    //In 0 thread mode the tasks are only run by wait
+    pool.wait();
+    for (size_t i(0); i < 1000; ++i)
+      if (results[i].get() != i * i)
+	throw std::runtime_error("WorkStealingPool future returned the wrong value");
+
+    std::future<int> failing = pool.submit([]() -> int { throw std::runtime_error("expected"); });
+    pool.wait();
+    bool caught = false;
+    try { failing.get(); } catch (std::runtime_error&) { caught = true; }
+    if (!caught)
+      throw std::runtime_error("WorkStealingPool future did not propagate an exception");
+  }
+
+  //Task group exception propagation
+  {
+    magnet::thread::WorkStealingPool::TaskGroup group(pool);
+    for (size_t i(0); i < 100; ++i)
+      group.run([i]() { if (i == 50) throw std::runtime_error("expected"); });
+    bool caught = false;
+    try { group.wait(); } catch (std::runtime_error&) { caught = true; }
+    if (!caught)
+      throw std::runtime_error("WorkStealingPool task group did not propagate an exception");
+  }
+
+  //Exceptions of plain tasks are reported by wait
+  {
+    pool.queueTask([]() { throw std::runtime_error("expected"); });
+    bool caught = false;
+    try { pool.wait(); } catch (std::exception&) { caught = true; }
+    if (!caught)
+      throw std::runtime_error("WorkStealingPool::wait did not report an exception");
+    //The exception is only reported once
+    pool.wait();
+  }
+}
+
+//Time the queueing and running of many tiny tasks
+template<class Pool>
+double throughput(Pool& pool, size_t tasks)
+{
+  std::atomic<size_t> count(0);
+  magnet::Timer timer;
+  for (size_t loop(0); loop < 10; ++loop)
+    {
+      std::vector<std::function<void()> > funcs(tasks, [&count]() { ++count; });
+      pool.queueTasks(funcs);
+      pool.wait();
+    }
+  const double time = timer.duration<std::nano>() / (10 * tasks);
+  if (count != 10 * tasks)
+    throw std::runtime_error("A pool lost a task");
+  return time;
+}
+
+//Time tasks queued from within the tasks (a chain of follow-on tasks per thread)
+template<class Pool>
+double chainThroughput(Pool& pool, size_t length)
+{
+  std::atomic<size_t> count(0);
+  std::function<void()> step = [&]() { if (++count % length) pool.queueTask(step); };
+  magnet::Timer timer;
+  for (size_t i(0); i < pool.getThreadCount(); ++i)
+    pool.queueTask(step);
+  pool.wait();
+  return timer.duration<std::nano>() / count;
+}
+
 int main()
 {
   int N = 1000;
@@ -94,6 +216,20 @@ int main()
 	}
     }
 
+  std::cerr << "Stress testing the WorkStealingPool\n";
+  for (size_t threads : {0, 1, 4, 8})
+    workStealingStress(threads);
+
+  {
+    magnet::thread::WorkStealingPool stealingPool;
+    stealingPool.setThreadCount(4);
+    const size_t tasks = 100000;
+    std::cerr << "Tiny task throughput, ThreadPool " << throughput(pool, tasks) << "ns/task, WorkStealingPool "
+	      << throughput(stealingPool, tasks) << "ns/task\n";
+    std::cerr << "Follow-on task throughput, ThreadPool " << chainThroughput(pool, 10000) << "ns/task, WorkStealingPool "
+	      << chainThroughput(stealingPool, 10000) << "ns/task\n";
+  }
+
   std::cerr << "Finished\n";
 
   return 0;